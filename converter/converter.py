@@ -1,6 +1,9 @@
 import os
 import argparse
 import json
+import subprocess
+import sys
+from collections import defaultdict
 from neo4j import GraphDatabase
 
 
@@ -27,6 +30,21 @@ def parse_args():
         default=os.getenv("NEO4J_PASSWORD", "PASSWORD"),
         help="Пароль для подключения к Neo4j (по умолчанию берётся из переменной окружения NEO4J_PASSWORD или используется 'PASSWORD')"
     )
+    parser.add_argument(
+        "--closure",
+        action="store_true",
+        help="Материализовать транзитивное замыкание CONTAINS в виде связей IN_SUBTREE (используется транслятором с флагом -c)"
+    )
+    parser.add_argument(
+        "--workspace",
+        default=None,
+        help="Имя рабочего пространства, которым помечаются все узлы модели (по умолчанию берётся имя workspace из JSON или имя файла)"
+    )
+    parser.add_argument(
+        "--graph_analysis",
+        default=os.getenv("GRAPH_ANALYSIS", "graph-analysis"),
+        help="Путь к исполняемому файлу graph-analysis, вычисляющему точки сочленения и мосты (по умолчанию берётся из переменной окружения GRAPH_ANALYSIS или ищется в PATH)"
+    )
     return parser.parse_args()
 
 
@@ -52,6 +70,16 @@ def load_structurizr_model(json_path):
     return model
 
 
+def workspace_name(model, json_path, override=None):
+    """
+    Определяет имя рабочего пространства: явно заданное, имя из JSON
+    или имя файла без расширения.
+    """
+    if override:
+        return override
+    return model.get('name') or os.path.splitext(os.path.basename(json_path))[0]
+
+
 def extract_elements_and_relationships(model):
     """
     Собирает из JSON все элементы (узлы) и отношения, 
@@ -190,16 +218,57 @@ def process_deployment_node(node, elements, relationships, parent_id=None):
         relationships.extend(infra_node.get('relationships', []))
 
 
-def import_elements(tx, elements):
+ALLOWED_LABELS = [
+    'Person', 'SoftwareSystem', 'Container',
+    'Component', 'DeploymentNode', 'ContainerInstance',
+    'InfrastructureNode'
+]
+
+
+def create_workspace_indexes(tx):
+    """
+    Создаёт составные индексы (workspace, id), по которым импорт и правила
+    находят узлы внутри одного рабочего пространства.
+    """
+    for label in ALLOWED_LABELS:
+        tx.run(
+            f"CREATE INDEX {label.lower()}_workspace_id IF NOT EXISTS "
+            f"FOR (n:{label}) ON (n.workspace, n.id)"
+        )
+
+
+def element_labels(elements):
+    """
+    Сопоставляет id элемента его метке: узлы ищутся с меткой, чтобы
+    использовался индекс (workspace, id) этой метки.
+    """
+    labels = {}
+    for element in elements:
+        if element.get('type') in ALLOWED_LABELS:
+            labels.setdefault(element['id'], element['type'])
+    return labels
+
+
+def group_by_labels(rows, labels, *keys):
+    """
+    Группирует строки по меткам узлов, на которые указывают поля keys.
+    Строки с неизвестными узлами пропускаются.
+    """
+    groups = defaultdict(list)
+    for row in rows:
+        group = tuple(labels.get(row[key]) for key in keys)
+        if None not in group:
+            groups[group].append(row)
+    return groups
+
+
+def import_elements(tx, elements, labels, workspace):
     """
     Создаёт (MERGE) в графе узлы различных типов,
     в том числе ContainerInstance с полями containerName и instanceCount.
+    Узлы идентифицируются парой (workspace, id), поэтому несколько моделей
+    не пересекаются в одной базе.
     """
-    allowed_labels = [
-        'Person', 'SoftwareSystem', 'Container',
-        'Component', 'DeploymentNode', 'ContainerInstance',
-        'InfrastructureNode'
-    ]
 
     for element in elements:
         element_id = element.get('id')
@@ -214,17 +283,18 @@ def import_elements(tx, elements):
         container_name = element.get('containerName', None)
         instance_count = element.get('instanceCount', None)
 
-        if element_type not in allowed_labels:
+        if element_type not in ALLOWED_LABELS:
             print(
                 f"Предупреждение: неизвестный тип узла '{element_type}'. Узел пропущен.")
             continue
 
         query = (
-            f"MERGE (n:{element_type} {{id: $id}}) "
+            f"MERGE (n:{element_type} {{workspace: $workspace, id: $id}}) "
             "SET n.name = $name, n.tags = $tags, n += $properties "
         )
 
         params = {
+            'workspace': workspace,
             'id': element_id,
             'name': element_name,
             'tags': tags,
@@ -249,16 +319,18 @@ def import_elements(tx, elements):
 
         tx.run(query, **params)
 
-        if parent_id:
+        if parent_id in labels:
             tx.run(
-                "MATCH (parent {id: $parent_id}), (child {id: $child_id}) "
+                f"MATCH (parent:{labels[parent_id]} {{workspace: $workspace, id: $parent_id}}), "
+                f"(child:{element_type} {{workspace: $workspace, id: $child_id}}) "
                 "MERGE (parent)-[:CONTAINS]->(child)",
+                workspace=workspace,
                 parent_id=parent_id,
                 child_id=element_id
             )
 
 
-def import_relationships(tx, relationships):
+def import_relationships(tx, relationships, labels, workspace):
     """
     Создаёт (MERGE) связи в графе.
     """
@@ -275,8 +347,10 @@ def import_relationships(tx, relationships):
         rel_type = relationship.get('type', 'RELATES_TO')
         rel_id = relationship.get('id')
 
-        if not source_id or not target_id:
+        if source_id not in labels or target_id not in labels:
             continue
+        source_label = labels[source_id]
+        target_label = labels[target_id]
 
         if rel_type not in allowed_rel_types:
             print(
@@ -285,11 +359,13 @@ def import_relationships(tx, relationships):
 
         if rel_id:
             query = (
-                "MATCH (a {id: $source_id}), (b {id: $target_id}) "
+                f"MATCH (a:{source_label} {{workspace: $workspace, id: $source_id}}), "
+                f"(b:{target_label} {{workspace: $workspace, id: $target_id}}) "
                 f"MERGE (a)-[r:{rel_type} {{id: $rel_id}}]->(b) "
                 "SET r.description = $description, r.technology = $technology, r.tags = $tags, r += $properties"
             )
             params = {
+                'workspace': workspace,
                 'source_id': source_id,
                 'target_id': target_id,
                 'rel_id': rel_id,
@@ -300,11 +376,13 @@ def import_relationships(tx, relationships):
             }
         else:
             query = (
-                "MATCH (a {id: $source_id}), (b {id: $target_id}) "
+                f"MATCH (a:{source_label} {{workspace: $workspace, id: $source_id}}), "
+                f"(b:{target_label} {{workspace: $workspace, id: $target_id}}) "
                 f"MERGE (a)-[r:{rel_type}]->(b) "
                 "SET r.description = $description, r.technology = $technology, r.tags = $tags, r += $properties"
             )
             params = {
+                'workspace': workspace,
                 'source_id': source_id,
                 'target_id': target_id,
                 'description': description,
@@ -316,39 +394,72 @@ def import_relationships(tx, relationships):
         tx.run(query, **params)
 
 
-def create_graph_projection(tx):
+def materialize_closure(tx, workspace):
     """
-    Создаёт проекцию графа для использования в GDS и запускает алгоритм поиска точек сочленения.
-    Если проекция с заданным именем уже существует, она будет удалена.
+    Связывает каждый элемент со всеми его предками по иерархии CONTAINS
+    связью (ancestor)-[:IN_SUBTREE]->(descendant), чтобы правила проверяли
+    вложенность одним переходом вместо обхода переменной длины.
     """
-    # Удаляем существующую проекцию, если она есть
-    tx.run("CALL gds.graph.drop('Graph', false) YIELD graphName")
-
-    projection_query = """
-    CALL gds.graph.project(
-      'Graph',
-      ['Person', 'SoftwareSystem', 'Container', 'Component', 'DeploymentNode', 'ContainerInstance', 'InfrastructureNode'],
-      {
-        RELATES_TO: {
-          type: 'RELATES_TO',
-          orientation: 'UNDIRECTED'
-        },
-        CONTAINS: {
-          type: 'CONTAINS',
-          orientation: 'UNDIRECTED'
-        },
-        INSTANCE_OF: {
-          type: 'INSTANCE_OF',
-          orientation: 'UNDIRECTED'
-        }
-      }
-    ) YIELD graphName, nodeCount, relationshipCount
-    WITH graphName
-    CALL gds.articulationPoints.write(graphName, { writeProperty: 'articulationPoint'})
-    YIELD articulationPointCount
-    RETURN articulationPointCount
+    for label in ALLOWED_LABELS:
+        tx.run(
+            f"MATCH (:{label} {{workspace: $workspace}})-[r:IN_SUBTREE]->() DELETE r",
+            workspace=workspace
+        )
+        tx.run(
+            f"MATCH (ancestor:{label} {{workspace: $workspace}})-[:CONTAINS*]->(descendant) "
+            "MERGE (ancestor)-[:IN_SUBTREE]->(descendant)",
+            workspace=workspace
+        )
+
+
+def analyse_graph(executable, json_path):
+    """
+    Запускает graph-analysis из language/ и возвращает точки сочленения,
+    мосты и компоненты двусвязности неориентированного графа модели.
     """
-    tx.run(projection_query)
+    try:
+        result = subprocess.run(
+            [executable, '-f', json_path],
+            capture_output=True, text=True, check=True
+        )
+    except FileNotFoundError:
+        sys.exit(
+            f"Ошибка: не найден исполняемый файл graph-analysis '{executable}'. "
+            "Укажите путь через --graph_analysis или переменную окружения GRAPH_ANALYSIS.")
+    except subprocess.CalledProcessError as error:
+        sys.exit(
+            f"Ошибка: graph-analysis завершился с кодом {error.returncode}: {error.stderr.strip()}")
+    return json.loads(result.stdout)
+
+
+def write_biconnectivity(tx, analysis, labels, workspace):
+    """
+    Записывает результаты graph-analysis в граф: articulationPoint (0 или 1)
+    у узлов, biconnectedComponent и bridge у связей. Заменяет проекцию GDS
+    и gds.articulationPoints, которые пересчитывались при каждом импорте.
+    """
+    nodes = group_by_labels(analysis['nodes'], labels, 'id')
+    for (label,), rows in nodes.items():
+        tx.run(
+            "UNWIND $nodes AS node "
+            f"MATCH (n:{label} {{workspace: $workspace, id: node.id}}) "
+            "SET n.articulationPoint = node.articulationPoint",
+            workspace=workspace,
+            nodes=rows
+        )
+    relationships = group_by_labels(
+        analysis['relationships'], labels, 'sourceId', 'destinationId')
+    for (source_label, target_label), rows in relationships.items():
+        tx.run(
+            "UNWIND $relationships AS relationship "
+            f"MATCH (a:{source_label} {{workspace: $workspace, id: relationship.sourceId}})"
+            "-[r:RELATES_TO|CONTAINS|INSTANCE_OF]-"
+            f"(b:{target_label} {{workspace: $workspace, id: relationship.destinationId}}) "
+            "SET r.biconnectedComponent = relationship.biconnectedComponent, "
+            "r.bridge = relationship.bridge",
+            workspace=workspace,
+            relationships=rows
+        )
 
 
 def main():
@@ -360,12 +471,18 @@ def main():
     )
 
     model = load_structurizr_model(args.file)
+    workspace = workspace_name(model, args.file, args.workspace)
     elements, relationships = extract_elements_and_relationships(model)
+    labels = element_labels(elements)
+    analysis = analyse_graph(args.graph_analysis, args.file)
 
     with driver.session() as session:
-        session.execute_write(import_elements, elements)
-        session.execute_write(import_relationships, relationships)
-        session.execute_write(create_graph_projection)
+        session.execute_write(create_workspace_indexes)
+        session.execute_write(import_elements, elements, labels, workspace)
+        session.execute_write(import_relationships, relationships, labels, workspace)
+        if args.closure:
+            session.execute_write(materialize_closure, workspace)
+        session.execute_write(write_biconnectivity, analysis, labels, workspace)
 
     driver.close()
     print("Success")
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <eval/batch.hpp>
+#include <fmt/format.h>
+#include <parser/parser.hpp>
+#include <vm/compiler.hpp>
+#include <vm/machine.hpp>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// One system of `containers` containers, built directly rather than through JSON so that a
+// million of them fit: every fifth a database, most with replicas, a third with an owner.
+lang::ast::eval::Workspace Synthetic(std::size_t containers)
+{
+    lang::graph::GraphBuilder builder;
+    builder.AddNode("1", lang::graph::Label::SOFTWARE_SYSTEM);
+    for (std::size_t i = 0; i < containers; ++i)
+    {
+        builder.AddNode(std::to_string(i + 2), lang::graph::Label::CONTAINER);
+    }
+    lang::ast::eval::Workspace workspace;
+    workspace.name = "bench";
+    workspace.graph = std::move(builder).Build();
+    workspace.properties.resize(workspace.graph.NodeCount());
+    workspace.properties[*workspace.graph.Find("1")] = {
+        {"name", "System"}, {"tags", lang::ast::eval::List{"Element", "Software System"}}};
+    for (std::size_t i = 0; i < containers; ++i)
+    {
+        auto &properties = workspace.properties[*workspace.graph.Find(std::to_string(i + 2))];
+        properties["name"] = i == containers / 2 ? "API Gateway" : "container-" + std::to_string(i);
+        properties["tags"] = i % 5 == 0 ? lang::ast::eval::List{"Element", "Container", "Database"}
+                                        : lang::ast::eval::List{"Element", "Container"};
+        properties["technology"] = lang::ast::eval::List{i % 2 == 0 ? "Java" : "Go"};
+        properties["replicas"] = static_cast<std::int64_t>(i % 4);
+        if (i % 3 == 0)
+        {
+            properties["owner"] = "team-" + std::to_string(i % 7);
+        }
+    }
+    workspace.columns = lang::ast::eval::detail::Columns(workspace.properties);
+    return workspace;
+}
+
+lang::ast::ExpressionPtr Parse(const std::string &text)
+{
+    auto result = lang::grammar::ParseTest<lang::grammar::ExpressionProduct>(text);
+    if (!result.has_value())
+    {
+        throw std::runtime_error{"Failed parsing expression"};
+    }
+    return std::move(result).value();
+}
+
+// Best of a few runs, in nanoseconds per element.
+template <typename F> double Time(std::size_t elements, F &&f)
+{
+    double best = 1e300;
+    for (int run = 0; run < 5; ++run)
+    {
+        const auto start = Clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start)
+                                  .count());
+    }
+    return best / static_cast<double>(elements);
+}
+
+// The bytecode machine has no calls or keyword sets: nullopt for a predicate it cannot run.
+std::optional<lang::ast::vm::Program> Compile(const lang::ast::ExpressionPtr &expr)
+{
+    try
+    {
+        return lang::ast::vm::Compile(expr);
+    }
+    catch (const std::runtime_error &)
+    {
+        return std::nullopt;
+    }
+}
+
+void Run(const lang::ast::eval::Workspace &workspace, const lang::ast::vm::Records &records,
+         const std::string &text)
+{
+    const auto expr = Parse(text);
+    const auto nodes = workspace.graph.Nodes(lang::graph::Label::CONTAINER);
+    const auto elements = nodes.size();
+    lang::ast::eval::EvaluatorContext context{workspace};
+    auto &bound = context.row["c"];
+
+    std::size_t walkCount = 0;
+    const auto walk = Time(elements,
+                           [&]
+                           {
+                               walkCount = 0;
+                               for (const auto node : nodes)
+                               {
+                                   bound = lang::ast::eval::Node{node};
+                                   walkCount += lang::ast::eval::IsTrue(
+                                       lang::ast::eval::Evaluator<lang::ast::ExpressionPtr>{
+                                           context}(expr));
+                               }
+                           });
+    std::string vm = "-";
+    std::size_t vmCount = walkCount;
+    if (const auto program = Compile(expr); program)
+    {
+        lang::ast::vm::Machine machine{*program, records};
+        std::vector<lang::ast::eval::Value> arguments(1);
+        vm = fmt::format("{:.1f}", Time(elements,
+                                        [&]
+                                        {
+                                            vmCount = 0;
+                                            for (const auto node : nodes)
+                                            {
+                                                arguments[0] = lang::ast::eval::Node{node};
+                                                vmCount += lang::ast::eval::IsTrue(
+                                                    machine.Run(arguments));
+                                            }
+                                        }));
+    }
+    std::size_t batchCount = 0;
+    const auto batch = Time(elements,
+                            [&]
+                            {
+                                batchCount = lang::ast::eval::EvaluateBatch(
+                                                 expr, workspace, "c",
+                                                 lang::graph::Label::CONTAINER)
+                                                 .yes.Count();
+                            });
+
+    std::cout << fmt::format("{:<68} {:>8} {:>7.1f} {:>7} {:>7.2f} {:>7.1f}x {:>6} {}\n", text,
+                             elements, walk, vm, batch, walk / batch, batchCount,
+                             walkCount == batchCount && vmCount == batchCount ? "" : "MISMATCH");
+}
+
+} // namespace
+
+// Row-at-a-time evaluation, tree-walking and bytecode, against batch evaluation of a whole
+// label partition, per element. Build with optimization (-DCMAKE_BUILD_TYPE=Release).
+int main()
+{
+    std::cout << fmt::format("{:<68} {:>8} {:>7} {:>7} {:>7} {:>8} {:>6}\n", "predicate", "rows",
+                             "walk ns", "vm ns", "batch", "speedup", "true");
+    for (const std::size_t containers : {100000, 1000000})
+    {
+        const auto workspace = Synthetic(containers);
+        const lang::ast::vm::Records records{workspace};
+        for (const auto *text : {
+                 R"("Database" in c.tags and c.replicas > 1 or c.name == "API Gateway")",
+                 R"(c.owner == "team-3" xor c.replicas <= 1)",
+                 R"(cross(c.technology, ["Java", "Kotlin"]) == none)",
+                 R"(c.name == "API Gateway" and c.replicas * 2 + 1 > 5)",
+                 R"(c.!owner and c.replicas * 2 + 1 > 5)",
+             })
+        {
+            Run(workspace, records, text);
+        }
+    }
+    return 0;
+}
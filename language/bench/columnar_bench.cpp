@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <columnar/store.hpp>
+#include <fmt/format.h>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// Rows as a rule sees them today: one vector of strings per list property.
+struct Rows
+{
+    std::vector<std::vector<std::string>> tags;
+    std::vector<std::string> names;
+};
+
+Rows Synthetic(std::size_t rows, std::size_t vocabulary, std::mt19937_64 &random)
+{
+    // A few tags on nearly every element, a long tail of rare ones.
+    std::geometric_distribution<std::size_t> rank{8.0 / static_cast<double>(vocabulary)};
+    Rows result;
+    result.tags.resize(rows);
+    result.names.resize(rows);
+    for (std::size_t row = 0; row < rows; ++row)
+    {
+        for (auto count = 2 + random() % 5; count > 0; --count)
+        {
+            result.tags[row].push_back("tag-" + std::to_string(rank(random) % vocabulary));
+        }
+        result.names[row] = "element-" + std::to_string(random() % (rows / 4 + 1));
+    }
+    return result;
+}
+
+// Best of a few runs, in nanoseconds per row.
+template <typename F> double Time(std::size_t rows, F &&f)
+{
+    double best = 1e300;
+    for (int run = 0; run < 5; ++run)
+    {
+        const auto start = Clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start)
+                                  .count());
+    }
+    return best / static_cast<double>(rows);
+}
+
+void Report(const char *query, std::size_t rows, std::size_t vocabulary, const char *layout,
+            double naive, double columnar, std::size_t naiveCount, std::size_t columnarCount)
+{
+    std::cout << fmt::format("{:<22} {:>8} {:>6} {:>7} {:>9.2f} {:>9.2f} {:>7.1f}x {:>8} {}\n",
+                             query, rows, vocabulary, layout, naive,
+                             columnar, naive / columnar, columnarCount,
+                             naiveCount == columnarCount ? "" : "MISMATCH");
+}
+
+void Run(std::size_t rows, std::size_t vocabulary)
+{
+    std::mt19937_64 random{rows * 31 + vocabulary};
+    const auto data = Synthetic(rows, vocabulary, random);
+    lang::columnar::ColumnStoreBuilder builder{rows};
+    for (std::size_t row = 0; row < rows; ++row)
+    {
+        builder.Add(row, "tags", std::span<const std::string>{data.tags[row]});
+        builder.Add(row, "name", data.names[row]);
+    }
+    const auto store = std::move(builder).Build();
+    const auto &tags = *store.Lists("tags");
+    const auto &names = *store.Strings("name");
+    const auto *layout = tags.UsesBitsets() ? "bitset" : "sorted";
+
+    // `"tag-3" in e.tags`
+    const std::string tag = "tag-3";
+    std::size_t naiveCount = 0;
+    std::size_t columnarCount = 0;
+    const auto naiveIn = Time(rows,
+                              [&]
+                              {
+                                  naiveCount = 0;
+                                  for (const auto &list : data.tags)
+                                  {
+                                      naiveCount += std::ranges::find(list, tag) != list.end();
+                                  }
+                              });
+    const auto columnarIn = Time(rows, [&] { columnarCount = tags.Contains(tag).Count(); });
+    Report("\"X\" in e.tags", rows, vocabulary, layout, naiveIn, columnarIn,
+           naiveCount, columnarCount);
+
+    // `cross(e.tags, [...])`
+    const std::vector<std::string> wanted{"tag-5", "tag-17", "tag-40", "tag-2"};
+    const auto naiveCross = Time(rows,
+                                 [&]
+                                 {
+                                     naiveCount = 0;
+                                     for (const auto &list : data.tags)
+                                     {
+                                         naiveCount += std::ranges::any_of(
+                                             list, [&](const std::string &item)
+                                             { return std::ranges::find(wanted, item) !=
+                                                      wanted.end(); });
+                                     }
+                                 });
+    const auto columnarCross = Time(rows,
+                                    [&]
+                                    {
+                                        const auto terms = tags.Encode(wanted);
+                                        columnarCount = tags.Intersects(terms).Count();
+                                    });
+    Report("cross(e.tags, list)", rows, vocabulary, layout, naiveCross,
+           columnarCross, naiveCount, columnarCount);
+
+    // `e.name == "..."`
+    const auto name = data.names[rows / 2];
+    const auto naiveEqual = Time(rows,
+                                 [&]
+                                 {
+                                     naiveCount = 0;
+                                     for (const auto &value : data.names)
+                                     {
+                                         naiveCount += value == name;
+                                     }
+                                 });
+    const auto columnarEqual = Time(rows, [&] { columnarCount = names.Equal(name).Count(); });
+    Report("e.name == \"...\"", rows, vocabulary, "codes", naiveEqual, columnarEqual, naiveCount,
+           columnarCount);
+
+    std::cout << fmt::format("{:<22} {:>8} {:>6} {:>7} tags {:.1f} B/row as strings, "
+                             "{:.1f} B/row as columns\n",
+                             "memory", rows, vocabulary, "", [&]
+                             {
+                                 std::size_t bytes = 0;
+                                 for (const auto &list : data.tags)
+                                 {
+                                     bytes += sizeof(list) + list.capacity() * sizeof(list[0]);
+                                     for (const auto &item : list)
+                                     {
+                                         bytes += item.capacity() > 15 ? item.capacity() : 0;
+                                     }
+                                 }
+                                 return static_cast<double>(bytes) / static_cast<double>(rows);
+                             }(),
+                             static_cast<double>(tags.Bytes()) / static_cast<double>(rows));
+}
+
+} // namespace
+
+// Membership, intersection and equality over a column against the same loop over strings.
+// Build with optimization (-DCMAKE_BUILD_TYPE=Release), or the kernels are not vectorized.
+int main()
+{
+    std::cout << fmt::format("{:<22} {:>8} {:>6} {:>7} {:>9} {:>9} {:>8} {:>8}\n", "query",
+                             "rows", "terms", "layout", "naive ns", "column ns", "speedup",
+                             "matches");
+    for (const std::size_t rows : {100000, 1000000})
+    {
+        for (const std::size_t vocabulary : {64, 4096})
+        {
+            Run(rows, vocabulary);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <fmt/format.h>
+#include <parallel/quantifier.hpp>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::uint32_t elements = 1U << 20;
+
+// About `rounds` multiply-adds per element; true unless the hash lands on zero, which these
+// ids never do.
+bool Work(std::uint32_t id, int rounds)
+{
+    std::uint64_t hash = id + 1;
+    for (int i = 0; i < rounds; ++i)
+    {
+        hash = hash * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    return hash != 0;
+}
+
+// Best of a few runs, in milliseconds.
+template <typename F> double Time(F &&f)
+{
+    double best = 1e300;
+    for (int run = 0; run < 3; ++run)
+    {
+        const auto start = Clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start)
+                                  .count());
+    }
+    return best;
+}
+
+} // namespace
+
+// `all` over 2^20 synthetic elements by the number of threads: evenly costed elements, a
+// skewed range whose first sixteenth costs 64 times the rest, and an `exist` whose witness
+// sits in the middle. Scaling is only meaningful with as many idle cores as threads. Build with
+// optimization (-DCMAKE_BUILD_TYPE=Release).
+int main()
+{
+    std::vector<std::size_t> threads;
+    for (std::size_t count = 1; count < lang::parallel::DefaultThreads(); count *= 2)
+    {
+        threads.push_back(count);
+    }
+    threads.push_back(lang::parallel::DefaultThreads());
+
+    std::cout << fmt::format("{:>7} {:>10} {:>8} {:>10} {:>8} {:>10} {:>10}\n", "threads",
+                             "even ms", "speedup", "skewed ms", "speedup", "exist ms",
+                             "evaluated");
+    double even1 = 0;
+    double skewed1 = 0;
+    for (const auto count : threads)
+    {
+        lang::parallel::Pool pool{count};
+        const auto even = Time(
+            [&]
+            {
+                lang::parallel::Quantify(pool, {0, elements}, lang::ast::QuantifierType::ALL,
+                                         [](std::uint32_t id) { return Work(id, 64); });
+            });
+        const auto skewed = Time(
+            [&]
+            {
+                lang::parallel::Quantify(pool, {0, elements}, lang::ast::QuantifierType::ALL,
+                                         [](std::uint32_t id)
+                                         { return Work(id, id < elements / 16 ? 1024 : 16); });
+            });
+        std::size_t evaluated = 0;
+        const auto exist = Time(
+            [&]
+            {
+                evaluated = lang::parallel::Quantify(pool, {0, elements},
+                                                     lang::ast::QuantifierType::ANY,
+                                                     [](std::uint32_t id)
+                                                     {
+                                                         return Work(id, 64) &&
+                                                                id == elements / 2;
+                                                     })
+                                .evaluated;
+            });
+        even1 = count == 1 ? even : even1;
+        skewed1 = count == 1 ? skewed : skewed1;
+        std::cout << fmt::format("{:>7} {:>10.1f} {:>7.1f}x {:>10.1f} {:>7.1f}x {:>10.1f} {:>10}\n",
+                                 count, even, even1 / even, skewed, skewed1 / skewed, exist,
+                                 evaluated);
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+#include <graph/reachability.hpp>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+double Seconds(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Mostly forward edges between nearby nodes, as layered architectures have, with a share of
+// backward edges that close cycles.
+lang::graph::Graph Synthetic(std::size_t nodes, std::size_t edges, double backward,
+                             std::mt19937_64 &random)
+{
+    lang::graph::GraphBuilder builder;
+    for (std::size_t i = 0; i < nodes; ++i)
+    {
+        builder.AddNode(std::to_string(i), lang::graph::Label::CONTAINER);
+    }
+    std::geometric_distribution<std::size_t> distance{0.01};
+    std::bernoulli_distribution isBackward{backward};
+    for (std::size_t e = 0; e < edges;)
+    {
+        const auto source = random() % nodes;
+        const auto step = 1 + distance(random);
+        const auto target = isBackward(random) ? source - std::min(step, source)
+                                               : std::min(source + step, nodes - 1);
+        if (source == target)
+        {
+            continue;
+        }
+        ++e;
+        builder.AddEdge(std::to_string(source), std::to_string(target),
+                        lang::graph::Relation::RELATES_TO);
+    }
+    return std::move(builder).Build();
+}
+
+bool Traverse(const lang::graph::Graph &graph, lang::graph::NodeId from, lang::graph::NodeId to,
+              std::vector<std::uint32_t> &seen, std::uint32_t stamp)
+{
+    std::deque<lang::graph::NodeId> queue{from};
+    while (!queue.empty())
+    {
+        const auto v = queue.front();
+        queue.pop_front();
+        for (const auto w : graph.Out(v, lang::graph::Relation::RELATES_TO))
+        {
+            if (w == to)
+            {
+                return true;
+            }
+            if (seen[w] != stamp)
+            {
+                seen[w] = stamp;
+                queue.push_back(w);
+            }
+        }
+    }
+    return false;
+}
+
+void Run(std::size_t nodes, std::size_t edges, double backward, std::size_t bitsetLimit)
+{
+    std::mt19937_64 random{nodes ^ edges};
+    const auto graph = Synthetic(nodes, edges, backward, random);
+
+    auto start = Clock::now();
+    const lang::graph::ReachabilityIndex index{graph, lang::graph::routeRelations,
+                                               {.bitsetLimit = bitsetLimit}};
+    const auto build = Seconds(start);
+
+    constexpr std::size_t queries = 1000000;
+    std::vector<std::pair<lang::graph::NodeId, lang::graph::NodeId>> pairs(queries);
+    for (auto &[from, to] : pairs)
+    {
+        from = static_cast<lang::graph::NodeId>(random() % graph.NodeCount());
+        to = static_cast<lang::graph::NodeId>(random() % graph.NodeCount());
+    }
+    start = Clock::now();
+    std::size_t reached = 0;
+    for (const auto &[from, to] : pairs)
+    {
+        reached += index.Reaches(from, to) ? 1 : 0;
+    }
+    const auto indexed = Seconds(start) / queries;
+
+    // Traversal is too slow for every pair; a sample also checks the index.
+    constexpr std::size_t sample = 200;
+    std::vector<std::uint32_t> seen(graph.NodeCount(), 0);
+    std::size_t mismatches = 0;
+    start = Clock::now();
+    for (std::size_t i = 0; i < sample; ++i)
+    {
+        const auto [from, to] = pairs[i];
+        const auto expected = Traverse(graph, from, to, seen, static_cast<std::uint32_t>(i + 1));
+        mismatches += expected != index.Reaches(from, to) ? 1 : 0;
+    }
+    const auto traversed = Seconds(start) / sample;
+
+    std::cout << fmt::format("{:>8} {:>8} {:>5.3f} {:>7} {:>7} {:>9.3f} {:>8.1f} {:>10.1f} "
+                             "{:>10.0f} {:>6.3f} {:>4}\n",
+                             graph.NodeCount(), graph.EdgeCount(), backward,
+                             index.ComponentCount(), index.UsesBitset() ? "bitset" : "2-hop",
+                             build, static_cast<double>(index.Bytes()) / (1 << 20),
+                             indexed * 1e9, traversed * 1e9,
+                             static_cast<double>(reached) / queries, mismatches);
+}
+
+} // namespace
+
+// Build time, size and per-query latency of the reachability index against a BFS per query.
+int main()
+{
+    std::cout << fmt::format("{:>8} {:>8} {:>5} {:>7} {:>7} {:>9} {:>8} {:>10} {:>10} {:>6} "
+                             "{:>4}\n",
+                             "nodes", "edges", "back", "sccs", "index", "build, s", "MiB",
+                             "index, ns", "bfs, ns", "reach", "diff");
+    for (const auto &[nodes, edges] : {std::pair<std::size_t, std::size_t>{10000, 100000},
+                                       {50000, 300000},
+                                       {100000, 1000000}})
+    {
+        for (const auto backward : {0.0, 0.001, 0.05})
+        {
+            Run(nodes, edges, backward, lang::graph::ReachabilityOptions{}.bitsetLimit);
+        }
+    }
+    // The same graph both ways, to compare bitset and labels directly.
+    Run(8000, 100000, 0.001, 0);
+    Run(8000, 100000, 0.001, 8192);
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <eval/evaluator.hpp>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+#include <parser/parser.hpp>
+#include <vm/compiler.hpp>
+#include <vm/machine.hpp>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// One system of `containers` containers, every fifth a database, most with replicas and some
+// with an owner.
+nlohmann::json Synthetic(std::size_t containers)
+{
+    auto items = nlohmann::json::array();
+    for (std::size_t i = 0; i < containers; ++i)
+    {
+        nlohmann::json properties{{"replicas", static_cast<std::int64_t>(i % 4)}};
+        if (i % 3 == 0)
+        {
+            properties["owner"] = "team-" + std::to_string(i % 7);
+        }
+        items.push_back({{"id", std::to_string(i + 2)},
+                         {"name", i == containers / 2 ? "API Gateway"
+                                                      : "container-" + std::to_string(i)},
+                         {"tags", i % 5 == 0 ? "Element,Container,Database" : "Element,Container"},
+                         {"technology", i % 2 == 0 ? "Java" : "Go"},
+                         {"properties", properties}});
+    }
+    const nlohmann::json system{{"id", "1"},
+                                {"name", "System"},
+                                {"tags", "Element,Software System"},
+                                {"containers", items}};
+    return {{"name", "bench"}, {"model", {{"softwareSystems", nlohmann::json::array({system})}}}};
+}
+
+lang::ast::ExpressionPtr Parse(const std::string &text)
+{
+    auto result = lang::grammar::ParseTest<lang::grammar::ExpressionProduct>(text);
+    if (!result.has_value())
+    {
+        throw std::runtime_error{"Failed parsing expression"};
+    }
+    return std::move(result).value();
+}
+
+// Best of a few runs, in nanoseconds per element.
+template <typename F> double Time(std::size_t elements, F &&f)
+{
+    double best = 1e300;
+    for (int run = 0; run < 5; ++run)
+    {
+        const auto start = Clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start)
+                                  .count());
+    }
+    return best / static_cast<double>(elements);
+}
+
+void Run(const lang::ast::eval::Workspace &workspace, const lang::ast::vm::Records &records,
+         const std::string &text)
+{
+    const auto expr = Parse(text);
+    const auto program = lang::ast::vm::Compile(expr);
+    const auto elements = workspace.graph.NodeCount();
+    lang::ast::eval::EvaluatorContext context{workspace};
+    auto &bound = context.row["c"];
+    lang::ast::vm::Machine machine{program, records};
+    std::vector<lang::ast::eval::Value> arguments(1);
+
+    std::size_t mismatches = 0;
+    for (std::uint32_t i = 0; i < elements; ++i)
+    {
+        bound = arguments[0] = lang::ast::eval::Node{i};
+        mismatches += lang::ast::eval::Evaluator<lang::ast::ExpressionPtr>{context}(expr) !=
+                      machine.Run(arguments);
+    }
+
+    std::size_t walkCount = 0;
+    const auto walk = Time(elements,
+                           [&]
+                           {
+                               walkCount = 0;
+                               for (std::uint32_t i = 0; i < elements; ++i)
+                               {
+                                   bound = lang::ast::eval::Node{i};
+                                   walkCount += lang::ast::eval::IsTrue(
+                                       lang::ast::eval::Evaluator<lang::ast::ExpressionPtr>{
+                                           context}(expr));
+                               }
+                           });
+    std::size_t vmCount = 0;
+    const auto vm = Time(elements,
+                         [&]
+                         {
+                             vmCount = 0;
+                             for (std::uint32_t i = 0; i < elements; ++i)
+                             {
+                                 arguments[0] = lang::ast::eval::Node{i};
+                                 vmCount += lang::ast::eval::IsTrue(
+                                     machine.Run(arguments));
+                             }
+                         });
+
+    std::cout << fmt::format("{:<70} {:>4} {:>8.1f} {:>8.1f} {:>7.1f}x {:>6} {}\n", text,
+                             program.code.size(), walk, vm, walk / vm, vmCount,
+                             mismatches == 0 && walkCount == vmCount ? "" : "MISMATCH");
+}
+
+} // namespace
+
+// Tree-walking evaluation against the bytecode machine, per element of a synthetic workspace.
+// Build with optimization (-DCMAKE_BUILD_TYPE=Release).
+int main()
+{
+    const auto workspace = lang::ast::eval::LoadWorkspace(Synthetic(20000));
+    const lang::ast::vm::Records records{workspace};
+    std::cout << fmt::format("{:<70} {:>4} {:>8} {:>8} {:>8} {:>6}\n", "expression", "ops",
+                             "walk ns", "vm ns", "speedup", "true");
+    for (const auto *text : {
+             R"("Database" in c.tags and c.replicas > 1 or c.name == "API Gateway")",
+             R"(c.replicas * 2 + 1 > 5 xor c.replicas / 2 == 1)",
+             R"(c.!owner ? c.owner : "nobody")",
+             R"(c.name in ["API Gateway", "container-7"] and "Java" in c.technology)",
+         })
+    {
+        Run(workspace, records, text);
+    }
+    return 0;
+}
@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace lang::ast
 {
@@ -30,4 +31,21 @@ struct Rule
     BlockPtr calls;
 };
 
+// `instance Name = Template(arguments);`
+struct Instance
+{
+    std::string name;
+    std::string templateName;
+    std::vector<ExpressionPtr> arguments;
+};
+
+// `rule template Name(parameters) { ... }` followed by its instances; the parameters are read
+// in the body as variables bound per instance.
+struct RuleTemplate
+{
+    Rule rule;
+    std::vector<std::string> parameters;
+    std::vector<Instance> instances;
+};
+
 } // namespace lang::ast
\ No newline at end of file
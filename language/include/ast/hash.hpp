@@ -0,0 +1,435 @@
+#pragma once
+
+#include "ast/ast.hpp"
+#include "ast/expression.hpp"
+#include "ast/statement.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lang::ast
+{
+
+namespace detail
+{
+
+// The members that make up a node's structure. Source locations are left out, so the same
+// predicate written in two rules hashes and compares equal.
+template <KeywordSets K> auto Fields(const KeywordExpr<K> & /*unused*/)
+{
+    return std::tie();
+}
+
+template <typename T> auto Fields(const LiteralExpr<T> &node)
+{
+    return std::tie(node.value);
+}
+
+inline auto Fields(const SetExpr &node)
+{
+    return std::tie(node.items);
+}
+
+inline auto Fields(const VariableExpr &node)
+{
+    return std::tie(node.name);
+}
+
+template <ExprType K> auto Fields(const AccessExpr<K> &node)
+{
+    return std::tie(node.operand, node.prop);
+}
+
+template <ExprType K> auto Fields(const UnaryExpr<K> &node)
+{
+    return std::tie(node.operand);
+}
+
+inline auto Fields(const CallExpr &node)
+{
+    return std::tie(node.functionName, node.args);
+}
+
+template <ExprType K> auto Fields(const MultExpr<K> &node)
+{
+    return std::tie(node.left, node.right);
+}
+
+template <ExprType K> auto Fields(const AddExpr<K> &node)
+{
+    return std::tie(node.left, node.right);
+}
+
+template <ExprType K> auto Fields(const LogicalExpr<K> &node)
+{
+    return std::tie(node.left, node.right);
+}
+
+template <ExprType K> auto Fields(const BooleanExpr<K> &node)
+{
+    return std::tie(node.left, node.right);
+}
+
+inline auto Fields(const TernaryExpr &node)
+{
+    return std::tie(node.condition, node.thenExpr, node.elseExpr);
+}
+
+inline auto Fields(const AssignmentStatement &node)
+{
+    return std::tie(node.name, node.valueExpr);
+}
+
+template <QuantifierType Q> auto Fields(const QuantifierStatement<Q> &node)
+{
+    return std::tie(node.identifiersList, node.source, node.predicate);
+}
+
+inline auto Fields(const IfThen &node)
+{
+    return std::tie(node.expr, node.then);
+}
+
+inline auto Fields(const IfThenElse &node)
+{
+    return std::tie(node.expr, node.then, node.els);
+}
+
+inline auto Fields(const ExceptStatement &node)
+{
+    return std::tie(node.inner);
+}
+
+inline auto Fields(const StatementExpression &node)
+{
+    return std::tie(node.expr);
+}
+
+inline auto Fields(const FilteredStatement &node)
+{
+    return std::tie(node.expr, node.quant);
+}
+
+inline auto Fields(const Block &node)
+{
+    return std::tie(node.statements);
+}
+
+inline auto Fields(const Rule &node)
+{
+    return std::tie(node.name, node.description, node.priority, node.calls);
+}
+
+template <typename T>
+concept Node = requires(const T &value) { Fields(value); };
+
+template <typename T> struct IsPointer : std::false_type
+{
+};
+
+template <typename T> struct IsPointer<std::unique_ptr<T>> : std::true_type
+{
+};
+
+template <typename T> struct IsVariant : std::false_type
+{
+};
+
+template <typename... Ts> struct IsVariant<std::variant<Ts...>> : std::true_type
+{
+};
+
+template <typename T> struct IsVector : std::false_type
+{
+};
+
+template <typename T> struct IsVector<std::vector<T>> : std::true_type
+{
+};
+
+// Types that are children in the tree rather than scalar payload.
+template <typename T>
+concept Subtree = Node<T> || IsPointer<T>::value || IsVariant<T>::value;
+
+// FNV-1a keeps hashes stable across runs and standard libraries, so they can key caches.
+constexpr std::uint64_t fnvOffset = 14695981039346656037ULL;
+constexpr std::uint64_t fnvPrime = 1099511628211ULL;
+
+inline void Mix(std::uint64_t &seed, std::uint64_t value)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        seed ^= (value >> (i * 8)) & 0xFFU;
+        seed *= fnvPrime;
+    }
+}
+
+inline void Mix(std::uint64_t &seed, std::string_view value)
+{
+    Mix(seed, value.size());
+    for (const char symbol : value)
+    {
+        seed ^= static_cast<unsigned char>(symbol);
+        seed *= fnvPrime;
+    }
+}
+
+template <typename T> void HashInto(std::uint64_t &seed, const T &value)
+{
+    if constexpr (Node<T>)
+    {
+        std::apply([&](const auto &...fields) { (HashInto(seed, fields), ...); }, Fields(value));
+    }
+    else if constexpr (IsPointer<T>::value)
+    {
+        Mix(seed, value != nullptr);
+        if (value)
+        {
+            HashInto(seed, *value);
+        }
+    }
+    else if constexpr (IsVariant<T>::value)
+    {
+        Mix(seed, value.index());
+        std::visit([&](const auto &alternative) { HashInto(seed, alternative); }, value);
+    }
+    else if constexpr (IsVector<T>::value)
+    {
+        Mix(seed, value.size());
+        for (const auto &item : value)
+        {
+            HashInto(seed, item);
+        }
+    }
+    else if constexpr (std::is_convertible_v<const T &, std::string_view>)
+    {
+        Mix(seed, std::string_view{value});
+    }
+    else if constexpr (std::is_enum_v<T>)
+    {
+        Mix(seed, static_cast<std::uint64_t>(std::to_underlying(value)));
+    }
+    else
+    {
+        static_assert(std::is_integral_v<T>, "no structural hash for this type");
+        Mix(seed, static_cast<std::uint64_t>(value));
+    }
+}
+
+template <typename T> bool EqualTo(const T &lhs, const T &rhs)
+{
+    if constexpr (Node<T>)
+    {
+        const auto left = Fields(lhs);
+        const auto right = Fields(rhs);
+        return [&]<std::size_t... I>(std::index_sequence<I...>)
+        {
+            return (EqualTo(std::get<I>(left), std::get<I>(right)) && ...);
+        }(std::make_index_sequence<std::tuple_size_v<decltype(left)>>{});
+    }
+    else if constexpr (IsPointer<T>::value)
+    {
+        if (!lhs || !rhs)
+        {
+            return !lhs && !rhs;
+        }
+        return EqualTo(*lhs, *rhs);
+    }
+    else if constexpr (IsVariant<T>::value)
+    {
+        return lhs.index() == rhs.index() &&
+               std::visit(
+                   [&](const auto &left)
+                   { return EqualTo(left, std::get<std::decay_t<decltype(left)>>(rhs)); },
+                   lhs);
+    }
+    else if constexpr (IsVector<T>::value)
+    {
+        if (lhs.size() != rhs.size())
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < lhs.size(); ++i)
+        {
+            if (!EqualTo(lhs[i], rhs[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    else
+    {
+        return lhs == rhs;
+    }
+}
+
+} // namespace detail
+
+// Structural hash and equality of any AST node, pointer or variant of nodes.
+template <typename T> std::uint64_t Hash(const T &node)
+{
+    auto seed = detail::fnvOffset;
+    detail::HashInto(seed, node);
+    return seed;
+}
+
+template <typename T> bool Equal(const T &lhs, const T &rhs)
+{
+    return detail::EqualTo(lhs, rhs);
+}
+
+struct StructuralHash
+{
+    template <typename T> std::size_t operator()(const T &node) const
+    {
+        return static_cast<std::size_t>(Hash(node));
+    }
+};
+
+struct StructuralEqual
+{
+    template <typename T> bool operator()(const T &lhs, const T &rhs) const
+    {
+        return Equal(lhs, rhs);
+    }
+};
+
+// Hash-consing: every structurally distinct subtree added to the builder is stored once, as a
+// node whose children are the ids of other nodes. Subtrees repeated within a rule or across
+// the rules of a pack therefore share one node and the pack becomes a DAG. Pointers and
+// variants do not get nodes of their own; a variant contributes its alternative index to the
+// tag of the node it holds.
+class HashConsing
+{
+public:
+    using Id = std::uint32_t;
+
+    struct Entry
+    {
+        std::uint64_t tag = 0;
+        std::string atoms;
+        std::vector<Id> children;
+
+        bool operator==(const Entry &) const = default;
+    };
+
+    template <typename T> Id Add(const T &node)
+    {
+        ++added_;
+        auto entry = Build(node);
+        auto &bucket = index_[Key(entry)];
+        for (const auto id : bucket)
+        {
+            if (entries_[id] == entry)
+            {
+                return id;
+            }
+        }
+        const auto id = static_cast<Id>(entries_.size());
+        entries_.push_back(std::move(entry));
+        bucket.push_back(id);
+        return id;
+    }
+
+    [[nodiscard]] const Entry &Get(Id id) const
+    {
+        return entries_.at(id);
+    }
+
+    // Distinct subtrees stored.
+    [[nodiscard]] std::size_t Size() const
+    {
+        return entries_.size();
+    }
+
+    // Subtrees added, counting every repetition.
+    [[nodiscard]] std::size_t Added() const
+    {
+        return added_;
+    }
+
+private:
+    std::vector<Entry> entries_;
+    std::unordered_map<std::uint64_t, std::vector<Id>> index_;
+    std::size_t added_ = 0;
+
+    static std::uint64_t Key(const Entry &entry)
+    {
+        auto seed = detail::fnvOffset;
+        detail::Mix(seed, entry.tag);
+        detail::Mix(seed, entry.atoms);
+        for (const auto id : entry.children)
+        {
+            detail::Mix(seed, id);
+        }
+        return seed;
+    }
+
+    template <typename T> Entry Build(const T &node)
+    {
+        if constexpr (detail::IsPointer<T>::value)
+        {
+            if (!node)
+            {
+                throw std::runtime_error{"broken AST: ptr is null in hash-consing"};
+            }
+            return Build(*node);
+        }
+        else if constexpr (detail::IsVariant<T>::value)
+        {
+            auto entry = std::visit([&](const auto &alternative) { return Build(alternative); },
+                                    node);
+            detail::Mix(entry.tag, node.index() + 1);
+            return entry;
+        }
+        else
+        {
+            Entry entry;
+            std::apply([&](const auto &...fields) { (Collect(entry, fields), ...); },
+                       detail::Fields(node));
+            return entry;
+        }
+    }
+
+    template <typename T> void Collect(Entry &entry, const T &field)
+    {
+        if constexpr (detail::Subtree<T>)
+        {
+            entry.children.push_back(Add(field));
+        }
+        else if constexpr (detail::IsVector<T>::value)
+        {
+            entry.atoms += std::to_string(field.size()) + ':';
+            for (const auto &item : field)
+            {
+                Collect(entry, item);
+            }
+        }
+        else if constexpr (std::is_convertible_v<const T &, std::string_view>)
+        {
+            entry.atoms += std::to_string(std::string_view{field}.size()) + ':';
+            entry.atoms += field;
+        }
+        else if constexpr (std::is_enum_v<T>)
+        {
+            entry.atoms += std::to_string(std::to_underlying(field)) + ';';
+        }
+        else
+        {
+            entry.atoms += std::to_string(field) + ';';
+        }
+    }
+};
+
+} // namespace lang::ast
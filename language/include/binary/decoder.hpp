@@ -0,0 +1,362 @@
+#pragma once
+
+#include "binary/reader.hpp"
+
+#include <ast/ast.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Rebuilds the AST from a binary document (see binary/writer.hpp), checking the kind, subtype
+// and arity of every node. The inverse of Encode, as Deserializer is of Serializer.
+namespace lang::ast::binary
+{
+
+namespace detail
+{
+
+[[noreturn]] inline void Invalid(std::string_view problem)
+{
+    throw std::runtime_error{"invalid binary AST: " + std::string{problem}};
+}
+
+inline void Expect(const NodeView &node, NodeKind kind, std::size_t atoms, std::size_t children)
+{
+    if (node.Kind() != kind || node.AtomCount() != atoms || node.ChildCount() != children)
+    {
+        Invalid("unexpected node shape");
+    }
+}
+
+template <typename T> auto Make(T &&node)
+{
+    return std::make_unique<Expression>(std::make_unique<std::decay_t<T>>(std::forward<T>(node)));
+}
+
+} // namespace detail
+
+template <typename T> class Decoder;
+
+template <> class Decoder<ExpressionPtr>
+{
+public:
+    ExpressionPtr operator()(const NodeView &node) const
+    {
+        switch (node.Kind())
+        {
+        case NodeKind::KEYWORD:
+            detail::Expect(node, NodeKind::KEYWORD, 0, 0);
+            return Keyword(node);
+        case NodeKind::NUMBER:
+            detail::Expect(node, NodeKind::NUMBER, 0, 0);
+            return detail::Make(LiteralExpr<int64_t>{node.Number()});
+        case NodeKind::STRING:
+            detail::Expect(node, NodeKind::STRING, 1, 0);
+            return detail::Make(LiteralExpr<std::string>{std::string{node.Atom(0)}});
+        case NodeKind::BOOL:
+            detail::Expect(node, NodeKind::BOOL, 0, 0);
+            return detail::Make(LiteralExpr<bool>{node.Bool()});
+        case NodeKind::SET:
+            detail::Expect(node, NodeKind::SET, 0, node.ChildCount());
+            return detail::Make(SetExpr{Children(node, 0)});
+        case NodeKind::VARIABLE:
+            detail::Expect(node, NodeKind::VARIABLE, 1, 0);
+            return detail::Make(
+                VariableExpr{std::string{node.Atom(0)}, node.Location().value_or(NodeLocation{})});
+        case NodeKind::CALL:
+            detail::Expect(node, NodeKind::CALL, 1, node.ChildCount());
+            return detail::Make(CallExpr{std::string{node.Atom(0)}, Children(node, 0),
+                                         node.Location().value_or(NodeLocation{})});
+        case NodeKind::ACCESS:
+            detail::Expect(node, NodeKind::ACCESS, 1, 1);
+            return Access(node);
+        case NodeKind::UNARY:
+            detail::Expect(node, NodeKind::UNARY, 0, 1);
+            if (node.Subtype<ExprType>() != ExprType::NEG)
+            {
+                detail::Invalid("unknown unary operator");
+            }
+            return detail::Make(UnaryExpr<ExprType::NEG>{Child(node, 0)});
+        case NodeKind::BINARY:
+            detail::Expect(node, NodeKind::BINARY, 0, 2);
+            return Operator(node);
+        case NodeKind::TERNARY:
+            detail::Expect(node, NodeKind::TERNARY, 0, 3);
+            return detail::Make(TernaryExpr{Child(node, 0), Child(node, 1), Child(node, 2)});
+        default:
+            detail::Invalid("expected an expression");
+        }
+    }
+
+    static std::vector<ExpressionPtr> Children(const NodeView &node, std::size_t from)
+    {
+        std::vector<ExpressionPtr> items;
+        items.reserve(node.ChildCount() - from);
+        for (std::size_t i = from; i < node.ChildCount(); ++i)
+        {
+            items.push_back(Child(node, i));
+        }
+        return items;
+    }
+
+private:
+    static ExpressionPtr Child(const NodeView &node, std::size_t index)
+    {
+        return Decoder<ExpressionPtr>{}(node.Child(index));
+    }
+
+    static ExpressionPtr Keyword(const NodeView &node)
+    {
+        const auto location = node.Location().value_or(NodeLocation{});
+        switch (node.Subtype<KeywordSets>())
+        {
+        case KeywordSets::SYSTEM:
+            return detail::Make(KeywordExpr<KeywordSets::SYSTEM>{location});
+        case KeywordSets::CONTAINER:
+            return detail::Make(KeywordExpr<KeywordSets::CONTAINER>{location});
+        case KeywordSets::COMPONENT:
+            return detail::Make(KeywordExpr<KeywordSets::COMPONENT>{location});
+        case KeywordSets::CODE:
+            return detail::Make(KeywordExpr<KeywordSets::CODE>{location});
+        case KeywordSets::DEPLOY:
+            return detail::Make(KeywordExpr<KeywordSets::DEPLOY>{location});
+        case KeywordSets::INFRASTRUCTURE:
+            return detail::Make(KeywordExpr<KeywordSets::INFRASTRUCTURE>{location});
+        case KeywordSets::NONE:
+            return detail::Make(KeywordExpr<KeywordSets::NONE>{location});
+        }
+        detail::Invalid("unknown keyword");
+    }
+
+    static ExpressionPtr Access(const NodeView &node)
+    {
+        std::string property{node.Atom(0)};
+        switch (node.Subtype<ExprType>())
+        {
+        case ExprType::ACCESS:
+            return detail::Make(
+                AccessExpr<ExprType::ACCESS>{Child(node, 0), std::move(property)});
+        case ExprType::SAFE_ACCESS:
+            return detail::Make(
+                AccessExpr<ExprType::SAFE_ACCESS>{Child(node, 0), std::move(property)});
+        default:
+            detail::Invalid("unknown access operator");
+        }
+    }
+
+    template <template <ExprType> class T, ExprType U>
+    static ExpressionPtr Binary(const NodeView &node)
+    {
+        return detail::Make(T<U>{Child(node, 0), Child(node, 1)});
+    }
+
+    static ExpressionPtr Operator(const NodeView &node)
+    {
+        switch (node.Subtype<ExprType>())
+        {
+        case ExprType::MULT:
+            return Binary<MultExpr, ExprType::MULT>(node);
+        case ExprType::DIV:
+            return Binary<MultExpr, ExprType::DIV>(node);
+        case ExprType::PLUS:
+            return Binary<AddExpr, ExprType::PLUS>(node);
+        case ExprType::MINUS:
+            return Binary<AddExpr, ExprType::MINUS>(node);
+        case ExprType::EQ:
+            return Binary<BooleanExpr, ExprType::EQ>(node);
+        case ExprType::NOT_EQ:
+            return Binary<BooleanExpr, ExprType::NOT_EQ>(node);
+        case ExprType::LESS:
+            return Binary<BooleanExpr, ExprType::LESS>(node);
+        case ExprType::GREATER:
+            return Binary<BooleanExpr, ExprType::GREATER>(node);
+        case ExprType::LESS_EQ:
+            return Binary<BooleanExpr, ExprType::LESS_EQ>(node);
+        case ExprType::GREATER_EQ:
+            return Binary<BooleanExpr, ExprType::GREATER_EQ>(node);
+        case ExprType::AND:
+            return Binary<LogicalExpr, ExprType::AND>(node);
+        case ExprType::OR:
+            return Binary<LogicalExpr, ExprType::OR>(node);
+        case ExprType::XOR:
+            return Binary<LogicalExpr, ExprType::XOR>(node);
+        case ExprType::IN:
+            return Binary<LogicalExpr, ExprType::IN>(node);
+        case ExprType::NOT_IN:
+            return Binary<LogicalExpr, ExprType::NOT_IN>(node);
+        default:
+            detail::Invalid("unknown binary operator");
+        }
+    }
+};
+
+template <> class Decoder<QuantifierPtr>
+{
+public:
+    QuantifierPtr operator()(const NodeView &node) const
+    {
+        detail::Expect(node, NodeKind::QUANTIFIER, node.AtomCount(), 2);
+        switch (node.Subtype<QuantifierType>())
+        {
+        case QuantifierType::ALL:
+            return Make<QuantifierType::ALL>(node);
+        case QuantifierType::ANY:
+            return Make<QuantifierType::ANY>(node);
+        }
+        detail::Invalid("unknown quantifier");
+    }
+
+private:
+    // Defined below, once predicates can be decoded.
+    template <QuantifierType Q> static QuantifierPtr Make(const NodeView &node);
+};
+
+template <> class Decoder<StatementExpressionPtr>
+{
+public:
+    StatementExpressionPtr operator()(const NodeView &node) const
+    {
+        detail::Expect(node, NodeKind::STATEMENT_EXPRESSION, 0, 1);
+        return std::make_unique<StatementExpression>(Decoder<ExpressionPtr>{}(node.Child(0)));
+    }
+};
+
+template <> class Decoder<PredicatePtr>
+{
+public:
+    PredicatePtr operator()(const NodeView &node) const
+    {
+        switch (node.Kind())
+        {
+        case NodeKind::STATEMENT_EXPRESSION:
+            return std::make_unique<Predicate>(Decoder<StatementExpressionPtr>{}(node));
+        case NodeKind::FILTER_STATEMENT:
+            detail::Expect(node, NodeKind::FILTER_STATEMENT, 0, 2);
+            return std::make_unique<Predicate>(std::make_unique<FilteredStatement>(
+                Decoder<StatementExpressionPtr>{}(node.Child(0)),
+                Decoder<QuantifierPtr>{}(node.Child(1))));
+        case NodeKind::IF_THEN:
+            detail::Expect(node, NodeKind::IF_THEN, 0, 2);
+            return Base(std::make_unique<Сondition>(
+                std::make_unique<IfThen>(Decoder<ExpressionPtr>{}(node.Child(0)),
+                                         Decoder<PredicatePtr>{}(node.Child(1)))));
+        case NodeKind::IF_THEN_ELSE:
+            detail::Expect(node, NodeKind::IF_THEN_ELSE, 0, 3);
+            return Base(std::make_unique<Сondition>(
+                std::make_unique<IfThenElse>(Decoder<ExpressionPtr>{}(node.Child(0)),
+                                             Decoder<PredicatePtr>{}(node.Child(1)),
+                                             Decoder<PredicatePtr>{}(node.Child(2)))));
+        case NodeKind::QUANTIFIER:
+            return Base(Decoder<QuantifierPtr>{}(node));
+        default:
+            detail::Invalid("expected a predicate");
+        }
+    }
+
+private:
+    template <typename T> static PredicatePtr Base(T &&statement)
+    {
+        return std::make_unique<Predicate>(
+            std::make_unique<BaseStatement>(std::forward<T>(statement)));
+    }
+};
+
+template <QuantifierType Q> QuantifierPtr Decoder<QuantifierPtr>::Make(const NodeView &node)
+{
+    std::vector<std::string> identifiers;
+    identifiers.reserve(node.AtomCount());
+    for (std::size_t i = 0; i < node.AtomCount(); ++i)
+    {
+        identifiers.emplace_back(node.Atom(i));
+    }
+    return std::make_unique<QuantifierStatement<Q>>(std::move(identifiers),
+                                                    Decoder<ExpressionPtr>{}(node.Child(0)),
+                                                    Decoder<PredicatePtr>{}(node.Child(1)));
+}
+
+template <> class Decoder<BodyStatementPtr>
+{
+public:
+    BodyStatementPtr operator()(const NodeView &node) const
+    {
+        switch (node.Kind())
+        {
+        case NodeKind::ASSIGNMENT:
+            detail::Expect(node, NodeKind::ASSIGNMENT, 1, 1);
+            return std::make_unique<BodyStatement>(std::make_unique<AssignmentStatement>(
+                std::string{node.Atom(0)}, Decoder<ExpressionPtr>{}(node.Child(0))));
+        case NodeKind::EXCEPT_STATEMENT:
+            detail::Expect(node, NodeKind::EXCEPT_STATEMENT, 0, 1);
+            return std::make_unique<BodyStatement>(
+                std::make_unique<ExceptStatement>(Decoder<QuantifierPtr>{}(node.Child(0))));
+        case NodeKind::QUANTIFIER:
+            return std::make_unique<BodyStatement>(Decoder<QuantifierPtr>{}(node));
+        default:
+            detail::Invalid("expected a body statement");
+        }
+    }
+};
+
+template <> class Decoder<Rule>
+{
+public:
+    Rule operator()(const NodeView &node) const
+    {
+        detail::Expect(node, NodeKind::RULE, 2, 1);
+        const auto block = node.Child(0);
+        detail::Expect(block, NodeKind::BLOCK, 0, block.ChildCount());
+        auto calls = std::make_unique<Block>();
+        calls->statements.reserve(block.ChildCount());
+        for (std::size_t i = 0; i < block.ChildCount(); ++i)
+        {
+            calls->statements.push_back(Decoder<BodyStatementPtr>{}(block.Child(i)));
+        }
+        const auto priority = node.Subtype<Priority>();
+        if (priority != Priority::INFO && priority != Priority::WARN &&
+            priority != Priority::ERROR)
+        {
+            detail::Invalid("unknown priority");
+        }
+        return Rule{std::string{node.Atom(0)}, std::string{node.Atom(1)}, priority,
+                    std::move(calls)};
+    }
+};
+
+template <> class Decoder<RuleTemplate>
+{
+public:
+    RuleTemplate operator()(const NodeView &node) const
+    {
+        detail::Expect(node, NodeKind::RULE_TEMPLATE, node.AtomCount(), node.ChildCount());
+        if (node.ChildCount() == 0)
+        {
+            detail::Invalid("rule template without a rule");
+        }
+        RuleTemplate result{Decoder<Rule>{}(node.Child(0)), {}, {}};
+        for (std::size_t i = 0; i < node.AtomCount(); ++i)
+        {
+            result.parameters.emplace_back(node.Atom(i));
+        }
+        for (std::size_t i = 1; i < node.ChildCount(); ++i)
+        {
+            const auto instance = node.Child(i);
+            detail::Expect(instance, NodeKind::INSTANCE, 2, instance.ChildCount());
+            result.instances.push_back(Instance{std::string{instance.Atom(0)},
+                                                std::string{instance.Atom(1)},
+                                                Decoder<ExpressionPtr>::Children(instance, 0)});
+        }
+        return result;
+    }
+};
+
+template <typename T> T Decode(std::string_view data)
+{
+    return Decoder<T>{}(Document{data}.Root());
+}
+
+} // namespace lang::ast::binary
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Compact binary encoding of the AST. A document is one flat buffer that is read in place:
+//
+//   header   "ARCB", u16 version, u16 flags, u32 root offset, u32 document size
+//   string   u32 length, bytes, zero padding to 4 bytes; every distinct string is stored once
+//   node     u8 kind, u8 subtype, u16 flags, u32 atom count, u32 child count,
+//            [u32 line, u32 column, u32 length]   when the node has a location
+//            [i64 value]                          for NUMBER
+//            u32 atom offsets (strings), u32 child offsets (nodes)
+//
+// All integers are little-endian and all offsets are absolute. Records are written children
+// first, so every offset points backwards and the root is the last node.
+namespace lang::ast::binary
+{
+
+inline constexpr std::array<char, 4> magic{'A', 'R', 'C', 'B'};
+// Bumped on any layout or NodeKind change; readers reject newer documents.
+inline constexpr std::uint16_t formatVersion = 1;
+
+inline constexpr std::size_t headerSize = 16;
+inline constexpr std::size_t nodeSize = 12;
+inline constexpr std::size_t locationSize = 12;
+
+// Header flags.
+inline constexpr std::uint16_t withLocations = 1U;
+// Node flags.
+inline constexpr std::uint16_t hasLocation = 1U;
+
+// The subtype byte holds the enum that specializes the kind: KeywordSets for KEYWORD, ExprType
+// for ACCESS, UNARY and BINARY, QuantifierType for QUANTIFIER, Priority for RULE and the value
+// of a BOOL.
+enum class NodeKind : std::uint8_t
+{
+    KEYWORD,
+    NUMBER,
+    STRING,
+    BOOL,
+    SET,
+    VARIABLE,
+    CALL,
+    ACCESS,
+    UNARY,
+    BINARY,
+    TERNARY,
+    ASSIGNMENT,
+    QUANTIFIER,
+    IF_THEN,
+    IF_THEN_ELSE,
+    STATEMENT_EXPRESSION,
+    FILTER_STATEMENT,
+    EXCEPT_STATEMENT,
+    BLOCK,
+    RULE,
+    RULE_TEMPLATE,
+    INSTANCE
+};
+
+namespace detail
+{
+
+template <typename T> void Store(std::string &out, T value)
+{
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+    {
+        out += static_cast<char>((static_cast<std::uint64_t>(value) >> (i * 8)) & 0xFFU);
+    }
+}
+
+template <typename T> void Store(std::string &out, std::size_t at, T value)
+{
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+    {
+        out[at + i] = static_cast<char>((static_cast<std::uint64_t>(value) >> (i * 8)) & 0xFFU);
+    }
+}
+
+// Callers check bounds.
+template <typename T> T Load(std::string_view data, std::size_t at)
+{
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+    {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[at + i])) << (i * 8);
+    }
+    return static_cast<T>(value);
+}
+
+} // namespace detail
+
+} // namespace lang::ast::binary
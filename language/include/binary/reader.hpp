@@ -0,0 +1,190 @@
+#pragma once
+
+#include "binary/format.hpp"
+
+#include <ast/expression.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace lang::ast::binary
+{
+
+// A node of an encoded document, read in place: nothing is decoded until it is asked for, and
+// every access is checked against the bounds of the buffer. The buffer must outlive the view.
+class NodeView
+{
+public:
+    NodeView(std::string_view data, std::uint32_t offset) : data_(data), offset_(offset)
+    {
+        Require(offset_, nodeSize);
+        if (static_cast<unsigned char>(data_[offset_]) > std::to_underlying(NodeKind::INSTANCE))
+        {
+            throw std::runtime_error{"broken binary AST: unknown node kind"};
+        }
+        if (Flags() & hasLocation)
+        {
+            Require(offset_ + nodeSize, locationSize);
+        }
+        if (Kind() == NodeKind::NUMBER)
+        {
+            Require(Payload(), sizeof(std::int64_t));
+        }
+        Require(Atoms(), 4 * (std::size_t{AtomCount()} + ChildCount()));
+    }
+
+    [[nodiscard]] NodeKind Kind() const
+    {
+        return static_cast<NodeKind>(data_[offset_]);
+    }
+
+    template <typename E> [[nodiscard]] E Subtype() const
+    {
+        return static_cast<E>(static_cast<unsigned char>(data_[offset_ + 1]));
+    }
+
+    [[nodiscard]] std::optional<NodeLocation> Location() const
+    {
+        if (!(Flags() & hasLocation))
+        {
+            return std::nullopt;
+        }
+        const auto at = offset_ + nodeSize;
+        return NodeLocation{detail::Load<std::uint32_t>(data_, at),
+                            detail::Load<std::uint32_t>(data_, at + 4),
+                            detail::Load<std::uint32_t>(data_, at + 8)};
+    }
+
+    [[nodiscard]] std::int64_t Number() const
+    {
+        Expect(NodeKind::NUMBER);
+        return detail::Load<std::int64_t>(data_, Payload());
+    }
+
+    [[nodiscard]] bool Bool() const
+    {
+        Expect(NodeKind::BOOL);
+        return Subtype<std::uint8_t>() != 0;
+    }
+
+    [[nodiscard]] std::uint32_t AtomCount() const
+    {
+        return detail::Load<std::uint32_t>(data_, offset_ + 4);
+    }
+
+    [[nodiscard]] std::string_view Atom(std::size_t index) const
+    {
+        if (index >= AtomCount())
+        {
+            throw std::runtime_error{"broken binary AST: atom index out of range"};
+        }
+        const auto at = detail::Load<std::uint32_t>(data_, Atoms() + 4 * index);
+        Require(at, 4);
+        const auto length = detail::Load<std::uint32_t>(data_, at);
+        Require(at + 4, length);
+        return data_.substr(at + 4, length);
+    }
+
+    [[nodiscard]] std::uint32_t ChildCount() const
+    {
+        return detail::Load<std::uint32_t>(data_, offset_ + 8);
+    }
+
+    [[nodiscard]] NodeView Child(std::size_t index) const
+    {
+        if (index >= ChildCount())
+        {
+            throw std::runtime_error{"broken binary AST: child index out of range"};
+        }
+        const auto at =
+            detail::Load<std::uint32_t>(data_, Atoms() + 4 * (std::size_t{AtomCount()} + index));
+        // Children are written before their parent, which also rules out cycles.
+        if (at >= offset_)
+        {
+            throw std::runtime_error{"broken binary AST: child does not precede its parent"};
+        }
+        return NodeView{data_, at};
+    }
+
+private:
+    std::string_view data_;
+    std::uint32_t offset_;
+
+    [[nodiscard]] std::uint16_t Flags() const
+    {
+        return detail::Load<std::uint16_t>(data_, offset_ + 2);
+    }
+
+    [[nodiscard]] std::size_t Payload() const
+    {
+        return offset_ + nodeSize + ((Flags() & hasLocation) ? locationSize : 0);
+    }
+
+    [[nodiscard]] std::size_t Atoms() const
+    {
+        return Payload() + (Kind() == NodeKind::NUMBER ? sizeof(std::int64_t) : 0);
+    }
+
+    void Require(std::size_t at, std::size_t size) const
+    {
+        if (at > data_.size() || size > data_.size() - at)
+        {
+            throw std::runtime_error{"broken binary AST: record out of bounds"};
+        }
+    }
+
+    void Expect(NodeKind kind) const
+    {
+        if (Kind() != kind)
+        {
+            throw std::runtime_error{"broken binary AST: unexpected node kind"};
+        }
+    }
+};
+
+class Document
+{
+public:
+    explicit Document(std::string_view data) : data_(data)
+    {
+        if (data_.size() < headerSize || !std::equal(magic.begin(), magic.end(), data_.begin()))
+        {
+            throw std::runtime_error{"not a binary AST document"};
+        }
+        if (Version() > formatVersion)
+        {
+            throw std::runtime_error{"binary AST version " + std::to_string(Version()) +
+                                     " is newer than supported " + std::to_string(formatVersion)};
+        }
+        if (detail::Load<std::uint32_t>(data_, 12) != data_.size())
+        {
+            throw std::runtime_error{"broken binary AST: size does not match the header"};
+        }
+    }
+
+    [[nodiscard]] std::uint16_t Version() const
+    {
+        return detail::Load<std::uint16_t>(data_, 4);
+    }
+
+    [[nodiscard]] bool HasLocations() const
+    {
+        return (detail::Load<std::uint16_t>(data_, 6) & withLocations) != 0;
+    }
+
+    [[nodiscard]] NodeView Root() const
+    {
+        return NodeView{data_, detail::Load<std::uint32_t>(data_, 8)};
+    }
+
+private:
+    std::string_view data_;
+};
+
+} // namespace lang::ast::binary
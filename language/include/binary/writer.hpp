@@ -0,0 +1,448 @@
+#pragma once
+
+#include "binary/format.hpp"
+
+#include <ast/ast.hpp>
+
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lang::ast::binary
+{
+
+struct EncodeOptions
+{
+    // Store the source locations of keywords, variables and calls.
+    bool locations = true;
+};
+
+struct NodeRecord
+{
+    NodeKind kind;
+    std::uint8_t subtype = 0;
+    std::vector<std::uint32_t> atoms;
+    std::vector<std::uint32_t> children;
+    std::optional<NodeLocation> location;
+    std::optional<std::int64_t> number;
+};
+
+class BinaryWriter
+{
+public:
+    explicit BinaryWriter(EncodeOptions options = {}) : options_(options)
+    {
+        buffer_.append(magic.begin(), magic.end());
+        detail::Store(buffer_, formatVersion);
+        detail::Store(buffer_, static_cast<std::uint16_t>(options.locations ? withLocations : 0));
+        detail::Store(buffer_, std::uint32_t{0});
+        detail::Store(buffer_, std::uint32_t{0});
+    }
+
+    [[nodiscard]] const EncodeOptions &Options() const
+    {
+        return options_;
+    }
+
+    std::uint32_t String(const std::string &value)
+    {
+        const auto found = strings_.find(value);
+        if (found != strings_.end())
+        {
+            return found->second;
+        }
+        const auto offset = Offset();
+        detail::Store(buffer_, Narrow(value.size()));
+        buffer_ += value;
+        Align();
+        strings_.emplace(value, offset);
+        return offset;
+    }
+
+    std::uint32_t Node(const NodeRecord &record)
+    {
+        const bool located = record.location.has_value() && options_.locations;
+        const auto offset = Offset();
+        buffer_ += static_cast<char>(record.kind);
+        buffer_ += static_cast<char>(record.subtype);
+        detail::Store(buffer_, static_cast<std::uint16_t>(located ? hasLocation : 0));
+        detail::Store(buffer_, Narrow(record.atoms.size()));
+        detail::Store(buffer_, Narrow(record.children.size()));
+        if (located)
+        {
+            detail::Store(buffer_, Narrow(record.location->line));
+            detail::Store(buffer_, Narrow(record.location->column));
+            detail::Store(buffer_, Narrow(record.location->length));
+        }
+        if (record.number)
+        {
+            detail::Store(buffer_, *record.number);
+        }
+        for (const auto atom : record.atoms)
+        {
+            detail::Store(buffer_, atom);
+        }
+        for (const auto child : record.children)
+        {
+            detail::Store(buffer_, child);
+        }
+        return offset;
+    }
+
+    // Completes the header; the writer is empty afterwards.
+    [[nodiscard]] std::string Finish(std::uint32_t root)
+    {
+        detail::Store(buffer_, 8, root);
+        detail::Store(buffer_, 12, Narrow(buffer_.size()));
+        strings_.clear();
+        return std::move(buffer_);
+    }
+
+private:
+    EncodeOptions options_;
+    std::string buffer_;
+    std::unordered_map<std::string, std::uint32_t> strings_;
+
+    static std::uint32_t Narrow(std::size_t value)
+    {
+        if (value > std::numeric_limits<std::uint32_t>::max())
+        {
+            throw std::runtime_error{"binary AST exceeds 4 GiB"};
+        }
+        return static_cast<std::uint32_t>(value);
+    }
+
+    [[nodiscard]] std::uint32_t Offset() const
+    {
+        return Narrow(buffer_.size());
+    }
+
+    void Align()
+    {
+        buffer_.append((4 - buffer_.size() % 4) % 4, '\0');
+    }
+};
+
+template <typename T> class Encoder
+{
+public:
+    std::uint32_t operator()(BinaryWriter & /*out*/, const T & /*value*/) const
+    {
+        static_assert(sizeof(T) == 0, "No binary encoding for this type");
+        return 0;
+    }
+};
+
+template <typename... Ts> class Encoder<std::variant<Ts...>>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const std::variant<Ts...> &var) const
+    {
+        return std::visit([&](auto &subValue)
+                          { return Encoder<std::decay_t<decltype(subValue)>>{}(out, subValue); },
+                          var);
+    }
+};
+
+template <typename T> class Encoder<std::unique_ptr<T>>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const std::unique_ptr<T> &ptr) const
+    {
+        if (!ptr)
+        {
+            throw std::runtime_error{"broken AST: ptr is null"};
+        }
+
+        return Encoder<T>{}(out, *ptr);
+    }
+};
+
+template <typename T> std::vector<std::uint32_t> EncodeAll(BinaryWriter &out, const T &items)
+{
+    std::vector<std::uint32_t> offsets;
+    offsets.reserve(items.size());
+    for (const auto &item : items)
+    {
+        if constexpr (std::is_same_v<std::decay_t<decltype(item)>, std::string>)
+        {
+            offsets.push_back(out.String(item));
+        }
+        else
+        {
+            offsets.push_back(Encoder<std::decay_t<decltype(item)>>{}(out, item));
+        }
+    }
+    return offsets;
+}
+
+template <KeywordSets K> class Encoder<KeywordExpr<K>>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const KeywordExpr<K> &keyword) const
+    {
+        return out.Node({.kind = NodeKind::KEYWORD,
+                         .subtype = static_cast<std::uint8_t>(K),
+                         .location = keyword.location});
+    }
+};
+
+template <typename T> class Encoder<LiteralExpr<T>>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const LiteralExpr<T> &lit) const
+    {
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            return out.Node({.kind = NodeKind::BOOL, .subtype = lit.value ? std::uint8_t{1} : 0});
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            return out.Node({.kind = NodeKind::NUMBER, .number = lit.value});
+        }
+        else
+        {
+            return out.Node({.kind = NodeKind::STRING, .atoms = {out.String(lit.value)}});
+        }
+    }
+};
+
+template <> class Encoder<SetExpr>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const SetExpr &expr) const
+    {
+        return out.Node({.kind = NodeKind::SET, .children = EncodeAll(out, expr.items)});
+    }
+};
+
+template <> class Encoder<VariableExpr>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const VariableExpr &var) const
+    {
+        return out.Node({.kind = NodeKind::VARIABLE,
+                         .atoms = {out.String(var.name)},
+                         .location = var.location});
+    }
+};
+
+template <ExprType K> class Encoder<AccessExpr<K>>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const AccessExpr<K> &expr) const
+    {
+        const auto operand = Encoder<ExpressionPtr>{}(out, expr.operand);
+        return out.Node({.kind = NodeKind::ACCESS,
+                         .subtype = static_cast<std::uint8_t>(K),
+                         .atoms = {out.String(expr.prop)},
+                         .children = {operand}});
+    }
+};
+
+template <ExprType K> class Encoder<UnaryExpr<K>>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const UnaryExpr<K> &expr) const
+    {
+        const auto operand = Encoder<ExpressionPtr>{}(out, expr.operand);
+        return out.Node({.kind = NodeKind::UNARY,
+                         .subtype = static_cast<std::uint8_t>(K),
+                         .children = {operand}});
+    }
+};
+
+template <> class Encoder<CallExpr>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const CallExpr &expr) const
+    {
+        auto args = EncodeAll(out, expr.args);
+        return out.Node({.kind = NodeKind::CALL,
+                         .atoms = {out.String(expr.functionName)},
+                         .children = std::move(args),
+                         .location = expr.location});
+    }
+};
+
+template <template <ExprType> class T, ExprType U>
+concept BinaryExpression = requires(T<U> expr) {
+    requires std::same_as<decltype(expr.left), ExpressionPtr>;
+    requires std::same_as<decltype(expr.right), ExpressionPtr>;
+};
+
+template <template <ExprType> class T, ExprType U>
+    requires BinaryExpression<T, U>
+class Encoder<T<U>>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const T<U> &expr) const
+    {
+        const auto left = Encoder<ExpressionPtr>{}(out, expr.left);
+        const auto right = Encoder<ExpressionPtr>{}(out, expr.right);
+        return out.Node({.kind = NodeKind::BINARY,
+                         .subtype = static_cast<std::uint8_t>(U),
+                         .children = {left, right}});
+    }
+};
+
+template <> class Encoder<TernaryExpr>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const TernaryExpr &expr) const
+    {
+        const auto condition = Encoder<ExpressionPtr>{}(out, expr.condition);
+        const auto thenExpr = Encoder<ExpressionPtr>{}(out, expr.thenExpr);
+        const auto elseExpr = Encoder<ExpressionPtr>{}(out, expr.elseExpr);
+        return out.Node({.kind = NodeKind::TERNARY, .children = {condition, thenExpr, elseExpr}});
+    }
+};
+
+template <> class Encoder<AssignmentStatement>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const AssignmentStatement &stmt) const
+    {
+        const auto value = Encoder<ExpressionPtr>{}(out, stmt.valueExpr);
+        return out.Node({.kind = NodeKind::ASSIGNMENT,
+                         .atoms = {out.String(stmt.name)},
+                         .children = {value}});
+    }
+};
+
+template <QuantifierType T> class Encoder<QuantifierStatement<T>>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const QuantifierStatement<T> &stmt) const
+    {
+        const auto source = Encoder<ExpressionPtr>{}(out, stmt.source);
+        const auto predicate = Encoder<PredicatePtr>{}(out, stmt.predicate);
+        return out.Node({.kind = NodeKind::QUANTIFIER,
+                         .subtype = static_cast<std::uint8_t>(T),
+                         .atoms = EncodeAll(out, stmt.identifiersList),
+                         .children = {source, predicate}});
+    }
+};
+
+template <> class Encoder<IfThen>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const IfThen &stmt) const
+    {
+        const auto condition = Encoder<ExpressionPtr>{}(out, stmt.expr);
+        const auto then = Encoder<PredicatePtr>{}(out, stmt.then);
+        return out.Node({.kind = NodeKind::IF_THEN, .children = {condition, then}});
+    }
+};
+
+template <> class Encoder<IfThenElse>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const IfThenElse &stmt) const
+    {
+        const auto condition = Encoder<ExpressionPtr>{}(out, stmt.expr);
+        const auto then = Encoder<PredicatePtr>{}(out, stmt.then);
+        const auto els = Encoder<PredicatePtr>{}(out, stmt.els);
+        return out.Node({.kind = NodeKind::IF_THEN_ELSE, .children = {condition, then, els}});
+    }
+};
+
+template <> class Encoder<StatementExpression>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const StatementExpression &stmt) const
+    {
+        const auto expr = Encoder<ExpressionPtr>{}(out, stmt.expr);
+        return out.Node({.kind = NodeKind::STATEMENT_EXPRESSION, .children = {expr}});
+    }
+};
+
+template <> class Encoder<FilteredStatement>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const FilteredStatement &stmt) const
+    {
+        const auto expr = Encoder<StatementExpressionPtr>{}(out, stmt.expr);
+        const auto quant = Encoder<QuantifierPtr>{}(out, stmt.quant);
+        return out.Node({.kind = NodeKind::FILTER_STATEMENT, .children = {expr, quant}});
+    }
+};
+
+template <> class Encoder<ExceptStatement>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const ExceptStatement &stmt) const
+    {
+        const auto inner = Encoder<QuantifierPtr>{}(out, stmt.inner);
+        return out.Node({.kind = NodeKind::EXCEPT_STATEMENT, .children = {inner}});
+    }
+};
+
+template <> class Encoder<Block>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const Block &stmt) const
+    {
+        return out.Node({.kind = NodeKind::BLOCK, .children = EncodeAll(out, stmt.statements)});
+    }
+};
+
+template <> class Encoder<Rule>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const Rule &stmt) const
+    {
+        const auto block = Encoder<BlockPtr>{}(out, stmt.calls);
+        return out.Node({.kind = NodeKind::RULE,
+                         .subtype = static_cast<std::uint8_t>(stmt.priority),
+                         .atoms = {out.String(stmt.name), out.String(stmt.description)},
+                         .children = {block}});
+    }
+};
+
+template <> class Encoder<Instance>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const Instance &instance) const
+    {
+        auto arguments = EncodeAll(out, instance.arguments);
+        return out.Node({.kind = NodeKind::INSTANCE,
+                         .atoms = {out.String(instance.name), out.String(instance.templateName)},
+                         .children = std::move(arguments)});
+    }
+};
+
+// Children: the rule, then one INSTANCE per instance.
+template <> class Encoder<RuleTemplate>
+{
+public:
+    std::uint32_t operator()(BinaryWriter &out, const RuleTemplate &stmt) const
+    {
+        std::vector<std::uint32_t> children{Encoder<Rule>{}(out, stmt.rule)};
+        for (const auto instance : EncodeAll(out, stmt.instances))
+        {
+            children.push_back(instance);
+        }
+        return out.Node({.kind = NodeKind::RULE_TEMPLATE,
+                         .atoms = EncodeAll(out, stmt.parameters),
+                         .children = std::move(children)});
+    }
+};
+
+template <typename U> std::string Encode(const U &value, EncodeOptions options = {})
+{
+    BinaryWriter out{options};
+    const auto root = Encoder<U>{}(out, value);
+    return out.Finish(root);
+}
+
+} // namespace lang::ast::binary
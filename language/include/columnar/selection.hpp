@@ -0,0 +1,221 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// A set of rows as one bit per row, and the word kernels columns are scanned with. The kernels
+// are plain branch-free loops over 64-bit words that the compiler vectorizes; nothing here is
+// specific to an instruction set.
+namespace lang::columnar
+{
+
+using Word = std::uint64_t;
+
+inline constexpr std::size_t wordBits = 64;
+
+inline constexpr std::size_t WordCount(std::size_t bits)
+{
+    return (bits + wordBits - 1) / wordBits;
+}
+
+// Whether two bitsets of the same length share a bit.
+inline bool AnyCommon(std::span<const Word> left, std::span<const Word> right)
+{
+    Word common = 0;
+    for (std::size_t i = 0; i < left.size(); ++i)
+    {
+        common |= left[i] & right[i];
+    }
+    return common != 0;
+}
+
+class Selection
+{
+public:
+    Selection() = default;
+
+    explicit Selection(std::size_t size, bool all = false)
+        : size_(size), words_(WordCount(size), all ? ~Word{0} : Word{0})
+    {
+        Trim();
+    }
+
+    [[nodiscard]] std::size_t Size() const
+    {
+        return size_;
+    }
+
+    [[nodiscard]] bool Test(std::size_t row) const
+    {
+        return (words_[row / wordBits] >> (row % wordBits) & 1U) != 0;
+    }
+
+    void Set(std::size_t row)
+    {
+        words_[row / wordBits] |= Word{1} << (row % wordBits);
+    }
+
+    void Reset(std::size_t row)
+    {
+        words_[row / wordBits] &= ~(Word{1} << (row % wordBits));
+    }
+
+    [[nodiscard]] std::size_t Count() const
+    {
+        std::size_t count = 0;
+        for (const auto word : words_)
+        {
+            count += static_cast<std::size_t>(std::popcount(word));
+        }
+        return count;
+    }
+
+    [[nodiscard]] bool Empty() const
+    {
+        Word any = 0;
+        for (const auto word : words_)
+        {
+            any |= word;
+        }
+        return any == 0;
+    }
+
+    Selection &operator&=(const Selection &other)
+    {
+        Check(other);
+        for (std::size_t i = 0; i < words_.size(); ++i)
+        {
+            words_[i] &= other.words_[i];
+        }
+        return *this;
+    }
+
+    Selection &operator|=(const Selection &other)
+    {
+        Check(other);
+        for (std::size_t i = 0; i < words_.size(); ++i)
+        {
+            words_[i] |= other.words_[i];
+        }
+        return *this;
+    }
+
+    Selection &operator^=(const Selection &other)
+    {
+        Check(other);
+        for (std::size_t i = 0; i < words_.size(); ++i)
+        {
+            words_[i] ^= other.words_[i];
+        }
+        return *this;
+    }
+
+    // Removes the rows of `other`.
+    Selection &Subtract(const Selection &other)
+    {
+        Check(other);
+        for (std::size_t i = 0; i < words_.size(); ++i)
+        {
+            words_[i] &= ~other.words_[i];
+        }
+        return *this;
+    }
+
+    Selection &Flip()
+    {
+        for (auto &word : words_)
+        {
+            word = ~word;
+        }
+        Trim();
+        return *this;
+    }
+
+    // Calls `f(row)` for every selected row in ascending order.
+    template <typename F> void ForEach(F &&f) const
+    {
+        for (std::size_t i = 0; i < words_.size(); ++i)
+        {
+            for (auto word = words_[i]; word != 0; word &= word - 1)
+            {
+                f(i * wordBits + static_cast<std::size_t>(std::countr_zero(word)));
+            }
+        }
+    }
+
+    [[nodiscard]] std::vector<std::uint32_t> Rows() const
+    {
+        std::vector<std::uint32_t> rows;
+        rows.reserve(Count());
+        ForEach([&](std::size_t row) { rows.push_back(static_cast<std::uint32_t>(row)); });
+        return rows;
+    }
+
+    [[nodiscard]] std::span<Word> Words()
+    {
+        return words_;
+    }
+
+    [[nodiscard]] std::span<const Word> Words() const
+    {
+        return words_;
+    }
+
+    bool operator==(const Selection &) const = default;
+
+private:
+    std::size_t size_ = 0;
+    std::vector<Word> words_;
+
+    void Check(const Selection &other) const
+    {
+        if (other.size_ != size_)
+        {
+            throw std::runtime_error{"selections of different sizes"};
+        }
+    }
+
+    // Bits past the last row stay zero, so Count and Empty need not mask them.
+    void Trim()
+    {
+        if (size_ % wordBits != 0)
+        {
+            words_.back() &= (Word{1} << (size_ % wordBits)) - 1;
+        }
+    }
+};
+
+inline Selection operator&(Selection left, const Selection &right)
+{
+    return left &= right;
+}
+
+inline Selection operator|(Selection left, const Selection &right)
+{
+    return left |= right;
+}
+
+// Packs `predicate(row)` for every row, 64 rows per word, without a branch per row.
+template <typename F> Selection Select(std::size_t size, F &&predicate)
+{
+    Selection selection{size};
+    auto words = selection.Words();
+    for (std::size_t i = 0; i < words.size(); ++i)
+    {
+        const auto begin = i * wordBits;
+        const auto end = begin + wordBits < size ? begin + wordBits : size;
+        Word word = 0;
+        for (auto row = begin; row < end; ++row)
+        {
+            word |= Word{predicate(row) ? 1U : 0U} << (row - begin);
+        }
+        words[i] = word;
+    }
+    return selection;
+}
+
+} // namespace lang::columnar
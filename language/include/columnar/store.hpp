@@ -0,0 +1,610 @@
+#pragma once
+
+#include "columnar/selection.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Element properties by column rather than by node. Strings are dictionary-encoded, so an
+// equality test compares 32-bit codes; string lists (tags, technology) keep per-row bitsets of
+// their codes, or sorted code arrays once the vocabulary outgrows `bitsetTerms`.
+namespace lang::columnar
+{
+
+using Code = std::uint32_t;
+
+inline constexpr auto nullCode = std::numeric_limits<Code>::max();
+
+class Dictionary
+{
+public:
+    Code Intern(std::string_view value)
+    {
+        const auto it = codes_.find(value);
+        if (it != codes_.end())
+        {
+            return it->second;
+        }
+        if (values_.size() >= nullCode)
+        {
+            throw std::runtime_error{"dictionary has too many values"};
+        }
+        const auto code = static_cast<Code>(values_.size());
+        values_.emplace_back(value);
+        codes_.emplace(values_.back(), code);
+        return code;
+    }
+
+    [[nodiscard]] std::optional<Code> Find(std::string_view value) const
+    {
+        const auto it = codes_.find(value);
+        return it == codes_.end() ? std::nullopt : std::optional{it->second};
+    }
+
+    [[nodiscard]] const std::string &Value(Code code) const
+    {
+        return values_.at(code);
+    }
+
+    [[nodiscard]] std::size_t Size() const
+    {
+        return values_.size();
+    }
+
+private:
+    struct Hash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view value) const
+        {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    std::vector<std::string> values_;
+    std::unordered_map<std::string, Code, Hash, std::equal_to<>> codes_;
+};
+
+class StringColumn
+{
+public:
+    [[nodiscard]] std::optional<std::string_view> Get(std::size_t row) const
+    {
+        const auto code = codes_[row];
+        return code == nullCode ? std::nullopt
+                                : std::optional<std::string_view>{dictionary_.Value(code)};
+    }
+
+    // Rows equal to `value`; rows without the property never match.
+    [[nodiscard]] Selection Equal(std::string_view value) const
+    {
+        const auto code = dictionary_.Find(value);
+        if (!code)
+        {
+            return Selection{codes_.size()};
+        }
+        return Select(codes_.size(), [&, target = *code](std::size_t row)
+                      { return codes_[row] == target; });
+    }
+
+    // Rows whose value is one of `values`.
+    [[nodiscard]] Selection In(std::span<const std::string> values) const
+    {
+        std::vector<bool> wanted(dictionary_.Size(), false);
+        for (const auto &value : values)
+        {
+            if (const auto code = dictionary_.Find(value); code)
+            {
+                wanted[*code] = true;
+            }
+        }
+        return Select(codes_.size(), [&](std::size_t row)
+                      { return codes_[row] != nullCode && wanted[codes_[row]]; });
+    }
+
+    [[nodiscard]] Selection Present() const
+    {
+        return Select(codes_.size(), [&](std::size_t row) { return codes_[row] != nullCode; });
+    }
+
+    [[nodiscard]] const Dictionary &Values() const
+    {
+        return dictionary_;
+    }
+
+    [[nodiscard]] std::span<const Code> Codes() const
+    {
+        return codes_;
+    }
+
+private:
+    friend class ColumnStoreBuilder;
+
+    Dictionary dictionary_;
+    std::vector<Code> codes_;
+};
+
+class IntColumn
+{
+public:
+    [[nodiscard]] std::optional<std::int64_t> Get(std::size_t row) const
+    {
+        return present_.Test(row) ? std::optional{values_[row]} : std::nullopt;
+    }
+
+    // Rows with the property for which `predicate(value)` holds.
+    template <typename F> [[nodiscard]] Selection Where(F &&predicate) const
+    {
+        return Select(values_.size(), [&](std::size_t row) { return predicate(values_[row]); }) &
+               present_;
+    }
+
+    [[nodiscard]] Selection Equal(std::int64_t value) const
+    {
+        return Where([value](std::int64_t row) { return row == value; });
+    }
+
+    [[nodiscard]] const Selection &Present() const
+    {
+        return present_;
+    }
+
+    [[nodiscard]] std::span<const std::int64_t> Values() const
+    {
+        return values_;
+    }
+
+private:
+    friend class ColumnStoreBuilder;
+
+    // Zero where the property is missing.
+    std::vector<std::int64_t> values_;
+    Selection present_;
+};
+
+// The codes a membership or intersection test looks for, encoded the way the column stores
+// its rows.
+struct Terms
+{
+    std::vector<Word> bits;
+    std::vector<Code> codes;
+};
+
+class ListColumn
+{
+public:
+    [[nodiscard]] bool UsesBitsets() const
+    {
+        return words_ != 0 || dictionary_.Size() == 0;
+    }
+
+    [[nodiscard]] std::vector<std::string_view> Get(std::size_t row) const
+    {
+        std::vector<std::string_view> values;
+        for (const auto code : Codes(row))
+        {
+            values.push_back(dictionary_.Value(code));
+        }
+        return values;
+    }
+
+    // `value in row`
+    [[nodiscard]] bool Contains(std::size_t row, std::string_view value) const
+    {
+        const auto code = dictionary_.Find(value);
+        if (!code)
+        {
+            return false;
+        }
+        if (UsesBitsets())
+        {
+            return (Row(row)[*code / wordBits] >> (*code % wordBits) & 1U) != 0;
+        }
+        return std::ranges::binary_search(Sorted(row), *code);
+    }
+
+    // Values not in the dictionary are left out: no row can hold them.
+    [[nodiscard]] Terms Encode(std::span<const std::string> values) const
+    {
+        Terms terms;
+        terms.bits.assign(words_, 0);
+        for (const auto &value : values)
+        {
+            if (const auto code = dictionary_.Find(value); code)
+            {
+                if (UsesBitsets())
+                {
+                    terms.bits[*code / wordBits] |= Word{1} << (*code % wordBits);
+                }
+                terms.codes.push_back(*code);
+            }
+        }
+        std::ranges::sort(terms.codes);
+        const auto [first, last] = std::ranges::unique(terms.codes);
+        terms.codes.erase(first, last);
+        return terms;
+    }
+
+    // Whether `row` shares a value with `terms`, `cross(row, list)`.
+    [[nodiscard]] bool Intersects(std::size_t row, const Terms &terms) const
+    {
+        if (UsesBitsets())
+        {
+            return AnyCommon(Row(row), terms.bits);
+        }
+        const auto codes = Sorted(row);
+        auto l = codes.begin();
+        auto r = terms.codes.begin();
+        while (l != codes.end() && r != terms.codes.end())
+        {
+            if (*l == *r)
+            {
+                return true;
+            }
+            if (*l < *r)
+            {
+                ++l;
+            }
+            else
+            {
+                ++r;
+            }
+        }
+        return false;
+    }
+
+    // Rows holding `value`.
+    [[nodiscard]] Selection Contains(std::string_view value) const
+    {
+        const auto code = dictionary_.Find(value);
+        if (!code)
+        {
+            return Selection{rows_};
+        }
+        if (UsesBitsets())
+        {
+            const auto word = *code / wordBits;
+            const auto shift = *code % wordBits;
+            return Select(rows_, [&](std::size_t row)
+                          { return (bits_[row * words_ + word] >> shift & 1U) != 0; });
+        }
+        return Scan([target = *code](Code code) { return code == target; });
+    }
+
+    // Rows sharing a value with `terms`.
+    [[nodiscard]] Selection Intersects(const Terms &terms) const
+    {
+        if (UsesBitsets() && words_ == 1)
+        {
+            const auto mask = terms.bits.empty() ? Word{0} : terms.bits.front();
+            return Select(rows_, [&](std::size_t row) { return (bits_[row] & mask) != 0; });
+        }
+        if (UsesBitsets())
+        {
+            return Select(rows_, [&](std::size_t row) { return Intersects(row, terms); });
+        }
+        std::vector<bool> wanted(dictionary_.Size(), false);
+        for (const auto code : terms.codes)
+        {
+            wanted[code] = true;
+        }
+        return Scan([&](Code code) { return wanted[code]; });
+    }
+
+    // Rows that have the property, possibly as an empty list.
+    [[nodiscard]] const Selection &Present() const
+    {
+        return present_;
+    }
+
+    [[nodiscard]] const Dictionary &Values() const
+    {
+        return dictionary_;
+    }
+
+    [[nodiscard]] std::size_t Bytes() const
+    {
+        return bits_.capacity() * sizeof(Word) + offsets_.capacity() * sizeof(std::uint32_t) +
+               codes_.capacity() * sizeof(Code) + present_.Words().size() * sizeof(Word);
+    }
+
+private:
+    friend class ColumnStoreBuilder;
+
+    Dictionary dictionary_;
+    std::size_t rows_ = 0;
+    Selection present_;
+    // Bitsets: `words_` words per row.
+    std::size_t words_ = 0;
+    std::vector<Word> bits_;
+    // Sorted codes: row r is codes_[offsets_[r]..offsets_[r + 1]).
+    std::vector<std::uint32_t> offsets_;
+    std::vector<Code> codes_;
+
+    [[nodiscard]] std::span<const Word> Row(std::size_t row) const
+    {
+        return std::span{bits_}.subspan(row * words_, words_);
+    }
+
+    [[nodiscard]] std::span<const Code> Sorted(std::size_t row) const
+    {
+        return std::span{codes_}.subspan(offsets_[row], offsets_[row + 1] - offsets_[row]);
+    }
+
+    // Sorted codes: one pass over all codes, hits mapped to rows by a cursor that only moves
+    // forward, instead of a search per row.
+    template <typename F> [[nodiscard]] Selection Scan(F &&match) const
+    {
+        Selection selection{rows_};
+        std::size_t row = 0;
+        for (std::size_t i = 0; i < codes_.size(); ++i)
+        {
+            if (match(codes_[i]))
+            {
+                while (offsets_[row + 1] <= i)
+                {
+                    ++row;
+                }
+                selection.Set(row);
+            }
+        }
+        return selection;
+    }
+
+    [[nodiscard]] std::vector<Code> Codes(std::size_t row) const
+    {
+        if (!UsesBitsets())
+        {
+            const auto codes = Sorted(row);
+            return {codes.begin(), codes.end()};
+        }
+        std::vector<Code> codes;
+        const auto words = Row(row);
+        for (std::size_t i = 0; i < words.size(); ++i)
+        {
+            for (auto word = words[i]; word != 0; word &= word - 1)
+            {
+                codes.push_back(static_cast<Code>(i * wordBits + std::countr_zero(word)));
+            }
+        }
+        return codes;
+    }
+};
+
+using Column = std::variant<StringColumn, IntColumn, ListColumn>;
+
+class ColumnStore
+{
+public:
+    [[nodiscard]] std::size_t Rows() const
+    {
+        return rows_;
+    }
+
+    // The column of `name` if every row that has it holds the type asked for.
+    template <typename T> [[nodiscard]] const T *Get(std::string_view name) const
+    {
+        const auto it = columns_.find(name);
+        return it == columns_.end() ? nullptr : std::get_if<T>(&it->second);
+    }
+
+    [[nodiscard]] const StringColumn *Strings(std::string_view name) const
+    {
+        return Get<StringColumn>(name);
+    }
+
+    [[nodiscard]] const IntColumn *Ints(std::string_view name) const
+    {
+        return Get<IntColumn>(name);
+    }
+
+    [[nodiscard]] const ListColumn *Lists(std::string_view name) const
+    {
+        return Get<ListColumn>(name);
+    }
+
+private:
+    friend class ColumnStoreBuilder;
+
+    std::size_t rows_ = 0;
+    std::map<std::string, Column, std::less<>> columns_;
+};
+
+struct ColumnOptions
+{
+    // Distinct list values up to which rows are bitsets rather than sorted code arrays.
+    std::size_t bitsetTerms = 256;
+};
+
+// Takes properties row by row. A property that holds different types on different rows gets no
+// column; callers keep answering it from their own rows.
+class ColumnStoreBuilder
+{
+public:
+    explicit ColumnStoreBuilder(std::size_t rows, ColumnOptions options = {})
+        : rows_(rows), options_(options)
+    {
+    }
+
+    void Add(std::size_t row, const std::string &name, std::string_view value)
+    {
+        if (auto *column = Pending<PendingStrings>(name); column != nullptr)
+        {
+            column->codes[row] = column->dictionary.Intern(value);
+        }
+    }
+
+    void Add(std::size_t row, const std::string &name, std::int64_t value)
+    {
+        if (auto *column = Pending<PendingInts>(name); column != nullptr)
+        {
+            column->values[row] = value;
+            column->present.Set(row);
+        }
+    }
+
+    void Add(std::size_t row, const std::string &name, std::span<const std::string> values)
+    {
+        if (auto *column = Pending<PendingLists>(name); column != nullptr)
+        {
+            auto &codes = column->rows[row];
+            codes.clear();
+            for (const auto &value : values)
+            {
+                codes.push_back(column->dictionary.Intern(value));
+            }
+            std::ranges::sort(codes);
+            const auto [first, last] = std::ranges::unique(codes);
+            codes.erase(first, last);
+            column->present.Set(row);
+        }
+    }
+
+    // Leaves `name` without a column, for values of a type the store does not hold.
+    void Exclude(const std::string &name)
+    {
+        pending_.insert_or_assign(name, Mixed{});
+    }
+
+    ColumnStore Build() &&
+    {
+        ColumnStore store;
+        store.rows_ = rows_;
+        for (auto &[name, pending] : pending_)
+        {
+            if (auto *strings = std::get_if<PendingStrings>(&pending); strings != nullptr)
+            {
+                StringColumn column;
+                column.dictionary_ = std::move(strings->dictionary);
+                column.codes_ = std::move(strings->codes);
+                store.columns_.emplace(name, std::move(column));
+            }
+            else if (auto *ints = std::get_if<PendingInts>(&pending); ints != nullptr)
+            {
+                IntColumn column;
+                column.values_ = std::move(ints->values);
+                column.present_ = std::move(ints->present);
+                store.columns_.emplace(name, std::move(column));
+            }
+            else if (auto *lists = std::get_if<PendingLists>(&pending); lists != nullptr)
+            {
+                store.columns_.emplace(name, Lists(std::move(*lists)));
+            }
+        }
+        pending_ = {};
+        return store;
+    }
+
+private:
+    struct PendingStrings
+    {
+        Dictionary dictionary;
+        std::vector<Code> codes;
+    };
+
+    struct PendingInts
+    {
+        std::vector<std::int64_t> values;
+        Selection present;
+    };
+
+    struct PendingLists
+    {
+        Dictionary dictionary;
+        std::vector<std::vector<Code>> rows;
+        Selection present;
+    };
+
+    // A property seen with two types.
+    struct Mixed
+    {
+    };
+
+    std::size_t rows_;
+    ColumnOptions options_;
+    std::map<std::string, std::variant<PendingStrings, PendingInts, PendingLists, Mixed>,
+             std::less<>>
+        pending_;
+
+    template <typename T> T *Pending(const std::string &name)
+    {
+        auto it = pending_.find(name);
+        if (it == pending_.end())
+        {
+            T column;
+            if constexpr (std::is_same_v<T, PendingStrings>)
+            {
+                column.codes.assign(rows_, nullCode);
+            }
+            else if constexpr (std::is_same_v<T, PendingInts>)
+            {
+                column.values.assign(rows_, 0);
+                column.present = Selection{rows_};
+            }
+            else
+            {
+                column.rows.resize(rows_);
+                column.present = Selection{rows_};
+            }
+            it = pending_.emplace(name, std::move(column)).first;
+        }
+        auto *column = std::get_if<T>(&it->second);
+        if (column == nullptr)
+        {
+            it->second = Mixed{};
+        }
+        return column;
+    }
+
+    ListColumn Lists(PendingLists pending) const
+    {
+        ListColumn column;
+        column.rows_ = rows_;
+        column.present_ = std::move(pending.present);
+        column.dictionary_ = std::move(pending.dictionary);
+        if (column.dictionary_.Size() <= options_.bitsetTerms)
+        {
+            column.words_ = WordCount(column.dictionary_.Size());
+            column.bits_.assign(rows_ * column.words_, 0);
+            for (std::size_t row = 0; row < rows_; ++row)
+            {
+                for (const auto code : pending.rows[row])
+                {
+                    column.bits_[row * column.words_ + code / wordBits] |= Word{1}
+                                                                           << (code % wordBits);
+                }
+            }
+            return column;
+        }
+        column.offsets_.reserve(rows_ + 1);
+        column.offsets_.push_back(0);
+        for (auto &codes : pending.rows)
+        {
+            column.codes_.insert(column.codes_.end(), codes.begin(), codes.end());
+            if (column.codes_.size() >= std::numeric_limits<std::uint32_t>::max())
+            {
+                throw std::runtime_error{"list column has too many values"};
+            }
+            column.offsets_.push_back(static_cast<std::uint32_t>(column.codes_.size()));
+            codes = {};
+        }
+        return column;
+    }
+};
+
+} // namespace lang::columnar
@@ -0,0 +1,772 @@
+#pragma once
+
+#include "eval/evaluator.hpp"
+
+#include <ast/expression.hpp>
+#include <columnar/selection.hpp>
+#include <columnar/store.hpp>
+#include <graph/csr.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Evaluates a predicate for every element of a set at once instead of one binding at a time.
+// A comparison of a property of the bound variable with a value that does not depend on it is
+// decided from the workspace's columns, 64 rows per word; `and` and `or` evaluate their right
+// operand only on the rows the left one leaves open. Anything else is evaluated row by row, so
+// answers, nulls and errors are the tree-walking evaluator's.
+namespace lang::ast::eval
+{
+
+// Rows in `yes` hold and rows in `no` do not; the rest are null or not a boolean.
+struct Tristate
+{
+    columnar::Selection yes;
+    columnar::Selection no;
+};
+
+struct BatchContext
+{
+    EvaluatorContext evaluator;
+    // Bound to Node{row} for each row in turn.
+    std::string variable;
+};
+
+namespace detail
+{
+
+// A row's value as the predicate sees it: bit 0 when it is a boolean, bit 1 when it is true.
+using Outcome = std::uint8_t;
+inline constexpr Outcome nullOutcome = 0;
+inline constexpr Outcome falseOutcome = 1;
+inline constexpr Outcome trueOutcome = 3;
+
+inline Outcome OutcomeOf(const Value &value)
+{
+    const auto truth = Truth(value);
+    return !truth ? nullOutcome : *truth ? trueOutcome : falseOutcome;
+}
+
+// Words with fewer active rows than this visit only those rows, as a selection vector would;
+// fuller words visit all 64 without a branch per row.
+inline constexpr int sparseRows = 16;
+
+// The rows of `active` split by `outcome(row)`, which must be safe to call on any row.
+template <typename F> Tristate Split(const columnar::Selection &active, F &&outcome)
+{
+    Tristate result{columnar::Selection{active.Size()}, columnar::Selection{active.Size()}};
+    const auto words = active.Words();
+    auto yes = result.yes.Words();
+    auto no = result.no.Words();
+    for (std::size_t i = 0; i < words.size(); ++i)
+    {
+        const auto word = words[i];
+        if (word == 0)
+        {
+            continue;
+        }
+        const auto begin = i * columnar::wordBits;
+        columnar::Word known = 0;
+        columnar::Word holds = 0;
+        if (std::popcount(word) < sparseRows)
+        {
+            for (auto rest = word; rest != 0; rest &= rest - 1)
+            {
+                const auto bit = static_cast<std::size_t>(std::countr_zero(rest));
+                const Outcome value = outcome(begin + bit);
+                known |= static_cast<columnar::Word>(value & 1U) << bit;
+                holds |= static_cast<columnar::Word>(value >> 1U) << bit;
+            }
+        }
+        else
+        {
+            const auto end = std::min(begin + columnar::wordBits, active.Size());
+            for (auto row = begin; row < end; ++row)
+            {
+                const Outcome value = outcome(row);
+                known |= static_cast<columnar::Word>(value & 1U) << (row - begin);
+                holds |= static_cast<columnar::Word>(value >> 1U) << (row - begin);
+            }
+        }
+        yes[i] = word & known & holds;
+        no[i] = word & known & ~holds;
+    }
+    return result;
+}
+
+// Every row of `active` with the same outcome.
+inline Tristate Uniform(const columnar::Selection &active, Outcome outcome)
+{
+    Tristate result{columnar::Selection{active.Size()}, columnar::Selection{active.Size()}};
+    if (outcome == trueOutcome)
+    {
+        result.yes = active;
+    }
+    else if (outcome == falseOutcome)
+    {
+        result.no = active;
+    }
+    return result;
+}
+
+inline columnar::Selection Without(columnar::Selection rows, const columnar::Selection &other)
+{
+    return rows.Subtract(other);
+}
+
+inline bool Mentions(const ExpressionPtr &expr, const std::string &variable);
+
+template <typename T> bool Mentions(const T &node, const std::string &variable)
+{
+    const auto any = [&](const std::vector<ExpressionPtr> &items)
+    {
+        return std::ranges::any_of(items,
+                                   [&](const ExpressionPtr &item)
+                                   { return Mentions(item, variable); });
+    };
+    if constexpr (std::same_as<T, VariableExpr>)
+    {
+        return node.name == variable;
+    }
+    else if constexpr (std::same_as<T, TernaryExpr>)
+    {
+        return Mentions(node.condition, variable) || Mentions(node.thenExpr, variable) ||
+               Mentions(node.elseExpr, variable);
+    }
+    else if constexpr (requires { node.left; })
+    {
+        return Mentions(node.left, variable) || Mentions(node.right, variable);
+    }
+    else if constexpr (requires { node.operand; })
+    {
+        return Mentions(node.operand, variable);
+    }
+    else if constexpr (requires { node.items; })
+    {
+        return any(node.items);
+    }
+    else if constexpr (requires { node.args; })
+    {
+        return any(node.args);
+    }
+    else
+    {
+        return false;
+    }
+}
+
+// Whether the value of `expr` may differ between rows. A broken tree counts as varying, so that
+// it is left to the evaluator to reject.
+inline bool Mentions(const ExpressionPtr &expr, const std::string &variable)
+{
+    if (!expr)
+    {
+        return true;
+    }
+    return std::visit([&](const auto &node) { return !node || Mentions(*node, variable); },
+                      *expr);
+}
+
+// The property `variable.prop` reads, if `expr` is that access.
+inline const std::string *Column(const ExpressionPtr &expr, const std::string &variable)
+{
+    const auto *access = expr ? std::get_if<AccessExprPtr>(expr.get()) : nullptr;
+    if (access == nullptr || !*access || !(*access)->operand)
+    {
+        return nullptr;
+    }
+    const auto *var = std::get_if<VariablePtr>((*access)->operand.get());
+    return var != nullptr && *var && (*var)->name == variable ? &(*access)->prop : nullptr;
+}
+
+// Whether `expr` is always a boolean or null, so that `-expr` swaps its outcomes; `-x` of a
+// string or a list throws instead.
+inline bool Boolean(const ExpressionPtr &expr)
+{
+    if (!expr)
+    {
+        return false;
+    }
+    if (const auto *negation = std::get_if<NegationPtr>(expr.get()); negation != nullptr)
+    {
+        return *negation && Boolean((*negation)->operand);
+    }
+    return std::holds_alternative<BoolPtr>(*expr) ||
+           std::holds_alternative<SafeAccessExprPtr>(*expr) ||
+           std::holds_alternative<EqualPtr>(*expr) || std::holds_alternative<NotEqualPtr>(*expr) ||
+           std::holds_alternative<LessPtr>(*expr) || std::holds_alternative<GreaterPtr>(*expr) ||
+           std::holds_alternative<GreateEqualPtr>(*expr) ||
+           std::holds_alternative<LessEqualPtr>(*expr) || std::holds_alternative<AndPtr>(*expr) ||
+           std::holds_alternative<OrPtr>(*expr) || std::holds_alternative<XorPtr>(*expr) ||
+           std::holds_alternative<InPtr>(*expr) || std::holds_alternative<NotInPtr>(*expr);
+}
+
+// The comparisons a column is matched against, with the operands in their original order.
+template <ExprType U> Value Comparison(const Value &left, const Value &right)
+{
+    switch (U)
+    {
+    case ExprType::EQ:
+        return Equal(left, right);
+    case ExprType::NOT_EQ:
+        return Not(Equal(left, right));
+    case ExprType::IN:
+        return In(left, right);
+    case ExprType::NOT_IN:
+        return Not(In(left, right));
+    default:
+        return Ordered(U, left, right);
+    }
+}
+
+// A value of the column's type equal to none of `targets`, which all compare alike.
+template <typename T> T Unmatched(std::vector<T> targets)
+{
+    std::ranges::sort(targets);
+    T value{};
+    while (std::ranges::binary_search(targets, value))
+    {
+        if constexpr (std::same_as<T, std::string>)
+        {
+            value += '\0';
+        }
+        else
+        {
+            ++value;
+        }
+    }
+    return value;
+}
+
+} // namespace detail
+
+class BatchBase
+{
+protected:
+    BatchContext &ctx;
+
+    // The fallback: one evaluation per active row, and none for the others, which could throw.
+    template <typename T> Tristate RowByRow(const T &expr, const columnar::Selection &active) const
+    {
+        Tristate result{columnar::Selection{active.Size()}, columnar::Selection{active.Size()}};
+        auto &bound = ctx.evaluator.row.at(ctx.variable);
+        active.ForEach(
+            [&](std::size_t row)
+            {
+                bound = Node{static_cast<std::uint32_t>(row)};
+                if (const auto truth = Truth(Evaluator<T>{ctx.evaluator}(expr)); truth)
+                {
+                    (*truth ? result.yes : result.no).Set(row);
+                }
+            });
+        bound = Value{};
+        return result;
+    }
+
+    // Evaluated once, for an expression that does not mention the variable.
+    Value Constant(const ExpressionPtr &expr) const
+    {
+        return Evaluator<ExpressionPtr>{ctx.evaluator}(expr);
+    }
+
+public:
+    explicit BatchBase(BatchContext &context) : ctx(context)
+    {
+    }
+    virtual ~BatchBase() = default;
+};
+
+template <typename T> class Batch : BatchBase
+{
+public:
+    using BatchBase::BatchBase;
+    Tristate operator()(const T &expr, const columnar::Selection &active) const
+    {
+        return RowByRow(expr, active);
+    }
+};
+
+template <typename T> class Batch<std::unique_ptr<T>> : BatchBase
+{
+public:
+    using BatchBase::BatchBase;
+    Tristate operator()(const std::unique_ptr<T> &ptr, const columnar::Selection &active) const
+    {
+        if (!ptr)
+        {
+            throw std::runtime_error{"broken AST: ptr is null in evaluator"};
+        }
+        return Batch<T>{ctx}(*ptr, active);
+    }
+};
+
+template <typename... Ts> class Batch<std::variant<Ts...>> : BatchBase
+{
+public:
+    using BatchBase::BatchBase;
+    Tristate operator()(const std::variant<Ts...> &expr, const columnar::Selection &active) const
+    {
+        return std::visit(
+            [&](auto &&subValue)
+            { return Batch<std::decay_t<decltype(subValue)>>{ctx}(subValue, active); },
+            expr);
+    }
+};
+
+template <> class Batch<LiteralExpr<bool>> : BatchBase
+{
+public:
+    using BatchBase::BatchBase;
+    Tristate operator()(const LiteralExpr<bool> &lit, const columnar::Selection &active) const
+    {
+        return detail::Uniform(active, lit.value ? detail::trueOutcome : detail::falseOutcome);
+    }
+};
+
+template <> class Batch<UnaryExpr<ExprType::NEG>> : BatchBase
+{
+public:
+    using BatchBase::BatchBase;
+    Tristate operator()(const UnaryExpr<ExprType::NEG> &expr,
+                        const columnar::Selection &active) const
+    {
+        if (!detail::Boolean(expr.operand))
+        {
+            return RowByRow(expr, active);
+        }
+        auto operand = Batch<ExpressionPtr>{ctx}(expr.operand, active);
+        return {std::move(operand.no), std::move(operand.yes)};
+    }
+};
+
+// `v.!prop`: whether the element has the property.
+template <> class Batch<AccessExpr<ExprType::SAFE_ACCESS>> : BatchBase
+{
+public:
+    using BatchBase::BatchBase;
+    Tristate operator()(const AccessExpr<ExprType::SAFE_ACCESS> &expr,
+                        const columnar::Selection &active) const
+    {
+        const auto *var = expr.operand ? std::get_if<VariablePtr>(expr.operand.get()) : nullptr;
+        if (var == nullptr || !*var || (*var)->name != ctx.variable)
+        {
+            return RowByRow(expr, active);
+        }
+        const auto &columns = ctx.evaluator.workspace.columns;
+        columnar::Selection present;
+        if (const auto *strings = columns.Strings(expr.prop); strings != nullptr)
+        {
+            present = strings->Present();
+        }
+        else if (const auto *ints = columns.Ints(expr.prop); ints != nullptr)
+        {
+            present = ints->Present();
+        }
+        else if (const auto *lists = columns.Lists(expr.prop); lists != nullptr)
+        {
+            present = lists->Present();
+        }
+        else
+        {
+            return RowByRow(expr, active);
+        }
+        return {present & active, detail::Without(active, present)};
+    }
+};
+
+template <> class Batch<TernaryExpr> : BatchBase
+{
+public:
+    using BatchBase::BatchBase;
+    Tristate operator()(const TernaryExpr &expr, const columnar::Selection &active) const
+    {
+        const auto condition = Batch<ExpressionPtr>{ctx}(expr.condition, active);
+        auto result = Batch<ExpressionPtr>{ctx}(expr.thenExpr, condition.yes);
+        const auto otherwise =
+            Batch<ExpressionPtr>{ctx}(expr.elseExpr, detail::Without(active, condition.yes));
+        result.yes |= otherwise.yes;
+        result.no |= otherwise.no;
+        return result;
+    }
+};
+
+// Comparisons whose one side is `v.prop` and whose other side does not depend on `v`, and
+// `cross(v.prop, list) = none`; nullopt for any other.
+class ColumnComparison : BatchBase
+{
+public:
+    using BatchBase::BatchBase;
+
+    template <ExprType U>
+    std::optional<Tristate> Decide(const ExpressionPtr &left, const ExpressionPtr &right,
+                                       const columnar::Selection &active) const
+    {
+        const auto *leftColumn = detail::Column(left, ctx.variable);
+        const auto *rightColumn = detail::Column(right, ctx.variable);
+        if (leftColumn != nullptr && !detail::Mentions(right, ctx.variable))
+        {
+            return Match<U>(*leftColumn, right, true, active);
+        }
+        if (rightColumn != nullptr && !detail::Mentions(left, ctx.variable))
+        {
+            return Match<U>(*rightColumn, left, false, active);
+        }
+        if constexpr (U == ExprType::EQ || U == ExprType::NOT_EQ)
+        {
+            if (auto result = Cross<U>(left, right, active); result)
+            {
+                return result;
+            }
+            return Cross<U>(right, left, active);
+        }
+        return std::nullopt;
+    }
+
+private:
+    template <ExprType U>
+    std::optional<Tristate> Match(const std::string &prop, const ExpressionPtr &other,
+                                  bool columnLeft, const columnar::Selection &active) const
+    {
+        const auto &columns = ctx.evaluator.workspace.columns;
+        const auto *strings = columns.Strings(prop);
+        const auto *ints = columns.Ints(prop);
+        const auto *lists = columns.Lists(prop);
+        if (strings == nullptr && ints == nullptr && lists == nullptr)
+        {
+            return std::nullopt;
+        }
+        if (active.Empty())
+        {
+            return detail::Uniform(active, detail::nullOutcome);
+        }
+        const auto constant = Constant(other);
+        const auto apply = [&](const Value &row)
+        {
+            return detail::OutcomeOf(columnLeft ? detail::Comparison<U>(row, constant)
+                                                : detail::Comparison<U>(constant, row));
+        };
+        const auto absent = apply(Value{});
+        if (strings != nullptr)
+        {
+            return Strings<U>(*strings, constant, columnLeft, apply, absent, active);
+        }
+        if (ints != nullptr)
+        {
+            return Ints<U>(*ints, constant, columnLeft, apply, absent, active);
+        }
+        return Lists<U>(*lists, constant, columnLeft, absent, active);
+    }
+
+    // A verdict per dictionary code, the last for rows without the property. Equality and
+    // membership only look up the codes they name; ordering evaluates each distinct value once.
+    template <ExprType U, typename F>
+    static Tristate Strings(const columnar::StringColumn &column, const Value &constant,
+                            bool columnLeft, const F &apply, detail::Outcome absent,
+                            const columnar::Selection &active)
+    {
+        const auto &dictionary = column.Values();
+        std::vector<detail::Outcome> verdicts(dictionary.Size() + 1, absent);
+        if (const auto targets = Targets<std::string, U>(constant, columnLeft); targets)
+        {
+            std::fill(verdicts.begin(), verdicts.end() - 1,
+                      apply(Value{detail::Unmatched(*targets)}));
+            for (const auto &target : *targets)
+            {
+                if (const auto code = dictionary.Find(target); code)
+                {
+                    verdicts[*code] = apply(Value{target});
+                }
+            }
+        }
+        else
+        {
+            for (columnar::Code code = 0; code < dictionary.Size(); ++code)
+            {
+                verdicts[code] = apply(Value{dictionary.Value(code)});
+            }
+        }
+        const auto codes = column.Codes();
+        const auto size = static_cast<columnar::Code>(dictionary.Size());
+        return detail::Split(active, [&](std::size_t row)
+                             { return verdicts[std::min(codes[row], size)]; });
+    }
+
+    template <ExprType U, typename F>
+    static Tristate Ints(const columnar::IntColumn &column, const Value &constant,
+                         bool columnLeft, const F &apply, detail::Outcome absent,
+                         const columnar::Selection &active)
+    {
+        const auto values = column.Values();
+        const auto &present = column.Present();
+        const auto with = [&](auto &&verdict)
+        {
+            return detail::Split(active, [&](std::size_t row)
+                                 { return present.Test(row) ? verdict(values[row]) : absent; });
+        };
+        if (const auto *number = constant.As<std::int64_t>();
+            number != nullptr && U != ExprType::IN && U != ExprType::NOT_IN)
+        {
+            const auto k = *number;
+            const auto outcome = [](bool holds)
+            { return holds ? detail::trueOutcome : detail::falseOutcome; };
+            // With the column on the right, `k < v` is `v > k`.
+            constexpr auto flipped = U == ExprType::LESS      ? ExprType::GREATER
+                                     : U == ExprType::GREATER ? ExprType::LESS
+                                     : U == ExprType::LESS_EQ ? ExprType::GREATER_EQ
+                                     : U == ExprType::GREATER_EQ ? ExprType::LESS_EQ
+                                                                 : U;
+            const auto op = columnLeft ? U : flipped;
+            switch (op)
+            {
+            case ExprType::EQ:
+                return with([&](std::int64_t v) { return outcome(v == k); });
+            case ExprType::NOT_EQ:
+                return with([&](std::int64_t v) { return outcome(v != k); });
+            case ExprType::LESS:
+                return with([&](std::int64_t v) { return outcome(v < k); });
+            case ExprType::GREATER:
+                return with([&](std::int64_t v) { return outcome(v > k); });
+            case ExprType::LESS_EQ:
+                return with([&](std::int64_t v) { return outcome(v <= k); });
+            default:
+                return with([&](std::int64_t v) { return outcome(v >= k); });
+            }
+        }
+        if (auto targets = Targets<std::int64_t, U>(constant, columnLeft);
+            targets && !targets->empty())
+        {
+            const auto matched = apply(Value{targets->front()});
+            const auto unmatched = apply(Value{detail::Unmatched(*targets)});
+            std::ranges::sort(*targets);
+            return with([&](std::int64_t v)
+                        { return std::ranges::binary_search(*targets, v) ? matched : unmatched; });
+        }
+        // Against anything but an integer every integer compares alike.
+        const auto verdict = apply(Value{std::int64_t{0}});
+        return with([&](std::int64_t /*unused*/) { return verdict; });
+    }
+
+    // `k in v.list` for a string k, or anything but null that no string equals.
+    template <ExprType U>
+    static std::optional<Tristate> Lists(const columnar::ListColumn &column,
+                                         const Value &constant, bool columnLeft,
+                                         detail::Outcome absent, const columnar::Selection &active)
+    {
+        if ((U != ExprType::IN && U != ExprType::NOT_IN) || columnLeft || constant.IsNull())
+        {
+            return std::nullopt;
+        }
+        const auto *text = constant.As<std::string>();
+        const auto terms = text != nullptr ? column.Encode(std::span{text, 1}) : columnar::Terms{};
+        const auto &present = column.Present();
+        return detail::Split(active,
+                             [&](std::size_t row)
+                             {
+                                 if (!present.Test(row))
+                                 {
+                                     return absent;
+                                 }
+                                 const bool found =
+                                     text != nullptr && column.Intersects(row, terms);
+                                 return found == (U == ExprType::IN) ? detail::trueOutcome
+                                                                     : detail::falseOutcome;
+                             });
+    }
+
+    // The values of the column's type an equality or a membership test looks for, when every
+    // other value of that type gets one and the same verdict.
+    template <typename T, ExprType U>
+    static std::optional<std::vector<T>> Targets(const Value &constant, bool columnLeft)
+    {
+        std::vector<T> targets;
+        if (U == ExprType::EQ || U == ExprType::NOT_EQ)
+        {
+            if (const auto *value = constant.As<T>(); value != nullptr)
+            {
+                targets.push_back(*value);
+            }
+            return targets;
+        }
+        if (U == ExprType::IN || U == ExprType::NOT_IN)
+        {
+            // A list is never in a string or an integer: every row of the column is null.
+            if (const auto *items = constant.As<List>(); items != nullptr && columnLeft)
+            {
+                for (const auto &item : *items)
+                {
+                    if (const auto *value = item.As<T>(); value != nullptr)
+                    {
+                        targets.push_back(*value);
+                    }
+                }
+            }
+            return targets;
+        }
+        return std::nullopt;
+    }
+
+    // `cross(v.prop, list) = e` with e an empty list, such as `none`: true when the element
+    // shares no value with the list, null when it has no such property.
+    template <ExprType U>
+    std::optional<Tristate> Cross(const ExpressionPtr &call, const ExpressionPtr &empty,
+                                  const columnar::Selection &active) const
+    {
+        const auto *cross = call ? std::get_if<CallPtr>(call.get()) : nullptr;
+        if (cross == nullptr || !*cross || (*cross)->functionName != "cross" ||
+            (*cross)->args.size() != 2 || detail::Mentions(empty, ctx.variable) ||
+            detail::Mentions((*cross)->args[1], ctx.variable))
+        {
+            return std::nullopt;
+        }
+        const auto *prop = detail::Column((*cross)->args[0], ctx.variable);
+        const auto *column =
+            prop != nullptr ? ctx.evaluator.workspace.columns.Lists(*prop) : nullptr;
+        if (column == nullptr)
+        {
+            return std::nullopt;
+        }
+        if (active.Empty())
+        {
+            return detail::Uniform(active, detail::nullOutcome);
+        }
+        const auto list = Constant((*cross)->args[1]);
+        const auto expected = Constant(empty);
+        if (const auto *items = expected.As<List>(); items == nullptr || !items->empty())
+        {
+            return std::nullopt;
+        }
+        std::vector<std::string> values;
+        if (const auto *items = list.As<List>(); items != nullptr)
+        {
+            for (const auto &item : *items)
+            {
+                if (const auto *text = item.As<std::string>(); text != nullptr)
+                {
+                    values.push_back(*text);
+                }
+            }
+        }
+        const auto terms = column->Encode(values);
+        const auto &present = column->Present();
+        return detail::Split(active,
+                             [&](std::size_t row)
+                             {
+                                 if (!present.Test(row))
+                                 {
+                                     return detail::nullOutcome;
+                                 }
+                                 const bool disjoint = !column->Intersects(row, terms);
+                                 return disjoint == (U == ExprType::EQ) ? detail::trueOutcome
+                                                                        : detail::falseOutcome;
+                             });
+    }
+};
+
+template <ExprType U> class Batch<BooleanExpr<U>> : BatchBase
+{
+public:
+    using BatchBase::BatchBase;
+    Tristate operator()(const BooleanExpr<U> &expr, const columnar::Selection &active) const
+    {
+        if (auto result = ColumnComparison{ctx}.Decide<U>(expr.left, expr.right, active); result)
+        {
+            return std::move(*result);
+        }
+        return RowByRow(expr, active);
+    }
+};
+
+template <ExprType U> class Batch<LogicalExpr<U>> : BatchBase
+{
+public:
+    using BatchBase::BatchBase;
+    Tristate operator()(const LogicalExpr<U> &expr, const columnar::Selection &active) const
+    {
+        if constexpr (U == ExprType::IN || U == ExprType::NOT_IN)
+        {
+            if (auto result = ColumnComparison{ctx}.Decide<U>(expr.left, expr.right, active);
+                result)
+            {
+                return std::move(*result);
+            }
+            return RowByRow(expr, active);
+        }
+        else
+        {
+            auto left = Batch<ExpressionPtr>{ctx}(expr.left, active);
+            // The rows the left operand decides alone are not evaluated again.
+            const auto open = U == ExprType::AND   ? detail::Without(active, left.no)
+                              : U == ExprType::OR ? detail::Without(active, left.yes)
+                                                  : active;
+            auto right = Batch<ExpressionPtr>{ctx}(expr.right, open);
+            if constexpr (U == ExprType::AND)
+            {
+                return {left.yes & right.yes, left.no | right.no};
+            }
+            else if constexpr (U == ExprType::OR)
+            {
+                return {left.yes | right.yes, left.no & right.no};
+            }
+            else
+            {
+                return {(left.yes & right.no) | (left.no & right.yes),
+                        (left.yes & right.yes) | (left.no & right.no)};
+            }
+        }
+    }
+};
+
+// The rows of `active` the predicate holds and does not hold for, with `variable` bound to
+// each in turn and the other variables to `row`. An error is the one row-by-row evaluation in
+// ascending order would raise.
+inline Tristate EvaluateBatch(const ExpressionPtr &predicate, const Workspace &workspace,
+                              const std::string &variable, const columnar::Selection &active,
+                              Row row = {})
+{
+    if (active.Size() != workspace.graph.NodeCount())
+    {
+        throw std::runtime_error{"Batch rows do not match the workspace's elements"};
+    }
+    row[variable] = Value{};
+    BatchContext context{{workspace, std::move(row)}, variable};
+    try
+    {
+        return Batch<ExpressionPtr>{context}(predicate, active);
+    }
+    catch (const std::runtime_error &)
+    {
+        // The batch may meet a different failing row first; replay in row order for its error.
+        auto &bound = context.evaluator.row.at(variable);
+        active.ForEach(
+            [&](std::size_t node)
+            {
+                bound = Node{static_cast<std::uint32_t>(node)};
+                Evaluator<ExpressionPtr>{context.evaluator}(predicate);
+            });
+        throw;
+    }
+}
+
+// Over every element of a label, as a quantifier ranges over `container` or `component`.
+inline Tristate EvaluateBatch(const ExpressionPtr &predicate, const Workspace &workspace,
+                              const std::string &variable, graph::Label label, Row row = {})
+{
+    columnar::Selection active{workspace.graph.NodeCount()};
+    for (const auto node : workspace.graph.Nodes(label))
+    {
+        active.Set(node);
+    }
+    return EvaluateBatch(predicate, workspace, variable, active, std::move(row));
+}
+
+} // namespace lang::ast::eval
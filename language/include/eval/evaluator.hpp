@@ -0,0 +1,1083 @@
+#pragma once
+
+#include "eval/operators.hpp"
+#include "eval/value.hpp"
+#include "eval/workspace.hpp"
+
+#include <ast/ast.hpp>
+#include <ast/expression.hpp>
+#include <ast/statement.hpp>
+#include <translator/constant.hpp>
+#include <translator/format.hpp>
+
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Runs a rule directly against a Workspace, with the semantics of the query the translator
+// would emit for it: a top-level quantifier is a MATCH whose rows are the findings, a nested
+// one an EXISTS subquery, and conditions follow Cypher's three-valued logic.
+namespace lang::ast::eval
+{
+
+using Row = std::map<std::string, Value>;
+
+struct EvaluatorContext
+{
+    const Workspace &workspace;
+    Row row{};
+    std::unordered_map<std::string, KeywordSets> variableType{};
+    std::uint32_t quantifierLevel = 0;
+    std::vector<std::string> returns{};
+    bool exceptRule = false;
+};
+
+// What the rule's RETURN would yield: the variables of its last top-level quantifier, one row
+// per finding, preceded by the instance name for a template.
+struct Result
+{
+    std::vector<std::string> columns;
+    std::vector<std::vector<Value>> rows;
+};
+
+template <typename T> struct EvaluatedType
+{
+    using type = Value;
+};
+
+template <typename T> struct EvaluatedType<std::unique_ptr<T>> : EvaluatedType<T>
+{
+};
+
+template <typename T, typename... Ts>
+struct EvaluatedType<std::variant<T, Ts...>> : EvaluatedType<T>
+{
+};
+
+template <> struct EvaluatedType<Block>
+{
+    using type = std::vector<Row>;
+};
+
+template <> struct EvaluatedType<Rule>
+{
+    using type = Result;
+};
+
+template <> struct EvaluatedType<RuleTemplate>
+{
+    using type = Result;
+};
+
+template <typename T> using Evaluated = typename EvaluatedType<T>::type;
+
+namespace
+{
+
+class QuantifierGuard
+{
+public:
+    explicit QuantifierGuard(EvaluatorContext &ctx) : ctx_(ctx)
+    {
+        ++ctx.quantifierLevel;
+    }
+
+    ~QuantifierGuard()
+    {
+        --ctx_.quantifierLevel;
+    }
+
+private:
+    EvaluatorContext &ctx_;
+};
+
+class ExceptGuard
+{
+public:
+    explicit ExceptGuard(EvaluatorContext &ctx) : ctx_(ctx)
+    {
+        ctx.exceptRule = true;
+    }
+
+    ~ExceptGuard()
+    {
+        ctx_.exceptRule = false;
+    }
+
+private:
+    EvaluatorContext &ctx_;
+};
+
+// Binds a quantified variable for the lifetime of the guard, restoring what it shadowed.
+class BindingGuard
+{
+public:
+    BindingGuard(Row &row, const std::string &name, Value value) : row_(row), name_(name)
+    {
+        if (auto it = row.find(name); it != row.end())
+        {
+            shadowed_ = std::move(it->second);
+            it->second = std::move(value);
+        }
+        else
+        {
+            row.emplace(name, std::move(value));
+        }
+    }
+
+    ~BindingGuard()
+    {
+        if (shadowed_)
+        {
+            row_[name_] = std::move(*shadowed_);
+        }
+        else
+        {
+            row_.erase(name_);
+        }
+    }
+
+    BindingGuard(const BindingGuard &) = delete;
+    BindingGuard &operator=(const BindingGuard &) = delete;
+
+private:
+    Row &row_;
+    const std::string &name_;
+    std::optional<Value> shadowed_;
+};
+
+class EvaluatorBase
+{
+protected:
+    EvaluatorContext &ctx;
+
+public:
+    explicit EvaluatorBase(EvaluatorContext &context) : ctx(context)
+    {
+    }
+    virtual ~EvaluatorBase() = default;
+};
+} // namespace
+
+// `(parent)-[:CONTAINS*]->(child)`
+inline std::vector<Node> Descendants(const Workspace &workspace, Node parent)
+{
+    std::vector<bool> seen(workspace.graph.NodeCount(), false);
+    std::vector<graph::NodeId> stack{parent.index};
+    while (!stack.empty())
+    {
+        const auto v = stack.back();
+        stack.pop_back();
+        for (const auto w : workspace.Out(Node{v}, Relation::CONTAINS))
+        {
+            if (!seen[w])
+            {
+                seen[w] = true;
+                stack.push_back(w);
+            }
+        }
+    }
+    std::vector<Node> nodes;
+    for (std::uint32_t i = 0; i < seen.size(); ++i)
+    {
+        if (seen[i])
+        {
+            nodes.push_back(Node{i});
+        }
+    }
+    return nodes;
+}
+
+template <typename T> class Evaluator : EvaluatorBase
+{
+public:
+    Value operator()(const T & /*unused*/) const
+    {
+        throw std::runtime_error{"unimplemented evaluation"};
+    }
+};
+
+template <typename... Ts> class Evaluator<std::variant<Ts...>> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Evaluated<std::variant<Ts...>> operator()(const std::variant<Ts...> &var) const
+    {
+        return std::visit([&](auto &subValue) -> Evaluated<std::variant<Ts...>>
+                          { return Evaluator<std::decay_t<decltype(subValue)>>{ctx}(subValue); },
+                          var);
+    }
+};
+
+template <typename T> class Evaluator<std::unique_ptr<T>> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Evaluated<T> operator()(const std::unique_ptr<T> &ptr) const
+    {
+        if (!ptr)
+        {
+            throw std::runtime_error{"broken AST: ptr is null in evaluator"};
+        }
+        return Evaluator<T>{ctx}(*ptr);
+    }
+};
+
+template <KeywordSets K> class Evaluator<KeywordExpr<K>> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const KeywordExpr<K> & /*unused*/) const
+    {
+        List items;
+        if constexpr (K != KeywordSets::NONE)
+        {
+            for (const auto node : ctx.workspace.Labelled(cypher::KeywordMap(K)))
+            {
+                items.emplace_back(node);
+            }
+        }
+        return items;
+    }
+};
+
+template <typename T> class Evaluator<LiteralExpr<T>> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const LiteralExpr<T> &lit) const
+    {
+        return Value{lit.value};
+    }
+};
+
+template <> class Evaluator<SetExpr> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const SetExpr &expr) const
+    {
+        List items;
+        for (const auto &item : expr.items)
+        {
+            items.push_back(Evaluator<ExpressionPtr>{ctx}(item));
+        }
+        return items;
+    }
+};
+
+template <> class Evaluator<VariableExpr> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const VariableExpr &var) const
+    {
+        const auto it = ctx.row.find(var.name);
+        if (it == ctx.row.end())
+        {
+            throw EvaluationError(cypher::variableError, var.name);
+        }
+        return it->second;
+    }
+};
+
+template <ExprType K> class Evaluator<AccessExpr<K>> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const AccessExpr<K> &expr) const
+    {
+        const Value operand = Evaluator<ExpressionPtr>{ctx}(expr.operand);
+        if (operand.IsNull())
+        {
+            return {};
+        }
+        const auto *node = operand.As<Node>();
+        if (node == nullptr)
+        {
+            throw EvaluationError(accessError, expr.prop);
+        }
+        auto value = ctx.workspace.Property(*node, expr.prop);
+        if constexpr (K == ExprType::SAFE_ACCESS)
+        {
+            return !value.IsNull();
+        }
+        return value;
+    }
+};
+
+template <ExprType K> class Evaluator<UnaryExpr<K>> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const UnaryExpr<K> &expr) const
+    {
+        return Negate(Evaluator<ExpressionPtr>{ctx}(expr.operand));
+    }
+};
+
+template <> class Evaluator<CallExpr> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const CallExpr &expr) const
+    {
+        if (not cypher::functionMap.contains(expr.functionName))
+        {
+            throw EvaluationError(cypher::functionError, expr.functionName);
+        }
+        const auto &name = expr.functionName;
+        if (name == "route")
+        {
+            const auto args = Arguments(expr, 2);
+            const auto *from = args[0].As<Node>();
+            const auto *to = args[1].As<Node>();
+            if (from == nullptr || to == nullptr)
+            {
+                return {};
+            }
+            return ctx.workspace.reachability.Reaches(from->index, to->index);
+        }
+        if (name == "cross")
+        {
+            const auto args = Arguments(expr, 2);
+            const auto *items = args[0].As<List>();
+            if (items == nullptr)
+            {
+                return {};
+            }
+            List result;
+            for (const auto &item : *items)
+            {
+                if (IsTrue(In(item, args[1])))
+                {
+                    result.push_back(item);
+                }
+            }
+            return result;
+        }
+        if (name == "union")
+        {
+            const auto args = Arguments(expr, 2);
+            const auto *left = args[0].As<List>();
+            const auto *right = args[1].As<List>();
+            if (left == nullptr || right == nullptr)
+            {
+                return {};
+            }
+            List items{*left};
+            items.insert(items.end(), right->begin(), right->end());
+            return Distinct(std::move(items));
+        }
+        if (name == "failure_point")
+        {
+            const auto args = Arguments(expr, 1);
+            const auto *node = args[0].As<Node>();
+            const auto point =
+                node != nullptr ? ctx.workspace.Property(*node, "articulationPoint") : Value{};
+            return Or(point.IsNull(), Equal(point, std::int64_t{1}));
+        }
+        if (name == "instance")
+        {
+            const auto args = Arguments(expr, 1);
+            List items;
+            if (const auto *node = args[0].As<Node>(); node != nullptr)
+            {
+                for (const auto instance : Instances(*node))
+                {
+                    items.emplace_back(instance);
+                }
+            }
+            return items;
+        }
+        const auto args = Arguments(expr, 1);
+        const auto *node = args[0].As<Node>();
+        return node != nullptr ? Value{ctx.workspace.Id(*node)} : Value{};
+    }
+
+    // `(instance:ContainerInstance)-[:INSTANCE_OF]->(container)`
+    std::vector<Node> Instances(Node container) const
+    {
+        std::vector<Node> nodes;
+        for (const auto source : ctx.workspace.In(container, Relation::INSTANCE_OF))
+        {
+            if (ctx.workspace.graph.LabelOf(source) == graph::Label::CONTAINER_INSTANCE)
+            {
+                nodes.push_back(Node{source});
+            }
+        }
+        std::ranges::sort(nodes);
+        return nodes;
+    }
+
+private:
+    std::vector<Value> Arguments(const CallExpr &expr, std::size_t count) const
+    {
+        if (expr.args.size() != count)
+        {
+            throw EvaluationError("Function [{}] expects {} arguments", expr.functionName, count);
+        }
+        std::vector<Value> args;
+        for (const auto &arg : expr.args)
+        {
+            args.push_back(Evaluator<ExpressionPtr>{ctx}(arg));
+        }
+        return args;
+    }
+};
+
+template <template <ExprType> class T, ExprType U>
+concept BinaryOperands = requires(T<U> tmp) {
+    requires std::same_as<decltype(tmp.left), ExpressionPtr>;
+    requires std::same_as<decltype(tmp.right), ExpressionPtr>;
+};
+
+template <template <ExprType> class T, ExprType U>
+    requires BinaryOperands<T, U>
+class Evaluator<T<U>> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const T<U> &expr) const
+    {
+        Value left = Evaluator<ExpressionPtr>{ctx}(expr.left);
+        // AND and OR are decided by the left operand alone when it is false or true.
+        if constexpr (U == ExprType::AND || U == ExprType::OR)
+        {
+            if (Truth(left) == std::optional<bool>{U == ExprType::OR})
+            {
+                return left;
+            }
+        }
+        Value right = Evaluator<ExpressionPtr>{ctx}(expr.right);
+        switch (U)
+        {
+        case ExprType::AND:
+            return And(left, right);
+        case ExprType::OR:
+            return Or(left, right);
+        case ExprType::XOR:
+            return Xor(left, right);
+        case ExprType::EQ:
+            return Equal(left, right);
+        case ExprType::NOT_EQ:
+            return Not(Equal(left, right));
+        case ExprType::IN:
+            return In(left, right);
+        case ExprType::NOT_IN:
+            return Not(In(left, right));
+        case ExprType::LESS:
+        case ExprType::GREATER:
+        case ExprType::LESS_EQ:
+        case ExprType::GREATER_EQ:
+            return Ordered(U, left, right);
+        default:
+            return Arithmetic(U, std::move(left), std::move(right));
+        }
+    }
+};
+
+template <> class Evaluator<TernaryExpr> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const TernaryExpr &expr) const
+    {
+        return IsTrue(Evaluator<ExpressionPtr>{ctx}(expr.condition))
+                   ? Evaluator<ExpressionPtr>{ctx}(expr.thenExpr)
+                   : Evaluator<ExpressionPtr>{ctx}(expr.elseExpr);
+    }
+};
+
+// The nodes a quantifier ranges over in the current row, and how many of its variables they
+// bind: `instance(c)` binds only the first.
+struct Candidates
+{
+    std::vector<Node> nodes;
+    std::size_t bound = 0;
+};
+
+inline KeywordSets ChildType(KeywordSets set)
+{
+    switch (set)
+    {
+    case KeywordSets::SYSTEM:
+        return KeywordSets::CONTAINER;
+    case KeywordSets::CONTAINER:
+        return KeywordSets::COMPONENT;
+    case KeywordSets::COMPONENT:
+        return KeywordSets::CODE;
+    default:
+        return KeywordSets::NONE;
+    }
+}
+
+template <typename T>
+concept BasicSource = std::is_same_v<T, SystemPtr> || std::is_same_v<T, ContainerPtr> ||
+                      std::is_same_v<T, ComponentPtr> || std::is_same_v<T, CodePtr> ||
+                      std::is_same_v<T, DeployPtr> || std::is_same_v<T, InfrastructurePtr>;
+
+template <typename T> struct SourceHandler
+{
+    Candidates operator()(const std::vector<std::string> & /*unused*/, const T & /*unused*/,
+                          EvaluatorContext & /*unused*/) const
+    {
+        throw std::runtime_error{"Unsupported quantifier source"};
+    }
+};
+
+template <typename... Ts> struct SourceHandler<std::variant<Ts...>>
+{
+    Candidates operator()(const std::vector<std::string> &args, const std::variant<Ts...> &var,
+                          EvaluatorContext &ctx) const
+    {
+        return std::visit(
+            [&](auto &subValue) -> Candidates
+            { return SourceHandler<std::decay_t<decltype(subValue)>>{}(args, subValue, ctx); },
+            var);
+    }
+};
+
+template <> struct SourceHandler<ExpressionPtr>
+{
+    Candidates operator()(const std::vector<std::string> &args, const ExpressionPtr &elem,
+                          EvaluatorContext &ctx) const
+    {
+        return SourceHandler<Expression>{}(args, *elem, ctx);
+    }
+};
+
+template <BasicSource T> struct SourceHandler<T>
+{
+    Candidates operator()(const std::vector<std::string> &args, const T & /*unused*/,
+                          EvaluatorContext &ctx) const
+    {
+        for (const auto &arg : args)
+        {
+            ctx.variableType[arg] = T::element_type::kind;
+        }
+        return {ctx.workspace.Labelled(cypher::KeywordMap(T::element_type::kind)), args.size()};
+    }
+};
+
+template <> struct SourceHandler<VariablePtr>
+{
+    Candidates operator()(const std::vector<std::string> &args, const VariablePtr &elem,
+                          EvaluatorContext &ctx) const
+    {
+        const auto parent = Evaluator<VariablePtr>{ctx}(elem);
+        if (!parent.IsNull() && parent.As<Node>() == nullptr)
+        {
+            throw std::runtime_error{"Element variable expected in pattern"};
+        }
+        const auto type = ctx.variableType[elem->name];
+        for (const auto &arg : args)
+        {
+            ctx.variableType[arg] =
+                type == KeywordSets::DEPLOY ? KeywordSets::CONTAINER : ChildType(type);
+        }
+        if (parent.IsNull())
+        {
+            return {{}, args.size()};
+        }
+        auto nodes = Descendants(ctx.workspace, *parent.As<Node>());
+        if (type != KeywordSets::DEPLOY)
+        {
+            return {std::move(nodes), args.size()};
+        }
+        // (d)-[:CONTAINS*]->(:ContainerInstance)-[:INSTANCE_OF]->(c:Container)
+        std::vector<Node> containers;
+        for (const auto node : nodes)
+        {
+            if (ctx.workspace.Label(node) != graph::Label::CONTAINER_INSTANCE)
+            {
+                continue;
+            }
+            for (const auto target : ctx.workspace.Out(node, Relation::INSTANCE_OF))
+            {
+                if (ctx.workspace.graph.LabelOf(target) == graph::Label::CONTAINER)
+                {
+                    containers.push_back(Node{target});
+                }
+            }
+        }
+        std::ranges::sort(containers);
+        const auto [first, last] = std::ranges::unique(containers);
+        containers.erase(first, last);
+        return {std::move(containers), args.size()};
+    }
+};
+
+template <> struct SourceHandler<CallPtr>
+{
+    Candidates operator()(const std::vector<std::string> &args, const CallPtr &elem,
+                          EvaluatorContext &ctx) const
+    {
+        for (const auto &arg : args)
+        {
+            ctx.variableType[arg] = KeywordSets::NONE;
+        }
+        if (elem->functionName == "route")
+        {
+            if (elem->args.size() != 2)
+            {
+                throw std::runtime_error{"route expects two elements"};
+            }
+            const auto from = NodeOf(elem->args[0], ctx);
+            const auto to = NodeOf(elem->args[1], ctx);
+            if (!from || !to)
+            {
+                return {{}, args.size()};
+            }
+            // Every node of every path `(from)-[*1..]->(to)`, ends included.
+            std::vector<Node> nodes;
+            for (const auto node :
+                 ctx.workspace.reachability.Between(ctx.workspace.graph, from->index, to->index))
+            {
+                nodes.push_back(Node{node});
+            }
+            return {std::move(nodes), args.size()};
+        }
+
+        if (elem->functionName == "instance")
+        {
+            if (args.empty() || elem->args.empty())
+            {
+                throw std::runtime_error{"Empty selector list"};
+            }
+            const auto container = NodeOf(elem->args.front(), ctx);
+            if (!container)
+            {
+                return {{}, 1};
+            }
+            return {Evaluator<CallExpr>{ctx}.Instances(*container), 1};
+        }
+
+        throw std::runtime_error{"Unsupported function"};
+    }
+
+private:
+    static std::optional<Node> NodeOf(const ExpressionPtr &expr, EvaluatorContext &ctx)
+    {
+        const auto value = Evaluator<ExpressionPtr>{ctx}(expr);
+        if (const auto *node = value.As<Node>(); node != nullptr)
+        {
+            return *node;
+        }
+        if (!value.IsNull())
+        {
+            throw std::runtime_error{"Element variable expected in pattern"};
+        }
+        return std::nullopt;
+    }
+};
+
+template <typename P>
+concept FilteredPredicate = std::is_same_v<std::decay_t<P>, FilteredStatementPtr>;
+
+template <QuantifierType Q> class Evaluator<QuantifierStatement<Q>> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+
+    // Nested quantifier: `all` holds when no binding is a counterexample, `exist` when one
+    // binding is a witness.
+    Value operator()(const QuantifierStatement<Q> &stmt) const
+    {
+        QuantifierGuard guard{ctx};
+        if (ctx.quantifierLevel == 1 and ctx.exceptRule)
+        {
+            return Condition(stmt, Q != QuantifierType::ALL);
+        }
+        bool found = false;
+        Bind(stmt,
+             [&]
+             {
+                 found = IsTrue(Condition(stmt, Q == QuantifierType::ALL));
+                 return found;
+             });
+        return Q == QuantifierType::ALL ? !found : found;
+    }
+
+    // Top-level quantifier: every row is extended with the bindings that satisfy it.
+    std::vector<Row> Witness(const QuantifierStatement<Q> &stmt, const std::vector<Row> &rows) const
+    {
+        QuantifierGuard guard{ctx};
+        ctx.returns = stmt.identifiersList;
+        std::vector<Row> result;
+        for (const auto &row : rows)
+        {
+            ctx.row = row;
+            Bind(stmt,
+                 [&]
+                 {
+                     if (IsTrue(Condition(stmt, Q == QuantifierType::ALL)))
+                     {
+                         result.push_back(ctx.row);
+                     }
+                     return false;
+                 });
+        }
+        return result;
+    }
+
+private:
+    // Calls `visit` for each binding of pairwise distinct nodes until it returns true.
+    template <typename F> void Bind(const QuantifierStatement<Q> &stmt, F &&visit) const
+    {
+        const auto candidates =
+            SourceHandler<ExpressionPtr>{}(stmt.identifiersList, stmt.source, ctx);
+        std::vector<Node> chosen;
+        Enumerate(std::span{stmt.identifiersList}.first(candidates.bound), candidates.nodes, chosen,
+                  visit);
+    }
+
+    template <typename F>
+    bool Enumerate(std::span<const std::string> args, const std::vector<Node> &nodes,
+                   std::vector<Node> &chosen, F &visit) const
+    {
+        if (args.empty())
+        {
+            return visit();
+        }
+        for (const auto node : nodes)
+        {
+            if (std::ranges::find(chosen, node) != chosen.end())
+            {
+                continue;
+            }
+            BindingGuard binding{ctx.row, args.front(), node};
+            chosen.push_back(node);
+            const bool stop = Enumerate(args.subspan(1), nodes, chosen, visit);
+            chosen.pop_back();
+            if (stop)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Value Condition(const QuantifierStatement<Q> &stmt, bool negate) const
+    {
+        const auto apply = [negate](const Value &value) { return negate ? Not(value) : value; };
+
+        return std::visit(
+            [&](auto &&pred) -> Value
+            {
+                using PredT = std::decay_t<decltype(pred)>;
+                if constexpr (FilteredPredicate<PredT>)
+                {
+                    auto filter = Evaluator<StatementExpressionPtr>{ctx}(pred->expr);
+                    if (Truth(filter) == std::optional<bool>{false})
+                    {
+                        return false;
+                    }
+                    return And(filter, apply(Evaluator<QuantifierPtr>{ctx}(pred->quant)));
+                }
+                return apply(Evaluator<PredicatePtr>{ctx}(stmt.predicate));
+            },
+            *stmt.predicate);
+    }
+};
+
+template <> class Evaluator<IfThen> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const IfThen &stmt) const
+    {
+        if (IsTrue(Evaluator<ExpressionPtr>{ctx}(stmt.expr)))
+        {
+            return Evaluator<PredicatePtr>{ctx}(stmt.then);
+        }
+        return true;
+    }
+};
+
+template <> class Evaluator<IfThenElse> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const IfThenElse &stmt) const
+    {
+        if (IsTrue(Evaluator<ExpressionPtr>{ctx}(stmt.expr)))
+        {
+            return Evaluator<PredicatePtr>{ctx}(stmt.then);
+        }
+        return Evaluator<PredicatePtr>{ctx}(stmt.els);
+    }
+};
+
+template <> class Evaluator<StatementExpression> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const StatementExpression &stmt) const
+    {
+        return Evaluator<ExpressionPtr>{ctx}(stmt.expr);
+    }
+};
+
+template <> class Evaluator<FilteredStatement> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const FilteredStatement &stmt) const
+    {
+        auto expr = Evaluator<StatementExpressionPtr>{ctx}(stmt.expr);
+        if (Truth(expr) == std::optional<bool>{false})
+        {
+            return false;
+        }
+        return And(expr, Evaluator<QuantifierPtr>{ctx}(stmt.quant));
+    }
+};
+
+template <> class Evaluator<ExceptStatement> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Value operator()(const ExceptStatement &stmt) const
+    {
+        ExceptGuard guard{ctx};
+        return Not(Evaluator<QuantifierPtr>{ctx}(stmt.inner));
+    }
+};
+
+template <> class Evaluator<Block> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    // `rows` holds the bindings the block reads before its own statements.
+    std::vector<Row> operator()(const Block &stmt, std::vector<Row> rows = {Row{}}) const
+    {
+        for (const auto &statement : stmt.statements)
+        {
+            if (!statement)
+            {
+                throw std::runtime_error{"broken AST: ptr is null in evaluator"};
+            }
+            rows = Apply(std::move(rows), *statement);
+        }
+        return rows;
+    }
+
+private:
+    std::vector<Row> Apply(std::vector<Row> rows, const BodyStatement &statement) const
+    {
+        return std::visit(
+            [&](const auto &body) -> std::vector<Row>
+            {
+                using T = std::decay_t<decltype(body)>;
+                if constexpr (std::is_same_v<T, AssignmentStatementPtr>)
+                {
+                    if (!body)
+                    {
+                        throw std::runtime_error{"broken AST: ptr is null in evaluator"};
+                    }
+                    ctx.variableType[body->name] = KeywordSets::NONE;
+                    for (auto &row : rows)
+                    {
+                        ctx.row = row;
+                        row[body->name] = Evaluator<ExpressionPtr>{ctx}(body->valueExpr);
+                    }
+                }
+                else if constexpr (std::is_same_v<T, ExceptStatementPtr>)
+                {
+                    std::erase_if(rows,
+                                  [&](const Row &row)
+                                  {
+                                      ctx.row = row;
+                                      return !IsTrue(Evaluator<T>{ctx}(body));
+                                  });
+                }
+                else
+                {
+                    rows = std::visit(
+                        [&](const auto &ptr) -> std::vector<Row>
+                        {
+                            using Q = typename std::decay_t<decltype(ptr)>::element_type;
+                            if (!ptr)
+                            {
+                                throw std::runtime_error{"broken AST: ptr is null in evaluator"};
+                            }
+                            return Evaluator<Q>{ctx}.Witness(*ptr, rows);
+                        },
+                        body);
+                }
+                return std::move(rows);
+            },
+            statement);
+    }
+};
+
+template <> class Evaluator<Rule> : EvaluatorBase
+{
+public:
+    using EvaluatorBase::EvaluatorBase;
+    Result operator()(const Rule &stmt, std::vector<Row> rows = {Row{}}) const
+    {
+        if (!stmt.calls)
+        {
+            throw std::runtime_error{"broken AST: ptr is null in evaluator"};
+        }
+        rows = Evaluator<Block>{ctx}(*stmt.calls, std::move(rows));
+        // Without a top-level quantifier the query has no RETURN and yields nothing.
+        Result result{ctx.returns, {}};
+        if (result.columns.empty())
+        {
+            return result;
+        }
+        for (const auto &row : rows)
+        {
+            std::vector<Value> values;
+            for (const auto &name : result.columns)
+            {
+                values.push_back(row.at(name));
+            }
+            result.rows.push_back(std::move(values));
+        }
+        return result;
+    }
+};
+
+// Each instance runs on its own, with the template parameters bound to its arguments.
+template <> class Evaluator<RuleTemplate> : EvaluatorBase
+{
+public:
+    static constexpr auto instanceColumn = "instance";
+
+    using EvaluatorBase::EvaluatorBase;
+    Result operator()(const RuleTemplate &stmt) const
+    {
+        for (const auto &parameter : stmt.parameters)
+        {
+            if (parameter == instanceColumn)
+            {
+                throw EvaluationError(cypher::templateParameterError, parameter);
+            }
+        }
+        Result result;
+        for (const auto &instance : stmt.instances)
+        {
+            if (instance.templateName != stmt.rule.name ||
+                instance.arguments.size() != stmt.parameters.size())
+            {
+                throw EvaluationError(cypher::instanceError, instance.name, stmt.rule.name,
+                                      stmt.parameters.size());
+            }
+            EvaluatorContext context{ctx.workspace};
+            Row row{{instanceColumn, Value{instance.name}}};
+            for (std::size_t i = 0; i < stmt.parameters.size(); ++i)
+            {
+                row[stmt.parameters[i]] = Evaluator<ExpressionPtr>{context}(instance.arguments[i]);
+                context.variableType[stmt.parameters[i]] = KeywordSets::NONE;
+            }
+            auto findings = Evaluator<Rule>{context}(stmt.rule, {std::move(row)});
+            result.columns = {instanceColumn};
+            result.columns.insert(result.columns.end(), findings.columns.begin(),
+                                  findings.columns.end());
+            for (auto &values : findings.rows)
+            {
+                values.insert(values.begin(), Value{instance.name});
+                result.rows.push_back(std::move(values));
+            }
+        }
+        return result;
+    }
+};
+
+template <typename U>
+Evaluated<std::decay_t<U>> Evaluate(const U &value, const Workspace &workspace)
+{
+    EvaluatorContext context{workspace};
+    return Evaluator<std::decay_t<U>>{context}(value);
+}
+
+// A value as cypher-shell prints it: `(:Label {key: value, ...})` for an element.
+inline std::string Print(const Value &value, const Workspace &workspace)
+{
+    return std::visit(
+        [&](const auto &data) -> std::string
+        {
+            using T = std::decay_t<decltype(data)>;
+            if constexpr (std::is_same_v<T, std::monostate>)
+            {
+                return "NULL";
+            }
+            else if constexpr (std::is_same_v<T, bool>)
+            {
+                return data ? "TRUE" : "FALSE";
+            }
+            else if constexpr (std::is_same_v<T, std::int64_t>)
+            {
+                return std::to_string(data);
+            }
+            else if constexpr (std::is_same_v<T, std::string>)
+            {
+                return fmt::format("\"{}\"", data);
+            }
+            else if constexpr (std::is_same_v<T, List>)
+            {
+                std::vector<std::string> items;
+                for (const auto &item : data)
+                {
+                    items.push_back(Print(item, workspace));
+                }
+                return fmt::format("[{}]", fmt::join(items, ", "));
+            }
+            else
+            {
+                std::vector<std::string> properties;
+                for (const auto &[key, property] : workspace.properties.at(data.index))
+                {
+                    const bool plain = std::ranges::all_of(
+                        key, [](unsigned char c) { return std::isalnum(c) != 0 || c == '_'; });
+                    properties.push_back(fmt::format("{}: {}",
+                                                     plain ? key : fmt::format("`{}`", key),
+                                                     Print(property, workspace)));
+                }
+                return fmt::format("(:{} {{{}}})", graph::LabelName(workspace.Label(data)),
+                                   fmt::join(properties, ", "));
+            }
+        },
+        value.data);
+}
+
+// The findings in cypher-shell's plain format: a header line, then one line per row.
+inline std::string Print(const Result &result, const Workspace &workspace)
+{
+    if (result.columns.empty())
+    {
+        return {};
+    }
+    std::string output = fmt::format("{}\n", fmt::join(result.columns, ", "));
+    for (const auto &row : result.rows)
+    {
+        std::vector<std::string> values;
+        for (const auto &value : row)
+        {
+            values.push_back(Print(value, workspace));
+        }
+        output += fmt::format("{}\n", fmt::join(values, ", "));
+    }
+    return output;
+}
+
+} // namespace lang::ast::eval
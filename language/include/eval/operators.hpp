@@ -0,0 +1,122 @@
+#pragma once
+
+#include "eval/value.hpp"
+
+#include <ast/expression.hpp>
+
+#include <fmt/format.h>
+
+#include <magic_enum/magic_enum.hpp>
+
+#include <compare>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+// The operators of rule expressions on values, shared by the tree-walking evaluator and the
+// bytecode machine so that both answer alike.
+namespace lang::ast::eval
+{
+
+inline constexpr std::string_view accessError = "Property [{}] of a value that is not an element";
+
+template <typename... Args>
+auto EvaluationError(std::string_view error, Args... args) -> std::runtime_error
+{
+    return std::runtime_error{fmt::format(fmt::runtime(error), args...)};
+}
+
+// `-x` of a number, `not x` of a boolean or null.
+inline Value Negate(const Value &operand)
+{
+    if (const auto *number = operand.As<std::int64_t>(); number != nullptr)
+    {
+        return -*number;
+    }
+    if (operand.IsNull() || operand.As<bool>() != nullptr)
+    {
+        return Not(operand);
+    }
+    throw std::runtime_error{"Negation of a value that is neither a number nor a boolean"};
+}
+
+// LESS, GREATER, LESS_EQ and GREATER_EQ.
+inline Value Ordered(ExprType op, const Value &left, const Value &right)
+{
+    const auto order = Compare(left, right);
+    if (!order || *order == std::partial_ordering::unordered)
+    {
+        return {};
+    }
+    switch (op)
+    {
+    case ExprType::LESS:
+        return *order < 0;
+    case ExprType::GREATER:
+        return *order > 0;
+    case ExprType::LESS_EQ:
+        return *order <= 0;
+    default:
+        return *order >= 0;
+    }
+}
+
+// PLUS, MINUS, MULT and DIV. PLUS also concatenates strings and lists.
+inline Value Arithmetic(ExprType op, Value left, Value right)
+{
+    if (left.IsNull() || right.IsNull())
+    {
+        return {};
+    }
+    if (op == ExprType::PLUS)
+    {
+        const auto *l = left.As<std::string>();
+        const auto *r = right.As<std::string>();
+        if (l != nullptr && r != nullptr)
+        {
+            return *l + *r;
+        }
+        if (auto *items = std::get_if<List>(&left.data); items != nullptr)
+        {
+            if (auto *tail = std::get_if<List>(&right.data); tail != nullptr)
+            {
+                items->insert(items->end(), tail->begin(), tail->end());
+            }
+            else
+            {
+                items->push_back(std::move(right));
+            }
+            return left;
+        }
+        if (auto *items = std::get_if<List>(&right.data); items != nullptr)
+        {
+            items->insert(items->begin(), std::move(left));
+            return right;
+        }
+    }
+    const auto *l = left.As<std::int64_t>();
+    const auto *r = right.As<std::int64_t>();
+    if (l == nullptr || r == nullptr)
+    {
+        throw EvaluationError("Operator [{}] expects numbers", magic_enum::enum_name(op));
+    }
+    switch (op)
+    {
+    case ExprType::PLUS:
+        return *l + *r;
+    case ExprType::MINUS:
+        return *l - *r;
+    case ExprType::MULT:
+        return *l * *r;
+    default:
+        if (*r == 0)
+        {
+            throw std::runtime_error{"Division by zero"};
+        }
+        return *l / *r;
+    }
+}
+
+} // namespace lang::ast::eval
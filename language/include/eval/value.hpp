@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lang::ast::eval
+{
+
+// An element of the workspace graph, by its position in Workspace::elements.
+struct Node
+{
+    std::uint32_t index;
+
+    auto operator<=>(const Node &) const = default;
+};
+
+struct Value;
+using List = std::vector<Value>;
+
+// A Cypher value as the translated queries see it: null, a boolean, an integer, a string, a
+// graph element or a list of values.
+struct Value
+{
+    std::variant<std::monostate, bool, std::int64_t, std::string, Node, List> data;
+
+    Value() = default;
+    Value(bool value) : data(value)
+    {
+    }
+    Value(std::int64_t value) : data(value)
+    {
+    }
+    Value(std::string value) : data(std::move(value))
+    {
+    }
+    Value(const char *value) : data(std::string{value})
+    {
+    }
+    Value(Node value) : data(value)
+    {
+    }
+    Value(List value) : data(std::move(value))
+    {
+    }
+
+    [[nodiscard]] bool IsNull() const
+    {
+        return std::holds_alternative<std::monostate>(data);
+    }
+
+    template <typename T> [[nodiscard]] const T *As() const
+    {
+        return std::get_if<T>(&data);
+    }
+
+    // Structural equality: null equals null. Cypher equality is Equal() below.
+    bool operator==(const Value &) const = default;
+};
+
+// Three-valued logic: a condition holds only when it is exactly true, as in WHERE.
+inline std::optional<bool> Truth(const Value &value)
+{
+    if (const auto *flag = value.As<bool>(); flag != nullptr)
+    {
+        return *flag;
+    }
+    return std::nullopt;
+}
+
+inline bool IsTrue(const Value &value)
+{
+    return Truth(value) == std::optional<bool>{true};
+}
+
+inline Value Not(const Value &value)
+{
+    const auto truth = Truth(value);
+    return truth ? Value{!*truth} : Value{};
+}
+
+inline Value And(const Value &left, const Value &right)
+{
+    const auto l = Truth(left);
+    const auto r = Truth(right);
+    if (l == std::optional<bool>{false} || r == std::optional<bool>{false})
+    {
+        return false;
+    }
+    return l && r ? Value{true} : Value{};
+}
+
+inline Value Or(const Value &left, const Value &right)
+{
+    const auto l = Truth(left);
+    const auto r = Truth(right);
+    if (l == std::optional<bool>{true} || r == std::optional<bool>{true})
+    {
+        return true;
+    }
+    return l && r ? Value{false} : Value{};
+}
+
+inline Value Xor(const Value &left, const Value &right)
+{
+    const auto l = Truth(left);
+    const auto r = Truth(right);
+    return l && r ? Value{*l != *r} : Value{};
+}
+
+// `=`: null if either side is or holds null where it matters, false for different types.
+inline Value Equal(const Value &left, const Value &right)
+{
+    if (left.IsNull() || right.IsNull())
+    {
+        return {};
+    }
+    const auto *l = left.As<List>();
+    const auto *r = right.As<List>();
+    if (l != nullptr && r != nullptr)
+    {
+        if (l->size() != r->size())
+        {
+            return false;
+        }
+        Value result{true};
+        for (std::size_t i = 0; i < l->size(); ++i)
+        {
+            result = And(result, Equal((*l)[i], (*r)[i]));
+            if (result == Value{false})
+            {
+                break;
+            }
+        }
+        return result;
+    }
+    if (left.data.index() != right.data.index())
+    {
+        return false;
+    }
+    return left == right;
+}
+
+// `<`, `>`, `<=`, `>=` order integers and strings; anything else compares to null.
+inline std::optional<std::partial_ordering> Compare(const Value &left, const Value &right)
+{
+    if (const auto *l = left.As<std::int64_t>(), *r = right.As<std::int64_t>(); l && r)
+    {
+        return *l <=> *r;
+    }
+    if (const auto *l = left.As<std::string>(), *r = right.As<std::string>(); l && r)
+    {
+        return *l <=> *r;
+    }
+    if (const auto *l = left.As<bool>(), *r = right.As<bool>(); l && r)
+    {
+        return *l <=> *r;
+    }
+    return std::nullopt;
+}
+
+// `x IN list`: true on a match, null when no match was found but a comparison was null.
+inline Value In(const Value &item, const Value &list)
+{
+    const auto *items = list.As<List>();
+    if (items == nullptr)
+    {
+        return {};
+    }
+    bool unknown = false;
+    for (const auto &candidate : *items)
+    {
+        const auto equal = Equal(item, candidate);
+        if (IsTrue(equal))
+        {
+            return true;
+        }
+        unknown = unknown || equal.IsNull();
+    }
+    return unknown ? Value{} : Value{false};
+}
+
+// The distinct values of a list, in first-seen order.
+inline List Distinct(List items)
+{
+    List result;
+    for (auto &item : items)
+    {
+        if (std::ranges::find(result, item) == result.end())
+        {
+            result.push_back(std::move(item));
+        }
+    }
+    return result;
+}
+
+} // namespace lang::ast::eval
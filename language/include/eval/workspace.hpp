@@ -0,0 +1,257 @@
+#pragma once
+
+#include "eval/value.hpp"
+
+#include <columnar/store.hpp>
+#include <graph/biconnected.hpp>
+#include <graph/csr.hpp>
+#include <graph/reachability.hpp>
+#include <graph/workspace.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lang::ast::eval
+{
+
+using graph::Relation;
+using Properties = std::map<std::string, Value>;
+
+// The graph converter.py imports into Neo4j, held in memory: the same labels, properties and
+// CONTAINS / INSTANCE_OF / RELATES_TO edges, with `articulationPoint` computed in place of GDS.
+struct Workspace
+{
+    std::string name;
+    graph::Graph graph;
+    // By NodeId.
+    std::vector<Properties> properties;
+    // Over every relation, as the translated route() is.
+    graph::ReachabilityIndex reachability;
+    // The string, integer and string list properties of `properties`, by column.
+    columnar::ColumnStore columns;
+
+    [[nodiscard]] std::span<const graph::NodeId> Out(Node node, Relation relation) const
+    {
+        return graph.Out(node.index, relation);
+    }
+
+    [[nodiscard]] std::span<const graph::NodeId> In(Node node, Relation relation) const
+    {
+        return graph.In(node.index, relation);
+    }
+
+    [[nodiscard]] graph::Label Label(Node node) const
+    {
+        return graph.LabelOf(node.index);
+    }
+
+    [[nodiscard]] const std::string &Id(Node node) const
+    {
+        return graph.Id(node.index);
+    }
+
+    [[nodiscard]] Value Property(Node node, const std::string &name) const
+    {
+        const auto &values = properties.at(node.index);
+        const auto it = values.find(name);
+        return it == values.end() ? Value{} : it->second;
+    }
+
+    // The nodes of a label as converter.py names it; none for labels it never writes.
+    [[nodiscard]] std::vector<Node> Labelled(std::string_view label) const
+    {
+        std::vector<Node> nodes;
+        if (const auto parsed = graph::ParseLabel(label); parsed)
+        {
+            for (const auto node : graph.Nodes(*parsed))
+            {
+                nodes.push_back(Node{node});
+            }
+        }
+        return nodes;
+    }
+};
+
+namespace detail
+{
+
+inline Value FromJson(const nlohmann::json &value)
+{
+    if (value.is_boolean())
+    {
+        return value.get<bool>();
+    }
+    if (value.is_number_integer())
+    {
+        return value.get<std::int64_t>();
+    }
+    if (value.is_string())
+    {
+        return value.get<std::string>();
+    }
+    if (value.is_array())
+    {
+        List items;
+        for (const auto &item : value)
+        {
+            items.push_back(FromJson(item));
+        }
+        return items;
+    }
+    return {};
+}
+
+// parse_tags / parse_technologies: comma-separated, trimmed, empty items dropped.
+inline List SplitList(const nlohmann::json &element, const char *key)
+{
+    List items;
+    if (!element.contains(key) || !element[key].is_string())
+    {
+        return items;
+    }
+    const auto text = element[key].get<std::string>();
+    for (const auto part : text | std::views::split(','))
+    {
+        std::string_view item{part.begin(), part.end()};
+        const auto begin = item.find_first_not_of(" \t\n\r");
+        if (begin == std::string_view::npos)
+        {
+            continue;
+        }
+        item = item.substr(begin, item.find_last_not_of(" \t\n\r") - begin + 1);
+        items.emplace_back(std::string{item});
+    }
+    return items;
+}
+
+// The properties import_elements sets on a node.
+inline Properties ElementProperties(const nlohmann::json &element, graph::Label label,
+                                    const std::string &workspace)
+{
+    using graph::detail::Text;
+    Properties properties;
+    properties["id"] = Text(element, "id");
+    properties["name"] = Text(element, "name");
+    properties["tags"] = SplitList(element, "tags");
+    properties["workspace"] = workspace;
+    if (element.contains("properties") && element["properties"].is_object())
+    {
+        for (const auto &[key, value] : element["properties"].items())
+        {
+            properties[key] = FromJson(value);
+        }
+    }
+    if (const auto technology = SplitList(element, "technology"); !technology.empty())
+    {
+        properties["technology"] = technology;
+    }
+    if (const auto environment = Text(element, "environment"); !environment.empty())
+    {
+        properties["environment"] = environment;
+    }
+    if (label == graph::Label::CONTAINER_INSTANCE)
+    {
+        const auto container = Text(element, "containerId");
+        properties["name"] = "Instance of " + container;
+        if (!container.empty())
+        {
+            properties["containerName"] = container;
+        }
+        properties["instanceCount"] = element.contains("instances")
+                                          ? FromJson(element["instances"])
+                                          : Value{std::int64_t{1}};
+    }
+    return properties;
+}
+
+// Booleans and lists of anything but strings stay row-only.
+inline columnar::ColumnStore Columns(const std::vector<Properties> &rows)
+{
+    columnar::ColumnStoreBuilder builder{rows.size()};
+    for (std::size_t row = 0; row < rows.size(); ++row)
+    {
+        for (const auto &[name, value] : rows[row])
+        {
+            if (const auto *text = value.As<std::string>(); text != nullptr)
+            {
+                builder.Add(row, name, *text);
+            }
+            else if (const auto *number = value.As<std::int64_t>(); number != nullptr)
+            {
+                builder.Add(row, name, *number);
+            }
+            else if (const auto *items = value.As<List>(); items != nullptr)
+            {
+                std::vector<std::string> texts;
+                for (const auto &item : *items)
+                {
+                    if (const auto *text = item.As<std::string>(); text != nullptr)
+                    {
+                        texts.push_back(*text);
+                    }
+                }
+                if (texts.size() == items->size())
+                {
+                    builder.Add(row, name, std::span<const std::string>{texts});
+                }
+                else
+                {
+                    builder.Exclude(name);
+                }
+            }
+            else if (!value.IsNull())
+            {
+                builder.Exclude(name);
+            }
+        }
+    }
+    return std::move(builder).Build();
+}
+
+} // namespace detail
+
+// Loads a workspace.json exported by Structurizr. `name` defaults to the workspace name.
+inline Workspace LoadWorkspace(const nlohmann::json &workspace, std::string name = {})
+{
+    Workspace result;
+    result.name = name.empty() && workspace.contains("name") && workspace["name"].is_string()
+                      ? workspace["name"].get<std::string>()
+                      : std::move(name);
+    // Later duplicates of an id update the first node, as MERGE on the id does.
+    std::unordered_map<std::string, Properties> elements;
+    result.graph = graph::LoadGraph(
+        workspace,
+        [&](const nlohmann::json &element, graph::Label label)
+        {
+            auto properties = detail::ElementProperties(element, label, result.name);
+            auto &merged = elements[graph::detail::Text(element, "id")];
+            for (auto &[key, value] : properties)
+            {
+                merged[key] = std::move(value);
+            }
+        });
+
+    const auto points = graph::Biconnected(result.graph).articulationPoints;
+    result.reachability = graph::ReachabilityIndex{result.graph, graph::relations};
+    result.properties.resize(result.graph.NodeCount());
+    for (graph::NodeId node = 0; node < result.graph.NodeCount(); ++node)
+    {
+        auto &properties = result.properties[node];
+        properties = std::move(elements[result.graph.Id(node)]);
+        properties["articulationPoint"] = Value{std::int64_t{points[node] ? 1 : 0}};
+    }
+    result.columns = detail::Columns(result.properties);
+    return result;
+}
+
+} // namespace lang::ast::eval
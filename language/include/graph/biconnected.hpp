@@ -0,0 +1,167 @@
+#pragma once
+
+#include "graph/csr.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace lang::graph
+{
+
+// Articulation points, bridges and biconnected components of the undirected projection of all
+// three relations, the one converter.py used to hand to gds.articulationPoints. Parallel edges
+// count separately, including repeated edges of one type that the Graph stores once, so two
+// nodes linked twice are never a bridge.
+struct Biconnectivity
+{
+    // By NodeId.
+    std::vector<bool> articulationPoints;
+    // (parent, child) in DFS order.
+    std::vector<std::pair<NodeId, NodeId>> bridges;
+    // Nodes of every component, sorted; an articulation point is in several. Isolated nodes
+    // are in none.
+    std::vector<std::vector<NodeId>> components;
+};
+
+// Iterative Tarjan-Hopcroft: one DFS with an explicit stack, so deep CONTAINS chains cannot
+// overflow the call stack.
+inline Biconnectivity Biconnected(const Graph &graph)
+{
+    const auto size = graph.NodeCount();
+    constexpr auto unvisited = invalidNode;
+    std::vector<NodeId> order(size, unvisited);
+    std::vector<NodeId> low(size, 0);
+    Biconnectivity result;
+    result.articulationPoints.assign(size, false);
+    NodeId counter = 0;
+
+    struct Neighbour
+    {
+        NodeId node;
+        // Whether the edge to `node` was added more than once.
+        bool parallel;
+    };
+
+    // Neighbour `index` of `v`: the out-edges of every relation, then the in-edges.
+    const auto neighbour = [&](NodeId v, std::size_t index) -> std::optional<Neighbour>
+    {
+        for (const auto relation : relations)
+        {
+            const auto out = graph.Out(v, relation);
+            if (index < out.size())
+            {
+                return Neighbour{out[index], graph.Parallel(v, out[index], relation)};
+            }
+            index -= out.size();
+            const auto in = graph.In(v, relation);
+            if (index < in.size())
+            {
+                return Neighbour{in[index], graph.Parallel(in[index], v, relation)};
+            }
+            index -= in.size();
+        }
+        return std::nullopt;
+    };
+
+    struct Frame
+    {
+        NodeId vertex;
+        NodeId parent;
+        std::size_t next;
+        // The tree edge to `parent` is skipped once; further edges to it, and the copies of a
+        // repeated tree edge, are parallel edges.
+        bool skippedParent;
+    };
+
+    std::vector<Frame> stack;
+    std::vector<std::pair<NodeId, NodeId>> edges;
+    const auto component = [&](NodeId parent, NodeId child)
+    {
+        std::vector<NodeId> nodes;
+        while (true)
+        {
+            const auto [u, w] = edges.back();
+            edges.pop_back();
+            nodes.push_back(u);
+            nodes.push_back(w);
+            if (u == parent && w == child)
+            {
+                break;
+            }
+        }
+        std::ranges::sort(nodes);
+        const auto [first, last] = std::ranges::unique(nodes);
+        nodes.erase(first, last);
+        result.components.push_back(std::move(nodes));
+    };
+
+    for (NodeId root = 0; root < size; ++root)
+    {
+        if (order[root] != unvisited)
+        {
+            continue;
+        }
+        std::size_t children = 0;
+        order[root] = low[root] = counter++;
+        stack.push_back(Frame{root, unvisited, 0, false});
+        while (!stack.empty())
+        {
+            auto &frame = stack.back();
+            const auto v = frame.vertex;
+            if (const auto next = neighbour(v, frame.next); next)
+            {
+                ++frame.next;
+                const auto w = next->node;
+                if (w == v)
+                {
+                    continue;
+                }
+                if (w == frame.parent && !frame.skippedParent && !next->parallel)
+                {
+                    frame.skippedParent = true;
+                    continue;
+                }
+                if (order[w] == unvisited)
+                {
+                    order[w] = low[w] = counter++;
+                    children += v == root ? 1 : 0;
+                    edges.emplace_back(v, w);
+                    stack.push_back(Frame{w, v, 0, false});
+                }
+                else if (order[w] < order[v])
+                {
+                    // A back edge to an ancestor; seen from the ancestor it is skipped.
+                    low[v] = std::min(low[v], order[w]);
+                    edges.emplace_back(v, w);
+                }
+                continue;
+            }
+
+            const auto parent = frame.parent;
+            stack.pop_back();
+            if (parent == unvisited)
+            {
+                continue;
+            }
+            low[parent] = std::min(low[parent], low[v]);
+            if (low[v] > order[parent])
+            {
+                result.bridges.emplace_back(parent, v);
+            }
+            if (low[v] >= order[parent])
+            {
+                if (parent != root || children > 1)
+                {
+                    result.articulationPoints[parent] = true;
+                }
+                component(parent, v);
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace lang::graph
@@ -0,0 +1,361 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Compressed-sparse-row store of a C4 model. Structurizr ids are remapped to dense NodeIds,
+// numbered so that the nodes of one label form a contiguous range; every relationship type
+// has its own forward and reverse adjacency:
+//
+//   offsets  NodeCount() + 1 entries, the edges of node v are targets[offsets[v]..offsets[v+1])
+//   targets  one NodeId per edge, sorted and without duplicates within a node
+//   repeated positions in targets of the edges that were added more than once, sorted
+//
+// An edge costs 4 bytes forward and 4 bytes reverse; offsets add 8 bytes per node and type.
+namespace lang::graph
+{
+
+using NodeId = std::uint32_t;
+
+inline constexpr auto invalidNode = std::numeric_limits<NodeId>::max();
+
+// Node labels in the order of their ranges, as converter.py names them.
+enum class Label : std::uint8_t
+{
+    PERSON,
+    SOFTWARE_SYSTEM,
+    CONTAINER,
+    COMPONENT,
+    DEPLOYMENT_NODE,
+    CONTAINER_INSTANCE,
+    INFRASTRUCTURE_NODE
+};
+
+inline constexpr std::size_t labelCount = 7;
+
+enum class Relation : std::uint8_t
+{
+    RELATES_TO,
+    CONTAINS,
+    INSTANCE_OF
+};
+
+inline constexpr std::size_t relationCount = 3;
+
+inline constexpr std::array<Relation, relationCount> relations{
+    Relation::RELATES_TO, Relation::CONTAINS, Relation::INSTANCE_OF};
+
+inline constexpr std::array<std::string_view, labelCount> labelNames{
+    "Person",         "SoftwareSystem",    "Container",         "Component",
+    "DeploymentNode", "ContainerInstance", "InfrastructureNode"};
+
+inline constexpr std::string_view LabelName(Label label)
+{
+    return labelNames[std::to_underlying(label)];
+}
+
+inline std::optional<Label> ParseLabel(std::string_view name)
+{
+    const auto it = std::ranges::find(labelNames, name);
+    if (it == labelNames.end())
+    {
+        return std::nullopt;
+    }
+    return static_cast<Label>(it - labelNames.begin());
+}
+
+struct Adjacency
+{
+    std::vector<std::uint32_t> offsets;
+    std::vector<NodeId> targets;
+    std::vector<std::uint32_t> repeated;
+
+    [[nodiscard]] std::span<const NodeId> operator[](NodeId node) const
+    {
+        return std::span{targets}.subspan(offsets[node], offsets[node + 1] - offsets[node]);
+    }
+
+    // Whether the edge from `node` to `target` was added more than once.
+    [[nodiscard]] bool Repeated(NodeId node, NodeId target) const
+    {
+        if (repeated.empty())
+        {
+            return false;
+        }
+        const auto row = (*this)[node];
+        const auto it = std::ranges::lower_bound(row, target);
+        return it != row.end() && *it == target &&
+               std::ranges::binary_search(
+                   repeated, static_cast<std::uint32_t>(offsets[node] + (it - row.begin())));
+    }
+
+    [[nodiscard]] std::size_t Bytes() const
+    {
+        return offsets.capacity() * sizeof(std::uint32_t) + targets.capacity() * sizeof(NodeId) +
+               repeated.capacity() * sizeof(std::uint32_t);
+    }
+};
+
+class Graph
+{
+public:
+    [[nodiscard]] NodeId NodeCount() const
+    {
+        return static_cast<NodeId>(ids_.size());
+    }
+
+    [[nodiscard]] std::size_t EdgeCount(Relation relation) const
+    {
+        return forward_[std::to_underlying(relation)].targets.size();
+    }
+
+    [[nodiscard]] std::size_t EdgeCount() const
+    {
+        std::size_t count = 0;
+        for (const auto &adjacency : forward_)
+        {
+            count += adjacency.targets.size();
+        }
+        return count;
+    }
+
+    [[nodiscard]] std::span<const NodeId> Out(NodeId node, Relation relation) const
+    {
+        return forward_[std::to_underlying(relation)][node];
+    }
+
+    [[nodiscard]] std::span<const NodeId> In(NodeId node, Relation relation) const
+    {
+        return reverse_[std::to_underlying(relation)][node];
+    }
+
+    // Parallel edges are stored once; this tells whether `source` -> `target` was added twice.
+    [[nodiscard]] bool Parallel(NodeId source, NodeId target, Relation relation) const
+    {
+        return forward_[std::to_underlying(relation)].Repeated(source, target);
+    }
+
+    [[nodiscard]] std::ranges::iota_view<NodeId, NodeId> Nodes(Label label) const
+    {
+        const auto index = std::to_underlying(label);
+        return {labelOffsets_[index], labelOffsets_[index + 1]};
+    }
+
+    [[nodiscard]] Label LabelOf(NodeId node) const
+    {
+        const auto it = std::ranges::upper_bound(labelOffsets_, node);
+        return static_cast<Label>(it - labelOffsets_.begin() - 1);
+    }
+
+    [[nodiscard]] const std::string &Id(NodeId node) const
+    {
+        return ids_.at(node);
+    }
+
+    [[nodiscard]] std::optional<NodeId> Find(const std::string &id) const
+    {
+        const auto it = index_.find(id);
+        return it == index_.end() ? std::nullopt : std::optional{it->second};
+    }
+
+    // Bytes held by the adjacency arrays, the part that grows with the edges.
+    [[nodiscard]] std::size_t AdjacencyBytes() const
+    {
+        std::size_t bytes = 0;
+        for (std::size_t r = 0; r < relationCount; ++r)
+        {
+            bytes += forward_[r].Bytes() + reverse_[r].Bytes();
+        }
+        return bytes;
+    }
+
+private:
+    friend class GraphBuilder;
+
+    std::array<NodeId, labelCount + 1> labelOffsets_{};
+    std::vector<std::string> ids_;
+    std::unordered_map<std::string, NodeId> index_;
+    std::array<Adjacency, relationCount> forward_;
+    std::array<Adjacency, relationCount> reverse_;
+};
+
+namespace detail
+{
+
+// CSR of `edges` (by target when `reverse`), rows sorted and without parallel edges. With
+// `markRepeated` the edges that had parallel copies are listed in `repeated`.
+inline Adjacency Compress(const std::vector<std::pair<NodeId, NodeId>> &edges, NodeId nodes,
+                          bool reverse, bool markRepeated = false)
+{
+    if (edges.size() >= std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::runtime_error{"graph has too many edges"};
+    }
+    Adjacency adjacency;
+    adjacency.offsets.assign(std::size_t{nodes} + 1, 0);
+    for (const auto &[source, target] : edges)
+    {
+        ++adjacency.offsets[(reverse ? target : source) + 1];
+    }
+    for (NodeId node = 0; node < nodes; ++node)
+    {
+        adjacency.offsets[node + 1] += adjacency.offsets[node];
+    }
+    std::vector<NodeId> targets(edges.size());
+    auto next = adjacency.offsets;
+    for (const auto &[source, target] : edges)
+    {
+        targets[next[reverse ? target : source]++] = reverse ? source : target;
+    }
+
+    // Sort every row and drop parallel edges, compacting in place.
+    std::uint32_t write = 0;
+    for (NodeId node = 0; node < nodes; ++node)
+    {
+        auto read = targets.begin() + adjacency.offsets[node];
+        const auto end = targets.begin() + adjacency.offsets[node + 1];
+        std::sort(read, end);
+        adjacency.offsets[node] = write;
+        while (read != end)
+        {
+            const auto target = *read;
+            const auto last = std::upper_bound(read, end, target);
+            if (markRepeated && last - read > 1)
+            {
+                adjacency.repeated.push_back(write);
+            }
+            targets[write++] = target;
+            read = last;
+        }
+    }
+    adjacency.offsets[nodes] = write;
+    targets.resize(write);
+    targets.shrink_to_fit();
+    adjacency.targets = std::move(targets);
+    return adjacency;
+}
+
+} // namespace detail
+
+// Collects nodes and edges in any order. Edges may name ids that are added later; edges whose
+// ends never become nodes are dropped, as the converter's MATCH drops them.
+class GraphBuilder
+{
+public:
+    // A repeated id keeps the label it was first added with.
+    void AddNode(const std::string &id, Label label)
+    {
+        const auto node = Intern(id);
+        if (labels_[node] == unlabelled)
+        {
+            labels_[node] = std::to_underlying(label);
+            nodes_.push_back(node);
+        }
+    }
+
+    void AddEdge(const std::string &source, const std::string &target, Relation relation)
+    {
+        edges_.push_back(Edge{Intern(source), Intern(target), relation});
+    }
+
+    Graph Build() &&
+    {
+        Graph graph;
+        const auto dense = Number(graph);
+        std::array<std::vector<std::pair<NodeId, NodeId>>, relationCount> edges;
+        for (const auto &edge : edges_)
+        {
+            const auto source = dense[edge.source];
+            const auto target = dense[edge.target];
+            if (source != invalidNode && target != invalidNode)
+            {
+                edges[std::to_underlying(edge.relation)].emplace_back(source, target);
+            }
+        }
+        edges_ = {};
+        for (std::size_t r = 0; r < relationCount; ++r)
+        {
+            graph.forward_[r] = detail::Compress(edges[r], graph.NodeCount(), false, true);
+            graph.reverse_[r] = detail::Compress(edges[r], graph.NodeCount(), true);
+            edges[r] = {};
+        }
+        return graph;
+    }
+
+private:
+    static constexpr std::uint8_t unlabelled = std::numeric_limits<std::uint8_t>::max();
+
+    struct Edge
+    {
+        NodeId source;
+        NodeId target;
+        Relation relation;
+    };
+
+    std::vector<std::string> ids_;
+    std::unordered_map<std::string, NodeId> index_;
+    std::vector<std::uint8_t> labels_;
+    // Labelled nodes in the order they were added.
+    std::vector<NodeId> nodes_;
+    std::vector<Edge> edges_;
+
+    NodeId Intern(const std::string &id)
+    {
+        const auto [it, inserted] = index_.emplace(id, static_cast<NodeId>(ids_.size()));
+        if (inserted)
+        {
+            if (ids_.size() == invalidNode)
+            {
+                throw std::runtime_error{"graph has too many nodes"};
+            }
+            ids_.push_back(id);
+            labels_.push_back(unlabelled);
+        }
+        return it->second;
+    }
+
+    // Counting sort of the labelled nodes by label, stable in the order they were added.
+    std::vector<NodeId> Number(Graph &graph)
+    {
+        std::array<NodeId, labelCount + 1> offsets{};
+        for (const auto node : nodes_)
+        {
+            ++offsets[labels_[node] + 1];
+        }
+        for (std::size_t i = 0; i < labelCount; ++i)
+        {
+            offsets[i + 1] += offsets[i];
+        }
+        graph.labelOffsets_ = offsets;
+        graph.ids_.resize(offsets[labelCount]);
+        graph.index_.reserve(offsets[labelCount]);
+
+        std::vector<NodeId> dense(ids_.size(), invalidNode);
+        for (const auto node : nodes_)
+        {
+            const auto id = offsets[labels_[node]]++;
+            dense[node] = id;
+            graph.index_.emplace(ids_[node], id);
+            graph.ids_[id] = std::move(ids_[node]);
+        }
+        ids_ = {};
+        index_ = {};
+        labels_ = {};
+        nodes_ = {};
+        return dense;
+    }
+};
+
+} // namespace lang::graph
@@ -0,0 +1,361 @@
+#pragma once
+
+#include "graph/csr.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Reachability over one or more edges of the chosen relations, the `route(a, b)` of a rule.
+//
+// The graph is condensed into its strongly connected components, numbered by Tarjan in reverse
+// topological order, so `from` can only reach components with a smaller number. Reachability
+// between components is then answered by one of two exact structures:
+//
+//   bitset   the transitive closure, one bit per pair of components; used up to `bitsetLimit`
+//            components, where it costs at most bitsetLimit^2 / 8 bytes
+//   2-hop    pruned landmark labels: every component keeps the hubs it reaches (out) and the
+//            hubs reaching it (in), and a reaches b iff out(a) and in(b) share a hub
+namespace lang::graph
+{
+
+inline constexpr std::array<Relation, 1> routeRelations{Relation::RELATES_TO};
+
+struct ReachabilityOptions
+{
+    // Components up to which the closure is kept as a bitset rather than as 2-hop labels.
+    std::size_t bitsetLimit = 8192;
+};
+
+class ReachabilityIndex
+{
+public:
+    ReachabilityIndex() = default;
+
+    explicit ReachabilityIndex(const Graph &graph,
+                               std::span<const Relation> relations = routeRelations,
+                               ReachabilityOptions options = {})
+        : relations_(relations.begin(), relations.end())
+    {
+        Condense(graph);
+        if (ComponentCount() <= options.bitsetLimit)
+        {
+            BuildClosure();
+        }
+        else
+        {
+            BuildLabels();
+        }
+        dag_ = {};
+        reverseDag_ = {};
+    }
+
+    // Whether a path of one or more edges leads from `from` to `to`.
+    [[nodiscard]] bool Reaches(NodeId from, NodeId to) const
+    {
+        const auto a = component_[from];
+        const auto b = component_[to];
+        if (a == b)
+        {
+            return cyclic_[a];
+        }
+        if (b > a)
+        {
+            return false;
+        }
+        if (!closure_.empty())
+        {
+            return (closure_[a * words_ + b / 64] >> (b % 64) & 1U) != 0;
+        }
+        return Intersects(outLabels_[a], inLabels_[b]);
+    }
+
+    // Every node of every path from `from` to `to`, ends included, in NodeId order; empty when
+    // there is no path. Walks only the nodes that can still reach `to`.
+    [[nodiscard]] std::vector<NodeId> Between(const Graph &graph, NodeId from, NodeId to) const
+    {
+        std::vector<NodeId> nodes;
+        if (!Reaches(from, to))
+        {
+            return nodes;
+        }
+        std::vector<bool> seen(graph.NodeCount(), false);
+        seen[from] = true;
+        nodes.push_back(from);
+        for (std::size_t next = 0; next < nodes.size(); ++next)
+        {
+            for (const auto relation : relations_)
+            {
+                for (const auto w : graph.Out(nodes[next], relation))
+                {
+                    if (!seen[w] && (w == to || Reaches(w, to)))
+                    {
+                        seen[w] = true;
+                        nodes.push_back(w);
+                    }
+                }
+            }
+        }
+        std::ranges::sort(nodes);
+        return nodes;
+    }
+
+    [[nodiscard]] std::size_t ComponentCount() const
+    {
+        return cyclic_.size();
+    }
+
+    [[nodiscard]] bool UsesBitset() const
+    {
+        return !closure_.empty() || ComponentCount() == 0;
+    }
+
+    [[nodiscard]] std::size_t Bytes() const
+    {
+        return component_.capacity() * sizeof(NodeId) + cyclic_.capacity() / 8 +
+               closure_.capacity() * sizeof(std::uint64_t) + outLabels_.Bytes() +
+               inLabels_.Bytes();
+    }
+
+private:
+    std::vector<Relation> relations_;
+    // By NodeId.
+    std::vector<NodeId> component_;
+    // By component: a path of one or more edges leads back to it.
+    std::vector<bool> cyclic_;
+    // Condensation, deduplicated; only alive while the index is built.
+    Adjacency dag_;
+    Adjacency reverseDag_;
+
+    std::size_t words_ = 0;
+    std::vector<std::uint64_t> closure_;
+    // Hub ranks, sorted, by component.
+    Adjacency outLabels_;
+    Adjacency inLabels_;
+
+    static bool Intersects(std::span<const NodeId> left, std::span<const NodeId> right)
+    {
+        auto l = left.begin();
+        auto r = right.begin();
+        while (l != left.end() && r != right.end())
+        {
+            if (*l == *r)
+            {
+                return true;
+            }
+            *l < *r ? ++l : ++r;
+        }
+        return false;
+    }
+
+    // Iterative Tarjan over the chosen relations, then the deduplicated component DAG.
+    void Condense(const Graph &graph)
+    {
+        const auto size = graph.NodeCount();
+        constexpr auto unvisited = invalidNode;
+        std::vector<NodeId> order(size, unvisited);
+        std::vector<NodeId> low(size, 0);
+        std::vector<bool> onStack(size, false);
+        std::vector<NodeId> members;
+        component_.assign(size, invalidNode);
+        NodeId counter = 0;
+        NodeId components = 0;
+
+        struct Frame
+        {
+            NodeId vertex;
+            std::size_t relation;
+            std::size_t next;
+        };
+        std::vector<Frame> stack;
+        for (NodeId root = 0; root < size; ++root)
+        {
+            if (order[root] != unvisited)
+            {
+                continue;
+            }
+            order[root] = low[root] = counter++;
+            members.push_back(root);
+            onStack[root] = true;
+            stack.push_back(Frame{root, 0, 0});
+            while (!stack.empty())
+            {
+                auto &frame = stack.back();
+                const auto v = frame.vertex;
+                if (frame.relation < relations_.size())
+                {
+                    const auto edges = graph.Out(v, relations_[frame.relation]);
+                    if (frame.next == edges.size())
+                    {
+                        ++frame.relation;
+                        frame.next = 0;
+                        continue;
+                    }
+                    const auto w = edges[frame.next++];
+                    if (order[w] == unvisited)
+                    {
+                        order[w] = low[w] = counter++;
+                        members.push_back(w);
+                        onStack[w] = true;
+                        stack.push_back(Frame{w, 0, 0});
+                    }
+                    else if (onStack[w])
+                    {
+                        low[v] = std::min(low[v], order[w]);
+                    }
+                    continue;
+                }
+
+                stack.pop_back();
+                if (!stack.empty())
+                {
+                    const auto parent = stack.back().vertex;
+                    low[parent] = std::min(low[parent], low[v]);
+                }
+                if (low[v] == order[v])
+                {
+                    NodeId w = invalidNode;
+                    do
+                    {
+                        w = members.back();
+                        members.pop_back();
+                        onStack[w] = false;
+                        component_[w] = components;
+                    } while (w != v);
+                    ++components;
+                }
+            }
+        }
+
+        cyclic_.assign(components, false);
+        std::vector<std::pair<NodeId, NodeId>> edges;
+        for (NodeId v = 0; v < size; ++v)
+        {
+            for (const auto relation : relations_)
+            {
+                for (const auto w : graph.Out(v, relation))
+                {
+                    if (component_[v] == component_[w])
+                    {
+                        cyclic_[component_[v]] = true;
+                    }
+                    else
+                    {
+                        edges.emplace_back(component_[v], component_[w]);
+                    }
+                }
+            }
+        }
+        dag_ = detail::Compress(edges, components, false);
+        reverseDag_ = detail::Compress(edges, components, true);
+    }
+
+    // Successors have smaller numbers, so one ascending pass sees every row it ORs in complete.
+    void BuildClosure()
+    {
+        const auto components = ComponentCount();
+        words_ = (components + 63) / 64;
+        closure_.assign(components * words_, 0);
+        for (NodeId c = 0; c < components; ++c)
+        {
+            auto *row = closure_.data() + std::size_t{c} * words_;
+            for (const auto s : dag_[c])
+            {
+                const auto *successor = closure_.data() + std::size_t{s} * words_;
+                // Rows of successors only have bits below `s + 1`.
+                for (std::size_t word = 0; word <= s / 64; ++word)
+                {
+                    row[word] |= successor[word];
+                }
+                row[s / 64] |= std::uint64_t{1} << (s % 64);
+            }
+        }
+    }
+
+    // Pruned landmark labeling: hubs in order of (in + 1) * (out + 1), each a forward and a
+    // backward BFS that stops wherever the labels so far already answer the query.
+    void BuildLabels()
+    {
+        const auto components = static_cast<NodeId>(ComponentCount());
+        std::vector<NodeId> hubs(components);
+        std::iota(hubs.begin(), hubs.end(), NodeId{0});
+        const auto weight = [&](NodeId c)
+        {
+            return (std::uint64_t{dag_[c].size()} + 1) * (reverseDag_[c].size() + 1);
+        };
+        std::ranges::stable_sort(hubs, [&](NodeId a, NodeId b) { return weight(a) > weight(b); });
+
+        // Ranks are appended in increasing order, so every label stays sorted.
+        std::vector<std::vector<NodeId>> out(components);
+        std::vector<std::vector<NodeId>> in(components);
+        std::vector<NodeId> forwardSeen(components, invalidNode);
+        std::vector<NodeId> backwardSeen(components, invalidNode);
+        std::vector<NodeId> queue;
+        // From `hub`, adding `rank` to the `other` label of every component not yet covered by
+        // the `own` label of the hub.
+        const auto search = [&](NodeId hub, NodeId rank, const Adjacency &edges,
+                                std::vector<NodeId> &seen, std::vector<std::vector<NodeId>> &own,
+                                std::vector<std::vector<NodeId>> &other)
+        {
+            queue.assign(1, hub);
+            seen[hub] = rank;
+            for (std::size_t next = 0; next < queue.size(); ++next)
+            {
+                const auto c = queue[next];
+                if (c != hub && Intersects(own[hub], other[c]))
+                {
+                    continue;
+                }
+                other[c].push_back(rank);
+                for (const auto w : edges[c])
+                {
+                    if (seen[w] != rank)
+                    {
+                        seen[w] = rank;
+                        queue.push_back(w);
+                    }
+                }
+            }
+        };
+        for (NodeId rank = 0; rank < components; ++rank)
+        {
+            search(hubs[rank], rank, dag_, forwardSeen, out, in);
+            search(hubs[rank], rank, reverseDag_, backwardSeen, in, out);
+        }
+        outLabels_ = Flatten(out);
+        inLabels_ = Flatten(in);
+    }
+
+    static Adjacency Flatten(std::vector<std::vector<NodeId>> &labels)
+    {
+        Adjacency adjacency;
+        adjacency.offsets.reserve(labels.size() + 1);
+        adjacency.offsets.push_back(0);
+        std::size_t total = 0;
+        for (const auto &label : labels)
+        {
+            total += label.size();
+            if (total >= std::numeric_limits<std::uint32_t>::max())
+            {
+                throw std::runtime_error{"reachability labels are too large"};
+            }
+            adjacency.offsets.push_back(static_cast<std::uint32_t>(total));
+        }
+        adjacency.targets.reserve(total);
+        for (auto &label : labels)
+        {
+            adjacency.targets.insert(adjacency.targets.end(), label.begin(), label.end());
+            label = {};
+        }
+        return adjacency;
+    }
+};
+
+} // namespace lang::graph
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "graph/csr.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace lang::graph
+{
+
+namespace detail
+{
+
+inline const nlohmann::json &Items(const nlohmann::json &object, const char *key)
+{
+    static const nlohmann::json empty = nlohmann::json::array();
+    return object.contains(key) && object[key].is_array() ? object[key] : empty;
+}
+
+inline std::string Text(const nlohmann::json &object, const char *key)
+{
+    return object.contains(key) && object[key].is_string() ? object[key].get<std::string>()
+                                                            : std::string{};
+}
+
+// Walks a model the way extract_elements_and_relationships in converter.py does, reporting
+// every element to `visit` and its edges to the builder.
+template <typename F> class Walker
+{
+public:
+    Walker(GraphBuilder &builder, F &visit) : builder_(builder), visit_(visit)
+    {
+    }
+
+    void operator()(const nlohmann::json &model)
+    {
+        for (const auto &person : Items(model, "people"))
+        {
+            Add(person, Label::PERSON, nullptr);
+        }
+        for (const auto &system : Items(model, "softwareSystems"))
+        {
+            Add(system, Label::SOFTWARE_SYSTEM, nullptr);
+            for (const auto &container : Items(system, "containers"))
+            {
+                Add(container, Label::CONTAINER, &system);
+                for (const auto &component : Items(container, "components"))
+                {
+                    Add(component, Label::COMPONENT, &container);
+                }
+            }
+        }
+        for (const auto &node : Items(model, "deploymentNodes"))
+        {
+            DeploymentNode(node, nullptr);
+        }
+        Relationships(model);
+    }
+
+private:
+    GraphBuilder &builder_;
+    F &visit_;
+
+    void Add(const nlohmann::json &element, Label label, const nlohmann::json *parent)
+    {
+        const auto id = Text(element, "id");
+        builder_.AddNode(id, label);
+        if (parent != nullptr)
+        {
+            builder_.AddEdge(Text(*parent, "id"), id, Relation::CONTAINS);
+        }
+        visit_(element, label);
+        Relationships(element);
+    }
+
+    void DeploymentNode(const nlohmann::json &node, const nlohmann::json *parent)
+    {
+        Add(node, Label::DEPLOYMENT_NODE, parent);
+        for (const auto &child : Items(node, "children"))
+        {
+            DeploymentNode(child, &node);
+        }
+        for (const auto &instance : Items(node, "containerInstances"))
+        {
+            Add(instance, Label::CONTAINER_INSTANCE, &node);
+            builder_.AddEdge(Text(instance, "id"), Text(instance, "containerId"),
+                             Relation::INSTANCE_OF);
+        }
+        for (const auto &infrastructure : Items(node, "infrastructureNodes"))
+        {
+            Add(infrastructure, Label::INFRASTRUCTURE_NODE, &node);
+        }
+    }
+
+    void Relationships(const nlohmann::json &object)
+    {
+        for (const auto &relationship : Items(object, "relationships"))
+        {
+            builder_.AddEdge(Text(relationship, "sourceId"), Text(relationship, "destinationId"),
+                             Relation::RELATES_TO);
+        }
+    }
+};
+
+} // namespace detail
+
+// Loads the elements and relationships of a Structurizr workspace.json. `visit` is called
+// with the JSON object and label of every element, for callers that keep their properties.
+template <typename F> Graph LoadGraph(const nlohmann::json &workspace, F &&visit)
+{
+    if (!workspace.contains("model") || !workspace["model"].is_object())
+    {
+        throw std::runtime_error{"workspace.json has no model"};
+    }
+    GraphBuilder builder;
+    detail::Walker<std::remove_reference_t<F>>{builder, visit}(workspace["model"]);
+    return std::move(builder).Build();
+}
+
+inline Graph LoadGraph(const nlohmann::json &workspace)
+{
+    return LoadGraph(workspace, [](const nlohmann::json &, Label) {});
+}
+
+} // namespace lang::graph
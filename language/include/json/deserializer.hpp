@@ -0,0 +1,449 @@
+#pragma once
+#include "ast/expression.hpp"
+#include "ast/statement.hpp"
+#include <ast/ast.hpp>
+#include <magic_enum/magic_enum.hpp>
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// The inverse of Serializer: rebuilds the AST from its JSON, checking every node against the
+// schema the serializer writes. Source locations are optional, so output written without them
+// (see json/writer.hpp) loads too.
+namespace lang::ast::json
+{
+
+namespace detail
+{
+
+[[noreturn]] inline void Invalid(const nlohmann::json &node, std::string_view problem)
+{
+    std::string type = "node";
+    if (node.is_object() && node.contains("type") && node["type"].is_string())
+    {
+        type = node["type"].get<std::string>();
+    }
+    throw std::runtime_error{"invalid AST JSON: " + std::string{problem} + " in " + type};
+}
+
+inline const nlohmann::json &Field(const nlohmann::json &node, const std::string &key)
+{
+    if (!node.is_object() || !node.contains(key))
+    {
+        Invalid(node, "missing '" + key + "'");
+    }
+    return node[key];
+}
+
+inline std::string Text(const nlohmann::json &node, const std::string &key)
+{
+    const auto &value = Field(node, key);
+    if (!value.is_string())
+    {
+        Invalid(node, "'" + key + "' is not a string");
+    }
+    return value.get<std::string>();
+}
+
+inline const nlohmann::json &Array(const nlohmann::json &node, const std::string &key)
+{
+    const auto &value = Field(node, key);
+    if (!value.is_array())
+    {
+        Invalid(node, "'" + key + "' is not an array");
+    }
+    return value;
+}
+
+template <typename E> E Enum(const nlohmann::json &node, const std::string &key)
+{
+    const auto value = magic_enum::enum_cast<E>(Text(node, key));
+    if (!value)
+    {
+        Invalid(node, "unknown " + key + " '" + Text(node, key) + "'");
+    }
+    return *value;
+}
+
+inline NodeLocation Location(const nlohmann::json &node)
+{
+    if (!node.contains("node"))
+    {
+        return {};
+    }
+    const auto &location = node["node"];
+    const auto number = [&](const std::string &key)
+    {
+        const auto &value = Field(location, key);
+        if (!value.is_number_unsigned())
+        {
+            Invalid(node, "location '" + key + "' is not a position");
+        }
+        return value.get<std::size_t>();
+    };
+    return {number("line"), number("column"), number("length")};
+}
+
+template <typename T> auto Make(T &&node)
+{
+    return std::make_unique<Expression>(std::make_unique<std::decay_t<T>>(std::forward<T>(node)));
+}
+
+} // namespace detail
+
+template <typename T> class Deserializer;
+
+template <> class Deserializer<std::string>
+{
+public:
+    std::string operator()(const nlohmann::json &node) const
+    {
+        if (!node.is_string())
+        {
+            detail::Invalid(node, "expected a string");
+        }
+        return node.get<std::string>();
+    }
+};
+
+template <typename T> class Deserializer<std::vector<T>>
+{
+public:
+    std::vector<T> operator()(const nlohmann::json &node) const
+    {
+        if (!node.is_array())
+        {
+            detail::Invalid(node, "expected an array");
+        }
+        std::vector<T> items;
+        items.reserve(node.size());
+        for (const auto &item : node)
+        {
+            items.push_back(Deserializer<T>{}(item));
+        }
+        return items;
+    }
+};
+
+template <> class Deserializer<ExpressionPtr>
+{
+public:
+    ExpressionPtr operator()(const nlohmann::json &node) const
+    {
+        if (node.is_object() && node.contains("expression") && !node.contains("type"))
+        {
+            if (detail::Text(node, "expression") != "set")
+            {
+                detail::Invalid(node, "unknown expression");
+            }
+            return detail::Make(
+                SetExpr{Deserializer<std::vector<ExpressionPtr>>{}(detail::Array(node, "set"))});
+        }
+
+        const auto type = detail::Text(node, "type");
+        if (type == "keyword")
+        {
+            return Keyword(node);
+        }
+        if (type == "literal")
+        {
+            return Literal(node);
+        }
+        if (type == "variable")
+        {
+            return detail::Make(
+                VariableExpr{detail::Text(node, "variable"), detail::Location(node)});
+        }
+        if (type == "call")
+        {
+            return detail::Make(CallExpr{
+                detail::Text(node, "name"),
+                Deserializer<std::vector<ExpressionPtr>>{}(detail::Array(node, "args")),
+                detail::Location(node)});
+        }
+        if (type == "ternary")
+        {
+            return detail::Make(TernaryExpr{Operand(node, "cond"), Operand(node, "then"),
+                                            Operand(node, "else")});
+        }
+        return Operator(node);
+    }
+
+private:
+    static ExpressionPtr Operand(const nlohmann::json &node, const std::string &key)
+    {
+        return Deserializer<ExpressionPtr>{}(detail::Field(node, key));
+    }
+
+    static ExpressionPtr Keyword(const nlohmann::json &node)
+    {
+        const auto location = detail::Location(node);
+        switch (detail::Enum<KeywordSets>(node, "keyword"))
+        {
+        case KeywordSets::SYSTEM:
+            return detail::Make(KeywordExpr<KeywordSets::SYSTEM>{location});
+        case KeywordSets::CONTAINER:
+            return detail::Make(KeywordExpr<KeywordSets::CONTAINER>{location});
+        case KeywordSets::COMPONENT:
+            return detail::Make(KeywordExpr<KeywordSets::COMPONENT>{location});
+        case KeywordSets::CODE:
+            return detail::Make(KeywordExpr<KeywordSets::CODE>{location});
+        case KeywordSets::DEPLOY:
+            return detail::Make(KeywordExpr<KeywordSets::DEPLOY>{location});
+        case KeywordSets::INFRASTRUCTURE:
+            return detail::Make(KeywordExpr<KeywordSets::INFRASTRUCTURE>{location});
+        case KeywordSets::NONE:
+            return detail::Make(KeywordExpr<KeywordSets::NONE>{location});
+        }
+        detail::Invalid(node, "unknown keyword");
+    }
+
+    static ExpressionPtr Literal(const nlohmann::json &node)
+    {
+        const auto &value = detail::Field(node, "literal");
+        if (value.is_boolean())
+        {
+            return detail::Make(LiteralExpr<bool>{value.get<bool>()});
+        }
+        if (value.is_number_integer())
+        {
+            return detail::Make(LiteralExpr<int64_t>{value.get<int64_t>()});
+        }
+        if (value.is_string())
+        {
+            return detail::Make(LiteralExpr<std::string>{value.get<std::string>()});
+        }
+        detail::Invalid(node, "unsupported literal");
+    }
+
+    template <template <ExprType> class T, ExprType U>
+    static ExpressionPtr Binary(const nlohmann::json &node)
+    {
+        return detail::Make(T<U>{Operand(node, "left"), Operand(node, "right")});
+    }
+
+    static ExpressionPtr Operator(const nlohmann::json &node)
+    {
+        switch (detail::Enum<ExprType>(node, "type"))
+        {
+        case ExprType::ACCESS:
+            return detail::Make(AccessExpr<ExprType::ACCESS>{Operand(node, "operand"),
+                                                             detail::Text(node, "property")});
+        case ExprType::SAFE_ACCESS:
+            return detail::Make(AccessExpr<ExprType::SAFE_ACCESS>{
+                Operand(node, "operand"), detail::Text(node, "property")});
+        case ExprType::NEG:
+            return detail::Make(UnaryExpr<ExprType::NEG>{Operand(node, "operand")});
+        case ExprType::MULT:
+            return Binary<MultExpr, ExprType::MULT>(node);
+        case ExprType::DIV:
+            return Binary<MultExpr, ExprType::DIV>(node);
+        case ExprType::PLUS:
+            return Binary<AddExpr, ExprType::PLUS>(node);
+        case ExprType::MINUS:
+            return Binary<AddExpr, ExprType::MINUS>(node);
+        case ExprType::EQ:
+            return Binary<BooleanExpr, ExprType::EQ>(node);
+        case ExprType::NOT_EQ:
+            return Binary<BooleanExpr, ExprType::NOT_EQ>(node);
+        case ExprType::LESS:
+            return Binary<BooleanExpr, ExprType::LESS>(node);
+        case ExprType::GREATER:
+            return Binary<BooleanExpr, ExprType::GREATER>(node);
+        case ExprType::LESS_EQ:
+            return Binary<BooleanExpr, ExprType::LESS_EQ>(node);
+        case ExprType::GREATER_EQ:
+            return Binary<BooleanExpr, ExprType::GREATER_EQ>(node);
+        case ExprType::AND:
+            return Binary<LogicalExpr, ExprType::AND>(node);
+        case ExprType::OR:
+            return Binary<LogicalExpr, ExprType::OR>(node);
+        case ExprType::XOR:
+            return Binary<LogicalExpr, ExprType::XOR>(node);
+        case ExprType::IN:
+            return Binary<LogicalExpr, ExprType::IN>(node);
+        case ExprType::NOT_IN:
+            return Binary<LogicalExpr, ExprType::NOT_IN>(node);
+        }
+        detail::Invalid(node, "unknown expression type");
+    }
+};
+
+template <> class Deserializer<QuantifierPtr>
+{
+public:
+    QuantifierPtr operator()(const nlohmann::json &node) const
+    {
+        switch (detail::Enum<QuantifierType>(node, "type"))
+        {
+        case QuantifierType::ALL:
+            return Make<QuantifierType::ALL>(node);
+        case QuantifierType::ANY:
+            return Make<QuantifierType::ANY>(node);
+        }
+        detail::Invalid(node, "unknown quantifier");
+    }
+
+    static bool Is(const nlohmann::json &node)
+    {
+        return magic_enum::enum_cast<QuantifierType>(detail::Text(node, "type")).has_value();
+    }
+
+private:
+    // Defined below, once predicates can be loaded.
+    template <QuantifierType Q> static QuantifierPtr Make(const nlohmann::json &node);
+};
+
+template <> class Deserializer<StatementExpressionPtr>
+{
+public:
+    StatementExpressionPtr operator()(const nlohmann::json &node) const
+    {
+        if (detail::Text(node, "type") != "statement-expression")
+        {
+            detail::Invalid(node, "expected a statement-expression");
+        }
+        return std::make_unique<StatementExpression>(
+            Deserializer<ExpressionPtr>{}(detail::Field(node, "expression")));
+    }
+};
+
+template <> class Deserializer<PredicatePtr>
+{
+public:
+    PredicatePtr operator()(const nlohmann::json &node) const
+    {
+        const auto type = detail::Text(node, "type");
+        if (type == "statement-expression")
+        {
+            return std::make_unique<Predicate>(Deserializer<StatementExpressionPtr>{}(node));
+        }
+        if (type == "filter-statement")
+        {
+            return std::make_unique<Predicate>(std::make_unique<FilteredStatement>(
+                Deserializer<StatementExpressionPtr>{}(detail::Field(node, "expression")),
+                Deserializer<QuantifierPtr>{}(detail::Field(node, "quantifier"))));
+        }
+        if (type == "if-then")
+        {
+            return Base(std::make_unique<Сondition>(std::make_unique<IfThen>(
+                Deserializer<ExpressionPtr>{}(detail::Field(node, "cond")),
+                Deserializer<PredicatePtr>{}(detail::Field(node, "then")))));
+        }
+        if (type == "if-then-else")
+        {
+            return Base(std::make_unique<Сondition>(std::make_unique<IfThenElse>(
+                Deserializer<ExpressionPtr>{}(detail::Field(node, "cond")),
+                Deserializer<PredicatePtr>{}(detail::Field(node, "then")),
+                Deserializer<PredicatePtr>{}(detail::Field(node, "else")))));
+        }
+        if (Deserializer<QuantifierPtr>::Is(node))
+        {
+            return Base(Deserializer<QuantifierPtr>{}(node));
+        }
+        detail::Invalid(node, "unknown predicate");
+    }
+
+private:
+    template <typename T> static PredicatePtr Base(T &&statement)
+    {
+        return std::make_unique<Predicate>(
+            std::make_unique<BaseStatement>(std::forward<T>(statement)));
+    }
+};
+
+template <QuantifierType Q>
+QuantifierPtr Deserializer<QuantifierPtr>::Make(const nlohmann::json &node)
+{
+    return std::make_unique<QuantifierStatement<Q>>(
+        Deserializer<std::vector<std::string>>{}(detail::Array(node, "args")),
+        Deserializer<ExpressionPtr>{}(detail::Field(node, "source")),
+        Deserializer<PredicatePtr>{}(detail::Field(node, "predicate")));
+}
+
+template <> class Deserializer<BodyStatementPtr>
+{
+public:
+    BodyStatementPtr operator()(const nlohmann::json &node) const
+    {
+        const auto type = detail::Text(node, "type");
+        if (type == "assignment")
+        {
+            return std::make_unique<BodyStatement>(std::make_unique<AssignmentStatement>(
+                detail::Text(node, "name"),
+                Deserializer<ExpressionPtr>{}(detail::Field(node, "expression"))));
+        }
+        if (type == "except-statement")
+        {
+            return std::make_unique<BodyStatement>(std::make_unique<ExceptStatement>(
+                Deserializer<QuantifierPtr>{}(detail::Field(node, "statement"))));
+        }
+        if (Deserializer<QuantifierPtr>::Is(node))
+        {
+            return std::make_unique<BodyStatement>(Deserializer<QuantifierPtr>{}(node));
+        }
+        detail::Invalid(node, "unknown body statement");
+    }
+};
+
+template <> class Deserializer<Rule>
+{
+public:
+    Rule operator()(const nlohmann::json &node) const
+    {
+        if (detail::Text(node, "type") != "rule")
+        {
+            detail::Invalid(node, "expected a rule");
+        }
+        const auto &block = detail::Field(node, "blocks");
+        if (detail::Text(block, "type") != "block")
+        {
+            detail::Invalid(block, "expected a block");
+        }
+        auto calls = std::make_unique<Block>();
+        calls->statements =
+            Deserializer<BodyStatementList>{}(detail::Array(block, "statements"));
+        return Rule{detail::Text(node, "name"), detail::Text(node, "description"),
+                    detail::Enum<Priority>(node, "priority"), std::move(calls)};
+    }
+};
+
+template <> class Deserializer<Instance>
+{
+public:
+    Instance operator()(const nlohmann::json &node) const
+    {
+        return Instance{
+            detail::Text(node, "name"), detail::Text(node, "template"),
+            Deserializer<std::vector<ExpressionPtr>>{}(detail::Array(node, "arguments"))};
+    }
+};
+
+template <> class Deserializer<RuleTemplate>
+{
+public:
+    RuleTemplate operator()(const nlohmann::json &node) const
+    {
+        if (detail::Text(node, "type") != "rule-template")
+        {
+            detail::Invalid(node, "expected a rule template");
+        }
+        return RuleTemplate{
+            Deserializer<Rule>{}(detail::Field(node, "rule")),
+            Deserializer<std::vector<std::string>>{}(detail::Array(node, "parameters")),
+            Deserializer<std::vector<Instance>>{}(detail::Array(node, "instances"))};
+    }
+};
+
+template <typename T> T Deserialize(std::string_view text)
+{
+    return Deserializer<T>{}(nlohmann::json::parse(text));
+}
+
+} // namespace lang::ast::json
@@ -331,6 +331,33 @@ public:
     }
 };
 
+template <> class Serializer<RuleTemplate>
+{
+public:
+    nlohmann::json operator()(const RuleTemplate &stmt) const
+    {
+        static constexpr auto type = "rule-template";
+        nlohmann::json jOut;
+        jOut["type"] = type;
+        jOut["rule"] = Serializer<Rule>{}(stmt.rule);
+        jOut["parameters"] = stmt.parameters;
+        jOut["instances"] = nlohmann::json::array();
+        for (const auto &instance : stmt.instances)
+        {
+            nlohmann::json jInstance;
+            jInstance["name"] = instance.name;
+            jInstance["template"] = instance.templateName;
+            jInstance["arguments"] = nlohmann::json::array();
+            for (const auto &argument : instance.arguments)
+            {
+                jInstance["arguments"].push_back(Serializer<ExpressionPtr>{}(argument));
+            }
+            jOut["instances"].push_back(jInstance);
+        }
+        return jOut;
+    }
+};
+
 template <typename U> std::string Serialize(U &&value)
 {
     using CleanType = std::decay_t<U>;
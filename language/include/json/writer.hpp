@@ -0,0 +1,666 @@
+#pragma once
+#include "ast/expression.hpp"
+#include "ast/statement.hpp"
+#include <ast/ast.hpp>
+#include <magic_enum/magic_enum.hpp>
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace lang::ast::json
+{
+
+// SAX-style counterpart of Serializer: walks the AST once and writes the JSON text straight
+// into a buffer or a file descriptor, without building an nlohmann::json tree. The output is
+// byte-identical to Serialize(), which dumps objects with their keys in sorted order, so every
+// Writer below emits its keys sorted.
+
+struct WriteOptions
+{
+    // Emit the `node` source locations of keywords, variables and calls.
+    bool locations = true;
+};
+
+class JsonWriter
+{
+public:
+    explicit JsonWriter(WriteOptions options = {}) : options_(options)
+    {
+    }
+
+    // Writes to `fd` in chunks of `chunk` bytes instead of collecting the whole text.
+    JsonWriter(int fd, WriteOptions options, std::size_t chunk = defaultChunk)
+        : options_(options), fd_(fd), chunk_(chunk)
+    {
+        buffer_.reserve(chunk);
+    }
+
+    JsonWriter(const JsonWriter &) = delete;
+    JsonWriter &operator=(const JsonWriter &) = delete;
+
+    // Text not yet written by Flush() is dropped: a Writer that threw left it incomplete.
+    ~JsonWriter() noexcept = default;
+
+    [[nodiscard]] const WriteOptions &Options() const
+    {
+        return options_;
+    }
+
+    void BeginObject()
+    {
+        Separate();
+        Put('{');
+        first_ = true;
+    }
+
+    void EndObject()
+    {
+        Put('}');
+        first_ = false;
+    }
+
+    void BeginArray()
+    {
+        Separate();
+        Put('[');
+        first_ = true;
+    }
+
+    void EndArray()
+    {
+        Put(']');
+        first_ = false;
+    }
+
+    void Key(std::string_view key)
+    {
+        Separate();
+        Quoted(key);
+        Put(':');
+        first_ = true;
+    }
+
+    void String(std::string_view value)
+    {
+        Separate();
+        Quoted(value);
+    }
+
+    void Bool(bool value)
+    {
+        Separate();
+        Put(value ? "true" : "false");
+    }
+
+    template <typename T>
+        requires std::is_integral_v<T>
+    void Number(T value)
+    {
+        Separate();
+        Put(std::to_string(value));
+    }
+
+    // The collected text; empty when writing to a file descriptor.
+    [[nodiscard]] std::string Take()
+    {
+        return std::move(buffer_);
+    }
+
+    void Flush()
+    {
+        if (fd_ >= 0)
+        {
+            Drain();
+        }
+    }
+
+private:
+    static constexpr std::size_t defaultChunk = std::size_t{1} << 16;
+
+    WriteOptions options_;
+    std::string buffer_;
+    int fd_ = -1;
+    std::size_t chunk_ = 0;
+    bool first_ = true;
+
+    void Separate()
+    {
+        if (!first_)
+        {
+            Put(',');
+        }
+        first_ = false;
+    }
+
+    void Put(char symbol)
+    {
+        buffer_ += symbol;
+        Spill();
+    }
+
+    void Put(std::string_view text)
+    {
+        buffer_ += text;
+        Spill();
+    }
+
+    // Escapes like nlohmann::json::dump(): short escapes where JSON has them, \u00XX for the
+    // remaining control characters, everything else (including UTF-8) verbatim.
+    void Quoted(std::string_view text)
+    {
+        static constexpr std::string_view hex = "0123456789abcdef";
+        buffer_ += '"';
+        for (const char symbol : text)
+        {
+            switch (symbol)
+            {
+            case '"':
+                buffer_ += "\\\"";
+                break;
+            case '\\':
+                buffer_ += "\\\\";
+                break;
+            case '\b':
+                buffer_ += "\\b";
+                break;
+            case '\f':
+                buffer_ += "\\f";
+                break;
+            case '\n':
+                buffer_ += "\\n";
+                break;
+            case '\r':
+                buffer_ += "\\r";
+                break;
+            case '\t':
+                buffer_ += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(symbol) < 0x20)
+                {
+                    buffer_ += "\\u00";
+                    buffer_ += hex[static_cast<unsigned char>(symbol) >> 4U];
+                    buffer_ += hex[static_cast<unsigned char>(symbol) & 0xFU];
+                }
+                else
+                {
+                    buffer_ += symbol;
+                }
+            }
+        }
+        buffer_ += '"';
+        Spill();
+    }
+
+    void Spill()
+    {
+        if (fd_ >= 0 && buffer_.size() >= chunk_)
+        {
+            Drain();
+        }
+    }
+
+    void Drain()
+    {
+        std::string_view pending = buffer_;
+        while (!pending.empty())
+        {
+            const auto written = ::write(fd_, pending.data(), pending.size());
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw std::runtime_error{"failed writing JSON output"};
+            }
+            pending.remove_prefix(static_cast<std::size_t>(written));
+        }
+        buffer_.clear();
+    }
+};
+
+inline void WriteNode(JsonWriter &out, const NodeLocation &node)
+{
+    out.BeginObject();
+    out.Key("column");
+    out.Number(node.column);
+    out.Key("length");
+    out.Number(node.length);
+    out.Key("line");
+    out.Number(node.line);
+    out.EndObject();
+}
+
+template <typename T> class Writer
+{
+public:
+    void operator()(JsonWriter &out, const T & /*value*/) const
+    {
+        out.BeginObject();
+        out.Key("unimplemented");
+        out.String("No serialization for this type");
+        out.EndObject();
+    }
+};
+
+template <typename... Ts> class Writer<std::variant<Ts...>>
+{
+public:
+    void operator()(JsonWriter &out, const std::variant<Ts...> &var) const
+    {
+        std::visit([&](auto &subValue)
+                   { Writer<std::decay_t<decltype(subValue)>>{}(out, subValue); },
+                   var);
+    }
+};
+
+template <typename T> class Writer<std::unique_ptr<T>>
+{
+public:
+    void operator()(JsonWriter &out, const std::unique_ptr<T> &ptr) const
+    {
+        if (!ptr)
+        {
+            throw std::runtime_error{"broken AST: ptr is null"};
+        }
+
+        Writer<T>{}(out, *ptr);
+    }
+};
+
+template <typename T> class Writer<std::vector<T>>
+{
+public:
+    void operator()(JsonWriter &out, const std::vector<T> &items) const
+    {
+        out.BeginArray();
+        for (const auto &item : items)
+        {
+            Writer<T>{}(out, item);
+        }
+        out.EndArray();
+    }
+};
+
+template <> class Writer<std::string>
+{
+public:
+    void operator()(JsonWriter &out, const std::string &value) const
+    {
+        out.String(value);
+    }
+};
+
+template <KeywordSets K> class Writer<KeywordExpr<K>>
+{
+public:
+    void operator()(JsonWriter &out, const KeywordExpr<K> &keyword) const
+    {
+        out.BeginObject();
+        out.Key("keyword");
+        out.String(magic_enum::enum_name(K));
+        if (out.Options().locations)
+        {
+            out.Key("node");
+            WriteNode(out, keyword.location);
+        }
+        out.Key("type");
+        out.String("keyword");
+        out.EndObject();
+    }
+};
+
+template <typename T> class Writer<LiteralExpr<T>>
+{
+public:
+    void operator()(JsonWriter &out, const LiteralExpr<T> &lit) const
+    {
+        out.BeginObject();
+        out.Key("literal");
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            out.Bool(lit.value);
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            out.Number(lit.value);
+        }
+        else
+        {
+            out.String(lit.value);
+        }
+        out.Key("type");
+        out.String("literal");
+        out.EndObject();
+    }
+};
+
+template <> class Writer<SetExpr>
+{
+public:
+    void operator()(JsonWriter &out, const SetExpr &expr) const
+    {
+        out.BeginObject();
+        out.Key("expression");
+        out.String("set");
+        out.Key("set");
+        Writer<std::vector<ExpressionPtr>>{}(out, expr.items);
+        out.EndObject();
+    }
+};
+
+template <> class Writer<VariableExpr>
+{
+public:
+    void operator()(JsonWriter &out, const VariableExpr &var) const
+    {
+        out.BeginObject();
+        if (out.Options().locations)
+        {
+            out.Key("node");
+            WriteNode(out, var.location);
+        }
+        out.Key("type");
+        out.String("variable");
+        out.Key("variable");
+        out.String(var.name);
+        out.EndObject();
+    }
+};
+
+template <ExprType K> class Writer<AccessExpr<K>>
+{
+public:
+    void operator()(JsonWriter &out, const AccessExpr<K> &expr) const
+    {
+        out.BeginObject();
+        out.Key("operand");
+        Writer<ExpressionPtr>{}(out, expr.operand);
+        out.Key("property");
+        out.String(expr.prop);
+        out.Key("type");
+        out.String(magic_enum::enum_name(K));
+        out.EndObject();
+    }
+};
+
+template <ExprType K> class Writer<UnaryExpr<K>>
+{
+public:
+    void operator()(JsonWriter &out, const UnaryExpr<K> &expr) const
+    {
+        out.BeginObject();
+        out.Key("operand");
+        Writer<ExpressionPtr>{}(out, expr.operand);
+        out.Key("type");
+        out.String(magic_enum::enum_name(K));
+        out.EndObject();
+    }
+};
+
+template <> class Writer<CallExpr>
+{
+public:
+    void operator()(JsonWriter &out, const CallExpr &expr) const
+    {
+        out.BeginObject();
+        out.Key("args");
+        Writer<std::vector<ExpressionPtr>>{}(out, expr.args);
+        out.Key("name");
+        out.String(expr.functionName);
+        if (out.Options().locations)
+        {
+            out.Key("node");
+            WriteNode(out, expr.location);
+        }
+        out.Key("type");
+        out.String("call");
+        out.EndObject();
+    }
+};
+
+template <template <ExprType> class T, ExprType U>
+concept BinaryOperands = requires(T<U> expr) {
+    requires std::same_as<decltype(expr.left), ExpressionPtr>;
+    requires std::same_as<decltype(expr.right), ExpressionPtr>;
+};
+
+template <template <ExprType> class T, ExprType U>
+    requires BinaryOperands<T, U>
+class Writer<T<U>>
+{
+public:
+    void operator()(JsonWriter &out, const T<U> &expr) const
+    {
+        out.BeginObject();
+        out.Key("left");
+        Writer<ExpressionPtr>{}(out, expr.left);
+        out.Key("right");
+        Writer<ExpressionPtr>{}(out, expr.right);
+        out.Key("type");
+        out.String(magic_enum::enum_name(U));
+        out.EndObject();
+    }
+};
+
+template <> class Writer<TernaryExpr>
+{
+public:
+    void operator()(JsonWriter &out, const TernaryExpr &expr) const
+    {
+        out.BeginObject();
+        out.Key("cond");
+        Writer<ExpressionPtr>{}(out, expr.condition);
+        out.Key("else");
+        Writer<ExpressionPtr>{}(out, expr.elseExpr);
+        out.Key("then");
+        Writer<ExpressionPtr>{}(out, expr.thenExpr);
+        out.Key("type");
+        out.String("ternary");
+        out.EndObject();
+    }
+};
+
+template <> class Writer<AssignmentStatement>
+{
+public:
+    void operator()(JsonWriter &out, const AssignmentStatement &stmt) const
+    {
+        out.BeginObject();
+        out.Key("expression");
+        Writer<ExpressionPtr>{}(out, stmt.valueExpr);
+        out.Key("name");
+        out.String(stmt.name);
+        out.Key("type");
+        out.String("assignment");
+        out.EndObject();
+    }
+};
+
+template <QuantifierType T> class Writer<QuantifierStatement<T>>
+{
+public:
+    void operator()(JsonWriter &out, const QuantifierStatement<T> &stmt) const
+    {
+        out.BeginObject();
+        out.Key("args");
+        Writer<std::vector<std::string>>{}(out, stmt.identifiersList);
+        out.Key("predicate");
+        Writer<PredicatePtr>{}(out, stmt.predicate);
+        out.Key("source");
+        Writer<ExpressionPtr>{}(out, stmt.source);
+        out.Key("type");
+        out.String(magic_enum::enum_name(T));
+        out.EndObject();
+    }
+};
+
+template <> class Writer<IfThen>
+{
+public:
+    void operator()(JsonWriter &out, const IfThen &stmt) const
+    {
+        out.BeginObject();
+        out.Key("cond");
+        Writer<ExpressionPtr>{}(out, stmt.expr);
+        out.Key("then");
+        Writer<PredicatePtr>{}(out, stmt.then);
+        out.Key("type");
+        out.String("if-then");
+        out.EndObject();
+    }
+};
+
+template <> class Writer<IfThenElse>
+{
+public:
+    void operator()(JsonWriter &out, const IfThenElse &stmt) const
+    {
+        out.BeginObject();
+        out.Key("cond");
+        Writer<ExpressionPtr>{}(out, stmt.expr);
+        out.Key("else");
+        Writer<PredicatePtr>{}(out, stmt.els);
+        out.Key("then");
+        Writer<PredicatePtr>{}(out, stmt.then);
+        out.Key("type");
+        out.String("if-then-else");
+        out.EndObject();
+    }
+};
+
+template <> class Writer<StatementExpression>
+{
+public:
+    void operator()(JsonWriter &out, const StatementExpression &stmt) const
+    {
+        out.BeginObject();
+        out.Key("expression");
+        Writer<ExpressionPtr>{}(out, stmt.expr);
+        out.Key("type");
+        out.String("statement-expression");
+        out.EndObject();
+    }
+};
+
+template <> class Writer<FilteredStatement>
+{
+public:
+    void operator()(JsonWriter &out, const FilteredStatement &stmt) const
+    {
+        out.BeginObject();
+        out.Key("expression");
+        Writer<StatementExpressionPtr>{}(out, stmt.expr);
+        out.Key("quantifier");
+        Writer<QuantifierPtr>{}(out, stmt.quant);
+        out.Key("type");
+        out.String("filter-statement");
+        out.EndObject();
+    }
+};
+
+template <> class Writer<ExceptStatement>
+{
+public:
+    void operator()(JsonWriter &out, const ExceptStatement &stmt) const
+    {
+        out.BeginObject();
+        out.Key("statement");
+        Writer<QuantifierPtr>{}(out, stmt.inner);
+        out.Key("type");
+        out.String("except-statement");
+        out.EndObject();
+    }
+};
+
+template <> class Writer<Block>
+{
+public:
+    void operator()(JsonWriter &out, const Block &stmt) const
+    {
+        out.BeginObject();
+        out.Key("statements");
+        Writer<BodyStatementList>{}(out, stmt.statements);
+        out.Key("type");
+        out.String("block");
+        out.EndObject();
+    }
+};
+
+template <> class Writer<Rule>
+{
+public:
+    void operator()(JsonWriter &out, const Rule &stmt) const
+    {
+        out.BeginObject();
+        out.Key("blocks");
+        Writer<BlockPtr>{}(out, stmt.calls);
+        out.Key("description");
+        out.String(stmt.description);
+        out.Key("name");
+        out.String(stmt.name);
+        out.Key("priority");
+        out.String(magic_enum::enum_name(stmt.priority));
+        out.Key("type");
+        out.String("rule");
+        out.EndObject();
+    }
+};
+
+template <> class Writer<RuleTemplate>
+{
+public:
+    void operator()(JsonWriter &out, const RuleTemplate &stmt) const
+    {
+        out.BeginObject();
+        out.Key("instances");
+        out.BeginArray();
+        for (const auto &instance : stmt.instances)
+        {
+            out.BeginObject();
+            out.Key("arguments");
+            Writer<std::vector<ExpressionPtr>>{}(out, instance.arguments);
+            out.Key("name");
+            out.String(instance.name);
+            out.Key("template");
+            out.String(instance.templateName);
+            out.EndObject();
+        }
+        out.EndArray();
+        out.Key("parameters");
+        Writer<std::vector<std::string>>{}(out, stmt.parameters);
+        out.Key("rule");
+        Writer<Rule>{}(out, stmt.rule);
+        out.Key("type");
+        out.String("rule-template");
+        out.EndObject();
+    }
+};
+
+template <typename U> std::string Write(const U &value, WriteOptions options = {})
+{
+    JsonWriter out{options};
+    Writer<U>{}(out, value);
+    return out.Take();
+}
+
+template <typename U> void Write(const U &value, int fd, WriteOptions options = {})
+{
+    JsonWriter out{fd, options};
+    Writer<U>{}(out, value);
+    out.Flush();
+}
+
+} // namespace lang::ast::json
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A fixed set of threads that run one task at a time on every thread at once, the calling
+// thread included. How the work is shared out is up to the task; see quantifier.hpp.
+namespace lang::parallel
+{
+
+inline std::size_t DefaultThreads()
+{
+    const auto threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+}
+
+class Pool
+{
+public:
+    explicit Pool(std::size_t threads = DefaultThreads())
+    {
+        if (threads == 0)
+        {
+            throw std::runtime_error{"A pool needs at least one thread"};
+        }
+        for (std::size_t worker = 1; worker < threads; ++worker)
+        {
+            threads_.emplace_back([this, worker] { Work(worker); });
+        }
+    }
+
+    ~Pool()
+    {
+        {
+            const std::lock_guard lock{mutex_};
+            stop_ = true;
+        }
+        wake_.notify_all();
+    }
+
+    Pool(const Pool &) = delete;
+    Pool &operator=(const Pool &) = delete;
+
+    [[nodiscard]] std::size_t Size() const
+    {
+        return threads_.size() + 1;
+    }
+
+    // Calls `task(worker)` for every worker from 0 to Size() - 1, worker 0 on the calling
+    // thread, and returns once all have returned. The first exception a task throws is
+    // rethrown here. A task must not Run the pool again.
+    void Run(const std::function<void(std::size_t)> &task)
+    {
+        {
+            const std::lock_guard lock{mutex_};
+            if (task_ != nullptr)
+            {
+                throw std::runtime_error{"The pool is already running a task"};
+            }
+            task_ = &task;
+            pending_ = threads_.size();
+            ++generation_;
+        }
+        wake_.notify_all();
+        std::exception_ptr error;
+        try
+        {
+            task(0);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        std::unique_lock lock{mutex_};
+        done_.wait(lock, [this] { return pending_ == 0; });
+        task_ = nullptr;
+        if (!error)
+        {
+            error = std::exchange(error_, nullptr);
+        }
+        error_ = nullptr;
+        lock.unlock();
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(std::size_t)> *task_ = nullptr;
+    std::size_t pending_ = 0;
+    std::uint64_t generation_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+    // Last, so that the threads are joined before anything they use is destroyed.
+    std::vector<std::jthread> threads_;
+
+    void Work(std::size_t worker)
+    {
+        std::uint64_t seen = 0;
+        while (true)
+        {
+            const std::function<void(std::size_t)> *task = nullptr;
+            {
+                std::unique_lock lock{mutex_};
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_)
+                {
+                    return;
+                }
+                seen = generation_;
+                task = task_;
+            }
+            std::exception_ptr error;
+            try
+            {
+                (*task)(worker);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            const std::lock_guard lock{mutex_};
+            if (error && !error_)
+            {
+                error_ = error;
+            }
+            if (--pending_ == 0)
+            {
+                done_.notify_one();
+            }
+        }
+    }
+};
+
+} // namespace lang::parallel
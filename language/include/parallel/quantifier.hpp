@@ -0,0 +1,194 @@
+#pragma once
+
+#include "parallel/pool.hpp"
+
+#include <ast/statement.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// `all` and `exist` over a range of element ids, on every thread of a pool. The range starts
+// out split evenly between the workers; each takes `grain` ids at a time off the front of its
+// own part, and once that is empty steals the back half of another worker's. A shared flag
+// stops every worker as soon as one finds the element that decides the quantifier: a
+// counterexample of `all`, a witness of `exist`.
+namespace lang::parallel
+{
+
+// Element ids [begin, end), as graph::Graph::Nodes gives them for a label.
+struct Range
+{
+    std::uint32_t begin = 0;
+    std::uint32_t end = 0;
+};
+
+enum class Collect
+{
+    // Stop at the first element that decides the quantifier.
+    FIRST,
+    // Evaluate every element, for a report of all violations.
+    ALL
+};
+
+struct QuantifierOptions
+{
+    Collect collect = Collect::FIRST;
+    // Ids taken at a time; 0 chooses from the size of the range and of the pool.
+    std::uint32_t grain = 0;
+};
+
+struct QuantifierResult
+{
+    bool holds = false;
+    // Counterexamples of `all`, witnesses of `exist`, in ascending order: every one with
+    // Collect::ALL, otherwise those found before the workers stopped.
+    std::vector<std::uint32_t> found;
+    // Calls of the predicate.
+    std::size_t evaluated = 0;
+};
+
+namespace detail
+{
+
+// A worker's part of the range, on a cache line of its own.
+struct alignas(64) Slot
+{
+    std::mutex mutex;
+    std::uint32_t begin = 0;
+    std::uint32_t end = 0;
+};
+
+struct alignas(64) Tally
+{
+    std::vector<std::uint32_t> found;
+    std::size_t evaluated = 0;
+};
+
+// Up to `grain` ids off the front of the worker's own part.
+inline std::optional<Range> Take(Slot &slot, std::uint32_t grain)
+{
+    const std::lock_guard lock{slot.mutex};
+    if (slot.begin == slot.end)
+    {
+        return std::nullopt;
+    }
+    const auto begin = slot.begin;
+    slot.begin += std::min(grain, slot.end - slot.begin);
+    return Range{begin, slot.begin};
+}
+
+// Moves the back half of the first other part with ids left into the worker's own, empty one;
+// false once every part is empty, so that no work is left to find.
+inline bool Steal(std::vector<Slot> &slots, std::size_t worker)
+{
+    for (std::size_t i = 1; i < slots.size(); ++i)
+    {
+        auto &victim = slots[(worker + i) % slots.size()];
+        std::uint32_t begin = 0;
+        std::uint32_t end = 0;
+        {
+            const std::lock_guard lock{victim.mutex};
+            if (victim.begin == victim.end)
+            {
+                continue;
+            }
+            begin = victim.begin + (victim.end - victim.begin) / 2;
+            end = victim.end;
+            victim.end = begin;
+        }
+        auto &own = slots[worker];
+        const std::lock_guard lock{own.mutex};
+        own.begin = begin;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
+
+} // namespace detail
+
+// `predicate(id)` for the ids of `range`, called from every thread of `pool` at once.
+template <typename F>
+QuantifierResult Quantify(Pool &pool, Range range, ast::QuantifierType kind, F &&predicate,
+                          QuantifierOptions options = {})
+{
+    const auto workers = pool.Size();
+    const auto size = range.end > range.begin ? range.end - range.begin : 0U;
+    const auto grain = options.grain != 0
+                           ? options.grain
+                           : std::clamp<std::uint32_t>(
+                                 static_cast<std::uint32_t>(size / (workers * 16)), 1, 1024);
+    const auto share = [&](std::size_t part)
+    { return range.begin + static_cast<std::uint32_t>(std::uint64_t{size} * part / workers); };
+    std::vector<detail::Slot> slots(workers);
+    for (std::size_t worker = 0; worker < workers; ++worker)
+    {
+        slots[worker].begin = share(worker);
+        slots[worker].end = share(worker + 1);
+    }
+    std::vector<detail::Tally> tallies(workers);
+    // Whether an element decides the quantifier: true of `exist`, false of `all`.
+    const bool decisive = kind == ast::QuantifierType::ANY;
+    const bool first = options.collect == Collect::FIRST;
+    std::atomic<bool> stop{false};
+
+    pool.Run(
+        [&](std::size_t worker)
+        {
+            auto &tally = tallies[worker];
+            try
+            {
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    const auto chunk = detail::Take(slots[worker], grain);
+                    if (!chunk)
+                    {
+                        if (!detail::Steal(slots, worker))
+                        {
+                            return;
+                        }
+                        continue;
+                    }
+                    for (auto id = chunk->begin; id < chunk->end; ++id)
+                    {
+                        if (first && stop.load(std::memory_order_relaxed))
+                        {
+                            return;
+                        }
+                        ++tally.evaluated;
+                        if (static_cast<bool>(predicate(id)) == decisive)
+                        {
+                            tally.found.push_back(id);
+                            if (first)
+                            {
+                                stop.store(true, std::memory_order_relaxed);
+                                return;
+                            }
+                        }
+                    }
+                }
+            }
+            catch (...)
+            {
+                stop.store(true, std::memory_order_relaxed);
+                throw;
+            }
+        });
+
+    QuantifierResult result;
+    for (auto &tally : tallies)
+    {
+        result.found.insert(result.found.end(), tally.found.begin(), tally.found.end());
+        result.evaluated += tally.evaluated;
+    }
+    std::ranges::sort(result.found);
+    result.holds = result.found.empty() != decisive;
+    return result;
+}
+
+} // namespace lang::parallel
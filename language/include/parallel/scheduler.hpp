@@ -0,0 +1,477 @@
+#pragma once
+
+#include "parallel/pool.hpp"
+
+#include <ast/ast.hpp>
+#include <ast/hash.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Runs a pack of rules a few at a time, ERROR rules first and the costliest first within a
+// priority, so that the long ones do not start last and hold up the end of the pack. Each rule
+// runs on a thread of its own under a time and a memory budget. A rule past its deadline is
+// reported as timed out and asked to stop, and its thread is detached. The thread keeps its
+// place among `threads` until the executor returns, and holds on to the pack and the executor
+// itself, so Schedule does not wait for it.
+namespace lang::parallel
+{
+
+enum class RuleStatus
+{
+    PASSED,
+    FAILED,
+    TIMEOUT,
+    OUT_OF_MEMORY,
+    ERROR
+};
+
+inline std::string_view StatusName(RuleStatus status)
+{
+    switch (status)
+    {
+    case RuleStatus::PASSED:
+        return "passed";
+    case RuleStatus::FAILED:
+        return "failed";
+    case RuleStatus::TIMEOUT:
+        return "timeout";
+    case RuleStatus::OUT_OF_MEMORY:
+        return "out of memory";
+    case RuleStatus::ERROR:
+        return "error";
+    }
+    return "unknown";
+}
+
+struct Budget
+{
+    std::chrono::milliseconds time{std::chrono::minutes{5}};
+    // Bytes the rule may hold at once through its RuleContext; 0 for no limit.
+    std::size_t memory = 0;
+};
+
+// Thrown by RuleContext::Allocate once a rule goes over its memory budget.
+class BudgetExceeded : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// What an executor gets along with its rule: a stop token that is triggered at the deadline,
+// and the account its allocations are charged to. Stopping is cooperative; an executor that
+// never looks at the token is still reported at its deadline, but keeps its thread until it
+// returns, possibly after Schedule has.
+class RuleContext
+{
+public:
+    RuleContext(std::stop_token token, std::size_t memory)
+        : token_{std::move(token)}, memory_{memory}
+    {
+    }
+
+    [[nodiscard]] const std::stop_token &Token() const
+    {
+        return token_;
+    }
+
+    [[nodiscard]] bool Stopped() const
+    {
+        return token_.stop_requested();
+    }
+
+    void Allocate(std::size_t bytes)
+    {
+        const auto held = used_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        if (memory_ != 0 && held > memory_)
+        {
+            used_.fetch_sub(bytes, std::memory_order_relaxed);
+            throw BudgetExceeded{
+                fmt::format("Rule needs {} bytes, over its budget of {}", held, memory_)};
+        }
+        auto peak = peak_.load(std::memory_order_relaxed);
+        while (held > peak && !peak_.compare_exchange_weak(peak, held, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void Release(std::size_t bytes)
+    {
+        used_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    // Most bytes held at once.
+    [[nodiscard]] std::size_t Peak() const
+    {
+        return peak_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::stop_token token_;
+    std::size_t memory_;
+    std::atomic<std::size_t> used_{0};
+    std::atomic<std::size_t> peak_{0};
+};
+
+// Standard allocator that charges a RuleContext, for the containers an executor builds:
+// `std::vector<T, Charged<T>> rows{Charged<T>{context}}`.
+template <typename T> class Charged
+{
+public:
+    using value_type = T;
+
+    explicit Charged(RuleContext &context) : context_{&context}
+    {
+    }
+
+    template <typename U> Charged(const Charged<U> &other) : context_{other.Context()}
+    {
+    }
+
+    T *allocate(std::size_t count)
+    {
+        if (count > std::numeric_limits<std::size_t>::max() / sizeof(T))
+        {
+            throw std::bad_array_new_length{};
+        }
+        context_->Allocate(count * sizeof(T));
+        try
+        {
+            return std::allocator<T>{}.allocate(count);
+        }
+        catch (...)
+        {
+            context_->Release(count * sizeof(T));
+            throw;
+        }
+    }
+
+    void deallocate(T *pointer, std::size_t count)
+    {
+        std::allocator<T>{}.deallocate(pointer, count);
+        context_->Release(count * sizeof(T));
+    }
+
+    [[nodiscard]] RuleContext *Context() const
+    {
+        return context_;
+    }
+
+    template <typename U> bool operator==(const Charged<U> &other) const
+    {
+        return context_ == other.Context();
+    }
+
+private:
+    RuleContext *context_;
+};
+
+// Runs one rule and returns its number of violations.
+using Executor = std::function<std::size_t(const ast::Rule &, RuleContext &)>;
+
+struct SchedulerOptions
+{
+    std::size_t threads = DefaultThreads();
+    Budget budget{};
+    // Budgets of particular rules, by name.
+    std::unordered_map<std::string, Budget> budgets{};
+};
+
+struct RuleReport
+{
+    std::string rule;
+    ast::Priority priority = ast::Priority::ERROR;
+    double cost = 0;
+    RuleStatus status = RuleStatus::PASSED;
+    std::size_t violations = 0;
+    std::chrono::duration<double, std::milli> elapsed{};
+    std::size_t peakMemory = 0;
+    // What went wrong, for TIMEOUT, OUT_OF_MEMORY and ERROR.
+    std::string message;
+};
+
+namespace detail
+{
+
+// A quantifier's body counts as many times as a label is assumed to have elements. Only the
+// order of the estimates matters, so a rough guess does.
+constexpr double quantifierFanout = 16;
+
+template <typename T> struct IsQuantifier : std::false_type
+{
+};
+
+template <ast::QuantifierType Q>
+struct IsQuantifier<ast::QuantifierStatement<Q>> : std::true_type
+{
+};
+
+template <typename T> double Weight(const T &value)
+{
+    if constexpr (IsQuantifier<T>::value)
+    {
+        return 1 + Weight(value.source) + quantifierFanout * Weight(value.predicate);
+    }
+    else if constexpr (ast::detail::Node<T>)
+    {
+        return std::apply([](const auto &...fields) { return 1 + (0.0 + ... + Weight(fields)); },
+                          ast::detail::Fields(value));
+    }
+    else if constexpr (ast::detail::IsPointer<T>::value)
+    {
+        return value ? Weight(*value) : 0.0;
+    }
+    else if constexpr (ast::detail::IsVariant<T>::value)
+    {
+        return std::visit([](const auto &alternative) { return Weight(alternative); }, value);
+    }
+    else if constexpr (ast::detail::IsVector<T>::value)
+    {
+        return std::accumulate(value.begin(), value.end(), 0.0,
+                               [](double sum, const auto &item) { return sum + Weight(item); });
+    }
+    else
+    {
+        return 0.0;
+    }
+}
+
+// The pack and everything its threads touch. A timed-out thread may outlive Schedule, so the
+// threads own this jointly with it instead of referring to Schedule's locals.
+struct Pack
+{
+    std::vector<ast::Rule> rules;
+    Executor executor;
+    std::mutex mutex;
+    std::condition_variable finished;
+    // Detached threads whose executor has not returned yet.
+    std::size_t abandoned = 0;
+};
+
+// One rule's run, shared by its thread and the scheduler, which may give up on it first.
+struct Task
+{
+    std::size_t index = 0;
+    // Place in the schedule, which is also the place of the report.
+    std::size_t position = 0;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point deadline;
+    std::stop_source stop;
+    std::unique_ptr<RuleContext> context;
+    bool done = false;
+    bool abandoned = false;
+    RuleReport report;
+    std::thread thread;
+};
+
+} // namespace detail
+
+// Static cost of a rule: its AST nodes, with nested quantifiers multiplying their bodies.
+inline double Cost(const ast::Rule &rule)
+{
+    return detail::Weight(rule.calls);
+}
+
+// Runs every rule of `rules` through `executor`, at most `options.threads` at a time, and
+// returns their reports in the order they were scheduled. Executor errors are reported rather
+// than thrown. The executor is called on other threads, possibly after Schedule has returned,
+// so whatever it refers to must outlive its timed-out runs.
+inline std::vector<RuleReport> Schedule(std::vector<ast::Rule> rules, Executor executor,
+                                        SchedulerOptions options = {})
+{
+    using Clock = std::chrono::steady_clock;
+    if (options.threads == 0)
+    {
+        throw std::runtime_error{"A scheduler needs at least one thread"};
+    }
+
+    const auto pack = std::make_shared<detail::Pack>();
+    pack->rules = std::move(rules);
+    pack->executor = std::move(executor);
+    const auto &pending = pack->rules;
+
+    std::vector<double> costs(pending.size());
+    std::ranges::transform(pending, costs.begin(), Cost);
+    std::vector<std::size_t> order(pending.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order,
+                             [&](std::size_t lhs, std::size_t rhs)
+                             {
+                                 if (pending[lhs].priority != pending[rhs].priority)
+                                 {
+                                     return pending[lhs].priority > pending[rhs].priority;
+                                 }
+                                 return costs[lhs] > costs[rhs];
+                             });
+
+    std::vector<RuleReport> reports(pending.size());
+    std::vector<std::shared_ptr<detail::Task>> running;
+    std::size_t next = 0;
+
+    const auto launch = [&](std::size_t position)
+    {
+        const auto index = order[position];
+        const auto &rule = pending[index];
+        const auto custom = options.budgets.find(rule.name);
+        const auto &budget = custom != options.budgets.end() ? custom->second : options.budget;
+        auto task = std::make_shared<detail::Task>();
+        task->index = index;
+        task->position = position;
+        task->start = Clock::now();
+        task->deadline = task->start + budget.time;
+        task->context = std::make_unique<RuleContext>(task->stop.get_token(), budget.memory);
+        task->report.rule = rule.name;
+        task->report.priority = rule.priority;
+        task->report.cost = costs[index];
+        task->thread = std::thread{
+            [pack, task]
+            {
+                RuleReport report;
+                try
+                {
+                    report.violations = pack->executor(pack->rules[task->index], *task->context);
+                    report.status = report.violations == 0 ? RuleStatus::PASSED
+                                                           : RuleStatus::FAILED;
+                }
+                catch (const BudgetExceeded &error)
+                {
+                    report.status = RuleStatus::OUT_OF_MEMORY;
+                    report.message = error.what();
+                }
+                catch (const std::exception &error)
+                {
+                    report.status = RuleStatus::ERROR;
+                    report.message = error.what();
+                }
+                catch (...)
+                {
+                    report.status = RuleStatus::ERROR;
+                    report.message = "unknown error";
+                }
+                const auto elapsed = Clock::now() - task->start;
+                {
+                    const std::lock_guard lock{pack->mutex};
+                    task->done = true;
+                    if (task->abandoned)
+                    {
+                        // Reported at its deadline; only its place among the threads is left.
+                        --pack->abandoned;
+                    }
+                    else
+                    {
+                        task->report.status = report.status;
+                        task->report.violations = report.violations;
+                        task->report.message = std::move(report.message);
+                        task->report.elapsed = elapsed;
+                        task->report.peakMemory = task->context->Peak();
+                    }
+                }
+                pack->finished.notify_one();
+            }};
+        running.push_back(std::move(task));
+    };
+
+    std::unique_lock lock{pack->mutex};
+    // Whether a rule is waiting and a thread is free for it.
+    const auto vacancy = [&]
+    { return next < order.size() && running.size() + pack->abandoned < options.threads; };
+    while (next < order.size() || !running.empty())
+    {
+        while (vacancy())
+        {
+            launch(next++);
+        }
+        if (running.empty())
+        {
+            // Every thread is held by a timed-out rule.
+            pack->finished.wait(lock, vacancy);
+            continue;
+        }
+        const auto deadline = (*std::ranges::min_element(running, {}, [](const auto &task)
+                                                         { return task->deadline; }))
+                                  ->deadline;
+        pack->finished.wait_until(lock, deadline,
+                                  [&]
+                                  {
+                                      return vacancy() ||
+                                             std::ranges::any_of(running, [](const auto &task)
+                                                                 { return task->done; });
+                                  });
+        const auto now = Clock::now();
+        for (auto &task : running)
+        {
+            const bool done = task->done;
+            if (!done && now >= task->deadline)
+            {
+                task->stop.request_stop();
+                task->report.status = RuleStatus::TIMEOUT;
+                task->report.elapsed = now - task->start;
+                task->report.peakMemory = task->context->Peak();
+                task->report.message =
+                    fmt::format("No result within {} ms", (task->deadline - task->start) /
+                                                              std::chrono::milliseconds{1});
+            }
+            else if (!done)
+            {
+                continue;
+            }
+            reports[task->position] = task->report;
+            if (done)
+            {
+                // The thread is about to exit, so joining it is quick.
+                lock.unlock();
+                task->thread.join();
+                lock.lock();
+            }
+            else
+            {
+                task->abandoned = true;
+                ++pack->abandoned;
+                task->thread.detach();
+            }
+            task.reset();
+        }
+        std::erase(running, nullptr);
+    }
+    return reports;
+}
+
+// One line per rule: status, violations, time and peak memory.
+inline std::string FormatSchedule(const std::vector<RuleReport> &reports)
+{
+    std::string result = fmt::format("{:<32}{:<8}{:<15}{:>12}{:>12}{:>14}  {}\n", "rule",
+                                     "prio", "status", "violations", "time ms", "peak bytes",
+                                     "message");
+    for (const auto &report : reports)
+    {
+        const std::string_view priority = report.priority == ast::Priority::ERROR  ? "ERROR"
+                                          : report.priority == ast::Priority::WARN ? "WARN"
+                                                                                   : "INFO";
+        result += fmt::format("{:<32}{:<8}{:<15}{:>12}{:>12.1f}{:>14}  {}\n", report.rule,
+                              priority, StatusName(report.status), report.violations,
+                              report.elapsed.count(), report.peakMemory, report.message);
+    }
+    return result;
+}
+
+} // namespace lang::parallel
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "expressions.hpp"
 #include "identifiers.hpp"
 #include "literals.hpp"
 #include "statements.hpp"
@@ -11,6 +12,12 @@
 #include <lexy/input/string_input.hpp>
 #include <lexy_ext/report_error.hpp>
 
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
 namespace lang::grammar
 {
 
@@ -71,6 +78,76 @@ struct RuleDecl
         { return ast::Rule(std::move(name), std::move(desc), prio, std::move(block)); });
 };
 
+struct TemplateParameters
+{
+    static constexpr auto whitespace = dsl::ascii::space;
+    static constexpr auto rule =
+        dsl::parenthesized.list(dsl::p<Identifier>, dsl::sep(dsl::comma));
+    static constexpr auto value = lexy::as_list<std::vector<std::string>>;
+};
+
+struct InstanceDecl
+{
+    static constexpr auto whitespace = dsl::ascii::space | dsl::ascii::newline;
+    static constexpr auto rule = LEXY_LIT("instance") >> dsl::p<Identifier> >> dsl::lit_c<'='> >>
+                                 dsl::p<Identifier> >> dsl::p<FuncArgs> >> dsl::semicolon;
+
+    static constexpr auto value = lexy::callback<ast::Instance>(
+        [](std::string &&name, std::string &&templateName,
+           std::vector<ast::ExpressionPtr> &&args) -> ast::Instance
+        { return ast::Instance{std::move(name), std::move(templateName), std::move(args)}; });
+};
+
+struct Instances
+{
+    static constexpr auto whitespace = dsl::ascii::space | dsl::ascii::newline;
+    static constexpr auto rule = dsl::list(dsl::p<InstanceDecl>);
+    static constexpr auto value = lexy::as_list<std::vector<ast::Instance>>;
+};
+
+struct TemplateDecl
+{
+    static constexpr auto whitespace = dsl::ascii::space | dsl::ascii::newline;
+    static constexpr auto rule = LEXY_LIT("rule") >> LEXY_LIT("template") >>
+                                 dsl::p<Identifier> >> dsl::p<TemplateParameters> >>
+                                 dsl::curly_bracketed(dsl::p<Description> + dsl::p<Priority> +
+                                                      dsl::p<Block>) >>
+                                 dsl::p<Instances>;
+
+    static constexpr auto value = lexy::callback<ast::RuleTemplate>(
+        [](std::string &&name, std::vector<std::string> &&parameters, std::string &&desc,
+           ast::Priority prio, ast::BlockPtr &&block,
+           std::vector<ast::Instance> &&instances) -> ast::RuleTemplate
+        {
+            return ast::RuleTemplate{
+                ast::Rule(std::move(name), std::move(desc), prio, std::move(block)),
+                std::move(parameters), std::move(instances)};
+        });
+};
+
+// What a source declares: a plain rule, or a rule template with its instances.
+using Source = std::variant<ast::Rule, ast::RuleTemplate>;
+
+// The entry production for source text: the keyword after `rule` picks the declaration.
+struct SourceDecl
+{
+    static constexpr auto whitespace = dsl::ascii::space | dsl::ascii::newline;
+    static constexpr auto rule = []
+    {
+        constexpr auto space = dsl::ascii::space | dsl::ascii::newline;
+        constexpr auto id =
+            dsl::identifier(dsl::ascii::alpha_digit_underscore, dsl::ascii::alpha_digit_underscore);
+        constexpr auto header =
+            LEXY_LIT("rule") + dsl::while_(space) + LEXY_KEYWORD("template", id);
+        return dsl::whitespace(space) +
+               (dsl::peek(header) >> dsl::p<TemplateDecl> | dsl::else_ >> dsl::p<RuleDecl>);
+    }();
+
+    static constexpr auto value = lexy::callback<Source>(
+        [](ast::Rule &&rule) { return Source{std::move(rule)}; },
+        [](ast::RuleTemplate &&ruleTemplate) { return Source{std::move(ruleTemplate)}; });
+};
+
 auto Parse(const std::string &input)
 {
     const auto strInput = lexy::string_input<lexy::utf8_encoding>(input);
@@ -83,6 +160,33 @@ auto Parse(const std::string &input)
     return result;
 }
 
+// A rule or a rule template, whichever `input` declares.
+inline Source ParseSource(const std::string &input)
+{
+    const auto strInput = lexy::string_input<lexy::utf8_encoding>(input);
+    const CaptureLocation<decltype(strInput)> capture{strInput};
+    auto result =
+        lexy::parse<lang::grammar::SourceDecl>(strInput, capture, lexy_ext::report_error);
+    if (not result.has_value())
+    {
+        throw std::runtime_error{"Failed parsing program"};
+    }
+    return std::move(result).value();
+}
+
+auto ParseTemplate(const std::string &input)
+{
+    const auto strInput = lexy::string_input<lexy::utf8_encoding>(input);
+    const CaptureLocation<decltype(strInput)> capture{strInput};
+    auto result =
+        lexy::parse<lang::grammar::TemplateDecl>(strInput, capture, lexy_ext::report_error);
+    if (not result.has_value())
+    {
+        throw std::runtime_error{"Failed parsing template"};
+    }
+    return result;
+}
+
 template <typename P> auto ParseTest(const std::string &input)
 {
     const auto strInput = lexy::string_input<lexy::utf8_encoding>(input);
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lang::profile
+{
+
+// Parses `cypher-shell --format verbose` output captured for queries produced by
+// `dsl-parser -t profile`: every rule is announced by a `profiledRule` marker row, followed
+// by its result table, the plan summary and the operator table.
+
+struct Operator
+{
+    std::string name;
+    std::uint64_t rows = 0;
+    std::uint64_t dbHits = 0;
+};
+
+struct RuleProfile
+{
+    std::string rule;
+    std::uint64_t dbHits = 0;
+    std::uint64_t rows = 0;
+    double timeMs = 0.0;
+    std::vector<Operator> operators;
+};
+
+static constexpr std::string_view markerColumn = "profiledRule";
+
+namespace detail
+{
+
+inline std::string_view Strip(std::string_view text)
+{
+    const auto first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos)
+    {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+inline std::string_view Unquote(std::string_view text)
+{
+    text = Strip(text);
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"')
+    {
+        return text.substr(1, text.size() - 2);
+    }
+    return text;
+}
+
+inline std::vector<std::string_view> Cells(std::string_view line)
+{
+    std::vector<std::string_view> cells;
+    line = Strip(line);
+    if (line.size() < 2 || line.front() != '|' || line.back() != '|')
+    {
+        return cells;
+    }
+    line = line.substr(1, line.size() - 2);
+    for (std::size_t begin = 0;;)
+    {
+        const auto end = line.find('|', begin);
+        cells.push_back(Strip(line.substr(begin, end - begin)));
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+        begin = end + 1;
+    }
+    return cells;
+}
+
+template <typename T> std::optional<T> Number(std::string_view text)
+{
+    text = Unquote(text);
+    T value{};
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (text.empty() || error != std::errc{} || end != text.data() + text.size())
+    {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Column boundaries of the operator table. The Details column may hold non-ASCII text, which
+// cypher-shell pads by characters rather than bytes, so the columns after it are located from
+// the end of the line.
+class OperatorTable
+{
+public:
+    explicit OperatorTable(std::string_view header)
+    {
+        header = Strip(header);
+        width_ = header.size();
+        std::vector<std::size_t> bars;
+        for (std::size_t i = 0; i < header.size(); ++i)
+        {
+            if (header[i] == '|')
+            {
+                bars.push_back(i);
+            }
+        }
+        std::size_t details = bars.size();
+        for (std::size_t i = 0; i + 1 < bars.size(); ++i)
+        {
+            const auto name = Strip(header.substr(bars[i] + 1, bars[i + 1] - bars[i] - 1));
+            if (name == "Details")
+            {
+                details = i;
+            }
+            columns_.push_back(Column{std::string{name}, bars[i] + 1, bars[i + 1], i > details});
+        }
+    }
+
+    [[nodiscard]] std::string_view Cell(std::string_view line, std::string_view name) const
+    {
+        line = Strip(line);
+        const auto it = std::ranges::find(columns_, name, &Column::name);
+        if (it == columns_.end())
+        {
+            return {};
+        }
+        auto begin = it->begin;
+        auto end = it->end;
+        if (it->fromEnd)
+        {
+            if (line.size() < width_)
+            {
+                return {};
+            }
+            begin += line.size() - width_;
+            end += line.size() - width_;
+        }
+        if (end > line.size())
+        {
+            return {};
+        }
+        return Strip(line.substr(begin, end - begin));
+    }
+
+private:
+    struct Column
+    {
+        std::string name;
+        std::size_t begin;
+        std::size_t end;
+        bool fromEnd;
+    };
+
+    std::vector<Column> columns_;
+    std::size_t width_ = 0;
+};
+
+inline std::string OperatorName(std::string_view cell)
+{
+    const auto first = cell.find('+');
+    if (first == std::string_view::npos)
+    {
+        return {};
+    }
+    return std::string{Strip(cell.substr(first + 1))};
+}
+
+} // namespace detail
+
+inline std::vector<RuleProfile> ParseProfiles(std::string_view text)
+{
+    std::vector<RuleProfile> profiles;
+    std::optional<detail::OperatorTable> table;
+    std::vector<std::string_view> summary;
+    bool marker = false;
+
+    const auto current = [&]() -> RuleProfile &
+    {
+        if (profiles.empty())
+        {
+            throw std::runtime_error{"profile output without a profiledRule marker"};
+        }
+        return profiles.back();
+    };
+
+    for (std::size_t begin = 0; begin < text.size();)
+    {
+        auto end = text.find('\n', begin);
+        end = end == std::string_view::npos ? text.size() : end;
+        const auto line = text.substr(begin, end - begin);
+        begin = end + 1;
+
+        const auto stripped = detail::Strip(line);
+        if (stripped.starts_with("Total database accesses:"))
+        {
+            table.reset();
+            auto &profile = current();
+            const auto value = stripped.substr(stripped.find(':') + 1);
+            if (const auto hits = detail::Number<std::uint64_t>(value.substr(0, value.find(',')));
+                hits && profile.dbHits == 0)
+            {
+                profile.dbHits = *hits;
+            }
+            continue;
+        }
+
+        const auto cells = detail::Cells(line);
+        if (cells.empty())
+        {
+            if (!stripped.starts_with('+'))
+            {
+                table.reset();
+            }
+            continue;
+        }
+        if (marker)
+        {
+            marker = false;
+            profiles.emplace_back().rule = detail::Unquote(cells.front());
+            continue;
+        }
+        if (cells.size() == 1 && cells.front() == markerColumn)
+        {
+            marker = true;
+            continue;
+        }
+        if (cells.front() == "Plan")
+        {
+            summary = cells;
+            continue;
+        }
+        if (!summary.empty())
+        {
+            auto &profile = current();
+            for (std::size_t i = 0; i < summary.size() && i < cells.size(); ++i)
+            {
+                if (summary[i] == "DbHits")
+                {
+                    profile.dbHits = detail::Number<std::uint64_t>(cells[i]).value_or(0);
+                }
+                else if (summary[i] == "Rows")
+                {
+                    profile.rows = detail::Number<std::uint64_t>(cells[i]).value_or(0);
+                }
+                else if (summary[i] == "Time")
+                {
+                    profile.timeMs = detail::Number<double>(cells[i]).value_or(0.0);
+                }
+            }
+            summary.clear();
+            continue;
+        }
+        if (cells.front() == "Operator")
+        {
+            table.emplace(line);
+            continue;
+        }
+        if (!table || !detail::Number<std::size_t>(table->Cell(line, "Id")))
+        {
+            continue;
+        }
+
+        auto &profile = current();
+        profile.operators.push_back(
+            Operator{detail::OperatorName(table->Cell(line, "Operator")),
+                     detail::Number<std::uint64_t>(table->Cell(line, "Rows")).value_or(0),
+                     detail::Number<std::uint64_t>(table->Cell(line, "DB Hits")).value_or(0)});
+    }
+
+    for (auto &profile : profiles)
+    {
+        if (profile.dbHits == 0)
+        {
+            for (const auto &op : profile.operators)
+            {
+                profile.dbHits += op.dbHits;
+            }
+        }
+        if (profile.rows == 0 && !profile.operators.empty())
+        {
+            profile.rows = profile.operators.front().rows;
+        }
+    }
+    return profiles;
+}
+
+// Most expensive rules first; ties are broken by wall time, then by name for stable output.
+inline void Rank(std::vector<RuleProfile> &profiles)
+{
+    std::ranges::sort(profiles,
+                      [](const RuleProfile &lhs, const RuleProfile &rhs)
+                      {
+                          if (lhs.dbHits != rhs.dbHits)
+                          {
+                              return lhs.dbHits > rhs.dbHits;
+                          }
+                          if (lhs.timeMs != rhs.timeMs)
+                          {
+                              return lhs.timeMs > rhs.timeMs;
+                          }
+                          return lhs.rule < rhs.rule;
+                      });
+}
+
+inline std::vector<Operator> TopOperators(const RuleProfile &profile, std::size_t count)
+{
+    auto operators = profile.operators;
+    std::ranges::stable_sort(operators, std::ranges::greater{}, &Operator::dbHits);
+    operators.resize(std::min(count, operators.size()));
+    return operators;
+}
+
+inline std::string FormatReport(const std::vector<RuleProfile> &profiles,
+                                std::size_t topOperators = 3)
+{
+    std::string result =
+        fmt::format("{:<4}{:<32}{:>12}{:>10}{:>10}  {}\n", "#", "rule", "db hits", "rows",
+                    "time ms", "top operators (db hits)");
+    for (std::size_t i = 0; i < profiles.size(); ++i)
+    {
+        const auto &profile = profiles[i];
+        std::string operators;
+        for (const auto &op : TopOperators(profile, topOperators))
+        {
+            operators += fmt::format("{}{} ({})", operators.empty() ? "" : ", ", op.name,
+                                     op.dbHits);
+        }
+        result += fmt::format("{:<4}{:<32}{:>12}{:>10}{:>10}  {}\n", i + 1, profile.rule,
+                              profile.dbHits, profile.rows, profile.timeMs, operators);
+    }
+    return result;
+}
+
+} // namespace lang::profile
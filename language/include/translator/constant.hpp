@@ -8,13 +8,17 @@ namespace lang::ast::cypher
 {
 using namespace std::string_literals;
 
-static const auto routeFunction = "({})-[*1..]->({})"s;
+// The model's own relationships. Without the types a route would also take the IN_SUBTREE
+// shortcuts that `--closure` imports, past the intermediate elements it quantifies over.
+static const auto modelRelationships = "RELATES_TO|CONTAINS|INSTANCE_OF"s;
+static const auto routeFunction = "({})-[:" + modelRelationships + "*1..]->({})";
 static const auto crossFunction = "[ x IN {} WHERE x IN {} ]"s;
 static const auto unionFunction =
     "WITH {} + {} AS combined UNWIND combined AS item WITH collect(DISTINCT item) AS unionSet"s;
 static const auto articulationFunction =
     "({0}.articulationPoint IS NULL OR {0}.articulationPoint = 1)"s;
 static const auto deploymentFunction = "[:INSTANCE_OF]->({})"s;
+static const auto elementIdFunction = "elementId({})"s;
 
 static const std::unordered_map<std::string, std::string> functionMap{
     {"route", routeFunction},
@@ -22,4 +26,8 @@ static const std::unordered_map<std::string, std::string> functionMap{
     {"union", unionFunction},
     {"failure_point", articulationFunction},
     {"instance", deploymentFunction}};
+
+// Calls the translator's own passes emit; not part of the DSL.
+static const std::unordered_map<std::string, std::string> internalFunctionMap{
+    {"elementId", elementIdFunction}};
 } // namespace lang::ast::cypher
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ast/expression.hpp"
+#include "translator/options.hpp"
 #include <cstdint>
 #include <string>
 #include <unordered_map>
@@ -18,6 +19,7 @@ struct TranslatorContext
     std::uint32_t quantifierLevel = 0;
     std::vector<std::string> returns;
     bool exceptRule = false;
+    TranslatorOptions options;
 };
 
 }; // namespace lang::ast::cypher
\ No newline at end of file
@@ -11,13 +11,13 @@ namespace lang::ast::cypher
 {
 using namespace std::literals::string_view_literals;
 using namespace std::literals::string_literals;
-static constexpr auto ruleNameFormat = "// [RULE]: {}"sv;
-static constexpr auto descriptionFormat = "// [DESCRIPTION]: {}"sv;
-static constexpr auto priorityFormat = "// [PRIORITY]: {}"sv;
-static constexpr auto withAssignmentFormat = "WITH {} AS {}"sv;
+static constexpr auto ruleNameFormat = "[RULE]: {}"sv;
+static constexpr auto descriptionFormat = "[DESCRIPTION]: {}"sv;
+static constexpr auto priorityFormat = "[PRIORITY]: {}"sv;
+static constexpr auto profileMarkerFormat = "RETURN \"{}\" AS profiledRule;"sv;
+static constexpr auto profileFormat = "PROFILE {};"sv;
+static constexpr auto instancesFormat = ":param {} => [{}];"sv;
 static constexpr auto ternaryFormat = "CASE WHEN ({}) THEN ({}) ELSE ({}) END"sv;
-static constexpr auto ifThenElseFormat = "CASE WHEN ({}) THEN ({}) ELSE ({}) END"sv;
-static constexpr auto ifThenFormat = "CASE WHEN ({}) THEN ({}) ELSE (true) END"sv;
 
 constexpr auto OperatorMap(const ExprType type)
 {
@@ -87,45 +87,8 @@ constexpr auto KeywordMap(const KeywordSets type)
     }
 }
 
-constexpr auto QuantifierMap(const QuantifierType type)
-{
-    switch (type)
-    {
-    case QuantifierType::ALL:
-        return "NOT EXISTS {{ {} {} NOT ({}) }}"s;
-    case QuantifierType::ANY:
-        return "EXISTS {{ {} {} ({}) }}"s;
-    default:
-        throw std::runtime_error{"undefined quantirier type"};
-    }
-}
-
-constexpr auto QuantifierStartMap(const QuantifierType type)
-{
-    switch (type)
-    {
-    case QuantifierType::ALL:
-        return "{} {} NOT ({})"s;
-    case QuantifierType::ANY:
-        return "{} {} ({})"s;
-    default:
-        throw std::runtime_error{"undefined quantirier type"};
-    }
-}
-
-constexpr auto QuantifierExceptMap(const QuantifierType type)
-{
-    switch (type)
-    {
-    case QuantifierType::ALL:
-        return "{} ({})"s;
-    case QuantifierType::ANY:
-        return "{} NOT ({})"s;
-    default:
-        throw std::runtime_error{"undefined quantirier type"};
-    }
-}
-
 static constexpr auto variableError = "Variable [{}] not exist in current context"sv;
 static constexpr auto functionError = "Function [{}] not exist"sv;
+static constexpr auto templateParameterError = "Template parameter [{}] is already bound"sv;
+static constexpr auto instanceError = "Instance [{}] must instantiate [{}] with {} arguments"sv;
 } // namespace lang::ast::cypher
\ No newline at end of file
@@ -0,0 +1,445 @@
+#pragma once
+
+#include <ast/expression.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lang::ast::cypher::ir
+{
+
+struct Literal;
+struct List;
+struct Variable;
+struct Raw;
+struct Property;
+struct Unary;
+struct Not;
+struct Binary;
+struct Logical;
+struct Case;
+struct Call;
+struct ListComprehension;
+struct ListPredicate;
+struct Aggregate;
+struct Exists;
+
+using LiteralPtr = std::unique_ptr<Literal>;
+using ListPtr = std::unique_ptr<List>;
+using VariablePtr = std::unique_ptr<Variable>;
+using RawPtr = std::unique_ptr<Raw>;
+using PropertyPtr = std::unique_ptr<Property>;
+using UnaryPtr = std::unique_ptr<Unary>;
+using NotPtr = std::unique_ptr<Not>;
+using BinaryPtr = std::unique_ptr<Binary>;
+using LogicalPtr = std::unique_ptr<Logical>;
+using CasePtr = std::unique_ptr<Case>;
+using CallPtr = std::unique_ptr<Call>;
+using ListComprehensionPtr = std::unique_ptr<ListComprehension>;
+using ListPredicatePtr = std::unique_ptr<ListPredicate>;
+using AggregatePtr = std::unique_ptr<Aggregate>;
+using ExistsPtr = std::unique_ptr<Exists>;
+
+using Expr = std::variant<LiteralPtr, ListPtr, VariablePtr, RawPtr, PropertyPtr, UnaryPtr, NotPtr,
+                          BinaryPtr, LogicalPtr, CasePtr, CallPtr, ListComprehensionPtr,
+                          ListPredicatePtr, AggregatePtr, ExistsPtr>;
+using ExprPtr = std::unique_ptr<Expr>;
+
+struct NodePattern
+{
+    std::string variable;
+    std::string label;
+    // Inline `{key: value}` constraints; values are Cypher text such as `$workspace`.
+    std::vector<std::pair<std::string, std::string>> properties = {};
+};
+
+struct RelationshipPattern
+{
+    std::string type;
+    std::string length;
+};
+
+struct PathPattern
+{
+    std::string variable;
+    std::vector<NodePattern> nodes;
+    std::vector<RelationshipPattern> relationships;
+};
+
+struct Projection
+{
+    ExprPtr expr;
+    std::string alias;
+};
+
+struct Match
+{
+    std::vector<PathPattern> patterns;
+    ExprPtr where;
+    bool optional = false;
+};
+
+struct Unwind
+{
+    ExprPtr list;
+    std::string alias;
+};
+
+struct With
+{
+    std::vector<Projection> items;
+    ExprPtr where;
+};
+
+struct Return
+{
+    std::vector<Projection> items;
+};
+
+using Clause = std::variant<Match, Unwind, With, Return>;
+
+struct Query
+{
+    std::vector<std::string> comments;
+    std::vector<Clause> clauses;
+};
+
+using LiteralValue = std::variant<std::int64_t, std::string, bool>;
+
+struct Literal
+{
+    LiteralValue value;
+};
+
+struct List
+{
+    std::vector<ExprPtr> items;
+};
+
+struct Variable
+{
+    std::string name;
+};
+
+struct Raw
+{
+    std::string text;
+};
+
+struct Property
+{
+    ExprType op;
+    ExprPtr operand;
+    std::string name;
+};
+
+struct Unary
+{
+    ExprType op;
+    ExprPtr operand;
+};
+
+struct Not
+{
+    ExprPtr operand;
+};
+
+struct Binary
+{
+    ExprType op;
+    ExprPtr left;
+    ExprPtr right;
+};
+
+struct Logical
+{
+    ExprType op;
+    std::vector<ExprPtr> operands;
+};
+
+struct Case
+{
+    ExprPtr condition;
+    ExprPtr thenExpr;
+    ExprPtr elseExpr;
+};
+
+struct Call
+{
+    std::string name;
+    std::vector<ExprPtr> args;
+};
+
+// `[variable IN source WHERE where]`
+struct ListComprehension
+{
+    std::string variable;
+    ExprPtr source;
+    ExprPtr where;
+};
+
+enum class ListQuantifier
+{
+    ANY,
+    NONE,
+    ALL
+};
+
+// `any(variable IN source WHERE where)` and friends
+struct ListPredicate
+{
+    ListQuantifier quantifier;
+    std::string variable;
+    ExprPtr source;
+    ExprPtr where;
+};
+
+// `count(DISTINCT operand)`; only valid in WITH/RETURN projections
+struct Aggregate
+{
+    std::string function;
+    ExprPtr operand;
+    bool distinct = false;
+};
+
+struct Exists
+{
+    Query query;
+};
+
+template <typename T, typename... Args> ExprPtr Make(Args &&...args)
+{
+    return std::make_unique<Expr>(std::make_unique<T>(std::forward<Args>(args)...));
+}
+
+template <typename T> T *As(const ExprPtr &expr)
+{
+    if (!expr)
+    {
+        return nullptr;
+    }
+    auto *ptr = std::get_if<std::unique_ptr<T>>(expr.get());
+    return ptr != nullptr ? ptr->get() : nullptr;
+}
+
+inline ExprPtr Clone(const ExprPtr &expr);
+inline Query Clone(const Query &query);
+
+inline std::vector<Projection> Clone(const std::vector<Projection> &items)
+{
+    std::vector<Projection> result;
+    result.reserve(items.size());
+    for (const auto &item : items)
+    {
+        result.push_back(Projection{Clone(item.expr), item.alias});
+    }
+    return result;
+}
+
+inline std::vector<ExprPtr> Clone(const std::vector<ExprPtr> &exprs)
+{
+    std::vector<ExprPtr> result;
+    result.reserve(exprs.size());
+    for (const auto &expr : exprs)
+    {
+        result.push_back(Clone(expr));
+    }
+    return result;
+}
+
+inline Clause Clone(const Clause &clause)
+{
+    return std::visit(
+        [](const auto &node) -> Clause
+        {
+            using T = std::decay_t<decltype(node)>;
+            if constexpr (std::is_same_v<T, Match>)
+            {
+                return Match{node.patterns, Clone(node.where), node.optional};
+            }
+            else if constexpr (std::is_same_v<T, Unwind>)
+            {
+                return Unwind{Clone(node.list), node.alias};
+            }
+            else if constexpr (std::is_same_v<T, With>)
+            {
+                return With{Clone(node.items), Clone(node.where)};
+            }
+            else
+            {
+                return Return{Clone(node.items)};
+            }
+        },
+        clause);
+}
+
+inline Query Clone(const Query &query)
+{
+    Query result{query.comments, {}};
+    result.clauses.reserve(query.clauses.size());
+    for (const auto &clause : query.clauses)
+    {
+        result.clauses.push_back(Clone(clause));
+    }
+    return result;
+}
+
+inline ExprPtr Clone(const ExprPtr &expr)
+{
+    if (!expr)
+    {
+        return nullptr;
+    }
+    return std::visit(
+        [](const auto &node) -> ExprPtr
+        {
+            using T = typename std::decay_t<decltype(node)>::element_type;
+            if constexpr (std::is_same_v<T, Literal> || std::is_same_v<T, Variable> ||
+                          std::is_same_v<T, Raw>)
+            {
+                return Make<T>(*node);
+            }
+            else if constexpr (std::is_same_v<T, List>)
+            {
+                return Make<List>(Clone(node->items));
+            }
+            else if constexpr (std::is_same_v<T, Property>)
+            {
+                return Make<Property>(node->op, Clone(node->operand), node->name);
+            }
+            else if constexpr (std::is_same_v<T, Unary>)
+            {
+                return Make<Unary>(node->op, Clone(node->operand));
+            }
+            else if constexpr (std::is_same_v<T, Not>)
+            {
+                return Make<Not>(Clone(node->operand));
+            }
+            else if constexpr (std::is_same_v<T, Binary>)
+            {
+                return Make<Binary>(node->op, Clone(node->left), Clone(node->right));
+            }
+            else if constexpr (std::is_same_v<T, Logical>)
+            {
+                return Make<Logical>(node->op, Clone(node->operands));
+            }
+            else if constexpr (std::is_same_v<T, Case>)
+            {
+                return Make<Case>(Clone(node->condition), Clone(node->thenExpr),
+                                  Clone(node->elseExpr));
+            }
+            else if constexpr (std::is_same_v<T, Call>)
+            {
+                return Make<Call>(node->name, Clone(node->args));
+            }
+            else if constexpr (std::is_same_v<T, ListComprehension>)
+            {
+                return Make<ListComprehension>(node->variable, Clone(node->source),
+                                               Clone(node->where));
+            }
+            else if constexpr (std::is_same_v<T, ListPredicate>)
+            {
+                return Make<ListPredicate>(node->quantifier, node->variable, Clone(node->source),
+                                           Clone(node->where));
+            }
+            else if constexpr (std::is_same_v<T, Aggregate>)
+            {
+                return Make<Aggregate>(node->function, Clone(node->operand), node->distinct);
+            }
+            else
+            {
+                return Make<Exists>(Clone(node->query));
+            }
+        },
+        *expr);
+}
+
+inline ExprPtr Combine(ExprType op, std::vector<ExprPtr> operands)
+{
+    std::vector<ExprPtr> flat;
+    for (auto &operand : operands)
+    {
+        if (!operand)
+        {
+            continue;
+        }
+        if (auto *logical = As<Logical>(operand); logical != nullptr && logical->op == op)
+        {
+            for (auto &inner : logical->operands)
+            {
+                flat.push_back(std::move(inner));
+            }
+            continue;
+        }
+        flat.push_back(std::move(operand));
+    }
+    if (flat.empty())
+    {
+        return nullptr;
+    }
+    if (flat.size() == 1)
+    {
+        return std::move(flat.front());
+    }
+    return Make<Logical>(op, std::move(flat));
+}
+
+template <typename... Ts> ExprPtr And(Ts &&...operands)
+{
+    std::vector<ExprPtr> list;
+    (list.push_back(std::forward<Ts>(operands)), ...);
+    return Combine(ExprType::AND, std::move(list));
+}
+
+inline std::vector<ExprPtr> Conjuncts(ExprPtr expr)
+{
+    std::vector<ExprPtr> result;
+    if (!expr)
+    {
+        return result;
+    }
+    if (auto *logical = As<Logical>(expr); logical != nullptr && logical->op == ExprType::AND)
+    {
+        return std::move(logical->operands);
+    }
+    result.push_back(std::move(expr));
+    return result;
+}
+
+inline void AddWhere(Query &query, ExprPtr cond)
+{
+    if (!cond)
+    {
+        return;
+    }
+    if (!query.clauses.empty())
+    {
+        auto *where = std::visit(
+            [](auto &clause) -> ExprPtr *
+            {
+                using C = std::decay_t<decltype(clause)>;
+                if constexpr (std::is_same_v<C, Match> || std::is_same_v<C, With>)
+                {
+                    return &clause.where;
+                }
+                return nullptr;
+            },
+            query.clauses.back());
+        if (where != nullptr)
+        {
+            *where = And(std::move(*where), std::move(cond));
+            return;
+        }
+    }
+    With with;
+    with.items.push_back(Projection{Make<Raw>("*"), ""});
+    with.where = std::move(cond);
+    query.clauses.emplace_back(std::move(with));
+}
+
+} // namespace lang::ast::cypher::ir
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <translator/printer.hpp>
+#include <translator/statistics.hpp>
+
+namespace lang::ast::cypher
+{
+
+// How rules are scoped when several workspaces share one database (converter --workspace):
+// PARAMETER matches only nodes of the `$workspace` parameter, GROUPED checks every workspace
+// in one pass and reports the workspace of each finding.
+enum class WorkspaceScope
+{
+    NONE,
+    PARAMETER,
+    GROUPED
+};
+
+struct TranslatorOptions
+{
+    ir::PrintOptions print;
+    bool optimize = false;
+    bool decorrelate = false;
+    bool closure = false;
+    WorkspaceScope workspace = WorkspaceScope::NONE;
+    Statistics statistics;
+};
+
+} // namespace lang::ast::cypher
@@ -0,0 +1,408 @@
+#pragma once
+
+#include <translator/ir.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lang::ast::cypher::ir
+{
+
+template <typename F> void ForEachExpr(Clause &clause, F &&fn)
+{
+    std::visit(
+        [&](auto &node)
+        {
+            using T = std::decay_t<decltype(node)>;
+            if constexpr (std::is_same_v<T, Match>)
+            {
+                fn(node.where);
+            }
+            else if constexpr (std::is_same_v<T, Unwind>)
+            {
+                fn(node.list);
+            }
+            else if constexpr (std::is_same_v<T, With>)
+            {
+                for (auto &item : node.items)
+                {
+                    fn(item.expr);
+                }
+                fn(node.where);
+            }
+            else
+            {
+                for (auto &item : node.items)
+                {
+                    fn(item.expr);
+                }
+            }
+        },
+        clause);
+}
+
+template <typename F> void ForEachExpr(Query &query, F &&fn)
+{
+    for (auto &clause : query.clauses)
+    {
+        ForEachExpr(clause, fn);
+    }
+}
+
+template <typename F> void ForEachChild(Expr &expr, F &&fn)
+{
+    std::visit(
+        [&](auto &node)
+        {
+            using T = typename std::decay_t<decltype(node)>::element_type;
+            if constexpr (std::is_same_v<T, List>)
+            {
+                for (auto &item : node->items)
+                {
+                    fn(item);
+                }
+            }
+            else if constexpr (std::is_same_v<T, Property> || std::is_same_v<T, Unary> ||
+                               std::is_same_v<T, Not> || std::is_same_v<T, Aggregate>)
+            {
+                fn(node->operand);
+            }
+            else if constexpr (std::is_same_v<T, Binary>)
+            {
+                fn(node->left);
+                fn(node->right);
+            }
+            else if constexpr (std::is_same_v<T, Logical>)
+            {
+                for (auto &operand : node->operands)
+                {
+                    fn(operand);
+                }
+            }
+            else if constexpr (std::is_same_v<T, Case>)
+            {
+                fn(node->condition);
+                fn(node->thenExpr);
+                fn(node->elseExpr);
+            }
+            else if constexpr (std::is_same_v<T, Call>)
+            {
+                for (auto &arg : node->args)
+                {
+                    fn(arg);
+                }
+            }
+            else if constexpr (std::is_same_v<T, ListComprehension> ||
+                               std::is_same_v<T, ListPredicate>)
+            {
+                fn(node->source);
+                fn(node->where);
+            }
+            else if constexpr (std::is_same_v<T, Exists>)
+            {
+                ForEachExpr(node->query, fn);
+            }
+        },
+        expr);
+}
+
+// Post-order rewrite: children are rewritten before `fn` sees their parent, nested
+// EXISTS subqueries included.
+template <typename F> void Rewrite(ExprPtr &expr, F &&fn)
+{
+    if (!expr)
+    {
+        return;
+    }
+    ForEachChild(*expr, [&](ExprPtr &child) { Rewrite(child, fn); });
+    fn(expr);
+}
+
+template <typename F> void Rewrite(Query &query, F &&fn)
+{
+    ForEachExpr(query, [&](ExprPtr &expr) { Rewrite(expr, fn); });
+}
+
+inline bool CarriesScope(const With &with)
+{
+    if (with.items.empty())
+    {
+        return false;
+    }
+    const auto *raw = As<Raw>(with.items.front().expr);
+    return raw != nullptr && raw->text == "*";
+}
+
+// Updates `scope` with the variables visible after `clause`.
+inline void Bind(const Clause &clause, std::set<std::string> &scope)
+{
+    std::visit(
+        [&](const auto &node)
+        {
+            using T = std::decay_t<decltype(node)>;
+            if constexpr (std::is_same_v<T, Match>)
+            {
+                for (const auto &path : node.patterns)
+                {
+                    if (!path.variable.empty())
+                    {
+                        scope.insert(path.variable);
+                    }
+                    for (const auto &pattern : path.nodes)
+                    {
+                        if (!pattern.variable.empty())
+                        {
+                            scope.insert(pattern.variable);
+                        }
+                    }
+                }
+            }
+            else if constexpr (std::is_same_v<T, Unwind>)
+            {
+                scope.insert(node.alias);
+            }
+            else if constexpr (std::is_same_v<T, With>)
+            {
+                if (!CarriesScope(node))
+                {
+                    scope.clear();
+                }
+                for (const auto &item : node.items)
+                {
+                    if (!item.alias.empty())
+                    {
+                        scope.insert(item.alias);
+                    }
+                    else if (const auto *var = As<Variable>(item.expr); var != nullptr)
+                    {
+                        scope.insert(var->name);
+                    }
+                }
+            }
+        },
+        clause);
+}
+
+inline void CollectVariables(const ExprPtr &expr, std::set<std::string> &result);
+
+// Variables an expression reads from its enclosing scope; names bound inside nested EXISTS
+// subqueries are not free.
+inline std::set<std::string> FreeVariables(const ExprPtr &expr)
+{
+    std::set<std::string> result;
+    CollectVariables(expr, result);
+    return result;
+}
+
+inline void CollectVariables(const Query &query, std::set<std::string> &result)
+{
+    std::set<std::string> bound;
+    const auto read = [&](const ExprPtr &expr)
+    {
+        for (const auto &name : FreeVariables(expr))
+        {
+            if (!bound.contains(name))
+            {
+                result.insert(name);
+            }
+        }
+    };
+    for (const auto &clause : query.clauses)
+    {
+        std::visit(
+            [&](const auto &node)
+            {
+                using T = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<T, Match>)
+                {
+                    // A pattern variable that is not bound yet may refer to the outer scope.
+                    for (const auto &path : node.patterns)
+                    {
+                        for (const auto &pattern : path.nodes)
+                        {
+                            if (!pattern.variable.empty() && !bound.contains(pattern.variable))
+                            {
+                                result.insert(pattern.variable);
+                            }
+                        }
+                    }
+                    Bind(clause, bound);
+                    read(node.where);
+                }
+                else if constexpr (std::is_same_v<T, Unwind>)
+                {
+                    read(node.list);
+                    Bind(clause, bound);
+                }
+                else
+                {
+                    for (const auto &item : node.items)
+                    {
+                        read(item.expr);
+                    }
+                    Bind(clause, bound);
+                    if constexpr (std::is_same_v<T, With>)
+                    {
+                        read(node.where);
+                    }
+                }
+            },
+            clause);
+    }
+}
+
+inline void CollectVariables(const ExprPtr &expr, std::set<std::string> &result)
+{
+    if (!expr)
+    {
+        return;
+    }
+    if (const auto *var = As<Variable>(expr); var != nullptr)
+    {
+        result.insert(var->name);
+        return;
+    }
+    if (const auto *exists = As<Exists>(expr); exists != nullptr)
+    {
+        CollectVariables(exists->query, result);
+        return;
+    }
+    const auto iterate = [&](const auto &node)
+    {
+        CollectVariables(node.source, result);
+        auto inner = FreeVariables(node.where);
+        inner.erase(node.variable);
+        result.merge(inner);
+    };
+    if (const auto *list = As<ListComprehension>(expr); list != nullptr)
+    {
+        iterate(*list);
+        return;
+    }
+    if (const auto *list = As<ListPredicate>(expr); list != nullptr)
+    {
+        iterate(*list);
+        return;
+    }
+    ForEachChild(*expr, [&](ExprPtr &child) { CollectVariables(child, result); });
+}
+
+// `elementId(v)` for one variable, a list of them for several: a value that identifies the
+// binding of `names` and can be collected into a set.
+inline ExprPtr ElementKey(const std::vector<std::string> &names)
+{
+    std::vector<ExprPtr> ids;
+    for (const auto &name : names)
+    {
+        std::vector<ExprPtr> args;
+        args.push_back(Make<Variable>(name));
+        ids.push_back(Make<Call>("elementId", std::move(args)));
+    }
+    return ids.size() == 1 ? std::move(ids.front()) : Make<List>(std::move(ids));
+}
+
+inline bool ReadsProperty(const ExprPtr &expr)
+{
+    if (!expr || As<Exists>(expr) != nullptr)
+    {
+        return false;
+    }
+    bool found = As<Property>(expr) != nullptr;
+    ForEachChild(*expr, [&](ExprPtr &child) { found = found || ReadsProperty(child); });
+    return found;
+}
+
+// Division and raw Cypher may raise an error at run time, and so may list operations (`IN`,
+// list comprehensions, `cross()`, `union()`) on a property that holds a scalar on some node;
+// a rewrite must not evaluate them where the original query would not have. `lists = false`
+// leaves the list operations out.
+inline bool MayFail(const ExprPtr &expr, bool lists = true)
+{
+    if (As<Raw>(expr) != nullptr)
+    {
+        return true;
+    }
+    if (const auto *binary = As<Binary>(expr); binary != nullptr)
+    {
+        if (binary->op == ExprType::DIV || (lists && binary->op == ExprType::IN &&
+                                            ReadsProperty(binary->right)))
+        {
+            return true;
+        }
+    }
+    if (lists)
+    {
+        if (const auto *list = As<ListComprehension>(expr);
+            list != nullptr && ReadsProperty(list->source))
+        {
+            return true;
+        }
+        if (const auto *list = As<ListPredicate>(expr);
+            list != nullptr && ReadsProperty(list->source))
+        {
+            return true;
+        }
+        if (const auto *call = As<Call>(expr);
+            call != nullptr && (call->name == "cross" || call->name == "union") &&
+            std::ranges::any_of(call->args, &ReadsProperty))
+        {
+            return true;
+        }
+    }
+    bool fails = false;
+    if (As<Exists>(expr) == nullptr)
+    {
+        ForEachChild(*expr, [&](ExprPtr &child) { fails = fails || MayFail(child, lists); });
+    }
+    return fails;
+}
+
+class Pass
+{
+public:
+    virtual ~Pass() = default;
+    [[nodiscard]] virtual std::string_view Name() const = 0;
+    virtual void Run(Query &query) = 0;
+};
+
+class PassManager
+{
+public:
+    template <typename P, typename... Args> PassManager &Add(Args &&...args)
+    {
+        static_assert(std::is_base_of_v<Pass, P>, "IR pass must derive from ir::Pass");
+        passes_.push_back(std::make_unique<P>(std::forward<Args>(args)...));
+        return *this;
+    }
+
+    void Run(Query &query) const
+    {
+        for (const auto &pass : passes_)
+        {
+            pass->Run(query);
+        }
+    }
+
+    [[nodiscard]] std::vector<std::string_view> Names() const
+    {
+        std::vector<std::string_view> names;
+        names.reserve(passes_.size());
+        for (const auto &pass : passes_)
+        {
+            names.push_back(pass->Name());
+        }
+        return names;
+    }
+
+private:
+    std::vector<std::unique_ptr<Pass>> passes_;
+};
+
+} // namespace lang::ast::cypher::ir
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <translator/ir.hpp>
+#include <translator/pass.hpp>
+
+#include <string_view>
+#include <variant>
+
+namespace lang::ast::cypher::passes
+{
+
+// Replaces `-[:CONTAINS*]->` expansions with a single hop over the `IN_SUBTREE` edges that
+// the converter materializes with `--closure`: every element is linked to all of its
+// ancestors, so `(d)-[:IN_SUBTREE]->(c)` holds exactly when `(d)-[:CONTAINS*]->(c)` does.
+class ContainmentClosure : public ir::Pass
+{
+public:
+    static constexpr auto containsType = "CONTAINS";
+    static constexpr auto closureType = "IN_SUBTREE";
+
+    [[nodiscard]] std::string_view Name() const override
+    {
+        return "closure";
+    }
+
+    void Run(ir::Query &query) override
+    {
+        Patterns(query);
+        ir::Rewrite(query,
+                    [](ir::ExprPtr &expr)
+                    {
+                        if (auto *exists = ir::As<ir::Exists>(expr); exists != nullptr)
+                        {
+                            Patterns(exists->query);
+                        }
+                    });
+    }
+
+private:
+    static void Patterns(ir::Query &query)
+    {
+        for (auto &clause : query.clauses)
+        {
+            if (auto *match = std::get_if<ir::Match>(&clause); match != nullptr)
+            {
+                for (auto &path : match->patterns)
+                {
+                    for (auto &relationship : path.relationships)
+                    {
+                        // A named path exposes the intermediate nodes the closure skips.
+                        if (path.variable.empty() && relationship.type == containsType &&
+                            relationship.length == "*")
+                        {
+                            relationship = ir::RelationshipPattern{closureType, ""};
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
+
+} // namespace lang::ast::cypher::passes
@@ -0,0 +1,471 @@
+#pragma once
+
+#include <translator/ir.hpp>
+#include <translator/pass.hpp>
+#include <translator/printer.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lang::ast::cypher::passes
+{
+
+// Common subexpression elimination. Structurally identical subexpressions of a WHERE are
+// bound once with `WITH *, expr AS __cseN`; expressions inside EXISTS subqueries that only
+// read the enclosing row are hoisted out of the subquery, and expressions that do not depend
+// on the matched pattern at all are computed before the MATCH. An expression that may fail
+// (ir::MayFail) is only bound after the MATCH, and only when the original query evaluates it
+// unconditionally in a conjunct that no moved conjunct used to guard.
+class CommonSubexpressions : public ir::Pass
+{
+public:
+    static constexpr auto prefix = "__cse";
+
+    [[nodiscard]] std::string_view Name() const override
+    {
+        return "cse";
+    }
+
+    void Run(ir::Query &query) override
+    {
+        counter_ = 0;
+        Process(query, {}, true);
+    }
+
+private:
+    struct Occurrence
+    {
+        ir::ExprPtr *slot;
+        std::vector<ir::With *> barriers;
+        bool nested;
+        // Index of the top-level conjunct of the WHERE the occurrence is part of.
+        std::size_t conjunct;
+        // Set when the occurrence is evaluated only for some rows: inside a subquery, a
+        // CASE branch, a comprehension filter or a later operand of AND / OR.
+        bool guarded;
+    };
+
+    using Occurrences = std::map<std::string, std::vector<Occurrence>>;
+
+    std::size_t counter_ = 0;
+
+    static std::size_t Size(const ir::ExprPtr &expr)
+    {
+        std::size_t size = 1;
+        ir::ForEachChild(*expr, [&](ir::ExprPtr &child) { size += Size(child); });
+        return size;
+    }
+
+    // Raw text may hide variable references: such expressions are never moved away from the
+    // place where they are evaluated.
+    static bool Movable(const ir::ExprPtr &expr)
+    {
+        if (ir::As<ir::Raw>(expr) != nullptr || ir::As<ir::Exists>(expr) != nullptr)
+        {
+            return false;
+        }
+        bool movable = true;
+        ir::ForEachChild(*expr, [&](ir::ExprPtr &child) { movable = movable && Movable(child); });
+        return movable;
+    }
+
+    static bool ContainsCall(const ir::ExprPtr &expr)
+    {
+        bool found = ir::As<ir::Call>(expr) != nullptr;
+        ir::ForEachChild(*expr,
+                         [&](ir::ExprPtr &child) { found = found || ContainsCall(child); });
+        return found;
+    }
+
+    static bool Candidate(const ir::ExprPtr &expr)
+    {
+        const auto composite =
+            ir::As<ir::Binary>(expr) != nullptr || ir::As<ir::Logical>(expr) != nullptr ||
+            ir::As<ir::Case>(expr) != nullptr || ir::As<ir::Call>(expr) != nullptr ||
+            ir::As<ir::ListComprehension>(expr) != nullptr ||
+            ir::As<ir::ListPredicate>(expr) != nullptr;
+        return composite && Movable(expr);
+    }
+
+    static bool Within(const std::set<std::string> &names, const std::set<std::string> &scope)
+    {
+        return std::ranges::all_of(names, [&](const auto &name) { return scope.contains(name); });
+    }
+
+    static bool Profitable(const ir::ExprPtr &expr, const std::vector<Occurrence> &occurrences)
+    {
+        if (occurrences.size() > 1 || std::ranges::any_of(occurrences, &Occurrence::nested))
+        {
+            return Size(expr) >= 4;
+        }
+        return ir::FreeVariables(expr).empty() && ContainsCall(expr);
+    }
+
+    static ir::ExprPtr *WhereOf(ir::Clause &clause)
+    {
+        return std::visit(
+            [](auto &node) -> ir::ExprPtr *
+            {
+                using T = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<T, ir::Match> || std::is_same_v<T, ir::With>)
+                {
+                    return &node.where;
+                }
+                return nullptr;
+            },
+            clause);
+    }
+
+    // `at` describes the position of `expr`; `locals` are the iteration variables of the
+    // enclosing list comprehensions, and anything that reads them cannot leave the
+    // comprehension.
+    void Collect(ir::ExprPtr &expr, const std::set<std::string> &scope, const Occurrence &at,
+                 Occurrences &result, const std::set<std::string> &locals = {}) const
+    {
+        if (!expr)
+        {
+            return;
+        }
+        if (auto *exists = ir::As<ir::Exists>(expr); exists != nullptr)
+        {
+            CollectNested(exists->query, scope, at, result);
+            return;
+        }
+        if (Candidate(expr))
+        {
+            const auto names = ir::FreeVariables(expr);
+            const auto local = std::ranges::any_of(
+                names, [&](const auto &name) { return locals.contains(name); });
+            if (!local && (!at.nested || Within(names, scope)))
+            {
+                auto occurrence = at;
+                occurrence.slot = &expr;
+                result[ir::Print(expr)].push_back(std::move(occurrence));
+            }
+        }
+        auto guarded = at;
+        guarded.guarded = true;
+        const auto iterate = [&](auto &node)
+        {
+            auto inner = locals;
+            inner.insert(node.variable);
+            Collect(node.source, scope, at, result, locals);
+            Collect(node.where, scope, guarded, result, inner);
+        };
+        if (auto *list = ir::As<ir::ListComprehension>(expr); list != nullptr)
+        {
+            iterate(*list);
+            return;
+        }
+        if (auto *list = ir::As<ir::ListPredicate>(expr); list != nullptr)
+        {
+            iterate(*list);
+            return;
+        }
+        if (auto *logical = ir::As<ir::Logical>(expr);
+            logical != nullptr && logical->op != ExprType::XOR)
+        {
+            for (std::size_t i = 0; i < logical->operands.size(); ++i)
+            {
+                Collect(logical->operands[i], scope, i == 0 ? at : guarded, result, locals);
+            }
+            return;
+        }
+        if (auto *branch = ir::As<ir::Case>(expr); branch != nullptr)
+        {
+            Collect(branch->condition, scope, at, result, locals);
+            Collect(branch->thenExpr, scope, guarded, result, locals);
+            Collect(branch->elseExpr, scope, guarded, result, locals);
+            return;
+        }
+        ir::ForEachChild(*expr,
+                         [&](ir::ExprPtr &child) { Collect(child, scope, at, result, locals); });
+    }
+
+    // A projecting WITH inside a subquery hides everything it does not list, so the bound
+    // name has to be passed through every such WITH in front of its use.
+    void CollectNested(ir::Query &query, const std::set<std::string> &scope, Occurrence at,
+                       Occurrences &result) const
+    {
+        at.nested = true;
+        at.guarded = true;
+        for (auto &clause : query.clauses)
+        {
+            std::visit(
+                [&](auto &node)
+                {
+                    using T = std::decay_t<decltype(node)>;
+                    if constexpr (std::is_same_v<T, ir::Match>)
+                    {
+                        Collect(node.where, scope, at, result);
+                    }
+                    else if constexpr (std::is_same_v<T, ir::Unwind>)
+                    {
+                        Collect(node.list, scope, at, result);
+                    }
+                    else
+                    {
+                        for (auto &item : node.items)
+                        {
+                            Collect(item.expr, scope, at, result);
+                        }
+                        if constexpr (std::is_same_v<T, ir::With>)
+                        {
+                            if (!ir::CarriesScope(node))
+                            {
+                                at.barriers.push_back(&node);
+                            }
+                            Collect(node.where, scope, at, result);
+                        }
+                    }
+                },
+                clause);
+        }
+    }
+
+    // Hoists the subexpressions of clause `index`; returns the number of clauses inserted
+    // in front of it.
+    std::size_t Hoist(ir::Query &query, std::size_t index, const std::set<std::string> &before,
+                      const std::set<std::string> &after, bool topLevel)
+    {
+        std::vector<ir::Projection> hoisted;
+        std::vector<ir::Projection> late;
+        std::set<std::string> lateNames;
+        const auto isMatch = std::holds_alternative<ir::Match>(query.clauses[index]);
+        // A WHERE on an OPTIONAL MATCH nulls the optional variables rather than dropping the
+        // row, so its conjuncts cannot move to a WITH after it; only bindings made before the
+        // match are allowed there.
+        const auto optional = isMatch && std::get<ir::Match>(query.clauses[index]).optional;
+        const auto early = [&](const ir::ExprPtr &expr)
+        {
+            return isMatch && (topLevel || index > 0) &&
+                   Within(ir::FreeVariables(expr), before) && !ir::MayFail(expr);
+        };
+
+        // Conjuncts that read a late binding move to the WITH behind it and run after every
+        // conjunct left in place. A binding that may fail is anchored to the first conjunct
+        // that evaluates it unconditionally; no conjunct in front of the anchor may move.
+        std::set<std::size_t> moved;
+        auto limit = std::numeric_limits<std::size_t>::max();
+        const auto anchor = [](const std::vector<Occurrence> &list)
+        {
+            auto result = std::numeric_limits<std::size_t>::max();
+            for (const auto &occurrence : list)
+            {
+                if (!occurrence.guarded)
+                {
+                    result = std::min(result, occurrence.conjunct);
+                }
+            }
+            return result;
+        };
+        const auto ordered = [&](const ir::ExprPtr &expr, const std::vector<Occurrence> &list)
+        {
+            if (early(expr))
+            {
+                return true;
+            }
+            if (!ir::MayFail(expr))
+            {
+                return std::ranges::all_of(list, [&](const auto &occurrence)
+                                           {
+                                               return occurrence.conjunct >= limit ||
+                                                      moved.contains(occurrence.conjunct);
+                                           });
+            }
+            const auto first = anchor(list);
+            return first != std::numeric_limits<std::size_t>::max() &&
+                   (moved.empty() || *moved.begin() >= first) &&
+                   std::ranges::all_of(list, [&](const auto &occurrence)
+                                       { return occurrence.conjunct >= first; });
+        };
+
+        while (true)
+        {
+            auto *where = WhereOf(query.clauses[index]);
+            Occurrences occurrences;
+            if (auto *logical = ir::As<ir::Logical>(*where);
+                logical != nullptr && logical->op == ExprType::AND)
+            {
+                for (std::size_t i = 0; i < logical->operands.size(); ++i)
+                {
+                    Collect(logical->operands[i], after, Occurrence{nullptr, {}, false, i, false},
+                            occurrences);
+                }
+            }
+            else
+            {
+                Collect(*where, after, Occurrence{nullptr, {}, false, 0, false}, occurrences);
+            }
+
+            const std::vector<Occurrence> *best = nullptr;
+            std::size_t bestSize = 0;
+            for (const auto &[key, list] : occurrences)
+            {
+                const auto &expr = *list.front().slot;
+                const auto size = Size(expr);
+                if (size > bestSize && Profitable(expr, list) && (!optional || early(expr)) &&
+                    ordered(expr, list))
+                {
+                    best = &list;
+                    bestSize = size;
+                }
+            }
+            if (best == nullptr)
+            {
+                break;
+            }
+
+            const auto name = prefix + std::to_string(counter_++);
+            auto expr = ir::Clone(*best->front().slot);
+            for (const auto &occurrence : *best)
+            {
+                *occurrence.slot = ir::Make<ir::Variable>(name);
+                for (auto *with : occurrence.barriers)
+                {
+                    const auto passed = std::ranges::any_of(
+                        with->items, [&](const auto &item)
+                        {
+                            const auto *var = ir::As<ir::Variable>(item.expr);
+                            return item.alias.empty() && var != nullptr && var->name == name;
+                        });
+                    if (!passed)
+                    {
+                        with->items.push_back(ir::Projection{ir::Make<ir::Variable>(name), ""});
+                    }
+                }
+            }
+            if (early(expr))
+            {
+                hoisted.push_back(ir::Projection{std::move(expr), name});
+            }
+            else
+            {
+                if (ir::MayFail(expr))
+                {
+                    limit = std::min(limit, anchor(*best));
+                }
+                for (const auto &occurrence : *best)
+                {
+                    moved.insert(occurrence.conjunct);
+                }
+                late.push_back(ir::Projection{std::move(expr), name});
+                lateNames.insert(name);
+            }
+        }
+
+        if (!late.empty())
+        {
+            auto *where = WhereOf(query.clauses[index]);
+            std::vector<ir::ExprPtr> keep;
+            std::vector<ir::ExprPtr> moved;
+            for (auto &conjunct : ir::Conjuncts(std::move(*where)))
+            {
+                const auto names = ir::FreeVariables(conjunct);
+                const auto uses = std::ranges::any_of(
+                    names, [&](const auto &name) { return lateNames.contains(name); });
+                (uses ? moved : keep).push_back(std::move(conjunct));
+            }
+            *where = ir::Combine(ExprType::AND, std::move(keep));
+
+            ir::With with;
+            with.items.push_back(ir::Projection{ir::Make<ir::Raw>("*"), ""});
+            std::ranges::move(late, std::back_inserter(with.items));
+            with.where = ir::Combine(ExprType::AND, std::move(moved));
+            query.clauses.insert(query.clauses.begin() + static_cast<std::ptrdiff_t>(index) + 1,
+                                 std::move(with));
+        }
+
+        if (hoisted.empty())
+        {
+            return 0;
+        }
+        ir::With with;
+        if (!before.empty())
+        {
+            with.items.push_back(ir::Projection{ir::Make<ir::Raw>("*"), ""});
+        }
+        std::ranges::move(hoisted, std::back_inserter(with.items));
+        query.clauses.insert(query.clauses.begin() + static_cast<std::ptrdiff_t>(index),
+                             std::move(with));
+        return 1;
+    }
+
+    void Process(ir::Query &query, const std::set<std::string> &outer, bool topLevel)
+    {
+        auto scope = outer;
+        for (std::size_t i = 0; i < query.clauses.size(); ++i)
+        {
+            const auto before = scope;
+            ir::Bind(query.clauses[i], scope);
+            const auto *where = WhereOf(query.clauses[i]);
+            if (where != nullptr && *where)
+            {
+                if (Hoist(query, i, before, scope, topLevel) > 0)
+                {
+                    scope = before;
+                    ir::Bind(query.clauses[i], scope);
+                    ir::Bind(query.clauses[++i], scope);
+                }
+            }
+        }
+
+        scope = outer;
+        for (auto &clause : query.clauses)
+        {
+            const auto before = scope;
+            ir::Bind(clause, scope);
+            std::visit(
+                [&](auto &node)
+                {
+                    using T = std::decay_t<decltype(node)>;
+                    if constexpr (std::is_same_v<T, ir::Match>)
+                    {
+                        Descend(node.where, scope);
+                    }
+                    else if constexpr (std::is_same_v<T, ir::Unwind>)
+                    {
+                        Descend(node.list, before);
+                    }
+                    else
+                    {
+                        for (auto &item : node.items)
+                        {
+                            Descend(item.expr, before);
+                        }
+                        if constexpr (std::is_same_v<T, ir::With>)
+                        {
+                            Descend(node.where, scope);
+                        }
+                    }
+                },
+                clause);
+        }
+    }
+
+    void Descend(ir::ExprPtr &expr, const std::set<std::string> &scope)
+    {
+        if (!expr)
+        {
+            return;
+        }
+        if (auto *exists = ir::As<ir::Exists>(expr); exists != nullptr)
+        {
+            Process(exists->query, scope, false);
+            return;
+        }
+        ir::ForEachChild(*expr, [&](ir::ExprPtr &child) { Descend(child, scope); });
+    }
+};
+
+} // namespace lang::ast::cypher::passes
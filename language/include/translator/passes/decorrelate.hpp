@@ -0,0 +1,268 @@
+#pragma once
+
+#include <translator/ir.hpp>
+#include <translator/pass.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lang::ast::cypher::passes
+{
+
+// Turns `[NOT] EXISTS { MATCH pattern WHERE w }` conjuncts of a rule's main MATCH into a
+// semi-join against a set computed once, before the MATCH:
+//
+//   OPTIONAL MATCH pattern WHERE w WITH collect(DISTINCT elementId(c)) AS __q0
+//   MATCH (c:Container) WHERE ... AND elementId(c) IN __q0
+//
+// The inner pattern is expanded from its own label instead of from every outer row, so the
+// cost follows the number of matching inner rows, not their product with the outer ones.
+// Filters of the main MATCH that only read the keys are copied into `w` to keep the set
+// small. A subquery that reads no variable of the main MATCH is counted once instead.
+class Decorrelation : public ir::Pass
+{
+public:
+    static constexpr auto prefix = "__q";
+
+    [[nodiscard]] std::string_view Name() const override
+    {
+        return "decorrelate";
+    }
+
+    void Run(ir::Query &query) override
+    {
+        counter_ = 0;
+        std::set<std::string> scope;
+        for (std::size_t i = 0; i < query.clauses.size(); ++i)
+        {
+            const auto before = scope;
+            ir::Bind(query.clauses[i], scope);
+            auto *match = std::get_if<ir::Match>(&query.clauses[i]);
+            if (match == nullptr || match->optional || !match->where)
+            {
+                continue;
+            }
+            const auto inserted = Rewrite(query, i, before, scope);
+            i += inserted;
+            scope = before;
+            for (std::size_t j = i - inserted; j <= i && j < query.clauses.size(); ++j)
+            {
+                ir::Bind(query.clauses[j], scope);
+            }
+        }
+    }
+
+private:
+    struct Candidate
+    {
+        ir::Match *match;
+        std::vector<std::string> keys;
+        std::string counted;
+        bool negated;
+    };
+
+    std::size_t counter_ = 0;
+
+    static bool Within(const std::set<std::string> &names, const std::set<std::string> &scope)
+    {
+        return std::ranges::includes(scope, names);
+    }
+
+    static bool HasSubquery(ir::ExprPtr &expr)
+    {
+        bool found = false;
+        ir::Rewrite(expr, [&](ir::ExprPtr &node)
+                    { found = found || ir::As<ir::Exists>(node) != nullptr; });
+        return found;
+    }
+
+    // The keys are the variables of the main MATCH the subquery reads; each must be a node of
+    // the inner pattern so the pattern binds it on its own.
+    static std::optional<Candidate> Extract(ir::ExprPtr &conjunct,
+                                            const std::set<std::string> &before,
+                                            const std::set<std::string> &after)
+    {
+        auto *expr = &conjunct;
+        bool negated = false;
+        while (auto *negation = ir::As<ir::Not>(*expr))
+        {
+            expr = &negation->operand;
+            negated = !negated;
+        }
+        auto *exists = ir::As<ir::Exists>(*expr);
+        if (exists == nullptr || exists->query.clauses.size() != 1)
+        {
+            return std::nullopt;
+        }
+        auto *inner = std::get_if<ir::Match>(&exists->query.clauses.front());
+        if (inner == nullptr || inner->optional || inner->patterns.size() != 1 ||
+            !inner->patterns.front().variable.empty())
+        {
+            return std::nullopt;
+        }
+
+        Candidate candidate{inner, {}, {}, negated};
+        const auto &nodes = inner->patterns.front().nodes;
+        const auto bound = [&](const std::string &name)
+        { return std::ranges::find(nodes, name, &ir::NodePattern::variable) != nodes.end(); };
+        for (const auto &name : ir::FreeVariables(*expr))
+        {
+            if (!after.contains(name) || before.contains(name))
+            {
+                continue;
+            }
+            if (!bound(name))
+            {
+                return std::nullopt;
+            }
+            candidate.keys.push_back(name);
+        }
+        for (const auto &node : nodes)
+        {
+            if (!node.variable.empty() && !after.contains(node.variable))
+            {
+                candidate.counted = node.variable;
+                break;
+            }
+        }
+        if (candidate.keys.empty() && candidate.counted.empty())
+        {
+            return std::nullopt;
+        }
+        return candidate;
+    }
+
+    // Rewrites the MATCH at `index`; returns the number of clauses inserted before it.
+    std::size_t Rewrite(ir::Query &query, std::size_t index, const std::set<std::string> &before,
+                        const std::set<std::string> &after)
+    {
+        auto &main = std::get<ir::Match>(query.clauses[index]);
+        auto conjuncts = ir::Conjuncts(std::move(main.where));
+        std::vector<std::optional<Candidate>> candidates;
+        for (auto &conjunct : conjuncts)
+        {
+            candidates.push_back(Extract(conjunct, before, after));
+        }
+
+        std::map<std::string, std::string> labels;
+        bool nodesOnly = true;
+        for (const auto &path : main.patterns)
+        {
+            nodesOnly = nodesOnly && path.variable.empty() && path.relationships.empty();
+            for (const auto &node : path.nodes)
+            {
+                if (!node.label.empty())
+                {
+                    labels.emplace(node.variable, node.label);
+                }
+            }
+        }
+
+        std::vector<ir::Clause> prologue;
+        std::vector<std::string> names;
+        for (std::size_t i = 0; i < conjuncts.size(); ++i)
+        {
+            if (!candidates[i])
+            {
+                continue;
+            }
+            auto &candidate = *candidates[i];
+            auto scope = before;
+            scope.insert(candidate.keys.begin(), candidate.keys.end());
+            std::vector<ir::ExprPtr> filters;
+            bool covered = nodesOnly;
+            for (std::size_t j = 0; j < conjuncts.size(); ++j)
+            {
+                if (candidates[j])
+                {
+                    continue;
+                }
+                if (Within(ir::FreeVariables(conjuncts[j]), scope) &&
+                    !ir::MayFail(conjuncts[j]) && !HasSubquery(conjuncts[j]))
+                {
+                    filters.push_back(ir::Clone(conjuncts[j]));
+                }
+                else
+                {
+                    covered = false;
+                }
+            }
+            // `w` now sees inner rows of outer rows the MATCH would have rejected.
+            if (ir::MayFail(candidate.match->where) && (candidate.keys.empty() || !covered))
+            {
+                continue;
+            }
+
+            const auto name = prefix + std::to_string(counter_++);
+            ir::Match match = std::move(*candidate.match);
+            match.optional = true;
+            for (auto &node : match.patterns.front().nodes)
+            {
+                if (node.label.empty() && labels.contains(node.variable))
+                {
+                    node.label = labels.at(node.variable);
+                }
+            }
+            if (!candidate.keys.empty())
+            {
+                filters.push_back(std::move(match.where));
+                match.where = ir::Combine(ExprType::AND, std::move(filters));
+            }
+
+            ir::With with;
+            for (const auto &variable : before)
+            {
+                with.items.push_back(ir::Projection{ir::Make<ir::Variable>(variable), ""});
+            }
+            for (const auto &variable : names)
+            {
+                with.items.push_back(ir::Projection{ir::Make<ir::Variable>(variable), ""});
+            }
+            ir::ExprPtr check;
+            if (candidate.keys.empty())
+            {
+                with.items.push_back(ir::Projection{
+                    ir::Make<ir::Aggregate>("count", ir::Make<ir::Variable>(candidate.counted)),
+                    name});
+                check = ir::Make<ir::Binary>(
+                    candidate.negated ? ExprType::EQ : ExprType::GREATER,
+                    ir::Make<ir::Variable>(name),
+                    ir::Make<ir::Literal>(ir::LiteralValue{std::int64_t{0}}));
+            }
+            else
+            {
+                with.items.push_back(ir::Projection{
+                    ir::Make<ir::Aggregate>("collect", ir::ElementKey(candidate.keys), true),
+                    name});
+                check = ir::Make<ir::Binary>(ExprType::IN, ir::ElementKey(candidate.keys),
+                                             ir::Make<ir::Variable>(name));
+                if (candidate.negated)
+                {
+                    check = ir::Make<ir::Not>(std::move(check));
+                }
+            }
+            prologue.emplace_back(std::move(match));
+            prologue.emplace_back(std::move(with));
+            names.push_back(name);
+            conjuncts[i] = std::move(check);
+        }
+        main.where = ir::Combine(ExprType::AND, std::move(conjuncts));
+
+        query.clauses.insert(query.clauses.begin() + static_cast<std::ptrdiff_t>(index),
+                             std::make_move_iterator(prologue.begin()),
+                             std::make_move_iterator(prologue.end()));
+        return prologue.size();
+    }
+};
+
+} // namespace lang::ast::cypher::passes
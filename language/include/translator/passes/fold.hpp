@@ -0,0 +1,670 @@
+#pragma once
+
+#include <translator/ir.hpp>
+#include <translator/pass.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lang::ast::cypher::passes
+{
+
+namespace detail
+{
+
+inline bool IsConstant(const ir::ExprPtr &expr)
+{
+    if (ir::As<ir::Literal>(expr) != nullptr)
+    {
+        return true;
+    }
+    const auto *list = ir::As<ir::List>(expr);
+    return list != nullptr && std::ranges::all_of(list->items, &IsConstant);
+}
+
+// Total order over constants: booleans, integers, strings, then lists.
+inline int Compare(const ir::ExprPtr &left, const ir::ExprPtr &right)
+{
+    const auto rank = [](const ir::ExprPtr &expr) -> int
+    {
+        if (const auto *lit = ir::As<ir::Literal>(expr); lit != nullptr)
+        {
+            return std::visit(
+                [](const auto &value) -> int
+                {
+                    using V = std::decay_t<decltype(value)>;
+                    if constexpr (std::is_same_v<V, bool>)
+                    {
+                        return 0;
+                    }
+                    else if constexpr (std::is_same_v<V, std::int64_t>)
+                    {
+                        return 1;
+                    }
+                    return 2;
+                },
+                lit->value);
+        }
+        return 3;
+    };
+    const auto three = [](const auto &a, const auto &b) { return a < b ? -1 : (b < a ? 1 : 0); };
+
+    const auto leftRank = rank(left);
+    const auto rightRank = rank(right);
+    if (leftRank != rightRank)
+    {
+        return three(leftRank, rightRank);
+    }
+    if (leftRank < 3)
+    {
+        return three(ir::As<ir::Literal>(left)->value, ir::As<ir::Literal>(right)->value);
+    }
+    const auto &leftItems = ir::As<ir::List>(left)->items;
+    const auto &rightItems = ir::As<ir::List>(right)->items;
+    for (std::size_t i = 0; i < std::min(leftItems.size(), rightItems.size()); ++i)
+    {
+        if (const auto order = Compare(leftItems[i], rightItems[i]); order != 0)
+        {
+            return order;
+        }
+    }
+    return three(leftItems.size(), rightItems.size());
+}
+
+inline ir::ExprPtr Bool(bool value)
+{
+    return ir::Make<ir::Literal>(ir::LiteralValue{value});
+}
+
+inline const bool *AsBool(const ir::ExprPtr &expr)
+{
+    const auto *lit = ir::As<ir::Literal>(expr);
+    return lit != nullptr ? std::get_if<bool>(&lit->value) : nullptr;
+}
+
+inline const std::int64_t *AsInt(const ir::ExprPtr &expr)
+{
+    const auto *lit = ir::As<ir::Literal>(expr);
+    return lit != nullptr ? std::get_if<std::int64_t>(&lit->value) : nullptr;
+}
+
+inline const std::string *AsString(const ir::ExprPtr &expr)
+{
+    const auto *lit = ir::As<ir::Literal>(expr);
+    return lit != nullptr ? std::get_if<std::string>(&lit->value) : nullptr;
+}
+
+// Literal lists are sets in the rule language: sort and deduplicate them.
+inline void Canonicalize(std::vector<ir::ExprPtr> &items)
+{
+    std::ranges::sort(items, [](const auto &a, const auto &b) { return Compare(a, b) < 0; });
+    const auto [first, last] = std::ranges::unique(
+        items, [](const auto &a, const auto &b) { return Compare(a, b) == 0; });
+    items.erase(first, last);
+}
+
+inline bool Contains(const std::vector<ir::ExprPtr> &items, const ir::ExprPtr &value)
+{
+    return std::ranges::any_of(items, [&](const auto &item) { return Compare(item, value) == 0; });
+}
+
+inline std::string Fresh(const std::vector<const ir::ExprPtr *> &exprs)
+{
+    std::set<std::string> used;
+    for (const auto *expr : exprs)
+    {
+        used.merge(ir::FreeVariables(*expr));
+    }
+    std::string name = "x";
+    for (std::size_t i = 1; used.contains(name); ++i)
+    {
+        name = "x" + std::to_string(i);
+    }
+    return name;
+}
+
+} // namespace detail
+
+// Evaluates literal-only subexpressions at translate time. Literal values bound with WITH
+// (rule-level assignments) are propagated into their uses, literal sets are deduplicated and
+// sorted, and set functions with a literal side are lowered to the cheapest list predicate.
+class ConstantFolding : public ir::Pass
+{
+public:
+    using Constants = std::map<std::string, ir::ExprPtr>;
+
+    [[nodiscard]] std::string_view Name() const override
+    {
+        return "fold";
+    }
+
+    void Run(ir::Query &query) override
+    {
+        Constants constants;
+        for (std::size_t i = 0; i < query.clauses.size();)
+        {
+            auto &clause = query.clauses[i];
+            ir::ForEachExpr(clause,
+                            [&](ir::ExprPtr &expr)
+                            {
+                                Substitute(expr, constants);
+                                Fold(expr);
+                            });
+            if (auto *where = WhereOf(clause); where != nullptr)
+            {
+                if (const auto *value = detail::AsBool(*where); value != nullptr && *value)
+                {
+                    *where = nullptr;
+                }
+            }
+            auto *with = std::get_if<ir::With>(&clause);
+            if (with != nullptr && Propagate(*with, constants, i == 0))
+            {
+                query.clauses.erase(query.clauses.begin() + static_cast<std::ptrdiff_t>(i));
+                continue;
+            }
+            ++i;
+        }
+    }
+
+    static void Fold(ir::ExprPtr &expr)
+    {
+        ir::Rewrite(expr, [](ir::ExprPtr &node) { FoldNode(node); });
+    }
+
+private:
+    static ir::ExprPtr *WhereOf(ir::Clause &clause)
+    {
+        if (auto *match = std::get_if<ir::Match>(&clause); match != nullptr)
+        {
+            return &match->where;
+        }
+        if (auto *with = std::get_if<ir::With>(&clause); with != nullptr)
+        {
+            return &with->where;
+        }
+        return nullptr;
+    }
+
+    // Moves literal projections of `with` into `constants`; returns true when nothing is left
+    // of the clause. A `first` clause has nothing in scope to carry over with `*`.
+    static bool Propagate(ir::With &with, Constants &constants, bool first)
+    {
+        Constants bound;
+        std::erase_if(with.items,
+                      [&](auto &item)
+                      {
+                          if (item.alias.empty() || !detail::IsConstant(item.expr))
+                          {
+                              return false;
+                          }
+                          bound[item.alias] = std::move(item.expr);
+                          return true;
+                      });
+        Substitute(with.where, bound);
+        Fold(with.where);
+        if (const auto *value = detail::AsBool(with.where); value != nullptr && *value)
+        {
+            with.where = nullptr;
+        }
+        // A later assignment replaces the value of an earlier one, constant or not.
+        for (const auto &item : with.items)
+        {
+            constants.erase(item.alias);
+        }
+        for (auto &[name, value] : bound)
+        {
+            constants.insert_or_assign(name, std::move(value));
+        }
+        if (first && ir::CarriesScope(with) && with.items.size() > 1)
+        {
+            with.items.erase(with.items.begin());
+        }
+        const auto carries = ir::CarriesScope(with);
+        if (with.items.size() > static_cast<std::size_t>(carries))
+        {
+            return false;
+        }
+        if (with.where)
+        {
+            if (!carries)
+            {
+                with.items.push_back(ir::Projection{ir::Make<ir::Raw>("*"), ""});
+            }
+            return false;
+        }
+        return true;
+    }
+
+    static void Substitute(ir::ExprPtr &expr, const Constants &constants)
+    {
+        if (!expr || constants.empty())
+        {
+            return;
+        }
+        if (const auto *var = ir::As<ir::Variable>(expr); var != nullptr)
+        {
+            if (const auto it = constants.find(var->name); it != constants.end())
+            {
+                expr = ir::Clone(it->second);
+            }
+            return;
+        }
+        const auto iterate = [&](auto &node)
+        {
+            Substitute(node.source, constants);
+            if (constants.contains(node.variable))
+            {
+                Constants shadowed;
+                for (const auto &[name, value] : constants)
+                {
+                    if (name != node.variable)
+                    {
+                        shadowed[name] = ir::Clone(value);
+                    }
+                }
+                Substitute(node.where, shadowed);
+                return;
+            }
+            Substitute(node.where, constants);
+        };
+        if (auto *list = ir::As<ir::ListComprehension>(expr); list != nullptr)
+        {
+            iterate(*list);
+            return;
+        }
+        if (auto *list = ir::As<ir::ListPredicate>(expr); list != nullptr)
+        {
+            iterate(*list);
+            return;
+        }
+        ir::ForEachChild(*expr, [&](ir::ExprPtr &child) { Substitute(child, constants); });
+    }
+
+    static void FoldNode(ir::ExprPtr &expr)
+    {
+        std::visit(
+            [&](auto &node)
+            {
+                using T = typename std::decay_t<decltype(node)>::element_type;
+                if constexpr (std::is_same_v<T, ir::List>)
+                {
+                    if (detail::IsConstant(expr))
+                    {
+                        detail::Canonicalize(node->items);
+                    }
+                }
+                else if constexpr (std::is_same_v<T, ir::Unary>)
+                {
+                    const auto *value = detail::AsInt(node->operand);
+                    if (node->op == ExprType::NEG && value != nullptr &&
+                        *value != std::numeric_limits<std::int64_t>::min())
+                    {
+                        expr = ir::Make<ir::Literal>(ir::LiteralValue{-*value});
+                    }
+                }
+                else if constexpr (std::is_same_v<T, ir::Not>)
+                {
+                    if (const auto *value = detail::AsBool(node->operand); value != nullptr)
+                    {
+                        expr = detail::Bool(!*value);
+                    }
+                }
+                else if constexpr (std::is_same_v<T, ir::Binary>)
+                {
+                    FoldBinary(expr, *node);
+                }
+                else if constexpr (std::is_same_v<T, ir::Logical>)
+                {
+                    FoldLogical(expr, *node);
+                }
+                else if constexpr (std::is_same_v<T, ir::Case>)
+                {
+                    if (const auto *value = detail::AsBool(node->condition); value != nullptr)
+                    {
+                        auto branch = std::move(*value ? node->thenExpr : node->elseExpr);
+                        expr = std::move(branch);
+                    }
+                }
+                else if constexpr (std::is_same_v<T, ir::Call>)
+                {
+                    FoldCall(expr, *node);
+                }
+                else if constexpr (std::is_same_v<T, ir::ListComprehension>)
+                {
+                    const auto *source = ir::As<ir::List>(node->source);
+                    if (source != nullptr && source->items.empty())
+                    {
+                        expr = ir::Make<ir::List>();
+                    }
+                }
+                else if constexpr (std::is_same_v<T, ir::ListPredicate>)
+                {
+                    FoldPredicate(expr, *node);
+                }
+            },
+            *expr);
+    }
+
+    static void FoldBinary(ir::ExprPtr &expr, ir::Binary &node)
+    {
+        const auto constant = detail::IsConstant(node.left) && detail::IsConstant(node.right);
+        switch (node.op)
+        {
+        case ExprType::PLUS:
+        case ExprType::MINUS:
+        case ExprType::MULT:
+        case ExprType::DIV: {
+            FoldArithmetic(expr, node);
+            return;
+        }
+        case ExprType::EQ:
+        case ExprType::NOT_EQ: {
+            if (constant)
+            {
+                const auto equal = detail::Compare(node.left, node.right) == 0;
+                expr = detail::Bool(equal == (node.op == ExprType::EQ));
+                return;
+            }
+            FoldEmptiness(expr, node);
+            return;
+        }
+        case ExprType::LESS:
+        case ExprType::GREATER:
+        case ExprType::LESS_EQ:
+        case ExprType::GREATER_EQ: {
+            const auto *leftLit = ir::As<ir::Literal>(node.left);
+            const auto *rightLit = ir::As<ir::Literal>(node.right);
+            if (leftLit == nullptr || rightLit == nullptr ||
+                leftLit->value.index() != rightLit->value.index())
+            {
+                return;
+            }
+            const auto order = detail::Compare(node.left, node.right);
+            const auto result = node.op == ExprType::LESS      ? order < 0
+                                : node.op == ExprType::GREATER ? order > 0
+                                : node.op == ExprType::LESS_EQ ? order <= 0
+                                                               : order >= 0;
+            expr = detail::Bool(result);
+            return;
+        }
+        case ExprType::IN:
+        case ExprType::NOT_IN: {
+            auto *list = ir::As<ir::List>(node.right);
+            if (list == nullptr || !detail::IsConstant(node.right))
+            {
+                return;
+            }
+            const auto positive = node.op == ExprType::IN;
+            if (detail::IsConstant(node.left))
+            {
+                expr = detail::Bool(detail::Contains(list->items, node.left) == positive);
+            }
+            else if (list->items.empty())
+            {
+                expr = detail::Bool(!positive);
+            }
+            else if (list->items.size() == 1)
+            {
+                auto value = std::move(list->items.front());
+                expr = ir::Make<ir::Binary>(positive ? ExprType::EQ : ExprType::NOT_EQ,
+                                            std::move(node.left), std::move(value));
+            }
+            return;
+        }
+        default:
+            return;
+        }
+    }
+
+    static void FoldArithmetic(ir::ExprPtr &expr, ir::Binary &node)
+    {
+        if (node.op == ExprType::PLUS)
+        {
+            const auto *leftStr = detail::AsString(node.left);
+            const auto *rightStr = detail::AsString(node.right);
+            if (leftStr != nullptr && rightStr != nullptr)
+            {
+                expr = ir::Make<ir::Literal>(ir::LiteralValue{*leftStr + *rightStr});
+                return;
+            }
+            auto *leftList = ir::As<ir::List>(node.left);
+            auto *rightList = ir::As<ir::List>(node.right);
+            if (leftList != nullptr && rightList != nullptr && detail::IsConstant(node.left) &&
+                detail::IsConstant(node.right))
+            {
+                auto items = std::move(leftList->items);
+                std::ranges::move(rightList->items, std::back_inserter(items));
+                detail::Canonicalize(items);
+                expr = ir::Make<ir::List>(std::move(items));
+                return;
+            }
+        }
+        const auto *left = detail::AsInt(node.left);
+        const auto *right = detail::AsInt(node.right);
+        if (left == nullptr || right == nullptr)
+        {
+            return;
+        }
+        std::int64_t result = 0;
+        bool overflow = false;
+        switch (node.op)
+        {
+        case ExprType::PLUS:
+            overflow = __builtin_add_overflow(*left, *right, &result);
+            break;
+        case ExprType::MINUS:
+            overflow = __builtin_sub_overflow(*left, *right, &result);
+            break;
+        case ExprType::MULT:
+            overflow = __builtin_mul_overflow(*left, *right, &result);
+            break;
+        default:
+            // Division by zero and INT64_MIN / -1 are left for the database to report.
+            overflow = *right == 0 ||
+                       (*right == -1 && *left == std::numeric_limits<std::int64_t>::min());
+            result = overflow ? 0 : *left / *right;
+            break;
+        }
+        if (!overflow)
+        {
+            expr = ir::Make<ir::Literal>(ir::LiteralValue{result});
+        }
+    }
+
+    // `[x IN s WHERE w] = []` is `none(x IN s WHERE w)`: the list is never built.
+    static void FoldEmptiness(ir::ExprPtr &expr, ir::Binary &node)
+    {
+        const auto empty = [](const ir::ExprPtr &side)
+        {
+            const auto *list = ir::As<ir::List>(side);
+            return list != nullptr && list->items.empty();
+        };
+        auto *comprehension = ir::As<ir::ListComprehension>(node.left);
+        if (comprehension == nullptr || !empty(node.right))
+        {
+            comprehension = ir::As<ir::ListComprehension>(node.right);
+            if (comprehension == nullptr || !empty(node.left))
+            {
+                return;
+            }
+        }
+        expr = ir::Make<ir::ListPredicate>(
+            node.op == ExprType::EQ ? ir::ListQuantifier::NONE : ir::ListQuantifier::ANY,
+            std::move(comprehension->variable), std::move(comprehension->source),
+            std::move(comprehension->where));
+        Fold(expr);
+    }
+
+    static void FoldLogical(ir::ExprPtr &expr, ir::Logical &node)
+    {
+        std::vector<ir::ExprPtr> rest;
+        bool parity = false;
+        for (auto &operand : node.operands)
+        {
+            const auto *value = detail::AsBool(operand);
+            if (value == nullptr)
+            {
+                rest.push_back(std::move(operand));
+                continue;
+            }
+            if (node.op == ExprType::XOR)
+            {
+                parity = parity != *value;
+                continue;
+            }
+            // `false AND x` and `true OR x` do not depend on x, even when x is null.
+            if (*value == (node.op == ExprType::OR))
+            {
+                expr = detail::Bool(*value);
+                return;
+            }
+        }
+        auto combined = ir::Combine(node.op, std::move(rest));
+        if (!combined)
+        {
+            expr = detail::Bool(node.op == ExprType::XOR ? parity : node.op == ExprType::AND);
+            return;
+        }
+        if (parity)
+        {
+            combined = ir::Make<ir::Not>(std::move(combined));
+        }
+        expr = std::move(combined);
+    }
+
+    static void FoldCall(ir::ExprPtr &expr, ir::Call &node)
+    {
+        if ((node.name != "cross" && node.name != "union") || node.args.size() != 2)
+        {
+            return;
+        }
+        auto &left = node.args.front();
+        auto &right = node.args.back();
+        auto *leftList = ir::As<ir::List>(left);
+        auto *rightList = ir::As<ir::List>(right);
+        const auto leftConstant = leftList != nullptr && detail::IsConstant(left);
+        const auto rightConstant = rightList != nullptr && detail::IsConstant(right);
+
+        if (node.name == "cross")
+        {
+            if ((leftConstant && leftList->items.empty()) ||
+                (rightConstant && rightList->items.empty()))
+            {
+                expr = ir::Make<ir::List>();
+                return;
+            }
+            if (leftConstant && rightConstant)
+            {
+                std::vector<ir::ExprPtr> items;
+                for (auto &item : leftList->items)
+                {
+                    if (detail::Contains(rightList->items, item))
+                    {
+                        items.push_back(std::move(item));
+                    }
+                }
+                detail::Canonicalize(items);
+                expr = ir::Make<ir::List>(std::move(items));
+                return;
+            }
+            if (leftConstant || rightConstant)
+            {
+                auto variable = detail::Fresh({&left, &right});
+                auto where = ir::Make<ir::Binary>(ExprType::IN, ir::Make<ir::Variable>(variable),
+                                                  std::move(right));
+                expr = ir::Make<ir::ListComprehension>(std::move(variable), std::move(left),
+                                                       std::move(where));
+                Fold(expr);
+            }
+            return;
+        }
+
+        if (leftConstant && rightConstant)
+        {
+            auto items = std::move(leftList->items);
+            std::ranges::move(rightList->items, std::back_inserter(items));
+            detail::Canonicalize(items);
+            expr = ir::Make<ir::List>(std::move(items));
+            return;
+        }
+        // union(e, L) without the UNWIND/collect pipeline: `e + [x IN L WHERE NOT x IN e]`,
+        // only when `e` is cheap enough to read twice.
+        if (leftConstant != rightConstant)
+        {
+            auto &value = leftConstant ? right : left;
+            auto &literal = leftConstant ? left : right;
+            if (ir::As<ir::Variable>(value) == nullptr && ir::As<ir::Property>(value) == nullptr)
+            {
+                return;
+            }
+            auto variable = detail::Fresh({&value});
+            auto where = ir::Make<ir::Binary>(ExprType::NOT_IN, ir::Make<ir::Variable>(variable),
+                                              ir::Clone(value));
+            auto missing = ir::Make<ir::ListComprehension>(std::move(variable), std::move(literal),
+                                                           std::move(where));
+            expr = ir::Make<ir::Binary>(ExprType::PLUS, std::move(value), std::move(missing));
+            Fold(expr);
+        }
+    }
+
+    static void FoldPredicate(ir::ExprPtr &expr, ir::ListPredicate &node)
+    {
+        const auto *source = ir::As<ir::List>(node.source);
+        if (source != nullptr && source->items.empty())
+        {
+            expr = detail::Bool(node.quantifier != ir::ListQuantifier::ANY);
+            return;
+        }
+        if (node.quantifier == ir::ListQuantifier::ALL)
+        {
+            return;
+        }
+        const auto positive = node.quantifier == ir::ListQuantifier::ANY;
+        const auto wrap = [&](ir::ExprPtr result)
+        { return positive ? std::move(result) : ir::Make<ir::Not>(std::move(result)); };
+
+        // any(x IN [c] WHERE w) is w with x bound to c.
+        if (source != nullptr && source->items.size() == 1 && detail::IsConstant(node.source))
+        {
+            Constants binding;
+            binding[node.variable] = ir::Clone(source->items.front());
+            Substitute(node.where, binding);
+            expr = wrap(std::move(node.where));
+            Fold(expr);
+            return;
+        }
+        // any(x IN s WHERE x = c) is `c IN s`.
+        auto *equality = ir::As<ir::Binary>(node.where);
+        if (equality == nullptr || equality->op != ExprType::EQ)
+        {
+            return;
+        }
+        const auto *var = ir::As<ir::Variable>(equality->left);
+        auto *value = &equality->right;
+        if (var == nullptr || var->name != node.variable)
+        {
+            var = ir::As<ir::Variable>(equality->right);
+            value = &equality->left;
+        }
+        if (var == nullptr || var->name != node.variable ||
+            ir::FreeVariables(*value).contains(node.variable))
+        {
+            return;
+        }
+        expr = wrap(ir::Make<ir::Binary>(ExprType::IN, std::move(*value), std::move(node.source)));
+    }
+};
+
+} // namespace lang::ast::cypher::passes
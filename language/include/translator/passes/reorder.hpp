@@ -0,0 +1,305 @@
+#pragma once
+
+#include <translator/ir.hpp>
+#include <translator/pass.hpp>
+#include <translator/statistics.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lang::ast::cypher::passes
+{
+
+// Orders the operands of every AND by estimated cost per filtered row, so that cheap and
+// selective checks (property equality, then list membership) run before subqueries and path
+// expansions. Operands that may raise an error (division, raw Cypher) are barriers: nothing
+// is moved across them, so a guard written before them keeps guarding them. List operations
+// on properties are not: the converter writes every list-valued property as a list.
+class ConjunctReordering : public ir::Pass
+{
+public:
+    static constexpr double propertyCost = 1.0;
+    static constexpr double membershipCost = 2.0;
+    static constexpr double listCost = 8.0;
+    static constexpr double subqueryCost = 50.0;
+    static constexpr double pathCost = 200.0;
+
+    explicit ConjunctReordering(Statistics statistics = {}) : statistics_(std::move(statistics))
+    {
+    }
+
+    [[nodiscard]] std::string_view Name() const override
+    {
+        return "reorder";
+    }
+
+    void Run(ir::Query &query) override
+    {
+        ir::Rewrite(query,
+                    [&](ir::ExprPtr &expr)
+                    {
+                        if (auto *logical = ir::As<ir::Logical>(expr);
+                            logical != nullptr && logical->op == ExprType::AND)
+                        {
+                            Reorder(*logical);
+                        }
+                    });
+    }
+
+    [[nodiscard]] double Cost(const ir::ExprPtr &expr) const
+    {
+        if (!expr)
+        {
+            return 0.0;
+        }
+        return std::visit([&](const auto &node) -> double { return Cost(*node); }, *expr);
+    }
+
+    // Estimated probability that the predicate holds for a row.
+    [[nodiscard]] double Selectivity(const ir::ExprPtr &expr) const
+    {
+        if (const auto *negation = ir::As<ir::Not>(expr); negation != nullptr)
+        {
+            return 1.0 - Selectivity(negation->operand);
+        }
+        if (const auto *logical = ir::As<ir::Logical>(expr); logical != nullptr)
+        {
+            double none = 1.0;
+            double all = 1.0;
+            for (const auto &operand : logical->operands)
+            {
+                const auto selectivity = Selectivity(operand);
+                all *= selectivity;
+                none *= 1.0 - selectivity;
+            }
+            return logical->op == ExprType::AND ? all
+                   : logical->op == ExprType::OR ? 1.0 - none
+                                                 : 0.5;
+        }
+        if (const auto *binary = ir::As<ir::Binary>(expr); binary != nullptr)
+        {
+            switch (binary->op)
+            {
+            case ExprType::EQ:
+                return PropertySelectivity(*binary, 0.1);
+            case ExprType::NOT_EQ:
+                return 1.0 - PropertySelectivity(*binary, 0.1);
+            case ExprType::IN:
+                return PropertySelectivity(*binary, 0.3);
+            case ExprType::NOT_IN:
+                return 1.0 - PropertySelectivity(*binary, 0.3);
+            case ExprType::LESS:
+            case ExprType::GREATER:
+            case ExprType::LESS_EQ:
+            case ExprType::GREATER_EQ:
+                return 1.0 / 3.0;
+            default:
+                break;
+            }
+        }
+        return 0.5;
+    }
+
+private:
+    Statistics statistics_;
+
+    // Rank of `a AND b` ordering: cost paid per row divided by the fraction of rows the
+    // operand removes.
+    [[nodiscard]] double Rank(const ir::ExprPtr &expr) const
+    {
+        const auto rejected = std::max(1.0 - Selectivity(expr), 0.01);
+        return Cost(expr) / rejected;
+    }
+
+    void Reorder(ir::Logical &logical) const
+    {
+        auto begin = logical.operands.begin();
+        while (begin != logical.operands.end())
+        {
+            auto end = std::find_if(begin, logical.operands.end(), [](const ir::ExprPtr &expr)
+                                    { return ir::MayFail(expr, false); });
+            std::vector<std::pair<double, ir::ExprPtr>> segment;
+            for (auto it = begin; it != end; ++it)
+            {
+                const auto rank = Rank(*it);
+                segment.emplace_back(rank, std::move(*it));
+            }
+            std::ranges::stable_sort(segment, {}, &std::pair<double, ir::ExprPtr>::first);
+            for (auto &[rank, operand] : segment)
+            {
+                *begin++ = std::move(operand);
+            }
+            begin = end == logical.operands.end() ? end : end + 1;
+        }
+    }
+
+    [[nodiscard]] double PropertySelectivity(const ir::Binary &binary, double fallback) const
+    {
+        for (const auto *side : {&binary.left, &binary.right})
+        {
+            if (const auto *property = ir::As<ir::Property>(*side); property != nullptr)
+            {
+                if (const auto it = statistics_.properties.find(property->name);
+                    it != statistics_.properties.end())
+                {
+                    return it->second;
+                }
+            }
+        }
+        return fallback;
+    }
+
+    double Cost(const ir::Literal & /*unused*/) const
+    {
+        return 0.0;
+    }
+
+    double Cost(const ir::Variable & /*unused*/) const
+    {
+        return 0.0;
+    }
+
+    double Cost(const ir::Raw & /*unused*/) const
+    {
+        return propertyCost;
+    }
+
+    double Cost(const ir::List &list) const
+    {
+        double cost = 0.0;
+        for (const auto &item : list.items)
+        {
+            cost += Cost(item);
+        }
+        return cost;
+    }
+
+    double Cost(const ir::Property &property) const
+    {
+        return propertyCost + Cost(property.operand);
+    }
+
+    double Cost(const ir::Unary &unary) const
+    {
+        return Cost(unary.operand);
+    }
+
+    double Cost(const ir::Not &negation) const
+    {
+        return Cost(negation.operand);
+    }
+
+    double Cost(const ir::Binary &binary) const
+    {
+        const auto membership = binary.op == ExprType::IN || binary.op == ExprType::NOT_IN;
+        return (membership ? membershipCost : propertyCost) + Cost(binary.left) +
+               Cost(binary.right);
+    }
+
+    double Cost(const ir::Logical &logical) const
+    {
+        double cost = 0.0;
+        for (const auto &operand : logical.operands)
+        {
+            cost += Cost(operand);
+        }
+        return cost;
+    }
+
+    double Cost(const ir::Case &node) const
+    {
+        return Cost(node.condition) + std::max(Cost(node.thenExpr), Cost(node.elseExpr));
+    }
+
+    double Cost(const ir::Call &call) const
+    {
+        double cost = call.name == "route"   ? pathCost
+                      : call.name == "cross" ? listCost
+                      : call.name == "union" ? listCost
+                                             : propertyCost;
+        for (const auto &arg : call.args)
+        {
+            cost += Cost(arg);
+        }
+        return cost;
+    }
+
+    double Cost(const ir::ListComprehension &list) const
+    {
+        return listCost + Cost(list.source) + Cost(list.where);
+    }
+
+    double Cost(const ir::ListPredicate &list) const
+    {
+        return listCost + Cost(list.source) + Cost(list.where);
+    }
+
+    double Cost(const ir::Aggregate &aggregate) const
+    {
+        return listCost + Cost(aggregate.operand);
+    }
+
+    double Cost(const ir::Exists &exists) const
+    {
+        double cost = subqueryCost;
+        for (const auto &clause : exists.query.clauses)
+        {
+            std::visit(
+                [&](const auto &node)
+                {
+                    using T = std::decay_t<decltype(node)>;
+                    if constexpr (std::is_same_v<T, ir::Match>)
+                    {
+                        for (const auto &path : node.patterns)
+                        {
+                            cost += Cost(path);
+                        }
+                        cost += Cost(node.where);
+                    }
+                    else if constexpr (std::is_same_v<T, ir::Unwind>)
+                    {
+                        cost += listCost + Cost(node.list);
+                    }
+                    else
+                    {
+                        for (const auto &item : node.items)
+                        {
+                            cost += Cost(item.expr);
+                        }
+                        if constexpr (std::is_same_v<T, ir::With>)
+                        {
+                            cost += Cost(node.where);
+                        }
+                    }
+                },
+                clause);
+        }
+        return cost;
+    }
+
+    // Variable-length relationships are expansions; a labelled node costs a label scan
+    // proportional to the label size when statistics are known.
+    double Cost(const ir::PathPattern &path) const
+    {
+        double cost = 0.0;
+        for (const auto &relationship : path.relationships)
+        {
+            cost += relationship.length.empty() ? propertyCost : pathCost;
+        }
+        for (const auto &node : path.nodes)
+        {
+            if (const auto it = statistics_.labels.find(node.label); it != statistics_.labels.end())
+            {
+                cost += static_cast<double>(it->second) / 100.0;
+            }
+        }
+        return cost;
+    }
+};
+
+} // namespace lang::ast::cypher::passes
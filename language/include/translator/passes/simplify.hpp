@@ -0,0 +1,52 @@
+#pragma once
+
+#include <translator/ir.hpp>
+#include <translator/pass.hpp>
+
+#include <string_view>
+#include <utility>
+
+namespace lang::ast::cypher::passes
+{
+
+// Removes the `NOT (NOT EXISTS { ... })` pairs produced by nested `all` quantifiers, folds
+// `NOT (x NOT IN y)` back to `x IN y` and re-flattens AND/OR/XOR chains after other rewrites.
+class Simplify : public ir::Pass
+{
+public:
+    [[nodiscard]] std::string_view Name() const override
+    {
+        return "simplify";
+    }
+
+    void Run(ir::Query &query) override
+    {
+        ir::Rewrite(query,
+                    [](ir::ExprPtr &expr)
+                    {
+                        if (auto *outer = ir::As<ir::Not>(expr); outer != nullptr)
+                        {
+                            if (auto *inner = ir::As<ir::Not>(outer->operand); inner != nullptr)
+                            {
+                                auto operand = std::move(inner->operand);
+                                expr = std::move(operand);
+                                return;
+                            }
+                            if (auto *inner = ir::As<ir::Binary>(outer->operand);
+                                inner != nullptr && inner->op == ExprType::NOT_IN)
+                            {
+                                inner->op = ExprType::IN;
+                                auto operand = std::move(outer->operand);
+                                expr = std::move(operand);
+                            }
+                            return;
+                        }
+                        if (auto *logical = ir::As<ir::Logical>(expr); logical != nullptr)
+                        {
+                            expr = ir::Combine(logical->op, std::move(logical->operands));
+                        }
+                    });
+    }
+};
+
+} // namespace lang::ast::cypher::passes
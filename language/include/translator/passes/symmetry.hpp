@@ -0,0 +1,357 @@
+#pragma once
+
+#include <translator/ir.hpp>
+#include <translator/pass.hpp>
+#include <translator/printer.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lang::ast::cypher::passes
+{
+
+// `s1, s2 in system` matches every pair of distinct systems in both orders. When the rest of
+// the query does not change under swapping the identifiers, the pairwise `s1 <> s2`
+// constraints are replaced by the ordered chain `elementId(s1) < elementId(s2) < ...`, so
+// each unordered tuple is matched once instead of n! times.
+//
+// Symmetry is checked syntactically: the query is printed in a canonical form (operands of
+// AND/OR/XOR/=/<> sorted, patterns and projections sorted) once as is and once for every
+// adjacent transposition of the identifiers. Directed paths such as `route(s1, s2)` are not
+// symmetric and keep the `<>` form.
+class SymmetryReduction : public ir::Pass
+{
+public:
+    [[nodiscard]] std::string_view Name() const override
+    {
+        return "symmetry";
+    }
+
+    void Run(ir::Query &query) override
+    {
+        Apply(query, {});
+    }
+
+private:
+    static void Apply(ir::Query &query, std::set<std::string> scope)
+    {
+        for (std::size_t i = 0; i < query.clauses.size(); ++i)
+        {
+            const auto before = scope;
+            ir::Bind(query.clauses[i], scope);
+            ir::ForEachExpr(query.clauses[i], [&](ir::ExprPtr &expr) { Nested(expr, scope); });
+            if (const auto *match = std::get_if<ir::Match>(&query.clauses[i]);
+                match == nullptr || match->optional || !match->where)
+            {
+                continue;
+            }
+            for (const auto &group : Groups(std::get<ir::Match>(query.clauses[i]), before))
+            {
+                Reduce(query, i, group);
+            }
+        }
+    }
+
+    static void Nested(ir::ExprPtr &expr, const std::set<std::string> &scope)
+    {
+        if (!expr)
+        {
+            return;
+        }
+        if (auto *exists = ir::As<ir::Exists>(expr); exists != nullptr)
+        {
+            Apply(exists->query, scope);
+            return;
+        }
+        ir::ForEachChild(*expr, [&](ir::ExprPtr &child) { Nested(child, scope); });
+    }
+
+    // Variables newly bound by single-node patterns, grouped by label in pattern order.
+    static std::vector<std::vector<std::string>> Groups(const ir::Match &match,
+                                                        const std::set<std::string> &before)
+    {
+        std::map<std::string, std::vector<std::string>> byLabel;
+        for (const auto &path : match.patterns)
+        {
+            if (!path.variable.empty() || path.nodes.size() != 1)
+            {
+                continue;
+            }
+            const auto &node = path.nodes.front();
+            if (!node.variable.empty() && !node.label.empty() && !before.contains(node.variable))
+            {
+                byLabel[node.label].push_back(node.variable);
+            }
+        }
+
+        std::vector<std::vector<std::string>> groups;
+        for (auto &[label, variables] : byLabel)
+        {
+            if (variables.size() > 1)
+            {
+                groups.push_back(std::move(variables));
+            }
+        }
+        return groups;
+    }
+
+    static bool Distinct(const ir::ExprPtr &expr, const std::string &a, const std::string &b)
+    {
+        const auto *binary = ir::As<ir::Binary>(expr);
+        if (binary == nullptr || binary->op != ExprType::NOT_EQ)
+        {
+            return false;
+        }
+        const auto *left = ir::As<ir::Variable>(binary->left);
+        const auto *right = ir::As<ir::Variable>(binary->right);
+        return left != nullptr && right != nullptr &&
+               ((left->name == a && right->name == b) || (left->name == b && right->name == a));
+    }
+
+    static void Reduce(ir::Query &query, std::size_t index, const std::vector<std::string> &group)
+    {
+        auto &match = std::get<ir::Match>(query.clauses[index]);
+        auto conjuncts = ir::Conjuncts(std::move(match.where));
+        std::vector<bool> distinct(conjuncts.size(), false);
+        bool complete = true;
+        for (std::size_t i = 0; i < group.size() && complete; ++i)
+        {
+            for (std::size_t j = i + 1; j < group.size() && complete; ++j)
+            {
+                const auto it =
+                    std::ranges::find_if(conjuncts, [&](const auto &conjunct)
+                                         { return Distinct(conjunct, group[i], group[j]); });
+                complete = it != conjuncts.end();
+                if (complete)
+                {
+                    distinct[static_cast<std::size_t>(it - conjuncts.begin())] = true;
+                }
+            }
+        }
+        if (!complete)
+        {
+            match.where = ir::Combine(ExprType::AND, std::move(conjuncts));
+            return;
+        }
+
+        std::vector<ir::ExprPtr> kept;
+        std::vector<ir::ExprPtr> removed;
+        std::size_t position = conjuncts.size();
+        for (std::size_t i = 0; i < conjuncts.size(); ++i)
+        {
+            if (distinct[i])
+            {
+                position = std::min(position, kept.size());
+            }
+            (distinct[i] ? removed : kept).push_back(std::move(conjuncts[i]));
+        }
+        match.where = ir::Combine(ExprType::AND, ir::Clone(kept));
+
+        auto replacement = Symmetric(query, group) ? Chain(group) : std::move(removed);
+        kept.insert(kept.begin() + static_cast<std::ptrdiff_t>(position),
+                    std::make_move_iterator(replacement.begin()),
+                    std::make_move_iterator(replacement.end()));
+        match.where = ir::Combine(ExprType::AND, std::move(kept));
+    }
+
+    static std::vector<ir::ExprPtr> Chain(const std::vector<std::string> &group)
+    {
+        const auto id = [](const std::string &variable)
+        {
+            std::vector<ir::ExprPtr> args;
+            args.push_back(ir::Make<ir::Variable>(variable));
+            return ir::Make<ir::Call>("elementId", std::move(args));
+        };
+        std::vector<ir::ExprPtr> chain;
+        for (std::size_t i = 0; i + 1 < group.size(); ++i)
+        {
+            chain.push_back(ir::Make<ir::Binary>(ExprType::LESS, id(group[i]), id(group[i + 1])));
+        }
+        return chain;
+    }
+
+    static bool Symmetric(const ir::Query &query, const std::vector<std::string> &group)
+    {
+        auto reference = ir::Clone(query);
+        bool opaque = false;
+        ir::Rewrite(reference,
+                    [&](ir::ExprPtr &expr)
+                    {
+                        if (const auto *raw = ir::As<ir::Raw>(expr); raw != nullptr)
+                        {
+                            opaque = opaque ||
+                                     std::ranges::any_of(group, [&](const auto &name)
+                                                         { return Mentions(raw->text, name); });
+                        }
+                    });
+        if (opaque)
+        {
+            return false;
+        }
+
+        const auto canonical = Canonical(std::move(reference));
+        for (std::size_t i = 0; i + 1 < group.size(); ++i)
+        {
+            auto swapped = ir::Clone(query);
+            Swap(swapped, group[i], group[i + 1]);
+            if (Canonical(std::move(swapped)) != canonical)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool Mentions(std::string_view text, std::string_view name)
+    {
+        const auto identifier = [](char c)
+        { return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_'; };
+        for (auto pos = text.find(name); pos != std::string_view::npos;
+             pos = text.find(name, pos + 1))
+        {
+            const auto end = pos + name.size();
+            if ((pos == 0 || !identifier(text[pos - 1])) &&
+                (end == text.size() || !identifier(text[end])))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void Swap(ir::Query &query, const std::string &a, const std::string &b)
+    {
+        const auto swap = [&](std::string &name) { name = name == a ? b : name == b ? a : name; };
+        const auto bindings = [&](ir::Query &target)
+        {
+            for (auto &clause : target.clauses)
+            {
+                std::visit(
+                    [&](auto &node)
+                    {
+                        using T = std::decay_t<decltype(node)>;
+                        if constexpr (std::is_same_v<T, ir::Match>)
+                        {
+                            for (auto &path : node.patterns)
+                            {
+                                swap(path.variable);
+                                for (auto &element : path.nodes)
+                                {
+                                    swap(element.variable);
+                                }
+                            }
+                        }
+                        else if constexpr (std::is_same_v<T, ir::Unwind>)
+                        {
+                            swap(node.alias);
+                        }
+                        else
+                        {
+                            for (auto &item : node.items)
+                            {
+                                swap(item.alias);
+                            }
+                        }
+                    },
+                    clause);
+            }
+        };
+
+        bindings(query);
+        ir::Rewrite(query,
+                    [&](ir::ExprPtr &expr)
+                    {
+                        if (auto *variable = ir::As<ir::Variable>(expr); variable != nullptr)
+                        {
+                            swap(variable->name);
+                        }
+                        else if (auto *list = ir::As<ir::ListComprehension>(expr); list != nullptr)
+                        {
+                            swap(list->variable);
+                        }
+                        else if (auto *list = ir::As<ir::ListPredicate>(expr); list != nullptr)
+                        {
+                            swap(list->variable);
+                        }
+                        else if (auto *exists = ir::As<ir::Exists>(expr); exists != nullptr)
+                        {
+                            bindings(exists->query);
+                        }
+                    });
+    }
+
+    static std::string Canonical(ir::Query query)
+    {
+        const auto order = [](ir::Query &target)
+        {
+            for (auto &clause : target.clauses)
+            {
+                std::visit(
+                    [&](auto &node)
+                    {
+                        using T = std::decay_t<decltype(node)>;
+                        if constexpr (std::is_same_v<T, ir::Match>)
+                        {
+                            std::ranges::sort(node.patterns, {}, &PatternKey);
+                        }
+                        else if constexpr (!std::is_same_v<T, ir::Unwind>)
+                        {
+                            std::ranges::sort(
+                                node.items, {}, [](const ir::Projection &item)
+                                { return ir::Print(item.expr) + " AS " + item.alias; });
+                        }
+                    },
+                    clause);
+            }
+        };
+
+        order(query);
+        ir::Rewrite(query,
+                    [&](ir::ExprPtr &expr)
+                    {
+                        if (auto *logical = ir::As<ir::Logical>(expr); logical != nullptr)
+                        {
+                            std::ranges::sort(logical->operands, {}, [](const ir::ExprPtr &operand)
+                                              { return ir::Print(operand); });
+                        }
+                        else if (auto *binary = ir::As<ir::Binary>(expr);
+                                 binary != nullptr &&
+                                 (binary->op == ExprType::EQ || binary->op == ExprType::NOT_EQ) &&
+                                 ir::Print(binary->right) < ir::Print(binary->left))
+                        {
+                            std::swap(binary->left, binary->right);
+                        }
+                        else if (auto *exists = ir::As<ir::Exists>(expr); exists != nullptr)
+                        {
+                            order(exists->query);
+                        }
+                    });
+        return ir::Print(query);
+    }
+
+    static std::string PatternKey(const ir::PathPattern &path)
+    {
+        auto key = path.variable;
+        for (std::size_t i = 0; i < path.nodes.size(); ++i)
+        {
+            key += "(" + path.nodes[i].variable + ":" + path.nodes[i].label + ")";
+            if (i < path.relationships.size())
+            {
+                key += "[" + path.relationships[i].type + path.relationships[i].length + "]";
+            }
+        }
+        return key;
+    }
+};
+
+} // namespace lang::ast::cypher::passes
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <translator/ir.hpp>
+#include <translator/options.hpp>
+#include <translator/pass.hpp>
+
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+namespace lang::ast::cypher::passes
+{
+
+// Restricts every newly bound node to one workspace. With PARAMETER each node gets
+// `{workspace: $workspace}`; with GROUPED the first node of the rule anchors the workspace,
+// every later node gets `{workspace: anchor.workspace}` and the findings are returned with
+// the anchor's workspace, so all workspaces are checked by a single query.
+class WorkspaceScoping : public ir::Pass
+{
+public:
+    static constexpr auto property = "workspace";
+    static constexpr auto parameter = "$workspace";
+
+    explicit WorkspaceScoping(WorkspaceScope scope) : scope_(scope)
+    {
+    }
+
+    [[nodiscard]] std::string_view Name() const override
+    {
+        return "workspace";
+    }
+
+    void Run(ir::Query &query) override
+    {
+        anchor_.reset();
+        Apply(query, {});
+        if (!anchor_)
+        {
+            return;
+        }
+        std::set<std::string> scope;
+        for (auto &clause : query.clauses)
+        {
+            if (auto *result = std::get_if<ir::Return>(&clause);
+                result != nullptr && scope.contains(*anchor_))
+            {
+                result->items.insert(
+                    result->items.begin(),
+                    ir::Projection{ir::Make<ir::Property>(ExprType::ACCESS,
+                                                          ir::Make<ir::Variable>(*anchor_),
+                                                          property),
+                                   property});
+            }
+            ir::Bind(clause, scope);
+        }
+    }
+
+private:
+    WorkspaceScope scope_;
+    std::optional<std::string> anchor_;
+
+    void Apply(ir::Query &query, std::set<std::string> scope)
+    {
+        for (auto &clause : query.clauses)
+        {
+            if (auto *match = std::get_if<ir::Match>(&clause); match != nullptr)
+            {
+                auto bound = scope;
+                for (auto &path : match->patterns)
+                {
+                    for (auto &node : path.nodes)
+                    {
+                        Scope(node, bound);
+                        if (!node.variable.empty())
+                        {
+                            bound.insert(node.variable);
+                        }
+                    }
+                }
+            }
+            ir::Bind(clause, scope);
+            ir::ForEachExpr(clause, [&](ir::ExprPtr &expr) { Nested(expr, scope); });
+        }
+    }
+
+    void Nested(ir::ExprPtr &expr, const std::set<std::string> &scope)
+    {
+        if (!expr)
+        {
+            return;
+        }
+        if (auto *exists = ir::As<ir::Exists>(expr); exists != nullptr)
+        {
+            Apply(exists->query, scope);
+            return;
+        }
+        ir::ForEachChild(*expr, [&](ir::ExprPtr &child) { Nested(child, scope); });
+    }
+
+    void Scope(ir::NodePattern &node, const std::set<std::string> &scope)
+    {
+        // A variable bound earlier already belongs to the workspace.
+        if (!node.variable.empty() && scope.contains(node.variable))
+        {
+            return;
+        }
+        if (scope_ == WorkspaceScope::PARAMETER)
+        {
+            node.properties.emplace_back(property, parameter);
+            return;
+        }
+        if (anchor_ && scope.contains(*anchor_))
+        {
+            node.properties.emplace_back(property, *anchor_ + "." + property);
+        }
+        else if (!node.variable.empty())
+        {
+            // The previous anchor went out of scope (e.g. a precomputed except set), so the
+            // rule's own nodes start a new group.
+            anchor_ = node.variable;
+        }
+    }
+};
+
+} // namespace lang::ast::cypher::passes
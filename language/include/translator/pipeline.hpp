@@ -0,0 +1,46 @@
+#pragma once
+
+#include <translator/options.hpp>
+#include <translator/pass.hpp>
+#include <translator/passes/closure.hpp>
+#include <translator/passes/cse.hpp>
+#include <translator/passes/decorrelate.hpp>
+#include <translator/passes/fold.hpp>
+#include <translator/passes/reorder.hpp>
+#include <translator/passes/simplify.hpp>
+#include <translator/passes/symmetry.hpp>
+#include <translator/passes/workspace.hpp>
+
+namespace lang::ast::cypher
+{
+
+inline ir::PassManager MakePipeline(const TranslatorOptions &options)
+{
+    ir::PassManager manager;
+    if (options.closure)
+    {
+        manager.Add<passes::ContainmentClosure>();
+    }
+    if (options.optimize)
+    {
+        manager.Add<passes::ConstantFolding>()
+            .Add<passes::Simplify>()
+            .Add<passes::SymmetryReduction>();
+    }
+    if (options.decorrelate)
+    {
+        manager.Add<passes::Decorrelation>();
+    }
+    if (options.optimize)
+    {
+        manager.Add<passes::ConjunctReordering>(options.statistics)
+            .Add<passes::CommonSubexpressions>();
+    }
+    if (options.workspace != WorkspaceScope::NONE)
+    {
+        manager.Add<passes::WorkspaceScoping>(options.workspace);
+    }
+    return manager;
+}
+
+} // namespace lang::ast::cypher
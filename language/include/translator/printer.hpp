@@ -0,0 +1,427 @@
+#pragma once
+
+#include <translator/constant.hpp>
+#include <translator/format.hpp>
+#include <translator/ir.hpp>
+
+#include <fmt/args.h>
+#include <fmt/base.h>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+namespace lang::ast::cypher::ir
+{
+
+struct PrintOptions
+{
+    bool pretty = false;
+    std::size_t indent = 2;
+};
+
+namespace detail
+{
+
+static constexpr int atomPrecedence = 10;
+
+constexpr int Precedence(const ExprType type)
+{
+    switch (type)
+    {
+    case ExprType::OR:
+        return 1;
+    case ExprType::XOR:
+        return 2;
+    case ExprType::AND:
+        return 3;
+    case ExprType::NOT_IN:
+        return 4;
+    case ExprType::EQ:
+    case ExprType::NOT_EQ:
+    case ExprType::LESS:
+    case ExprType::GREATER:
+    case ExprType::LESS_EQ:
+    case ExprType::GREATER_EQ:
+    case ExprType::IN:
+        return 5;
+    case ExprType::PLUS:
+    case ExprType::MINUS:
+        return 6;
+    case ExprType::MULT:
+    case ExprType::DIV:
+        return 7;
+    case ExprType::NEG:
+        return 8;
+    case ExprType::ACCESS:
+        return 9;
+    case ExprType::SAFE_ACCESS:
+        return atomPrecedence;
+    default:
+        throw std::runtime_error{"undefined operator"};
+    }
+}
+
+inline int Precedence(const ExprPtr &expr)
+{
+    return std::visit(
+        [](const auto &node) -> int
+        {
+            using T = typename std::decay_t<decltype(node)>::element_type;
+            if constexpr (std::is_same_v<T, Property> || std::is_same_v<T, Unary> ||
+                          std::is_same_v<T, Binary> || std::is_same_v<T, Logical>)
+            {
+                return Precedence(node->op);
+            }
+            else if constexpr (std::is_same_v<T, Not>)
+            {
+                return Precedence(ExprType::NOT_IN);
+            }
+            return atomPrecedence;
+        },
+        *expr);
+}
+
+constexpr std::string_view QuantifierName(const ListQuantifier quantifier)
+{
+    switch (quantifier)
+    {
+    case ListQuantifier::ANY:
+        return "any";
+    case ListQuantifier::NONE:
+        return "none";
+    case ListQuantifier::ALL:
+        return "all";
+    default:
+        throw std::runtime_error{"undefined list quantifier"};
+    }
+}
+
+inline std::string Quote(const std::string &value)
+{
+    std::string result = "\"";
+    for (const char symbol : value)
+    {
+        if (symbol == '"' || symbol == '\\')
+        {
+            result += '\\';
+        }
+        result += symbol;
+    }
+    return result + "\"";
+}
+
+} // namespace detail
+
+class Printer
+{
+public:
+    explicit Printer(PrintOptions options = {}) : options_(options)
+    {
+    }
+
+    std::string operator()(const ExprPtr &expr) const
+    {
+        return Expression(expr, 0);
+    }
+
+    std::string operator()(const Clause &clause) const
+    {
+        return Statement(clause, 0);
+    }
+
+    std::string operator()(const Query &query) const
+    {
+        std::string result;
+        for (const auto &comment : query.comments)
+        {
+            result += fmt::format("// {}\n", comment);
+        }
+        return result + Body(query, 0);
+    }
+
+private:
+    PrintOptions options_;
+
+    std::string Separator(std::size_t depth) const
+    {
+        if (!options_.pretty)
+        {
+            return " ";
+        }
+        return "\n" + std::string(depth * options_.indent, ' ');
+    }
+
+    std::string Body(const Query &query, std::size_t depth) const
+    {
+        std::string result;
+        for (const auto &clause : query.clauses)
+        {
+            if (!result.empty())
+            {
+                result += Separator(depth);
+            }
+            result += Statement(clause, depth);
+        }
+        return result;
+    }
+
+    std::string Wrapped(const ExprPtr &expr, bool parens, std::size_t depth) const
+    {
+        const auto text = Expression(expr, depth);
+        return parens ? fmt::format("({})", text) : text;
+    }
+
+    std::string Where(const ExprPtr &where, std::size_t depth) const
+    {
+        if (!where)
+        {
+            return "";
+        }
+        return Separator(depth) + "WHERE " + Expression(where, depth);
+    }
+
+    std::string Items(const std::vector<Projection> &items, std::size_t depth) const
+    {
+        std::string result;
+        for (const auto &item : items)
+        {
+            if (!result.empty())
+            {
+                result += ", ";
+            }
+            result += Expression(item.expr, depth);
+            if (!item.alias.empty())
+            {
+                result += fmt::format(" AS {}", item.alias);
+            }
+        }
+        return result;
+    }
+
+    static std::string Pattern(const PathPattern &path)
+    {
+        std::string result;
+        if (!path.variable.empty())
+        {
+            result += path.variable + " = ";
+        }
+        for (std::size_t i = 0; i < path.nodes.size(); ++i)
+        {
+            const auto &node = path.nodes[i];
+            result += "(" + node.variable;
+            if (!node.label.empty())
+            {
+                result += ":" + node.label;
+            }
+            for (std::size_t j = 0; j < node.properties.size(); ++j)
+            {
+                const auto &[key, value] = node.properties[j];
+                result += fmt::format("{}{}: {}{}", j == 0 ? " {" : ", ", key, value,
+                                      j + 1 == node.properties.size() ? "}" : "");
+            }
+            result += ")";
+            if (i < path.relationships.size())
+            {
+                const auto &rel = path.relationships[i];
+                result += fmt::format("-[{}{}]->", rel.type.empty() ? "" : ":" + rel.type,
+                                      rel.length);
+            }
+        }
+        return result;
+    }
+
+    std::string Statement(const Clause &clause, std::size_t depth) const
+    {
+        return std::visit(
+            [&](const auto &node) -> std::string
+            {
+                using T = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<T, Match>)
+                {
+                    std::string patterns;
+                    for (const auto &path : node.patterns)
+                    {
+                        patterns += (patterns.empty() ? "" : ", ") + Pattern(path);
+                    }
+                    return (node.optional ? "OPTIONAL MATCH " : "MATCH ") + patterns +
+                           Where(node.where, depth);
+                }
+                else if constexpr (std::is_same_v<T, Unwind>)
+                {
+                    return fmt::format("UNWIND {} AS {}", Expression(node.list, depth), node.alias);
+                }
+                else if constexpr (std::is_same_v<T, With>)
+                {
+                    return "WITH " + Items(node.items, depth) + Where(node.where, depth);
+                }
+                else
+                {
+                    return "RETURN " + Items(node.items, depth);
+                }
+            },
+            clause);
+    }
+
+    std::string Expression(const ExprPtr &expr, std::size_t depth) const
+    {
+        if (!expr)
+        {
+            throw std::runtime_error{"broken IR: expression is null in printer"};
+        }
+        return std::visit([&](const auto &node) -> std::string { return Node(*node, depth); },
+                          *expr);
+    }
+
+    std::string Node(const Literal &lit, std::size_t /*unused*/) const
+    {
+        return std::visit(
+            [](const auto &value) -> std::string
+            {
+                if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string>)
+                {
+                    return detail::Quote(value);
+                }
+                return fmt::to_string(value);
+            },
+            lit.value);
+    }
+
+    std::string Node(const List &list, std::size_t depth) const
+    {
+        std::string result;
+        for (const auto &item : list.items)
+        {
+            result += (result.empty() ? "" : ", ") + Expression(item, depth);
+        }
+        return "[" + result + "]";
+    }
+
+    std::string Node(const Variable &var, std::size_t /*unused*/) const
+    {
+        return var.name;
+    }
+
+    std::string Node(const Raw &raw, std::size_t /*unused*/) const
+    {
+        return raw.text;
+    }
+
+    std::string Node(const Property &prop, std::size_t depth) const
+    {
+        const auto operand = Wrapped(
+            prop.operand, detail::Precedence(prop.operand) < detail::Precedence(ExprType::ACCESS),
+            depth);
+        return fmt::format(fmt::runtime(OperatorMap(prop.op)), operand, prop.name);
+    }
+
+    std::string Node(const Unary &unary, std::size_t depth) const
+    {
+        const auto operand = Wrapped(
+            unary.operand, detail::Precedence(unary.operand) < detail::Precedence(unary.op), depth);
+        return fmt::format(fmt::runtime(OperatorMap(unary.op)), operand);
+    }
+
+    std::string Node(const Not &negation, std::size_t depth) const
+    {
+        return "NOT " + Wrapped(negation.operand,
+                                detail::Precedence(negation.operand) < detail::atomPrecedence,
+                                depth);
+    }
+
+    std::string Node(const Binary &binary, std::size_t depth) const
+    {
+        const auto op = binary.op == ExprType::NOT_IN ? ExprType::IN : binary.op;
+        const auto precedence = detail::Precedence(op);
+        const auto comparison = precedence == detail::Precedence(ExprType::EQ);
+        const auto leftPrecedence = detail::Precedence(binary.left);
+        const auto left = Wrapped(binary.left,
+                                  leftPrecedence < precedence ||
+                                      (comparison && leftPrecedence == precedence),
+                                  depth);
+        const auto right =
+            Wrapped(binary.right, detail::Precedence(binary.right) <= precedence, depth);
+        return fmt::format(fmt::runtime(OperatorMap(binary.op)), left, right);
+    }
+
+    std::string Node(const Logical &logical, std::size_t depth) const
+    {
+        const auto precedence = detail::Precedence(logical.op);
+        const auto separator = fmt::format(fmt::runtime(OperatorMap(logical.op)), "", "");
+        std::string result;
+        for (const auto &operand : logical.operands)
+        {
+            if (!result.empty())
+            {
+                result += separator;
+            }
+            result += Wrapped(operand, detail::Precedence(operand) < precedence, depth);
+        }
+        return result;
+    }
+
+    std::string Node(const Case &node, std::size_t depth) const
+    {
+        return fmt::format(ternaryFormat, Expression(node.condition, depth),
+                           Expression(node.thenExpr, depth), Expression(node.elseExpr, depth));
+    }
+
+    std::string Node(const Call &call, std::size_t depth) const
+    {
+        const auto function = functionMap.find(call.name);
+        const auto internal = internalFunctionMap.find(call.name);
+        if (function == functionMap.end() && internal == internalFunctionMap.end())
+        {
+            throw std::runtime_error{fmt::format(fmt::runtime(functionError), call.name)};
+        }
+        fmt::dynamic_format_arg_store<fmt::format_context> store;
+        for (const auto &arg : call.args)
+        {
+            store.push_back(Wrapped(
+                arg, detail::Precedence(arg) < detail::Precedence(ExprType::ACCESS), depth));
+        }
+        return fmt::vformat(function != functionMap.end() ? function->second : internal->second,
+                            store);
+    }
+
+    std::string Node(const ListComprehension &list, std::size_t depth) const
+    {
+        return fmt::format("[{} IN {} WHERE {}]", list.variable, Expression(list.source, depth),
+                           Expression(list.where, depth));
+    }
+
+    std::string Node(const ListPredicate &list, std::size_t depth) const
+    {
+        return fmt::format("{}({} IN {} WHERE {})", detail::QuantifierName(list.quantifier),
+                           list.variable, Expression(list.source, depth),
+                           Expression(list.where, depth));
+    }
+
+    std::string Node(const Aggregate &aggregate, std::size_t depth) const
+    {
+        return fmt::format("{}({}{})", aggregate.function, aggregate.distinct ? "DISTINCT " : "",
+                           Expression(aggregate.operand, depth));
+    }
+
+    std::string Node(const Exists &exists, std::size_t depth) const
+    {
+        if (!options_.pretty)
+        {
+            return "EXISTS { " + Body(exists.query, depth) + " }";
+        }
+        return "EXISTS {" + Separator(depth + 1) + Body(exists.query, depth + 1) +
+               Separator(depth) + "}";
+    }
+};
+
+template <typename T> std::string Print(const T &value, PrintOptions options = {})
+{
+    return Printer{options}(value);
+}
+
+} // namespace lang::ast::cypher::ir
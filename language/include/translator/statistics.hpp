@@ -0,0 +1,59 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace lang::ast::cypher
+{
+
+// Optional model statistics used by the optimizer to rank predicates.
+//
+// {"labels": {"Container": 120}, "properties": {"name": 0.01, "tags": 0.2}}
+//
+// `labels` holds node counts per label, `properties` the fraction of nodes for which an
+// equality or membership test on the property succeeds.
+struct Statistics
+{
+    std::unordered_map<std::string, std::size_t> labels;
+    std::unordered_map<std::string, double> properties;
+
+    [[nodiscard]] bool Empty() const
+    {
+        return labels.empty() && properties.empty();
+    }
+};
+
+inline Statistics ParseStatistics(const nlohmann::json &json)
+{
+    if (!json.is_object())
+    {
+        throw std::runtime_error{"statistics must be a JSON object"};
+    }
+    Statistics statistics;
+    if (json.contains("labels"))
+    {
+        for (const auto &[label, count] : json.at("labels").items())
+        {
+            statistics.labels[label] = count.get<std::size_t>();
+        }
+    }
+    if (json.contains("properties"))
+    {
+        for (const auto &[property, selectivity] : json.at("properties").items())
+        {
+            const auto value = selectivity.get<double>();
+            if (value < 0.0 || value > 1.0)
+            {
+                throw std::runtime_error{"property selectivity must be in [0, 1]: " + property};
+            }
+            statistics.properties[property] = value;
+        }
+    }
+    return statistics;
+}
+
+} // namespace lang::ast::cypher
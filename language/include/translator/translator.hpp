@@ -5,6 +5,10 @@
 #include <translator/context.hpp>
 #include <translator/format.hpp>
 #include <translator/helpers.hpp>
+#include <translator/ir.hpp>
+#include <translator/pass.hpp>
+#include <translator/pipeline.hpp>
+#include <translator/printer.hpp>
 
 #include <ast/ast.hpp>
 #include <ast/expression.hpp>
@@ -16,6 +20,9 @@
 
 #include <magic_enum/magic_enum.hpp>
 
+#include <cstddef>
+#include <map>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -26,6 +33,41 @@ namespace lang::ast::cypher
 
 using TranslationResult = std::string;
 
+template <typename T> struct LoweredType
+{
+    using type = ir::ExprPtr;
+};
+
+template <typename T> struct LoweredType<std::unique_ptr<T>> : LoweredType<T>
+{
+};
+
+template <typename T, typename... Ts> struct LoweredType<std::variant<T, Ts...>> : LoweredType<T>
+{
+};
+
+template <> struct LoweredType<AssignmentStatement>
+{
+    using type = ir::Clause;
+};
+
+template <> struct LoweredType<Block>
+{
+    using type = ir::Query;
+};
+
+template <> struct LoweredType<Rule>
+{
+    using type = ir::Query;
+};
+
+template <> struct LoweredType<RuleTemplate>
+{
+    using type = ir::Query;
+};
+
+template <typename T> using Lowered = typename LoweredType<T>::type;
+
 namespace
 {
 
@@ -79,9 +121,9 @@ public:
 template <typename T> class Translator : TranslatorBase
 {
 public:
-    TranslationResult operator()(const T & /*unused*/) const
+    ir::ExprPtr operator()(const T & /*unused*/) const
     {
-        return "unimplemented translation";
+        return ir::Make<ir::Raw>("unimplemented translation");
     }
 };
 
@@ -89,9 +131,9 @@ template <typename... Ts> class Translator<std::variant<Ts...>> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const std::variant<Ts...> &var) const
+    Lowered<std::variant<Ts...>> operator()(const std::variant<Ts...> &var) const
     {
-        return std::visit([&](auto &subValue) -> TranslationResult
+        return std::visit([&](auto &subValue) -> Lowered<std::variant<Ts...>>
                           { return Translator<std::decay_t<decltype(subValue)>>{ctx}(subValue); },
                           var);
     }
@@ -101,7 +143,7 @@ template <typename T> class Translator<std::unique_ptr<T>> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const std::unique_ptr<T> &ptr) const
+    Lowered<T> operator()(const std::unique_ptr<T> &ptr) const
     {
         if (!ptr)
         {
@@ -115,9 +157,13 @@ template <KeywordSets K> class Translator<KeywordExpr<K>> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const KeywordExpr<K> & /*unused*/) const
+    ir::ExprPtr operator()(const KeywordExpr<K> & /*unused*/) const
     {
-        return KeywordMap(K);
+        if constexpr (K == KeywordSets::NONE)
+        {
+            return ir::Make<ir::List>();
+        }
+        return ir::Make<ir::Raw>(KeywordMap(K));
     }
 };
 
@@ -125,13 +171,9 @@ template <typename T> class Translator<LiteralExpr<T>> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const LiteralExpr<T> &lit) const
+    ir::ExprPtr operator()(const LiteralExpr<T> &lit) const
     {
-        if constexpr (std::is_same_v<T, std::string>)
-        {
-            return fmt::format("\"{}\"", lit.value);
-        }
-        return fmt::to_string(lit.value);
+        return ir::Make<ir::Literal>(ir::LiteralValue{lit.value});
     }
 };
 
@@ -139,11 +181,14 @@ template <> class Translator<SetExpr> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const SetExpr &expr) const
+    ir::ExprPtr operator()(const SetExpr &expr) const
     {
-        return fmt::format(
-            "[{}]",
-            fmt::join(expr.items | std::views::transform(Translator<ExpressionPtr>{ctx}), ", "));
+        std::vector<ir::ExprPtr> items;
+        for (const auto &item : expr.items)
+        {
+            items.push_back(Translator<ExpressionPtr>{ctx}(item));
+        }
+        return ir::Make<ir::List>(std::move(items));
     }
 };
 
@@ -151,13 +196,13 @@ template <> class Translator<VariableExpr> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const VariableExpr &var) const
+    ir::ExprPtr operator()(const VariableExpr &var) const
     {
         if (not ctx.variableTable.contains(var.name))
         {
             throw ErrorHelper(variableError, var.name);
         }
-        return var.name;
+        return ir::Make<ir::Variable>(var.name);
     }
 };
 
@@ -165,10 +210,9 @@ template <ExprType K> class Translator<AccessExpr<K>> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const AccessExpr<K> &expr) const
+    ir::ExprPtr operator()(const AccessExpr<K> &expr) const
     {
-        return fmt::format(fmt::runtime(OperatorMap(K)),
-                           Translator<ExpressionPtr>{ctx}(expr.operand), expr.prop);
+        return ir::Make<ir::Property>(K, Translator<ExpressionPtr>{ctx}(expr.operand), expr.prop);
     }
 };
 
@@ -176,10 +220,9 @@ template <ExprType K> class Translator<UnaryExpr<K>> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const UnaryExpr<K> &expr) const
+    ir::ExprPtr operator()(const UnaryExpr<K> &expr) const
     {
-        return fmt::format(fmt::runtime(OperatorMap(K)),
-                           Translator<ExpressionPtr>{ctx}(expr.operand));
+        return ir::Make<ir::Unary>(K, Translator<ExpressionPtr>{ctx}(expr.operand));
     }
 };
 
@@ -187,18 +230,18 @@ template <> class Translator<CallExpr> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const CallExpr &expr) const
+    ir::ExprPtr operator()(const CallExpr &expr) const
     {
         if (not functionMap.contains(expr.functionName))
         {
             throw ErrorHelper(functionError, expr.functionName);
         }
-        fmt::dynamic_format_arg_store<fmt::format_context> store;
-        for (const auto &arg : expr.args | std::views::transform(Translator<ExpressionPtr>{ctx}))
+        std::vector<ir::ExprPtr> args;
+        for (const auto &arg : expr.args)
         {
-            store.push_back(arg);
+            args.push_back(Translator<ExpressionPtr>{ctx}(arg));
         }
-        return fmt::vformat(functionMap.at(expr.functionName), store);
+        return ir::Make<ir::Call>(expr.functionName, std::move(args));
     }
 };
 
@@ -214,11 +257,18 @@ class Translator<T<U>> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const T<U> &expr) const
+    ir::ExprPtr operator()(const T<U> &expr) const
     {
-        const auto left = Translator<ExpressionPtr>{ctx}(expr.left);
-        const auto right = Translator<ExpressionPtr>{ctx}(expr.right);
-        return fmt::format(fmt::runtime(OperatorMap(U)), left, right);
+        auto left = Translator<ExpressionPtr>{ctx}(expr.left);
+        auto right = Translator<ExpressionPtr>{ctx}(expr.right);
+        if constexpr (U == ExprType::AND || U == ExprType::OR || U == ExprType::XOR)
+        {
+            std::vector<ir::ExprPtr> operands;
+            operands.push_back(std::move(left));
+            operands.push_back(std::move(right));
+            return ir::Combine(U, std::move(operands));
+        }
+        return ir::Make<ir::Binary>(U, std::move(left), std::move(right));
     }
 };
 
@@ -226,12 +276,12 @@ template <> class Translator<TernaryExpr> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const TernaryExpr &expr) const
+    ir::ExprPtr operator()(const TernaryExpr &expr) const
     {
-        const auto cond = Translator<ExpressionPtr>{ctx}(expr.condition);
-        const auto then = Translator<ExpressionPtr>{ctx}(expr.thenExpr);
-        const auto els = Translator<ExpressionPtr>{ctx}(expr.elseExpr);
-        return fmt::format(ternaryFormat, cond, then, els);
+        auto cond = Translator<ExpressionPtr>{ctx}(expr.condition);
+        auto then = Translator<ExpressionPtr>{ctx}(expr.thenExpr);
+        auto els = Translator<ExpressionPtr>{ctx}(expr.elseExpr);
+        return ir::Make<ir::Case>(std::move(cond), std::move(then), std::move(els));
     }
 };
 
@@ -239,12 +289,14 @@ template <> class Translator<AssignmentStatement> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const AssignmentStatement &stmt) const
+    ir::Clause operator()(const AssignmentStatement &stmt) const
     {
         ctx.variableTable.insert(stmt.name);
         ctx.variableType[stmt.name] = KeywordSets::NONE;
-        const auto value = Translator<ExpressionPtr>{ctx}(stmt.valueExpr);
-        return fmt::format(withAssignmentFormat, value, stmt.name);
+        ir::With with;
+        with.items.push_back(
+            ir::Projection{Translator<ExpressionPtr>{ctx}(stmt.valueExpr), stmt.name});
+        return with;
     }
 };
 
@@ -253,10 +305,35 @@ concept BasicSource = std::is_same_v<T, SystemPtr> || std::is_same_v<T, Containe
                       std::is_same_v<T, ComponentPtr> || std::is_same_v<T, CodePtr> ||
                       std::is_same_v<T, DeployPtr> || std::is_same_v<T, InfrastructurePtr>;
 
+inline std::string NodeName(const ir::ExprPtr &expr)
+{
+    const auto *var = ir::As<ir::Variable>(expr);
+    if (var == nullptr)
+    {
+        throw std::runtime_error{"Element variable expected in pattern"};
+    }
+    return var->name;
+}
+
+inline ir::ExprPtr Distinct(const std::vector<std::string> &args)
+{
+    std::vector<ir::ExprPtr> constraints;
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        for (size_t j = i + 1; j < args.size(); ++j)
+        {
+            constraints.push_back(ir::Make<ir::Binary>(ExprType::NOT_EQ,
+                                                       ir::Make<ir::Variable>(args[i]),
+                                                       ir::Make<ir::Variable>(args[j])));
+        }
+    }
+    return ir::Combine(ExprType::AND, std::move(constraints));
+}
+
 template <typename T> struct SourceHandler
 {
-    TranslationResult operator()(const std::vector<std::string> & /*unused*/, const T & /*unused*/,
-                                 TranslatorContext & /*unused*/) const
+    ir::Query operator()(const std::vector<std::string> & /*unused*/, const T & /*unused*/,
+                         TranslatorContext & /*unused*/) const
     {
         throw std::runtime_error{"BUG"};
     };
@@ -264,11 +341,11 @@ template <typename T> struct SourceHandler
 
 template <typename... Ts> struct SourceHandler<std::variant<Ts...>>
 {
-    TranslationResult operator()(const std::vector<std::string> &args,
-                                 const std::variant<Ts...> &var, TranslatorContext &ctx) const
+    ir::Query operator()(const std::vector<std::string> &args, const std::variant<Ts...> &var,
+                         TranslatorContext &ctx) const
     {
         return std::visit(
-            [&](auto &subValue) -> TranslationResult
+            [&](auto &subValue) -> ir::Query
             { return SourceHandler<std::decay_t<decltype(subValue)>>{}(args, subValue, ctx); },
             var);
     }
@@ -276,8 +353,8 @@ template <typename... Ts> struct SourceHandler<std::variant<Ts...>>
 
 template <> struct SourceHandler<ExpressionPtr>
 {
-    TranslationResult operator()(const std::vector<std::string> &args, const ExpressionPtr &elem,
-                                 TranslatorContext &ctx)
+    ir::Query operator()(const std::vector<std::string> &args, const ExpressionPtr &elem,
+                         TranslatorContext &ctx)
     {
         return SourceHandler<Expression>{}(args, *elem, ctx);
     }
@@ -285,41 +362,51 @@ template <> struct SourceHandler<ExpressionPtr>
 
 template <> struct SourceHandler<CallPtr>
 {
-    TranslationResult operator()(const std::vector<std::string> &args, const CallPtr &elem,
-                                 TranslatorContext &ctx)
+    ir::Query operator()(const std::vector<std::string> &args, const CallPtr &elem,
+                         TranslatorContext &ctx)
     {
+        ir::Query query;
         if (elem->functionName == "route")
         {
-            std::string result = fmt::format("MATCH p = {}", Translator<CallPtr>{ctx}(elem));
-            for (const auto &arg : args)
+            if (elem->args.size() != 2)
             {
-                result += fmt::format(" UNWIND nodes(p) AS {}", arg);
-                result += fmt::format(" WITH {}", arg);
-                ctx.variableTable.insert(arg);
+                throw std::runtime_error{"route expects two elements"};
             }
-            result += " WHERE";
-            for (size_t i = 0; i < args.size(); ++i)
+            ir::PathPattern path{"p", {}, {ir::RelationshipPattern{modelRelationships, "*1.."}}};
+            for (const auto &arg : elem->args)
             {
-                for (size_t j = i + 1; j < args.size(); ++j)
-                {
-                    result += fmt::format(" {} <> {} AND", args[i], args[j]);
-                }
+                path.nodes.push_back(
+                    ir::NodePattern{NodeName(Translator<ExpressionPtr>{ctx}(arg)), ""});
             }
+            query.clauses.emplace_back(ir::Match{{std::move(path)}, nullptr});
 
-            return result;
+            ir::With with;
+            for (const auto &arg : args)
+            {
+                query.clauses.emplace_back(ir::Unwind{ir::Make<ir::Raw>("nodes(p)"), arg});
+                with.items.push_back(ir::Projection{ir::Make<ir::Variable>(arg), ""});
+                ctx.variableTable.insert(arg);
+            }
+            with.where = Distinct(args);
+            query.clauses.emplace_back(std::move(with));
+            return query;
         }
 
         if (elem->functionName == "instance")
         {
-            if (args.empty())
+            if (args.empty() || elem->args.empty())
             {
                 throw std::runtime_error{"Empty selector list"};
             }
-            std::string result = fmt::format("MATCH ({}:ContainerInstance)-{}", args.front(),
-                                             Translator<CallPtr>{ctx}(elem));
-            result += " WHERE";
+            ir::PathPattern path{"",
+                                 {ir::NodePattern{args.front(), "ContainerInstance"},
+                                  ir::NodePattern{
+                                      NodeName(Translator<ExpressionPtr>{ctx}(elem->args.front())),
+                                      ""}},
+                                 {ir::RelationshipPattern{"INSTANCE_OF", ""}}};
+            query.clauses.emplace_back(ir::Match{{std::move(path)}, nullptr});
             ctx.variableTable.insert(args.front());
-            return result;
+            return query;
         }
 
         throw std::runtime_error{"Unsupported function"};
@@ -328,47 +415,41 @@ template <> struct SourceHandler<CallPtr>
 
 template <BasicSource T> struct SourceHandler<T>
 {
-    TranslationResult operator()(const std::vector<std::string> &args, const T &elem,
-                                 TranslatorContext &ctx)
+    ir::Query operator()(const std::vector<std::string> &args, const T & /*unused*/,
+                         TranslatorContext &ctx)
     {
-        std::string result = "MATCH";
-        bool first = true;
+        ir::Match match;
         for (const auto &arg : args)
         {
-            if (!first)
-            {
-                result += ", ";
-            }
-            first = false;
-            result += fmt::format(" ({}:{})", arg, Translator<T>{ctx}(elem));
+            match.patterns.push_back(
+                ir::PathPattern{"", {ir::NodePattern{arg, KeywordMap(T::element_type::kind)}}, {}});
             ctx.variableTable.insert(arg);
             ctx.variableType[arg] = T::element_type::kind;
         }
-        result += " WHERE";
-        for (size_t i = 0; i < args.size(); ++i)
-        {
-            for (size_t j = i + 1; j < args.size(); ++j)
-            {
-                result += fmt::format(" {} <> {} AND", args[i], args[j]);
-            }
-        }
-        return result;
+        match.where = Distinct(args);
+        ir::Query query;
+        query.clauses.emplace_back(std::move(match));
+        return query;
     }
 };
 
 template <> struct SourceHandler<VariablePtr>
 {
-    TranslationResult operator()(const std::vector<std::string> &args, const VariablePtr &elem,
-                                 TranslatorContext &ctx)
+    ir::Query operator()(const std::vector<std::string> &args, const VariablePtr &elem,
+                         TranslatorContext &ctx)
     {
-        std::string result = "MATCH";
+        const auto parent = NodeName(Translator<VariablePtr>{ctx}(elem));
+        ir::Match match;
         if (ctx.variableType[elem->name] == KeywordSets::DEPLOY)
         {
             for (const auto &arg : args)
             {
-                result += fmt::format(
-                    " ({})-[:CONTAINS*]->(:ContainerInstance)-[:INSTANCE_OF]->({}:Container)",
-                    Translator<VariablePtr>{ctx}(elem), arg);
+                match.patterns.push_back(ir::PathPattern{
+                    "",
+                    {ir::NodePattern{parent, ""}, ir::NodePattern{"", "ContainerInstance"},
+                     ir::NodePattern{arg, "Container"}},
+                    {ir::RelationshipPattern{"CONTAINS", "*"},
+                     ir::RelationshipPattern{"INSTANCE_OF", ""}}});
                 ctx.variableTable.insert(arg);
                 ctx.variableType[arg] = KeywordSets::CONTAINER;
             }
@@ -377,21 +458,18 @@ template <> struct SourceHandler<VariablePtr>
         {
             for (const auto &arg : args)
             {
-                result += fmt::format(" ({})-[:CONTAINS*]->({})",
-                                      Translator<VariablePtr>{ctx}(elem), arg);
+                match.patterns.push_back(
+                    ir::PathPattern{"",
+                                    {ir::NodePattern{parent, ""}, ir::NodePattern{arg, ""}},
+                                    {ir::RelationshipPattern{"CONTAINS", "*"}}});
                 ctx.variableTable.insert(arg);
                 ctx.variableType[arg] = SetsMapping(ctx.variableType[elem->name]);
             }
         }
-        result += " WHERE";
-        for (size_t i = 0; i < args.size(); ++i)
-        {
-            for (size_t j = i + 1; j < args.size(); ++j)
-            {
-                result += fmt::format(" {} <> {} AND", args[i], args[j]);
-            }
-        }
-        return result;
+        match.where = Distinct(args);
+        ir::Query query;
+        query.clauses.emplace_back(std::move(match));
+        return query;
     }
 };
 
@@ -402,55 +480,57 @@ template <QuantifierType Q> class Translator<QuantifierStatement<Q>> : Translato
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const QuantifierStatement<Q> &stmt) const
+
+    // Nested quantifier: `all` becomes NOT EXISTS over its counterexamples,
+    // `exist` becomes EXISTS over its witnesses.
+    ir::ExprPtr operator()(const QuantifierStatement<Q> &stmt) const
+    {
+        QuantifierGuard guard{ctx};
+        if (ctx.quantifierLevel == 1 and ctx.exceptRule)
+        {
+            return Condition(stmt, Q != QuantifierType::ALL);
+        }
+        auto exists = ir::Make<ir::Exists>(Body(stmt));
+        if constexpr (Q == QuantifierType::ALL)
+        {
+            return ir::Make<ir::Not>(std::move(exists));
+        }
+        return exists;
+    }
+
+    // Top-level quantifier: the rows of the returned query are the rule's findings.
+    ir::Query Witness(const QuantifierStatement<Q> &stmt) const
     {
         QuantifierGuard guard{ctx};
+        ctx.returns = stmt.identifiersList;
+        return Body(stmt);
+    }
+
+private:
+    ir::Query Body(const QuantifierStatement<Q> &stmt) const
+    {
+        using T = std::decay_t<decltype(stmt.source)>;
+        auto query = SourceHandler<T>{}(stmt.identifiersList, stmt.source, ctx);
+        ir::AddWhere(query, Condition(stmt, Q == QuantifierType::ALL));
+        return query;
+    }
+
+    ir::ExprPtr Condition(const QuantifierStatement<Q> &stmt, bool negate) const
+    {
+        const auto apply = [negate](ir::ExprPtr expr)
+        { return negate ? ir::Make<ir::Not>(std::move(expr)) : std::move(expr); };
 
         return std::visit(
-            [&](auto &&pred) -> TranslationResult
+            [&](auto &&pred) -> ir::ExprPtr
             {
                 using PredT = std::decay_t<decltype(pred)>;
-                using T = std::decay_t<decltype(stmt.source)>;
                 if constexpr (FilteredPredicate<PredT>)
                 {
-                    if (ctx.quantifierLevel == 1 and ctx.exceptRule)
-                    {
-                        const auto predicate = Translator<StatementExpressionPtr>{ctx}(pred->expr);
-                        const auto quant = Translator<QuantifierPtr>{ctx}(pred->quant);
-                        return fmt::format(fmt::runtime(QuantifierExceptMap(Q)),
-                                           predicate + " AND ", quant);
-                    }
-                    if (ctx.quantifierLevel == 1)
-                    {
-                        ctx.returns = stmt.identifiersList;
-                        const auto source =
-                            SourceHandler<T>{}(stmt.identifiersList, stmt.source, ctx);
-                        const auto expr = Translator<StatementExpressionPtr>{ctx}(pred->expr);
-                        const auto quant = Translator<QuantifierPtr>{ctx}(pred->quant);
-                        return fmt::format(fmt::runtime(QuantifierStartMap(Q)), source,
-                                           expr + " AND ", quant);
-                    }
-                    const auto source = SourceHandler<T>{}(stmt.identifiersList, stmt.source, ctx);
-                    const auto expr = Translator<StatementExpressionPtr>{ctx}(pred->expr);
-                    const auto quant = Translator<QuantifierPtr>{ctx}(pred->quant);
-                    return fmt::format(fmt::runtime(QuantifierMap(Q)), source, expr + " AND ",
-                                       quant);
-                }
-                if (ctx.quantifierLevel == 1 and ctx.exceptRule)
-                {
-                    return fmt::format(fmt::runtime(QuantifierExceptMap(Q)), "",
-                                       Translator<PredicatePtr>{ctx}(stmt.predicate));
+                    auto filter = Translator<StatementExpressionPtr>{ctx}(pred->expr);
+                    auto quant = Translator<QuantifierPtr>{ctx}(pred->quant);
+                    return ir::And(std::move(filter), apply(std::move(quant)));
                 }
-                if (ctx.quantifierLevel == 1)
-                {
-                    const auto source = SourceHandler<T>{}(stmt.identifiersList, stmt.source, ctx);
-                    const auto predicate = Translator<PredicatePtr>{ctx}(stmt.predicate);
-                    ctx.returns = stmt.identifiersList;
-                    return fmt::format(fmt::runtime(QuantifierStartMap(Q)), source, "", predicate);
-                }
-                const auto source = SourceHandler<T>{}(stmt.identifiersList, stmt.source, ctx);
-                const auto predicate = Translator<PredicatePtr>{ctx}(stmt.predicate);
-                return fmt::format(fmt::runtime(QuantifierMap(Q)), source, "", predicate);
+                return apply(Translator<PredicatePtr>{ctx}(stmt.predicate));
             },
             *stmt.predicate);
     }
@@ -460,11 +540,12 @@ template <> class Translator<IfThen> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const IfThen &stmt) const
+    ir::ExprPtr operator()(const IfThen &stmt) const
     {
-        const auto expr = Translator<ExpressionPtr>{ctx}(stmt.expr);
-        const auto then = Translator<PredicatePtr>{ctx}(stmt.then);
-        return fmt::format(ifThenFormat, expr, then);
+        auto expr = Translator<ExpressionPtr>{ctx}(stmt.expr);
+        auto then = Translator<PredicatePtr>{ctx}(stmt.then);
+        return ir::Make<ir::Case>(std::move(expr), std::move(then),
+                                  ir::Make<ir::Literal>(ir::LiteralValue{true}));
     }
 };
 
@@ -472,12 +553,12 @@ template <> class Translator<IfThenElse> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const IfThenElse &stmt) const
+    ir::ExprPtr operator()(const IfThenElse &stmt) const
     {
-        const auto expr = Translator<ExpressionPtr>{ctx}(stmt.expr);
-        const auto then = Translator<PredicatePtr>{ctx}(stmt.then);
-        const auto els = Translator<PredicatePtr>{ctx}(stmt.els);
-        return fmt::format(ifThenElseFormat, expr, then, els);
+        auto expr = Translator<ExpressionPtr>{ctx}(stmt.expr);
+        auto then = Translator<PredicatePtr>{ctx}(stmt.then);
+        auto els = Translator<PredicatePtr>{ctx}(stmt.els);
+        return ir::Make<ir::Case>(std::move(expr), std::move(then), std::move(els));
     }
 };
 
@@ -485,7 +566,7 @@ template <> class Translator<StatementExpression> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const StatementExpression &stmt) const
+    ir::ExprPtr operator()(const StatementExpression &stmt) const
     {
         return Translator<ExpressionPtr>{ctx}(stmt.expr);
     }
@@ -495,11 +576,11 @@ template <> class Translator<FilteredStatement> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const FilteredStatement &stmt) const
+    ir::ExprPtr operator()(const FilteredStatement &stmt) const
     {
-        const auto expr = Translator<StatementExpressionPtr>{ctx}(stmt.expr);
-        const auto quant = Translator<QuantifierPtr>{ctx}(stmt.quant);
-        return fmt::format("{} AND {}", expr, quant);
+        auto expr = Translator<StatementExpressionPtr>{ctx}(stmt.expr);
+        auto quant = Translator<QuantifierPtr>{ctx}(stmt.quant);
+        return ir::And(std::move(expr), std::move(quant));
     }
 };
 
@@ -507,10 +588,10 @@ template <> class Translator<ExceptStatement> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const ExceptStatement &stmt) const
+    ir::ExprPtr operator()(const ExceptStatement &stmt) const
     {
         ExceptGuard guard{ctx};
-        return fmt::format("AND NOT ( {} )", Translator<QuantifierPtr>{ctx}(stmt.inner));
+        return ir::Make<ir::Not>(Translator<QuantifierPtr>{ctx}(stmt.inner));
     }
 };
 
@@ -518,10 +599,162 @@ template <> class Translator<Block> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const Block &stmt) const
+    // `query` holds the clauses that bind variables the block reads before its own statements.
+    ir::Query operator()(const Block &stmt, ir::Query query = {}) const
     {
-        return fmt::to_string(fmt::join(
-            stmt.statements | std::views::transform(Translator<BodyStatementPtr>{ctx}), " "));
+        std::size_t excepts = 0;
+        for (const auto &statement : stmt.statements)
+        {
+            if (!statement)
+            {
+                throw std::runtime_error{"broken AST: ptr is null in translator"};
+            }
+            std::visit(
+                [&](const auto &body)
+                {
+                    using T = std::decay_t<decltype(body)>;
+                    if constexpr (std::is_same_v<T, AssignmentStatementPtr>)
+                    {
+                        auto clause = Translator<T>{ctx}(body);
+                        // A later assignment must not drop the variables bound before it.
+                        if (!query.clauses.empty())
+                        {
+                            auto &items = std::get<ir::With>(clause).items;
+                            items.insert(items.begin(),
+                                         ir::Projection{ir::Make<ir::Raw>("*"), ""});
+                        }
+                        query.clauses.push_back(std::move(clause));
+                    }
+                    else if constexpr (std::is_same_v<T, ExceptStatementPtr>)
+                    {
+                        auto except = Translator<T>{ctx}(body);
+                        if (ctx.options.optimize)
+                        {
+                            except = Precompute(query, std::move(except), excepts);
+                        }
+                        ir::AddWhere(query, std::move(except));
+                    }
+                    else
+                    {
+                        auto main = Main(body);
+                        for (auto &clause : main.clauses)
+                        {
+                            query.clauses.push_back(std::move(clause));
+                        }
+                    }
+                },
+                *statement);
+        }
+        return query;
+    }
+
+private:
+    static constexpr auto exceptPrefix = "__except";
+
+    // `NOT E`, where E holds a correlated subquery and reads only nodes bound by single-node
+    // patterns, is evaluated once for the whole label product instead of once per row:
+    //
+    //   OPTIONAL MATCH (c:Container) WHERE E WITH collect(DISTINCT elementId(c)) AS __except0
+    //   ... main query ... WHERE NOT elementId(c) IN __except0
+    //
+    // The match is optional so that an empty set still leaves one row: a later precompute is
+    // placed in front and carried through this WITH as a grouping key.
+    static ir::ExprPtr Precompute(ir::Query &query, ir::ExprPtr except, std::size_t &counter)
+    {
+        auto *negation = ir::As<ir::Not>(except);
+        if (negation == nullptr)
+        {
+            return except;
+        }
+        bool subquery = false;
+        bool opaque = false;
+        ir::Rewrite(negation->operand,
+                    [&](ir::ExprPtr &expr)
+                    {
+                        subquery = subquery || ir::As<ir::Exists>(expr) != nullptr;
+                        opaque = opaque || ir::As<ir::Raw>(expr) != nullptr;
+                    });
+        if (!subquery || opaque)
+        {
+            return except;
+        }
+
+        std::set<std::string> scope;
+        std::map<std::string, std::string> labels;
+        for (const auto &clause : query.clauses)
+        {
+            ir::Bind(clause, scope);
+            if (const auto *match = std::get_if<ir::Match>(&clause); match != nullptr)
+            {
+                for (const auto &path : match->patterns)
+                {
+                    if (path.variable.empty() && path.nodes.size() == 1 &&
+                        !path.nodes.front().label.empty())
+                    {
+                        labels.emplace(path.nodes.front().variable, path.nodes.front().label);
+                    }
+                }
+            }
+        }
+        std::vector<std::string> keys;
+        for (const auto &name : ir::FreeVariables(negation->operand))
+        {
+            if (!scope.contains(name))
+            {
+                continue;
+            }
+            if (!labels.contains(name))
+            {
+                return except;
+            }
+            keys.push_back(name);
+        }
+        if (keys.empty())
+        {
+            return except;
+        }
+
+        const auto name = exceptPrefix + std::to_string(counter++);
+        ir::Match match;
+        for (const auto &variable : keys)
+        {
+            match.patterns.push_back(
+                ir::PathPattern{"", {ir::NodePattern{variable, labels.at(variable)}}, {}});
+        }
+        match.where = std::move(negation->operand);
+        match.optional = true;
+        ir::With with;
+        with.items.push_back(
+            ir::Projection{ir::Make<ir::Aggregate>("collect", ir::ElementKey(keys), true), name});
+
+        // Clauses that narrow the scope must keep the precomputed set visible.
+        for (auto &clause : query.clauses)
+        {
+            if (auto *next = std::get_if<ir::With>(&clause);
+                next != nullptr && !ir::CarriesScope(*next))
+            {
+                next->items.push_back(ir::Projection{ir::Make<ir::Variable>(name), ""});
+            }
+        }
+        query.clauses.insert(query.clauses.begin(), std::move(with));
+        query.clauses.insert(query.clauses.begin(), std::move(match));
+        return ir::Make<ir::Not>(
+            ir::Make<ir::Binary>(ExprType::IN, ir::ElementKey(keys), ir::Make<ir::Variable>(name)));
+    }
+
+    ir::Query Main(const QuantifierPtr &quant) const
+    {
+        return std::visit(
+            [&](const auto &ptr) -> ir::Query
+            {
+                using T = typename std::decay_t<decltype(ptr)>::element_type;
+                if (!ptr)
+                {
+                    throw std::runtime_error{"broken AST: ptr is null in translator"};
+                }
+                return Translator<T>{ctx}.Witness(*ptr);
+            },
+            quant);
     }
 };
 
@@ -529,22 +762,153 @@ template <> class Translator<Rule> : TranslatorBase
 {
 public:
     using TranslatorBase::TranslatorBase;
-    TranslationResult operator()(const Rule &stmt) const
+    ir::Query operator()(const Rule &stmt, ir::Query prologue = {}) const
     {
-        std::string result = fmt::format(ruleNameFormat, stmt.name);
-        result += "\n" + fmt::format(descriptionFormat, stmt.description);
-        result += "\n" + fmt::format(priorityFormat, magic_enum::enum_name(stmt.priority)) + "\n";
-        return result + Translator<BlockPtr>{ctx}(stmt.calls) +
-               fmt::format(" RETURN {}", fmt::join(ctx.returns, " ,"));
+        if (!stmt.calls)
+        {
+            throw std::runtime_error{"broken AST: ptr is null in translator"};
+        }
+        auto query = Translator<Block>{ctx}(*stmt.calls, std::move(prologue));
+        query.comments = {fmt::format(ruleNameFormat, stmt.name),
+                          fmt::format(descriptionFormat, stmt.description),
+                          fmt::format(priorityFormat, magic_enum::enum_name(stmt.priority))};
+        if (!ctx.returns.empty())
+        {
+            ir::Return result;
+            for (const auto &name : ctx.returns)
+            {
+                result.items.push_back(ir::Projection{ir::Make<ir::Variable>(name), ""});
+            }
+            query.clauses.emplace_back(std::move(result));
+        }
+        return query;
+    }
+};
+
+// All instances of a template run as one query over the `$instances` table, one row per
+// instance, with the row's arguments bound to the template parameters:
+//
+//   UNWIND $instances AS __instance
+//   WITH __instance.instance AS instance, __instance.lst AS lst ... RETURN instance, c
+template <> class Translator<RuleTemplate> : TranslatorBase
+{
+public:
+    static constexpr auto tableParameter = "instances";
+    static constexpr auto rowVariable = "__instance";
+    static constexpr auto instanceColumn = "instance";
+
+    using TranslatorBase::TranslatorBase;
+    ir::Query operator()(const RuleTemplate &stmt) const
+    {
+        ir::With bind;
+        bind.items.push_back(Column(instanceColumn));
+        for (const auto &parameter : stmt.parameters)
+        {
+            if (parameter == instanceColumn || ctx.variableTable.contains(parameter))
+            {
+                throw ErrorHelper(templateParameterError, parameter);
+            }
+            ctx.variableTable.insert(parameter);
+            ctx.variableType[parameter] = KeywordSets::NONE;
+            bind.items.push_back(Column(parameter));
+        }
+        ir::Query prologue;
+        prologue.clauses.emplace_back(
+            ir::Unwind{ir::Make<ir::Raw>(fmt::format("${}", tableParameter)), rowVariable});
+        prologue.clauses.emplace_back(std::move(bind));
+
+        auto query = Translator<Rule>{ctx}(stmt.rule, std::move(prologue));
+        if (auto *result = std::get_if<ir::Return>(&query.clauses.back()); result != nullptr)
+        {
+            result->items.insert(result->items.begin(),
+                                 ir::Projection{ir::Make<ir::Variable>(instanceColumn), ""});
+        }
+        return query;
+    }
+
+    // The `$instances` rows as a cypher-shell `:param` command. Arguments are constants, so
+    // they are lowered before the template parameters enter the variable table.
+    std::string Table(const RuleTemplate &stmt) const
+    {
+        std::vector<std::string> rows;
+        for (const auto &instance : stmt.instances)
+        {
+            if (instance.templateName != stmt.rule.name ||
+                instance.arguments.size() != stmt.parameters.size())
+            {
+                throw ErrorHelper(instanceError, instance.name, stmt.rule.name,
+                                  stmt.parameters.size());
+            }
+            std::vector<std::string> fields{
+                fmt::format("{}: {}", instanceColumn,
+                            ir::Print(ir::Make<ir::Literal>(ir::LiteralValue{instance.name})))};
+            for (std::size_t i = 0; i < stmt.parameters.size(); ++i)
+            {
+                fields.push_back(
+                    fmt::format("{}: {}", stmt.parameters[i],
+                                ir::Print(Translator<ExpressionPtr>{ctx}(instance.arguments[i]))));
+            }
+            rows.push_back(fmt::format("{{{}}}", fmt::join(fields, ", ")));
+        }
+        return fmt::format(instancesFormat, tableParameter, fmt::join(rows, ", "));
+    }
+
+private:
+    static ir::Projection Column(const std::string &name)
+    {
+        return ir::Projection{
+            ir::Make<ir::Property>(ExprType::ACCESS, ir::Make<ir::Variable>(rowVariable), name),
+            name};
     }
 };
 
-template <typename U> TranslationResult Translate(U &&value)
+template <typename U> Lowered<std::decay_t<U>> Lower(U &&value, TranslatorContext &context)
 {
     using CleanType = std::decay_t<U>;
-    TranslatorContext context;
     Translator<CleanType> translator{context};
-    return translator(std::forward<U>(value));
+    auto result = translator(std::forward<U>(value));
+    if constexpr (std::is_same_v<Lowered<CleanType>, ir::Query>)
+    {
+        MakePipeline(context.options).Run(result);
+    }
+    return result;
+}
+
+template <typename U>
+TranslationResult Translate(U &&value, const TranslatorOptions &options = TranslatorOptions{})
+{
+    TranslatorContext context;
+    context.options = options;
+    return ir::Print(Lower(std::forward<U>(value), context), options.print);
+}
+
+// The instance table followed by the template query. The query text does not depend on the
+// instances, so the database plans it once however many instances the table holds.
+inline TranslationResult TranslateTemplate(const RuleTemplate &rule,
+                                           const TranslatorOptions &options = TranslatorOptions{})
+{
+    TranslatorContext context;
+    context.options = options;
+    auto table = Translator<RuleTemplate>{context}.Table(rule);
+    return table + "\n" + ir::Print(Lower(rule, context), options.print);
+}
+
+// A marker row naming the rule followed by the rule's query under PROFILE, so that captured
+// cypher-shell output can be attributed back to the rule (see profile/report.hpp).
+inline TranslationResult Profile(const Rule &rule,
+                                 const TranslatorOptions &options = TranslatorOptions{})
+{
+    TranslatorContext context;
+    context.options = options;
+    auto query = Lower(rule, context);
+    std::string result;
+    for (const auto &comment : query.comments)
+    {
+        result += fmt::format("// {}\n", comment);
+    }
+    query.comments.clear();
+    result += fmt::format(profileMarkerFormat, rule.name) + "\n";
+    return result + fmt::format(profileFormat, ir::Print(query, options.print)) + "\n";
 }
 
-}; // namespace lang::ast::cypher
\ No newline at end of file
+}; // namespace lang::ast::cypher
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <eval/value.hpp>
+
+#include <fmt/format.h>
+
+#include <magic_enum/magic_enum.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The register bytecode rule expressions are compiled to. Registers hold, in order, the
+// temporaries, the constants and the variables of a program; an instruction names them by
+// index, so the machine looks nothing up by name except properties.
+namespace lang::ast::vm
+{
+
+enum class Op : std::uint8_t
+{
+    MOVE,             // dst = a
+    GET,              // dst = a.names[b], null when a is null
+    HAS,              // dst = a.names[b] is not null, null when a is null
+    NEG,              // dst = -a, or not a
+    ADD,              // dst = a + b
+    SUB,              // dst = a - b
+    MUL,              // dst = a * b
+    DIV,              // dst = a / b
+    EQ,               // dst = a = b
+    NE,               // dst = a <> b
+    LT,               // dst = a < b
+    GT,               // dst = a > b
+    LE,               // dst = a <= b
+    GE,               // dst = a >= b
+    IN,               // dst = a in b
+    NOT_IN,           // dst = not (a in b)
+    AND,              // dst = a and b
+    OR,               // dst = a or b
+    XOR,              // dst = a xor b
+    LIST,             // dst = [a, a + 1, ..., a + b - 1]
+    JUMP,             // to a
+    JUMP_IF_FALSE,    // to b when a is exactly false
+    JUMP_IF_TRUE,     // to b when a is exactly true
+    JUMP_UNLESS_TRUE, // to b when a is false or null
+    RETURN            // the value of a
+};
+
+struct Instruction
+{
+    Op op;
+    std::uint16_t dst = 0;
+    std::uint16_t a = 0;
+    std::uint16_t b = 0;
+};
+
+static_assert(sizeof(Instruction) == 8);
+
+struct Program
+{
+    std::vector<Instruction> code;
+    std::vector<eval::Value> constants;
+    // The properties GET and HAS read, by name.
+    std::vector<std::string> names;
+    // The free variables, in the order Machine::Run takes their values.
+    std::vector<std::string> variables;
+    std::size_t temporaries = 0;
+
+    [[nodiscard]] std::size_t Registers() const
+    {
+        return temporaries + constants.size() + variables.size();
+    }
+};
+
+// One instruction per line, for tests and for reading what the compiler made of a rule.
+inline std::string Disassemble(const Program &program)
+{
+    std::string text;
+    for (std::size_t pc = 0; pc < program.code.size(); ++pc)
+    {
+        const auto &in = program.code[pc];
+        text += fmt::format("{:>4} {:<16} {} {} {}", pc, magic_enum::enum_name(in.op), in.dst,
+                            in.a, in.b);
+        if (in.op == Op::GET || in.op == Op::HAS)
+        {
+            text += " ; " + program.names[in.b];
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+} // namespace lang::ast::vm
@@ -0,0 +1,440 @@
+#pragma once
+
+#include "vm/bytecode.hpp"
+
+#include <ast/expression.hpp>
+#include <eval/value.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Lowers an expression tree to bytecode. Every node compiles to the register its value ends up
+// in: literals and variables to their own, with no instruction, anything else to the lowest
+// free temporary, so temporaries are taken and released like a stack.
+namespace lang::ast::vm
+{
+
+namespace detail
+{
+
+// Operands while compiling: the kind of register in the top bits, its index below. Constants
+// and variables are only placed after the temporaries once their number is known.
+inline constexpr std::uint32_t constantOperand = 1U << 30;
+inline constexpr std::uint32_t variableOperand = 2U << 30;
+inline constexpr std::uint32_t operandIndex = constantOperand - 1;
+
+struct Pending
+{
+    Op op;
+    std::uint32_t dst = 0;
+    std::uint32_t a = 0;
+    std::uint32_t b = 0;
+};
+
+inline constexpr bool Binary(Op op)
+{
+    return op >= Op::ADD && op <= Op::XOR;
+}
+
+} // namespace detail
+
+struct CompilerContext
+{
+    std::vector<detail::Pending> code{};
+    std::vector<eval::Value> constants{};
+    std::vector<std::string> names{};
+    std::vector<std::string> variables{};
+    std::uint32_t next = 0;
+    std::uint32_t temporaries = 0;
+
+    std::uint32_t Temporary()
+    {
+        temporaries = std::max(temporaries, next + 1);
+        return next++;
+    }
+
+    std::uint32_t Constant(eval::Value value)
+    {
+        auto it = std::ranges::find(constants, value);
+        if (it == constants.end())
+        {
+            it = constants.insert(it, std::move(value));
+        }
+        return detail::constantOperand | static_cast<std::uint32_t>(it - constants.begin());
+    }
+
+    std::uint32_t Variable(const std::string &name)
+    {
+        return detail::variableOperand | Index(variables, name);
+    }
+
+    std::uint32_t Name(const std::string &name)
+    {
+        return Index(names, name);
+    }
+
+    std::size_t Emit(Op op, std::uint32_t dst, std::uint32_t a = 0, std::uint32_t b = 0)
+    {
+        code.push_back({op, dst, a, b});
+        return code.size() - 1;
+    }
+
+    // Points the jump at `at` to the next instruction.
+    void Patch(std::size_t at)
+    {
+        auto &jump = code[at];
+        (jump.op == Op::JUMP ? jump.a : jump.b) = static_cast<std::uint32_t>(code.size());
+    }
+
+    // Leaves `operand` in temporary `dst`.
+    void Move(std::uint32_t dst, std::uint32_t operand)
+    {
+        if (operand != dst)
+        {
+            Emit(Op::MOVE, dst, operand);
+        }
+    }
+
+private:
+    static std::uint32_t Index(std::vector<std::string> &list, const std::string &name)
+    {
+        auto it = std::ranges::find(list, name);
+        if (it == list.end())
+        {
+            it = list.insert(it, name);
+        }
+        return static_cast<std::uint32_t>(it - list.begin());
+    }
+};
+
+class CompilerBase
+{
+protected:
+    CompilerContext &ctx;
+
+public:
+    explicit CompilerBase(CompilerContext &context) : ctx(context)
+    {
+    }
+    virtual ~CompilerBase() = default;
+};
+
+template <typename T> class Compiler : CompilerBase
+{
+public:
+    std::uint32_t operator()(const T & /*unused*/) const
+    {
+        throw std::runtime_error{"unimplemented compilation"};
+    }
+};
+
+template <typename... Ts> class Compiler<std::variant<Ts...>> : CompilerBase
+{
+public:
+    using CompilerBase::CompilerBase;
+    std::uint32_t operator()(const std::variant<Ts...> &var) const
+    {
+        return std::visit([&](auto &subValue)
+                          { return Compiler<std::decay_t<decltype(subValue)>>{ctx}(subValue); },
+                          var);
+    }
+};
+
+template <typename T> class Compiler<std::unique_ptr<T>> : CompilerBase
+{
+public:
+    using CompilerBase::CompilerBase;
+    std::uint32_t operator()(const std::unique_ptr<T> &ptr) const
+    {
+        if (!ptr)
+        {
+            throw std::runtime_error{"broken AST: ptr is null in compiler"};
+        }
+        return Compiler<T>{ctx}(*ptr);
+    }
+};
+
+// Keyword sets and functions need the whole workspace; rules keep them in the quantifiers the
+// evaluator runs.
+template <KeywordSets K> class Compiler<KeywordExpr<K>> : CompilerBase
+{
+public:
+    using CompilerBase::CompilerBase;
+    std::uint32_t operator()(const KeywordExpr<K> & /*unused*/) const
+    {
+        throw std::runtime_error{"Keyword sets are not supported in bytecode"};
+    }
+};
+
+template <> class Compiler<CallExpr> : CompilerBase
+{
+public:
+    using CompilerBase::CompilerBase;
+    std::uint32_t operator()(const CallExpr &expr) const
+    {
+        throw std::runtime_error{
+            fmt::format("Function [{}] is not supported in bytecode", expr.functionName)};
+    }
+};
+
+template <typename T> class Compiler<LiteralExpr<T>> : CompilerBase
+{
+public:
+    using CompilerBase::CompilerBase;
+    std::uint32_t operator()(const LiteralExpr<T> &lit) const
+    {
+        return ctx.Constant(eval::Value{lit.value});
+    }
+};
+
+template <> class Compiler<VariableExpr> : CompilerBase
+{
+public:
+    using CompilerBase::CompilerBase;
+    std::uint32_t operator()(const VariableExpr &var) const
+    {
+        return ctx.Variable(var.name);
+    }
+};
+
+// A list of constants is a constant; anything else is built from consecutive temporaries.
+template <> class Compiler<SetExpr> : CompilerBase
+{
+public:
+    using CompilerBase::CompilerBase;
+    std::uint32_t operator()(const SetExpr &expr) const
+    {
+        if (Constant(expr))
+        {
+            eval::List values;
+            for (const auto &item : expr.items)
+            {
+                values.push_back(ctx.constants[Compiler<ExpressionPtr>{ctx}(item) &
+                                               detail::operandIndex]);
+            }
+            return ctx.Constant(std::move(values));
+        }
+        const auto mark = ctx.next;
+        for (const auto &item : expr.items)
+        {
+            const auto slot = ctx.next;
+            const auto operand = Compiler<ExpressionPtr>{ctx}(item);
+            ctx.next = slot;
+            ctx.Move(ctx.Temporary(), operand);
+        }
+        ctx.next = mark;
+        const auto dst = ctx.Temporary();
+        ctx.Emit(Op::LIST, dst, mark, static_cast<std::uint32_t>(expr.items.size()));
+        return dst;
+    }
+
+private:
+    static bool Constant(const SetExpr &expr)
+    {
+        return std::ranges::all_of(
+            expr.items,
+            [](const ExpressionPtr &item)
+            {
+                return std::holds_alternative<NumberPtr>(*item) ||
+                       std::holds_alternative<StringPtr>(*item) ||
+                       std::holds_alternative<BoolPtr>(*item) ||
+                       (std::holds_alternative<SetPtr>(*item) &&
+                        Constant(*std::get<SetPtr>(*item)));
+            });
+    }
+};
+
+template <ExprType K> class Compiler<AccessExpr<K>> : CompilerBase
+{
+public:
+    using CompilerBase::CompilerBase;
+    std::uint32_t operator()(const AccessExpr<K> &expr) const
+    {
+        const auto mark = ctx.next;
+        const auto operand = Compiler<ExpressionPtr>{ctx}(expr.operand);
+        ctx.next = mark;
+        const auto dst = ctx.Temporary();
+        ctx.Emit(K == ExprType::SAFE_ACCESS ? Op::HAS : Op::GET, dst, operand,
+                 ctx.Name(expr.prop));
+        return dst;
+    }
+};
+
+template <ExprType K> class Compiler<UnaryExpr<K>> : CompilerBase
+{
+public:
+    using CompilerBase::CompilerBase;
+    std::uint32_t operator()(const UnaryExpr<K> &expr) const
+    {
+        const auto mark = ctx.next;
+        const auto operand = Compiler<ExpressionPtr>{ctx}(expr.operand);
+        ctx.next = mark;
+        const auto dst = ctx.Temporary();
+        ctx.Emit(Op::NEG, dst, operand);
+        return dst;
+    }
+};
+
+template <template <ExprType> class T, ExprType U>
+concept BinaryOperands = requires(T<U> tmp) {
+    requires std::same_as<decltype(tmp.left), ExpressionPtr>;
+    requires std::same_as<decltype(tmp.right), ExpressionPtr>;
+};
+
+constexpr Op BinaryOp(ExprType type)
+{
+    switch (type)
+    {
+    case ExprType::PLUS:
+        return Op::ADD;
+    case ExprType::MINUS:
+        return Op::SUB;
+    case ExprType::MULT:
+        return Op::MUL;
+    case ExprType::DIV:
+        return Op::DIV;
+    case ExprType::EQ:
+        return Op::EQ;
+    case ExprType::NOT_EQ:
+        return Op::NE;
+    case ExprType::LESS:
+        return Op::LT;
+    case ExprType::GREATER:
+        return Op::GT;
+    case ExprType::LESS_EQ:
+        return Op::LE;
+    case ExprType::GREATER_EQ:
+        return Op::GE;
+    case ExprType::IN:
+        return Op::IN;
+    case ExprType::NOT_IN:
+        return Op::NOT_IN;
+    case ExprType::AND:
+        return Op::AND;
+    case ExprType::OR:
+        return Op::OR;
+    default:
+        return Op::XOR;
+    }
+}
+
+template <template <ExprType> class T, ExprType U>
+    requires BinaryOperands<T, U>
+class Compiler<T<U>> : CompilerBase
+{
+public:
+    using CompilerBase::CompilerBase;
+    std::uint32_t operator()(const T<U> &expr) const
+    {
+        const auto mark = ctx.next;
+        const auto left = Compiler<ExpressionPtr>{ctx}(expr.left);
+        if constexpr (U == ExprType::AND || U == ExprType::OR)
+        {
+            // The left operand stays in dst when it decides the result on its own.
+            ctx.next = mark;
+            const auto dst = ctx.Temporary();
+            ctx.Move(dst, left);
+            const auto jump =
+                ctx.Emit(U == ExprType::AND ? Op::JUMP_IF_FALSE : Op::JUMP_IF_TRUE, 0, dst);
+            const auto right = Compiler<ExpressionPtr>{ctx}(expr.right);
+            ctx.next = mark + 1;
+            ctx.Emit(BinaryOp(U), dst, dst, right);
+            ctx.Patch(jump);
+            return dst;
+        }
+        else
+        {
+            const auto right = Compiler<ExpressionPtr>{ctx}(expr.right);
+            ctx.next = mark;
+            const auto dst = ctx.Temporary();
+            ctx.Emit(BinaryOp(U), dst, left, right);
+            return dst;
+        }
+    }
+};
+
+template <> class Compiler<TernaryExpr> : CompilerBase
+{
+public:
+    using CompilerBase::CompilerBase;
+    std::uint32_t operator()(const TernaryExpr &expr) const
+    {
+        const auto mark = ctx.next;
+        const auto condition = Compiler<ExpressionPtr>{ctx}(expr.condition);
+        ctx.next = mark;
+        const auto otherwise = ctx.Emit(Op::JUMP_UNLESS_TRUE, 0, condition);
+        const auto dst = ctx.Temporary();
+        ctx.next = mark;
+        ctx.Move(dst, Compiler<ExpressionPtr>{ctx}(expr.thenExpr));
+        const auto end = ctx.Emit(Op::JUMP, 0);
+        ctx.Patch(otherwise);
+        ctx.next = mark;
+        ctx.Move(dst, Compiler<ExpressionPtr>{ctx}(expr.elseExpr));
+        ctx.Patch(end);
+        ctx.next = mark + 1;
+        return dst;
+    }
+};
+
+namespace detail
+{
+
+// Places constants and variables after the temporaries and narrows operands to 16 bits.
+inline Program Finalize(CompilerContext &&ctx)
+{
+    Program program;
+    program.temporaries = ctx.temporaries;
+    program.constants = std::move(ctx.constants);
+    program.names = std::move(ctx.names);
+    program.variables = std::move(ctx.variables);
+    if (program.Registers() > UINT16_MAX || ctx.code.size() > UINT16_MAX)
+    {
+        throw std::runtime_error{"Expression is too large for bytecode"};
+    }
+    const auto reg = [&](std::uint32_t operand)
+    {
+        const auto index = operand & operandIndex;
+        switch (operand & ~operandIndex)
+        {
+        case constantOperand:
+            return static_cast<std::uint16_t>(program.temporaries + index);
+        case variableOperand:
+            return static_cast<std::uint16_t>(program.temporaries + program.constants.size() +
+                                              index);
+        default:
+            return static_cast<std::uint16_t>(index);
+        }
+    };
+    program.code.reserve(ctx.code.size());
+    for (const auto &in : ctx.code)
+    {
+        const auto jump = in.op == Op::JUMP;
+        program.code.push_back({in.op, reg(in.dst), jump ? static_cast<std::uint16_t>(in.a)
+                                                         : reg(in.a),
+                                Binary(in.op) ? reg(in.b) : static_cast<std::uint16_t>(in.b)});
+    }
+    return program;
+}
+
+} // namespace detail
+
+template <typename U> Program Compile(const U &value)
+{
+    CompilerContext context;
+    const auto result = Compiler<std::decay_t<U>>{context}(value);
+    context.Emit(Op::RETURN, 0, result);
+    return detail::Finalize(std::move(context));
+}
+
+} // namespace lang::ast::vm
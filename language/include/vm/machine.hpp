@@ -0,0 +1,449 @@
+#pragma once
+
+#include "vm/bytecode.hpp"
+
+#include <eval/operators.hpp>
+#include <eval/value.hpp>
+#include <eval/workspace.hpp>
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Runs bytecode against the properties of elements. A provider resolves a property name to a
+// key once per program, `Key(name)`, and reads it per element, `Lookup(node, key)`, null for a
+// missing property: PropertyMap by name, Records by slot.
+namespace lang::ast::vm
+{
+
+template <typename P>
+concept PropertyProvider = requires(const P &provider, eval::Node node, const std::string &name) {
+    { provider.Lookup(node, provider.Key(name)) } -> std::convertible_to<const eval::Value *>;
+};
+
+// Properties set by hand, for running a program without a workspace.
+class PropertyMap
+{
+public:
+    void Set(eval::Node node, const std::string &name, eval::Value value)
+    {
+        properties_[node.index][name] = std::move(value);
+    }
+
+    [[nodiscard]] const std::string &Key(const std::string &name) const
+    {
+        return name;
+    }
+
+    [[nodiscard]] const eval::Value *Lookup(eval::Node node, const std::string &name) const
+    {
+        const auto element = properties_.find(node.index);
+        if (element == properties_.end())
+        {
+            return nullptr;
+        }
+        const auto it = element->second.find(name);
+        return it == element->second.end() ? nullptr : &it->second;
+    }
+
+private:
+    std::map<std::uint32_t, std::map<std::string, eval::Value, std::less<>>> properties_;
+};
+
+// A record per element of a workspace with one slot per property name, so a lookup is an index
+// into memory laid out element by element instead of a search by name.
+class Records
+{
+public:
+    static constexpr std::uint32_t missing = UINT32_MAX;
+
+    explicit Records(const eval::Workspace &workspace) : elements_(workspace.properties.size())
+    {
+        for (const auto &properties : workspace.properties)
+        {
+            for (const auto &[name, value] : properties)
+            {
+                slots_.try_emplace(name, static_cast<std::uint32_t>(slots_.size()));
+            }
+        }
+        cells_.resize(elements_ * slots_.size());
+        for (std::size_t element = 0; element < elements_; ++element)
+        {
+            for (const auto &[name, value] : workspace.properties[element])
+            {
+                cells_[element * slots_.size() + slots_.at(name)] = value;
+            }
+        }
+    }
+
+    [[nodiscard]] std::uint32_t Key(const std::string &name) const
+    {
+        const auto it = slots_.find(name);
+        return it == slots_.end() ? missing : it->second;
+    }
+
+    [[nodiscard]] const eval::Value *Lookup(eval::Node node, std::uint32_t slot) const
+    {
+        if (slot == missing || node.index >= elements_)
+        {
+            return nullptr;
+        }
+        return &cells_[node.index * slots_.size() + slot];
+    }
+
+private:
+    std::size_t elements_;
+    std::unordered_map<std::string, std::uint32_t> slots_;
+    std::vector<eval::Value> cells_;
+};
+
+namespace detail
+{
+
+inline const eval::Value null{};
+
+// A register either borrows a value that outlives the run, a constant, an argument or a
+// property, or owns one it computed. Borrowing keeps strings and lists from being copied.
+struct Register
+{
+    const eval::Value *ref = nullptr;
+    eval::Value owned;
+
+    [[nodiscard]] const eval::Value &Get() const
+    {
+        return ref != nullptr ? *ref : owned;
+    }
+
+    void Borrow(const eval::Value *value)
+    {
+        ref = value;
+    }
+
+    void Set(eval::Value value)
+    {
+        owned = std::move(value);
+        ref = nullptr;
+    }
+
+    // Writes a boolean or an integer over the one the register already owns, if any.
+    template <typename T> void Put(T value)
+    {
+        if (auto *slot = std::get_if<T>(&owned.data); slot != nullptr)
+        {
+            *slot = value;
+        }
+        else
+        {
+            owned.data.template emplace<T>(value);
+        }
+        ref = nullptr;
+    }
+};
+
+inline ExprType Operator(Op op)
+{
+    switch (op)
+    {
+    case Op::ADD:
+        return ExprType::PLUS;
+    case Op::SUB:
+        return ExprType::MINUS;
+    case Op::MUL:
+        return ExprType::MULT;
+    case Op::DIV:
+        return ExprType::DIV;
+    case Op::LT:
+        return ExprType::LESS;
+    case Op::GT:
+        return ExprType::GREATER;
+    case Op::LE:
+        return ExprType::LESS_EQ;
+    default:
+        return ExprType::GREATER_EQ;
+    }
+}
+
+// The operators on integers, booleans and strings that need no Value built: false when the
+// generic operator has to decide, as it does for null, mixed types and division by zero.
+inline bool Fast(Op op, const eval::Value &left, const eval::Value &right, Register &dst)
+{
+    if (const auto *l = left.As<std::int64_t>(), *r = right.As<std::int64_t>(); l && r)
+    {
+        const auto x = *l;
+        const auto y = *r;
+        switch (op)
+        {
+        case Op::ADD:
+            dst.Put(x + y);
+            return true;
+        case Op::SUB:
+            dst.Put(x - y);
+            return true;
+        case Op::MUL:
+            dst.Put(x * y);
+            return true;
+        case Op::DIV:
+            if (y == 0)
+            {
+                return false;
+            }
+            dst.Put(x / y);
+            return true;
+        case Op::EQ:
+            dst.Put(x == y);
+            return true;
+        case Op::NE:
+            dst.Put(x != y);
+            return true;
+        case Op::LT:
+            dst.Put(x < y);
+            return true;
+        case Op::GT:
+            dst.Put(x > y);
+            return true;
+        case Op::LE:
+            dst.Put(x <= y);
+            return true;
+        case Op::GE:
+            dst.Put(x >= y);
+            return true;
+        default:
+            return false;
+        }
+    }
+    if (const auto *l = left.As<bool>(), *r = right.As<bool>(); l && r)
+    {
+        const auto x = *l;
+        const auto y = *r;
+        switch (op)
+        {
+        case Op::AND:
+            dst.Put(x && y);
+            return true;
+        case Op::OR:
+            dst.Put(x || y);
+            return true;
+        case Op::EQ:
+            dst.Put(x == y);
+            return true;
+        case Op::NE:
+        case Op::XOR:
+            dst.Put(x != y);
+            return true;
+        default:
+            return false;
+        }
+    }
+    if (const auto *l = left.As<std::string>(), *r = right.As<std::string>(); l && r)
+    {
+        if (op == Op::EQ || op == Op::NE)
+        {
+            dst.Put((*l == *r) == (op == Op::EQ));
+            return true;
+        }
+    }
+    // A scalar in a list equals an item exactly when it is the same value.
+    if (const auto *items = right.As<eval::List>(); items != nullptr &&
+                                                    (op == Op::IN || op == Op::NOT_IN) &&
+                                                    !left.IsNull() && !left.As<eval::List>())
+    {
+        bool unknown = false;
+        for (const auto &item : *items)
+        {
+            if (item == left)
+            {
+                dst.Put(op == Op::IN);
+                return true;
+            }
+            unknown = unknown || item.IsNull();
+        }
+        if (!unknown)
+        {
+            dst.Put(op == Op::NOT_IN);
+            return true;
+        }
+    }
+    return false;
+}
+
+inline eval::Value Binary(Op op, const eval::Value &left, const eval::Value &right)
+{
+    switch (op)
+    {
+    case Op::ADD:
+    case Op::SUB:
+    case Op::MUL:
+    case Op::DIV:
+        return eval::Arithmetic(Operator(op), left, right);
+    case Op::LT:
+    case Op::GT:
+    case Op::LE:
+    case Op::GE:
+        return eval::Ordered(Operator(op), left, right);
+    case Op::EQ:
+        return eval::Equal(left, right);
+    case Op::NE:
+        return eval::Not(eval::Equal(left, right));
+    case Op::IN:
+        return eval::In(left, right);
+    case Op::NOT_IN:
+        return eval::Not(eval::In(left, right));
+    case Op::AND:
+        return eval::And(left, right);
+    case Op::OR:
+        return eval::Or(left, right);
+    default:
+        return eval::Xor(left, right);
+    }
+}
+
+} // namespace detail
+
+// Runs one program against one provider, as many times as there are elements to check: keys
+// are resolved and constants placed once, and the registers are reused between runs.
+template <PropertyProvider P> class Machine
+{
+public:
+    Machine(const Program &program, const P &provider)
+        : program_(program), provider_(provider), registers_(program.Registers())
+    {
+        for (const auto &name : program.names)
+        {
+            keys_.push_back(provider.Key(name));
+        }
+        for (std::size_t i = 0; i < program.constants.size(); ++i)
+        {
+            registers_[program.temporaries + i].Borrow(&program.constants[i]);
+        }
+    }
+
+    // `arguments` are the values of program.variables, in order.
+    eval::Value Run(std::span<const eval::Value> arguments)
+    {
+        if (arguments.size() < program_.variables.size())
+        {
+            throw std::runtime_error{"Not enough arguments for the program's variables"};
+        }
+        auto *r = registers_.data();
+        auto *variables = r + program_.temporaries + program_.constants.size();
+        for (std::size_t i = 0; i < program_.variables.size(); ++i)
+        {
+            variables[i].Borrow(&arguments[i]);
+        }
+
+        for (std::size_t pc = 0;;)
+        {
+            const auto &in = program_.code[pc++];
+            switch (in.op)
+            {
+            case Op::MOVE:
+                if (r[in.a].ref != nullptr)
+                {
+                    r[in.dst].Borrow(r[in.a].ref);
+                }
+                else
+                {
+                    r[in.dst].Set(r[in.a].owned);
+                }
+                break;
+            case Op::GET:
+            case Op::HAS: {
+                const auto &operand = r[in.a].Get();
+                if (operand.IsNull())
+                {
+                    r[in.dst].Borrow(&detail::null);
+                    break;
+                }
+                const auto *node = operand.As<eval::Node>();
+                if (node == nullptr)
+                {
+                    throw eval::EvaluationError(eval::accessError, program_.names[in.b]);
+                }
+                const eval::Value *value = provider_.Lookup(*node, keys_[in.b]);
+                if (in.op == Op::HAS)
+                {
+                    r[in.dst].Put(value != nullptr && !value->IsNull());
+                }
+                else
+                {
+                    r[in.dst].Borrow(value != nullptr ? value : &detail::null);
+                }
+                break;
+            }
+            case Op::NEG:
+                if (const auto *number = r[in.a].Get().As<std::int64_t>(); number != nullptr)
+                {
+                    r[in.dst].Put(-*number);
+                }
+                else
+                {
+                    r[in.dst].Set(eval::Negate(r[in.a].Get()));
+                }
+                break;
+            case Op::LIST: {
+                eval::List items;
+                items.reserve(in.b);
+                for (std::size_t i = 0; i < in.b; ++i)
+                {
+                    items.push_back(r[in.a + i].Get());
+                }
+                r[in.dst].Set(std::move(items));
+                break;
+            }
+            case Op::JUMP:
+                pc = in.a;
+                break;
+            case Op::JUMP_IF_FALSE:
+                if (eval::Truth(r[in.a].Get()) == std::optional<bool>{false})
+                {
+                    pc = in.b;
+                }
+                break;
+            case Op::JUMP_IF_TRUE:
+                if (eval::IsTrue(r[in.a].Get()))
+                {
+                    pc = in.b;
+                }
+                break;
+            case Op::JUMP_UNLESS_TRUE:
+                if (!eval::IsTrue(r[in.a].Get()))
+                {
+                    pc = in.b;
+                }
+                break;
+            case Op::RETURN:
+                return r[in.a].Get();
+            default: {
+                const auto &left = r[in.a].Get();
+                const auto &right = r[in.b].Get();
+                if (!detail::Fast(in.op, left, right, r[in.dst]))
+                {
+                    r[in.dst].Set(detail::Binary(in.op, left, right));
+                }
+                break;
+            }
+            }
+        }
+    }
+
+private:
+    using Key = std::decay_t<decltype(std::declval<const P &>().Key(std::string{}))>;
+
+    const Program &program_;
+    const P &provider_;
+    std::vector<Key> keys_;
+    std::vector<detail::Register> registers_;
+};
+
+} // namespace lang::ast::vm
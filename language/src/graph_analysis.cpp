@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <graph/biconnected.hpp>
+#include <graph/workspace.hpp>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+
+// The properties converter.py writes back after import: articulationPoint per node, and the
+// biconnected component and bridge flag per pair of adjacent nodes. Every edge between two
+// nodes lies in the one component that contains both of them.
+nlohmann::json Analyse(const lang::graph::Graph &graph)
+{
+    const auto biconnectivity = lang::graph::Biconnected(graph);
+    std::vector<std::vector<std::int64_t>> components(graph.NodeCount());
+    for (std::size_t index = 0; index < biconnectivity.components.size(); ++index)
+    {
+        for (const auto node : biconnectivity.components[index])
+        {
+            components[node].push_back(static_cast<std::int64_t>(index));
+        }
+    }
+
+    auto nodes = nlohmann::json::array();
+    for (lang::graph::NodeId node = 0; node < graph.NodeCount(); ++node)
+    {
+        nodes.push_back({{"id", graph.Id(node)},
+                         {"articulationPoint", biconnectivity.articulationPoints[node] ? 1 : 0}});
+    }
+
+    std::vector<std::pair<lang::graph::NodeId, lang::graph::NodeId>> pairs;
+    for (lang::graph::NodeId node = 0; node < graph.NodeCount(); ++node)
+    {
+        for (const auto relation : lang::graph::relations)
+        {
+            for (const auto target : graph.Out(node, relation))
+            {
+                if (target != node)
+                {
+                    pairs.push_back(std::minmax(node, target));
+                }
+            }
+        }
+    }
+    std::ranges::sort(pairs);
+    pairs.erase(std::ranges::unique(pairs).begin(), pairs.end());
+    auto bridges = biconnectivity.bridges;
+    for (auto &[parent, child] : bridges)
+    {
+        if (child < parent)
+        {
+            std::swap(parent, child);
+        }
+    }
+    std::ranges::sort(bridges);
+
+    auto relationships = nlohmann::json::array();
+    for (const auto &[source, target] : pairs)
+    {
+        std::vector<std::int64_t> shared;
+        std::ranges::set_intersection(components[source], components[target],
+                                      std::back_inserter(shared));
+        relationships.push_back({{"sourceId", graph.Id(source)},
+                                 {"destinationId", graph.Id(target)},
+                                 {"biconnectedComponent", shared.at(0)},
+                                 {"bridge", std::ranges::binary_search(
+                                                bridges, std::pair{source, target})}});
+    }
+    return {{"nodes", std::move(nodes)},
+            {"relationships", std::move(relationships)},
+            {"componentCount", biconnectivity.components.size()}};
+}
+
+int main(int argc, char *argv[])
+{
+    std::string usage = "Usage: " + std::string(argv[0]) +
+                        " -f <workspace.json> [-o <output_file>|-]\n"
+                        "       articulation points, bridges and biconnected components of the\n"
+                        "       undirected RELATES_TO/CONTAINS/INSTANCE_OF graph, as JSON for\n"
+                        "       converter.py.";
+
+    fs::path inputPath;
+    fs::path outputPath = "-";
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-f" && i + 1 < argc)
+        {
+            inputPath = fs::path(argv[++i]);
+        }
+        else if (arg == "-o" && i + 1 < argc)
+        {
+            outputPath = fs::path(argv[++i]);
+        }
+        else
+        {
+            std::cerr << "Неизвестный аргумент: " << arg << std::endl;
+            std::cerr << usage << std::endl;
+            return 1;
+        }
+    }
+
+    if (inputPath.empty())
+    {
+        std::cerr << usage << std::endl;
+        return 1;
+    }
+
+    std::ifstream inFile(inputPath);
+    if (!inFile)
+    {
+        std::cerr << "Не удалось открыть входной файл: " << inputPath << std::endl;
+        return 1;
+    }
+
+    nlohmann::json result;
+    try
+    {
+        result = Analyse(lang::graph::LoadGraph(nlohmann::json::parse(inFile)));
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << inputPath << ": " << error.what() << std::endl;
+        return 1;
+    }
+
+    if (outputPath == "-")
+    {
+        std::cout << result.dump() << std::endl;
+        return 0;
+    }
+    std::ofstream outFile(outputPath);
+    if (!outFile)
+    {
+        std::cerr << "Output file is not open: " << outputPath << std::endl;
+        return 1;
+    }
+    outFile << result.dump() << std::endl;
+    return 0;
+}
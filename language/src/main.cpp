@@ -7,13 +7,57 @@
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <unistd.h>
+#include <utility>
+#include <variant>
 
+#include <binary/decoder.hpp>
+#include <binary/writer.hpp>
+#include <eval/evaluator.hpp>
+#include <json/deserializer.hpp>
 #include <json/serializer.hpp>
+#include <json/writer.hpp>
 #include <parser/parser.hpp>
 #include <translator/translator.hpp>
 
 namespace fs = std::filesystem;
 
+int Write(const std::string &output, bool outputProvided, const fs::path &outputPath,
+          std::ios::openmode mode = std::ios::out)
+{
+    if (!outputProvided || outputPath == "-")
+    {
+        std::cout << output;
+    }
+    else
+    {
+        std::ofstream outFile(outputPath, mode);
+        if (!outFile)
+        {
+            std::cerr << "Output file is not open: " << outputPath << std::endl;
+            return 1;
+        }
+        outFile << output;
+    }
+
+    return 0;
+}
+
+// Streams the AST as JSON straight to stdout, or collects it for an output file.
+template <typename T>
+int WriteJson(const T &value, const lang::ast::json::WriteOptions &options, bool outputProvided,
+              const fs::path &outputPath)
+{
+    if (!outputProvided || outputPath == "-")
+    {
+        std::cout.flush();
+        lang::ast::json::Write(value, STDOUT_FILENO, options);
+        return 0;
+    }
+
+    return Write(lang::ast::json::Write(value, options), outputProvided, outputPath);
+}
+
 constexpr std::string Trim(std::string_view const input)
 {
     auto view = input | std::views::drop_while(isspace) | std::views::reverse |
@@ -24,8 +68,24 @@ constexpr std::string Trim(std::string_view const input)
 int main(int argc, char *argv[])
 {
     std::string usage = "Usage: " + std::string(argv[0]) +
-                        " [-f <input_file>|-] [-o <output_file>|-] -t <json|cypher>\n"
-                        "       use '-' for stdin/stdout mode.";
+                        " [-f <input_file>|-] [-o <output_file>|-]"
+                        " -t <json|binary|cypher|profile|eval>"
+                        " [-p] [-O] [-d] [-c] [-l] [-w <param|group>]\n"
+                        " [-s <statistics.json>] [-i <json|binary>] [-m <workspace.json>]\n"
+                        "       use '-' for stdin/stdout mode.\n"
+                        "       -p  pretty-print generated Cypher\n"
+                        "       -O  run IR optimization passes on generated Cypher\n"
+                        "       -d  precompute EXISTS subqueries as sets of matching nodes\n"
+                        "       -c  query IN_SUBTREE edges (converter --closure) for CONTAINS*\n"
+                        "       -l  omit source locations from -t json and -t binary output\n"
+                        "       -w  scope nodes to the $workspace parameter or group findings"
+                        " by workspace\n"
+                        "       -s  label/property statistics used by -O to order predicates\n"
+                        "       -i  read a rule AST written by -t json or -t binary instead of"
+                        " source\n"
+                        "       -t binary  compact AST encoding read in place (binary/reader.hpp)\n"
+                        "       -t profile  wrap the rule in PROFILE for profile-report\n"
+                        "       -t eval  run the rule on the -m workspace.json without Neo4j";
 
     if (argc < 3)
     {
@@ -38,6 +98,10 @@ int main(int argc, char *argv[])
     fs::path inputPath;
     fs::path outputPath;
     std::string saveType;
+    std::string loadType;
+    fs::path workspacePath;
+    lang::ast::cypher::TranslatorOptions translatorOptions;
+    lang::ast::json::WriteOptions jsonOptions;
 
     for (int i = 1; i < argc; i++)
     {
@@ -72,6 +136,76 @@ int main(int argc, char *argv[])
         {
             saveType = argv[++i];
         }
+        else if (arg == "-i" && i + 1 < argc)
+        {
+            loadType = argv[++i];
+            if (loadType != "json" && loadType != "binary")
+            {
+                std::cerr << "Ошибка: формат -i должен быть 'json' или 'binary'." << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "-m" && i + 1 < argc)
+        {
+            workspacePath = fs::path(argv[++i]);
+        }
+        else if (arg == "-p")
+        {
+            translatorOptions.print.pretty = true;
+        }
+        else if (arg == "-O")
+        {
+            translatorOptions.optimize = true;
+        }
+        else if (arg == "-d")
+        {
+            translatorOptions.decorrelate = true;
+        }
+        else if (arg == "-c")
+        {
+            translatorOptions.closure = true;
+        }
+        else if (arg == "-l")
+        {
+            jsonOptions.locations = false;
+        }
+        else if (arg == "-w" && i + 1 < argc)
+        {
+            std::string scope = argv[++i];
+            if (scope == "param")
+            {
+                translatorOptions.workspace = lang::ast::cypher::WorkspaceScope::PARAMETER;
+            }
+            else if (scope == "group")
+            {
+                translatorOptions.workspace = lang::ast::cypher::WorkspaceScope::GROUPED;
+            }
+            else
+            {
+                std::cerr << "Ошибка: режим -w должен быть 'param' или 'group'." << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "-s" && i + 1 < argc)
+        {
+            fs::path statisticsPath{argv[++i]};
+            std::ifstream statisticsFile(statisticsPath);
+            if (!statisticsFile)
+            {
+                std::cerr << "Не удалось открыть файл статистики: " << statisticsPath << std::endl;
+                return 1;
+            }
+            try
+            {
+                translatorOptions.statistics =
+                    lang::ast::cypher::ParseStatistics(nlohmann::json::parse(statisticsFile));
+            }
+            catch (const std::exception &error)
+            {
+                std::cerr << "Ошибка чтения статистики: " << error.what() << std::endl;
+                return 1;
+            }
+        }
         else
         {
             std::cerr << "Неизвестный аргумент: " << arg << std::endl;
@@ -80,12 +214,36 @@ int main(int argc, char *argv[])
         }
     }
 
-    if (saveType != "json" && saveType != "cypher")
+    if (saveType != "json" && saveType != "binary" && saveType != "cypher" &&
+        saveType != "profile" && saveType != "eval")
     {
-        std::cerr << "Ошибка: тип сохранения должен быть 'json' или 'cypher'." << std::endl;
+        std::cerr << "Ошибка: тип сохранения должен быть 'json', 'binary', 'cypher', 'profile' "
+                     "или 'eval'."
+                  << std::endl;
         return 1;
     }
 
+    std::optional<lang::ast::eval::Workspace> workspace;
+    if (saveType == "eval")
+    {
+        std::ifstream workspaceFile(workspacePath);
+        if (workspacePath.empty() || !workspaceFile)
+        {
+            std::cerr << "Не удалось открыть файл рабочего пространства: " << workspacePath
+                      << std::endl;
+            return 1;
+        }
+        try
+        {
+            workspace = lang::ast::eval::LoadWorkspace(nlohmann::json::parse(workspaceFile));
+        }
+        catch (const std::exception &error)
+        {
+            std::cerr << "Ошибка чтения рабочего пространства: " << error.what() << std::endl;
+            return 1;
+        }
+    }
+
     std::string fileContent;
     if (!inputProvided || inputPath == "-")
     {
@@ -113,37 +271,76 @@ int main(int argc, char *argv[])
 
     std::string trimmedContent = Trim(fileContent);
 
-    auto data = lang::grammar::Parse(trimmedContent);
-    if (!data.has_value())
+    std::string output;
+    std::optional<lang::grammar::Source> source;
+    if (loadType.empty())
     {
-        std::cerr << "Ошибка парсинга." << std::endl;
-        return 1;
+        source = lang::grammar::ParseSource(trimmedContent);
+    }
+    if (source && std::holds_alternative<lang::ast::RuleTemplate>(*source))
+    {
+        const auto &ruleTemplate = std::get<lang::ast::RuleTemplate>(*source);
+        if (saveType == "json")
+        {
+            return WriteJson(ruleTemplate, jsonOptions, outputProvided, outputPath);
+        }
+        if (saveType == "binary")
+        {
+            output = lang::ast::binary::Encode(ruleTemplate, {.locations = jsonOptions.locations});
+            return Write(output, outputProvided, outputPath, std::ios::out | std::ios::binary);
+        }
+        if (saveType == "cypher")
+        {
+            output = lang::ast::cypher::TranslateTemplate(ruleTemplate, translatorOptions);
+        }
+        else if (saveType == "eval")
+        {
+            output = lang::ast::eval::Print(lang::ast::eval::Evaluate(ruleTemplate, *workspace),
+                                            *workspace);
+        }
+        else
+        {
+            std::cerr << "Ошибка: шаблоны правил не поддерживают -t profile." << std::endl;
+            return 1;
+        }
+        return Write(output, outputProvided, outputPath);
     }
 
-    std::string output;
-    if (saveType == "json")
+    lang::ast::Rule rule;
+    if (loadType == "binary")
     {
-        output = lang::ast::json::Serialize(data.value());
+        rule = lang::ast::binary::Decode<lang::ast::Rule>(fileContent);
     }
-    else if (saveType == "cypher")
+    else if (loadType == "json")
     {
-        output = lang::ast::cypher::Translate(data.value());
+        rule = lang::ast::json::Deserialize<lang::ast::Rule>(fileContent);
+    }
+    else
+    {
+        rule = std::get<lang::ast::Rule>(std::move(*source));
     }
 
-    if (!outputProvided || outputPath == "-")
+    if (saveType == "json")
     {
-        std::cout << output;
+        return WriteJson(rule, jsonOptions, outputProvided, outputPath);
     }
-    else
+    if (saveType == "binary")
     {
-        std::ofstream outFile(outputPath);
-        if (!outFile)
-        {
-            std::cerr << "Output file is not open: " << outputPath << std::endl;
-            return 1;
-        }
-        outFile << output;
+        output = lang::ast::binary::Encode(rule, {.locations = jsonOptions.locations});
+        return Write(output, outputProvided, outputPath, std::ios::out | std::ios::binary);
+    }
+    if (saveType == "cypher")
+    {
+        output = lang::ast::cypher::Translate(rule, translatorOptions);
+    }
+    else if (saveType == "profile")
+    {
+        output = lang::ast::cypher::Profile(rule, translatorOptions);
+    }
+    else if (saveType == "eval")
+    {
+        output = lang::ast::eval::Print(lang::ast::eval::Evaluate(rule, *workspace), *workspace);
     }
 
-    return 0;
+    return Write(output, outputProvided, outputPath);
 }
\ No newline at end of file
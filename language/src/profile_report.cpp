@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <profile/report.hpp>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char *argv[])
+{
+    std::string usage = "Usage: " + std::string(argv[0]) +
+                        " [-n <operators>] <profile.txt>...\n"
+                        "       profile.txt is cypher-shell --format verbose output of a rule\n"
+                        "       translated with dsl-parser -t profile.\n"
+                        "       -n  number of most expensive operators shown per rule (3)";
+
+    std::size_t topOperators = 3;
+    std::vector<fs::path> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc)
+        {
+            try
+            {
+                topOperators = std::stoul(argv[++i]);
+            }
+            catch (const std::exception &)
+            {
+                std::cerr << "Некорректное число операторов: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg.starts_with("-"))
+        {
+            std::cerr << "Неизвестный аргумент: " << arg << std::endl;
+            std::cerr << usage << std::endl;
+            return 1;
+        }
+        else
+        {
+            inputs.emplace_back(arg);
+        }
+    }
+
+    if (inputs.empty())
+    {
+        std::cerr << usage << std::endl;
+        return 1;
+    }
+
+    std::vector<lang::profile::RuleProfile> profiles;
+    for (const auto &input : inputs)
+    {
+        std::ifstream inFile(input);
+        if (!inFile)
+        {
+            std::cerr << "Не удалось открыть входной файл: " << input << std::endl;
+            return 1;
+        }
+        std::stringstream buffer;
+        buffer << inFile.rdbuf();
+        try
+        {
+            auto parsed = lang::profile::ParseProfiles(buffer.str());
+            std::ranges::move(parsed, std::back_inserter(profiles));
+        }
+        catch (const std::exception &error)
+        {
+            std::cerr << input << ": " << error.what() << std::endl;
+            return 1;
+        }
+    }
+
+    lang::profile::Rank(profiles);
+    std::cout << lang::profile::FormatReport(profiles, topOperators);
+    return 0;
+}
@@ -0,0 +1,349 @@
+#include <eval/batch.hpp>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using lang::ast::Expression;
+using lang::ast::ExpressionPtr;
+using lang::ast::ExprType;
+using lang::ast::eval::Value;
+using lang::columnar::Selection;
+
+template <typename T> ExpressionPtr Wrap(T node)
+{
+    return std::make_unique<Expression>(std::make_unique<T>(std::move(node)));
+}
+
+ExpressionPtr Variable(const std::string &name)
+{
+    return Wrap(lang::ast::VariableExpr{name, {}});
+}
+
+ExpressionPtr Access(const std::string &prop)
+{
+    return Wrap(lang::ast::AccessExpr<ExprType::ACCESS>{Variable("c"), prop});
+}
+
+template <template <ExprType> class T, ExprType U>
+ExpressionPtr Binary(ExpressionPtr left, ExpressionPtr right)
+{
+    return Wrap(T<U>{std::move(left), std::move(right)});
+}
+
+constexpr std::array comparisons{
+    &Binary<lang::ast::BooleanExpr, ExprType::EQ>,
+    &Binary<lang::ast::BooleanExpr, ExprType::NOT_EQ>,
+    &Binary<lang::ast::BooleanExpr, ExprType::LESS>,
+    &Binary<lang::ast::BooleanExpr, ExprType::GREATER>,
+    &Binary<lang::ast::BooleanExpr, ExprType::LESS_EQ>,
+    &Binary<lang::ast::BooleanExpr, ExprType::GREATER_EQ>,
+    &Binary<lang::ast::LogicalExpr, ExprType::IN>,
+    &Binary<lang::ast::LogicalExpr, ExprType::NOT_IN>,
+};
+
+constexpr std::array connectives{
+    &Binary<lang::ast::LogicalExpr, ExprType::AND>,
+    &Binary<lang::ast::LogicalExpr, ExprType::OR>,
+    &Binary<lang::ast::LogicalExpr, ExprType::XOR>,
+};
+
+// Random predicates over `c`: mostly comparisons of its properties with values that do not
+// depend on it, which the batch decides from columns, mixed with ones it evaluates row by row.
+class Generator
+{
+public:
+    explicit Generator(unsigned seed) : random_(seed)
+    {
+    }
+
+    ExpressionPtr operator()(int depth)
+    {
+        if (depth == 0 || Pick(3) == 0)
+        {
+            return Atom();
+        }
+        switch (Pick(6))
+        {
+        case 0:
+            return Wrap(lang::ast::UnaryExpr<ExprType::NEG>{(*this)(depth - 1)});
+        case 1:
+            return Wrap(lang::ast::TernaryExpr{(*this)(depth - 1), (*this)(depth - 1),
+                                               (*this)(depth - 1)});
+        default: {
+            auto left = (*this)(depth - 1);
+            return connectives[Pick(connectives.size())](std::move(left), (*this)(depth - 1));
+        }
+        }
+    }
+
+private:
+    static constexpr std::array<const char *, 8> properties{
+        "name", "tags", "technology", "instanceCount", "articulationPoint",
+        "replicas", "owner", "missing"};
+
+    std::mt19937 random_;
+
+    std::size_t Pick(std::size_t count)
+    {
+        return random_() % count;
+    }
+
+    ExpressionPtr Property()
+    {
+        return Access(properties[Pick(properties.size())]);
+    }
+
+    ExpressionPtr Constant()
+    {
+        switch (Pick(8))
+        {
+        case 0:
+            return Wrap(lang::ast::LiteralExpr<std::int64_t>{static_cast<std::int64_t>(Pick(4))});
+        case 1:
+        case 2:
+            return Wrap(lang::ast::LiteralExpr<std::string>{
+                std::array{"API Gateway", "Database", "Element", "HTTPS", "team-1", "Container"}
+                    [Pick(6)]});
+        case 3:
+            return Variable(std::array{"n", "k", "s", "l"}[Pick(4)]);
+        case 4:
+            return Wrap(lang::ast::KeywordExpr<lang::ast::KeywordSets::NONE>{});
+        case 5:
+            return Binary<lang::ast::AddExpr, ExprType::PLUS>(Variable("k"), Constant());
+        default: {
+            lang::ast::SetExpr set;
+            for (auto count = Pick(4); count > 0; --count)
+            {
+                set.items.push_back(Constant());
+            }
+            return Wrap(std::move(set));
+        }
+        }
+    }
+
+    ExpressionPtr Atom()
+    {
+        switch (Pick(12))
+        {
+        case 0:
+            return Wrap(lang::ast::LiteralExpr<bool>{Pick(2) == 0});
+        case 1:
+            return Wrap(lang::ast::AccessExpr<ExprType::SAFE_ACCESS>{
+                Variable("c"), properties[Pick(properties.size())]});
+        case 2: {
+            std::vector<ExpressionPtr> args;
+            args.push_back(Property());
+            args.push_back(Constant());
+            auto call = Wrap(lang::ast::CallExpr{"cross", std::move(args), {}});
+            auto none = Wrap(lang::ast::KeywordExpr<lang::ast::KeywordSets::NONE>{});
+            return Pick(2) == 0 ? comparisons[Pick(2)](std::move(call), std::move(none))
+                                : comparisons[Pick(2)](std::move(none), std::move(call));
+        }
+        case 3:
+            // Row by row: arithmetic on a property.
+            return comparisons[Pick(comparisons.size())](
+                Binary<lang::ast::AddExpr, ExprType::PLUS>(Property(), Constant()), Constant());
+        default: {
+            auto property = Property();
+            const auto compare = comparisons[Pick(comparisons.size())];
+            return Pick(2) == 0 ? compare(std::move(property), Constant())
+                                : compare(Constant(), std::move(property));
+        }
+        }
+    }
+};
+
+// `containers` containers with an integer `replicas`, an `owner` on some and an `owner` of
+// another type on one, so that it has no column.
+nlohmann::json Synthetic(std::size_t containers, bool mixedOwner)
+{
+    auto items = nlohmann::json::array();
+    for (std::size_t i = 0; i < containers; ++i)
+    {
+        nlohmann::json properties{{"replicas", static_cast<std::int64_t>(i % 4)}};
+        if (i % 3 == 0)
+        {
+            properties["owner"] = "team-" + std::to_string(i % 5);
+        }
+        if (mixedOwner && i == 7)
+        {
+            properties["owner"] = 7;
+        }
+        items.push_back({{"id", std::to_string(i + 2)},
+                         {"name", i % 11 == 0 ? "API Gateway" : "container-" + std::to_string(i)},
+                         {"tags", i % 5 == 0 ? "Element,Container,Database" : "Element,Container"},
+                         {"technology", i % 2 == 0 ? "HTTPS" : "Go"},
+                         {"properties", properties}});
+    }
+    const nlohmann::json system{{"id", "1"},
+                                {"name", "System"},
+                                {"tags", "Element,Software System"},
+                                {"containers", items}};
+    return {{"name", "batch"}, {"model", {{"softwareSystems", nlohmann::json::array({system})}}}};
+}
+
+const std::vector<lang::ast::eval::Workspace> &Workspaces()
+{
+    static const auto workspaces = []
+    {
+        std::vector<lang::ast::eval::Workspace> result;
+        std::ifstream file{WORKSPACE_JSON};
+        result.push_back(lang::ast::eval::LoadWorkspace(nlohmann::json::parse(file)));
+        result.push_back(lang::ast::eval::LoadWorkspace(Synthetic(150, false)));
+        result.push_back(lang::ast::eval::LoadWorkspace(Synthetic(70, true)));
+        return result;
+    }();
+    return workspaces;
+}
+
+lang::ast::eval::Row Row()
+{
+    return {{"n", Value{}},
+            {"k", Value{std::int64_t{2}}},
+            {"s", Value{"Database"}},
+            {"l", Value{lang::ast::eval::List{"Database", std::int64_t{1}, Value{}}}}};
+}
+
+// The split, or the message of the error, evaluating one row at a time gives.
+std::pair<std::optional<lang::ast::eval::Tristate>, std::string>
+Walk(const ExpressionPtr &expr, const lang::ast::eval::Workspace &workspace,
+     const Selection &active)
+{
+    lang::ast::eval::EvaluatorContext context{workspace, Row()};
+    lang::ast::eval::Tristate result{Selection{active.Size()}, Selection{active.Size()}};
+    try
+    {
+        active.ForEach(
+            [&](std::size_t row)
+            {
+                context.row["c"] = lang::ast::eval::Node{static_cast<std::uint32_t>(row)};
+                const auto truth = lang::ast::eval::Truth(
+                    lang::ast::eval::Evaluator<ExpressionPtr>{context}(expr));
+                if (truth)
+                {
+                    (*truth ? result.yes : result.no).Set(row);
+                }
+            });
+    }
+    catch (const std::runtime_error &error)
+    {
+        return {std::nullopt, error.what()};
+    }
+    return {std::move(result), ""};
+}
+
+std::pair<std::optional<lang::ast::eval::Tristate>, std::string>
+Batch(const ExpressionPtr &expr, const lang::ast::eval::Workspace &workspace,
+      const Selection &active)
+{
+    try
+    {
+        return {lang::ast::eval::EvaluateBatch(expr, workspace, "c", active, Row()), ""};
+    }
+    catch (const std::runtime_error &error)
+    {
+        return {std::nullopt, error.what()};
+    }
+}
+
+void ExpectSame(const std::pair<std::optional<lang::ast::eval::Tristate>, std::string> &actual,
+                const std::pair<std::optional<lang::ast::eval::Tristate>, std::string> &expected,
+                unsigned seed)
+{
+    ASSERT_EQ(actual.first.has_value(), expected.first.has_value())
+        << "seed " << seed << ": " << actual.second << expected.second;
+    if (expected.first)
+    {
+        EXPECT_EQ(actual.first->yes.Rows(), expected.first->yes.Rows()) << "seed " << seed;
+        EXPECT_EQ(actual.first->no.Rows(), expected.first->no.Rows()) << "seed " << seed;
+    }
+    EXPECT_EQ(actual.second, expected.second) << "seed " << seed;
+}
+
+} // namespace
+
+TEST(BatchTestSmoke, DifferentialSmoke)
+{
+    std::size_t decided = 0;
+    for (unsigned seed = 0; seed < 1500; ++seed)
+    {
+        const auto &workspace = Workspaces()[seed % Workspaces().size()];
+        const auto rows = workspace.graph.NodeCount();
+        Generator generate{seed};
+        const auto expr = generate(1 + static_cast<int>(seed % 4));
+        std::mt19937 random{seed};
+        const std::array actives{
+            Selection{rows, true},
+            lang::columnar::Select(rows, [&](std::size_t /*unused*/) { return random() % 3 != 0; }),
+            Selection{rows},
+        };
+        for (const auto &active : actives)
+        {
+            const auto expected = Walk(expr, workspace, active);
+            ExpectSame(Batch(expr, workspace, active), expected, seed);
+            decided += expected.first && !(expected.first->yes | expected.first->no).Empty();
+        }
+    }
+    // Errors and nulls must not crowd out the rows the comparison is about.
+    EXPECT_GT(decided, 1000U);
+}
+
+TEST(BatchTestSmoke, PartitionSmoke)
+{
+    const auto &workspace = Workspaces()[1];
+    // `c.replicas > 1 and "Database" in c.tags`
+    const auto expr = Binary<lang::ast::LogicalExpr, ExprType::AND>(
+        Binary<lang::ast::BooleanExpr, ExprType::GREATER>(
+            Access("replicas"), Wrap(lang::ast::LiteralExpr<std::int64_t>{1})),
+        Binary<lang::ast::LogicalExpr, ExprType::IN>(
+            Wrap(lang::ast::LiteralExpr<std::string>{"Database"}), Access("tags")));
+    const auto result =
+        lang::ast::eval::EvaluateBatch(expr, workspace, "c", lang::graph::Label::CONTAINER);
+    std::size_t expected = 0;
+    for (std::size_t i = 0; i < 150; ++i)
+    {
+        expected += i % 4 > 1 && i % 5 == 0;
+    }
+    EXPECT_EQ(result.yes.Count(), expected);
+    // The system is not in the partition; every container is decided.
+    EXPECT_EQ(result.yes.Count() + result.no.Count(), 150U);
+    EXPECT_FALSE(result.yes.Test(*workspace.graph.Find("1")));
+}
+
+TEST(BatchTestSmoke, ShortCircuitSmoke)
+{
+    const auto &workspace = Workspaces()[1];
+    const Selection all{workspace.graph.NodeCount(), true};
+    const auto negate = [] { return Wrap(lang::ast::UnaryExpr<ExprType::NEG>{Access("name")}); };
+
+    // The right operand is never reached, so `-c.name` never throws.
+    const auto unreached = Binary<lang::ast::LogicalExpr, ExprType::AND>(
+        Binary<lang::ast::BooleanExpr, ExprType::EQ>(
+            Access("name"), Wrap(lang::ast::LiteralExpr<std::string>{"no such name"})),
+        negate());
+    const auto result = lang::ast::eval::EvaluateBatch(unreached, workspace, "c", all);
+    EXPECT_TRUE(result.yes.Empty());
+    EXPECT_EQ(result.no, all);
+
+    // Here it is, and the error is the evaluator's.
+    const auto reached = Binary<lang::ast::LogicalExpr, ExprType::OR>(
+        Binary<lang::ast::BooleanExpr, ExprType::EQ>(
+            Access("name"), Wrap(lang::ast::LiteralExpr<std::string>{"API Gateway"})),
+        negate());
+    EXPECT_THROW(lang::ast::eval::EvaluateBatch(reached, workspace, "c", all), std::runtime_error);
+
+    EXPECT_THROW(lang::ast::eval::EvaluateBatch(unreached, workspace, "c", Selection{3}),
+                 std::runtime_error);
+}
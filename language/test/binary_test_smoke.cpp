@@ -0,0 +1,81 @@
+#include "parser/parser.hpp"
+#include <binary/reader.hpp>
+#include <binary/writer.hpp>
+#include <gtest/gtest.h>
+#include <json/writer.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+using lang::ast::binary::NodeKind;
+
+TEST(BinaryTestSmoke, RuleSmoke)
+{
+    const std::string input{R"(rule first {
+        description: "Hello world";
+        priority: Warn;
+        x = 10;
+        all {
+            s1 in system:
+                "DMZ" in s1.props
+        };
+        except exist {
+            s1 in system:
+                s1.tech in ["go"]
+        }
+    }
+    )"};
+    const auto result = lang::grammar::Parse(input);
+    ASSERT_TRUE(result.has_value());
+
+    const auto encoded = lang::ast::binary::Encode(result.value());
+    EXPECT_LT(encoded.size(), lang::ast::json::Write(result.value()).size());
+
+    const lang::ast::binary::Document document{encoded};
+    EXPECT_EQ(document.Version(), lang::ast::binary::formatVersion);
+    const auto rule = document.Root();
+    EXPECT_EQ(rule.Kind(), NodeKind::RULE);
+    EXPECT_EQ(rule.Atom(0), "first");
+    EXPECT_EQ(rule.Atom(1), "Hello world");
+    EXPECT_EQ(rule.Subtype<lang::ast::Priority>(), lang::ast::Priority::WARN);
+
+    const auto block = rule.Child(0);
+    ASSERT_EQ(block.ChildCount(), 3);
+    const auto assignment = block.Child(0);
+    EXPECT_EQ(assignment.Kind(), NodeKind::ASSIGNMENT);
+    EXPECT_EQ(assignment.Atom(0), "x");
+    EXPECT_EQ(assignment.Child(0).Number(), 10);
+
+    const auto quantifier = block.Child(1);
+    EXPECT_EQ(quantifier.Subtype<lang::ast::QuantifierType>(), lang::ast::QuantifierType::ALL);
+    EXPECT_EQ(quantifier.Atom(0), "s1");
+    const auto source = quantifier.Child(0);
+    EXPECT_EQ(source.Subtype<lang::ast::KeywordSets>(), lang::ast::KeywordSets::SYSTEM);
+    EXPECT_TRUE(source.Location().has_value());
+    EXPECT_EQ(block.Child(2).Kind(), NodeKind::EXCEPT_STATEMENT);
+
+    const auto compact = lang::ast::binary::Encode(result.value(), {.locations = false});
+    EXPECT_LT(compact.size(), encoded.size());
+    EXPECT_FALSE(lang::ast::binary::Document{compact}.Root().Child(0).Child(1).Child(0).Location());
+}
+
+TEST(BinaryTestSmoke, BrokenSmoke)
+{
+    const auto result = lang::grammar::Parse(R"(rule second {
+        description: "Hello world";
+        priority: Info;
+        x = 10
+    })");
+    ASSERT_TRUE(result.has_value());
+    const auto encoded = lang::ast::binary::Encode(result.value());
+
+    EXPECT_THROW(lang::ast::binary::Document{encoded.substr(0, encoded.size() - 4)},
+                 std::runtime_error);
+    auto wrongMagic = encoded;
+    wrongMagic[0] = 'X';
+    EXPECT_THROW(lang::ast::binary::Document{wrongMagic}, std::runtime_error);
+    auto newer = encoded;
+    newer[4] = static_cast<char>(lang::ast::binary::formatVersion + 1);
+    EXPECT_THROW(lang::ast::binary::Document{newer}, std::runtime_error);
+}
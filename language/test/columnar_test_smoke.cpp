@@ -0,0 +1,161 @@
+#include <columnar/selection.hpp>
+#include <columnar/store.hpp>
+#include <eval/workspace.hpp>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST(ColumnarTestSmoke, SelectionSmoke)
+{
+    auto odd = lang::columnar::Select(130, [](std::size_t row) { return row % 2 == 1; });
+    const lang::columnar::Selection all{130, true};
+    EXPECT_EQ(odd.Count(), 65U);
+    EXPECT_EQ(all.Count(), 130U);
+    EXPECT_TRUE(odd.Test(129));
+    EXPECT_FALSE(odd.Test(128));
+
+    auto even = odd;
+    even.Flip();
+    EXPECT_EQ(even.Count(), 65U);
+    EXPECT_TRUE((odd & even).Empty());
+    EXPECT_EQ(odd | even, all);
+    EXPECT_EQ(lang::columnar::Selection{all}.Subtract(odd), even);
+
+    std::vector<std::uint32_t> rows;
+    odd.ForEach([&](std::size_t row) { rows.push_back(static_cast<std::uint32_t>(row)); });
+    EXPECT_EQ(rows, odd.Rows());
+    EXPECT_EQ(rows.front(), 1U);
+    EXPECT_EQ(rows.back(), 129U);
+
+    const lang::columnar::Selection other{64};
+    EXPECT_THROW(odd &= other, std::runtime_error);
+}
+
+TEST(ColumnarTestSmoke, ColumnSmoke)
+{
+    // Against the rows themselves, with bitsets and with sorted code arrays.
+    std::mt19937 random{3};
+    constexpr std::size_t rows = 500;
+    std::vector<std::vector<std::string>> tags(rows);
+    std::vector<std::string> names(rows);
+    std::vector<std::int64_t> counts(rows);
+    for (std::size_t row = 0; row < rows; ++row)
+    {
+        for (auto count = random() % 5; count > 0; --count)
+        {
+            tags[row].push_back("tag" + std::to_string(random() % 100));
+        }
+        names[row] = "name" + std::to_string(random() % 20);
+        counts[row] = static_cast<std::int64_t>(random() % 10);
+    }
+    const std::vector<std::string> wanted{"tag3", "tag50", "missing"};
+
+    for (const std::size_t bitsetTerms : {std::size_t{256}, std::size_t{10}})
+    {
+        lang::columnar::ColumnStoreBuilder builder{rows, {.bitsetTerms = bitsetTerms}};
+        for (std::size_t row = 0; row < rows; ++row)
+        {
+            if (row % 7 != 0)
+            {
+                builder.Add(row, "tags", std::span<const std::string>{tags[row]});
+                builder.Add(row, "name", names[row]);
+                builder.Add(row, "count", counts[row]);
+            }
+        }
+        builder.Add(0, "mixed", "text");
+        builder.Add(1, "mixed", std::int64_t{1});
+        const auto store = std::move(builder).Build();
+
+        EXPECT_EQ(store.Strings("mixed"), nullptr);
+        EXPECT_EQ(store.Ints("mixed"), nullptr);
+        EXPECT_EQ(store.Strings("tags"), nullptr);
+        const auto *tagColumn = store.Lists("tags");
+        const auto *nameColumn = store.Strings("name");
+        const auto *countColumn = store.Ints("count");
+        ASSERT_NE(tagColumn, nullptr);
+        ASSERT_NE(nameColumn, nullptr);
+        ASSERT_NE(countColumn, nullptr);
+        EXPECT_EQ(tagColumn->UsesBitsets(), bitsetTerms == 256);
+
+        const auto terms = tagColumn->Encode(wanted);
+        const auto contains = tagColumn->Contains("tag3");
+        const auto intersects = tagColumn->Intersects(terms);
+        const auto equal = nameColumn->Equal("name5");
+        const auto in = nameColumn->In(std::vector<std::string>{"name1", "name2"});
+        const auto greater = countColumn->Where([](std::int64_t count) { return count > 4; });
+        for (std::size_t row = 0; row < rows; ++row)
+        {
+            const auto present = row % 7 != 0;
+            const auto has = [&](const std::string &tag)
+            { return present && std::ranges::find(tags[row], tag) != tags[row].end(); };
+            const auto any = has("tag3") || has("tag50");
+            EXPECT_EQ(tagColumn->Contains(row, "tag3"), has("tag3"));
+            EXPECT_EQ(contains.Test(row), has("tag3"));
+            EXPECT_EQ(tagColumn->Intersects(row, terms), any);
+            EXPECT_EQ(intersects.Test(row), any);
+            EXPECT_EQ(tagColumn->Present().Test(row), present);
+            EXPECT_EQ(equal.Test(row), present && names[row] == "name5");
+            EXPECT_EQ(in.Test(row), present && (names[row] == "name1" || names[row] == "name2"));
+            EXPECT_EQ(greater.Test(row), present && counts[row] > 4);
+            EXPECT_EQ(countColumn->Get(row).has_value(), present);
+
+            auto expected = present ? tags[row] : std::vector<std::string>{};
+            std::ranges::sort(expected);
+            const auto [first, last] = std::ranges::unique(expected);
+            expected.erase(first, last);
+            std::vector<std::string> stored;
+            for (const auto tag : tagColumn->Get(row))
+            {
+                stored.emplace_back(tag);
+            }
+            std::ranges::sort(stored);
+            EXPECT_EQ(stored, expected);
+        }
+        EXPECT_TRUE(tagColumn->Contains("missing").Empty());
+        EXPECT_TRUE(nameColumn->Equal("missing").Empty());
+    }
+}
+
+TEST(ColumnarTestSmoke, WorkspaceSmoke)
+{
+    std::ifstream file{WORKSPACE_JSON};
+    const auto workspace = lang::ast::eval::LoadWorkspace(nlohmann::json::parse(file));
+    const auto &columns = workspace.columns;
+    ASSERT_EQ(columns.Rows(), workspace.graph.NodeCount());
+    const auto *tags = columns.Lists("tags");
+    const auto *technology = columns.Lists("technology");
+    const auto *names = columns.Strings("name");
+    const auto *points = columns.Ints("articulationPoint");
+    ASSERT_NE(tags, nullptr);
+    ASSERT_NE(technology, nullptr);
+    ASSERT_NE(names, nullptr);
+    ASSERT_NE(points, nullptr);
+
+    std::size_t elements = 0;
+    for (const auto &properties : workspace.properties)
+    {
+        const auto &list = *properties.at("tags").As<lang::ast::eval::List>();
+        elements += static_cast<std::size_t>(
+            std::ranges::count(list, lang::ast::eval::Value{std::string{"Element"}}));
+    }
+    EXPECT_GT(elements, 0U);
+    EXPECT_EQ(tags->Contains("Element").Count(), elements);
+    std::vector<std::string> gateway;
+    names->Equal("API Gateway").ForEach(
+        [&](std::size_t row)
+        { gateway.push_back(workspace.graph.Id(static_cast<lang::graph::NodeId>(row))); });
+    EXPECT_EQ(gateway, (std::vector<std::string>{"11"}));
+    EXPECT_EQ(points->Equal(1).Count(), 1U);
+
+    const auto either = technology->Encode(std::vector<std::string>{"React", "Flask"});
+    EXPECT_EQ(technology->Intersects(either),
+              technology->Contains("React") | technology->Contains("Flask"));
+}
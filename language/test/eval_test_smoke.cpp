@@ -0,0 +1,138 @@
+#include "parser/parser.hpp"
+#include <eval/evaluator.hpp>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::string Read(const std::filesystem::path &path)
+{
+    std::ifstream file{path};
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+const lang::ast::eval::Workspace &Workspace()
+{
+    static const auto workspace =
+        lang::ast::eval::LoadWorkspace(nlohmann::json::parse(Read(WORKSPACE_JSON)));
+    return workspace;
+}
+
+// The element ids of every finding, row by row.
+std::vector<std::vector<std::string>> Evaluate(const std::string &input)
+{
+    const auto parsed = lang::grammar::Parse(input);
+    EXPECT_TRUE(parsed.has_value());
+    const auto result = lang::ast::eval::Evaluate(parsed.value(), Workspace());
+    std::vector<std::vector<std::string>> rows;
+    for (const auto &row : result.rows)
+    {
+        std::vector<std::string> ids;
+        for (const auto &value : row)
+        {
+            const auto *node = value.As<lang::ast::eval::Node>();
+            ids.push_back(node != nullptr ? Workspace().Id(*node) : "");
+        }
+        rows.push_back(std::move(ids));
+    }
+    return rows;
+}
+
+} // namespace
+
+// converter/workspace.json is the model result.txt was captured from.
+TEST(EvalTestSmoke, ArticulationSmoke)
+{
+    const std::filesystem::path example{EXAMPLES_DIR "/Articulation"};
+    const auto expected = Read(example / "result.txt");
+    std::vector<std::vector<std::string>> rows;
+    const std::regex id{R"re(\bid: "([^"]*)")re"};
+    std::istringstream lines{expected.substr(expected.find('\n') + 1)};
+    for (std::string line; std::getline(lines, line);)
+    {
+        std::vector<std::string> ids;
+        for (auto it = std::sregex_iterator{line.begin(), line.end(), id};
+             it != std::sregex_iterator{}; ++it)
+        {
+            ids.push_back((*it)[1]);
+        }
+        rows.push_back(std::move(ids));
+    }
+    ASSERT_FALSE(rows.empty());
+    EXPECT_EQ(Evaluate(Read(example / "input.arch")), rows);
+}
+
+TEST(EvalTestSmoke, QuantifierSmoke)
+{
+    EXPECT_EQ(Evaluate(R"(rule Gateway {
+        description: "exist keeps the witnesses";
+        priority: Info;
+        exist {
+            c in container: c.name == "API Gateway"
+        }
+    })"),
+              (std::vector<std::vector<std::string>>{{"11"}}));
+
+    EXPECT_EQ(Evaluate(R"(rule DMZ {
+        description: "Deployment nodes range over the containers they deploy";
+        priority: Info;
+        all {
+            d in deploy:
+                "DMZ" == d.name:
+                all {
+                    c in d: "Database" not in c.tags
+                }
+        }
+    })"),
+              (std::vector<std::vector<std::string>>{{"27"}}));
+
+    EXPECT_EQ(Evaluate(R"(rule Route {
+        description: "Systems linked by a path that avoids an integration platform";
+        priority: Info;
+        all {
+            s1, s2 in system:
+            all {
+                s in route(s1, s2):
+                    "Integration platform" in s.tags
+            }
+        }
+    })"),
+              (std::vector<std::vector<std::string>>{{"4", "3"}}));
+}
+
+TEST(EvalTestSmoke, ExceptSmoke)
+{
+    EXPECT_EQ(Evaluate(R"(rule Except {
+        description: "except drops the findings its quantifier holds for";
+        priority: Info;
+        all {
+            c in container: "Flask" in c.technology
+        };
+        except all {
+            c in container: c.name /= "API Gateway"
+        }
+    })"),
+              (std::vector<std::vector<std::string>>{{"11"}}));
+}
+
+TEST(EvalTestSmoke, ErrorSmoke)
+{
+    EXPECT_THROW(Evaluate(R"(rule Unbound {
+        description: "Unbound";
+        priority: Info;
+        all {
+            c in container: x.name == c.name
+        }
+    })"),
+                 std::runtime_error);
+}
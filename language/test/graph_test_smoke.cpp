@@ -0,0 +1,328 @@
+#include <graph/biconnected.hpp>
+#include <graph/csr.hpp>
+#include <graph/reachability.hpp>
+#include <graph/workspace.hpp>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+std::vector<std::string> Ids(const lang::graph::Graph &graph, auto &&nodes)
+{
+    std::vector<std::string> ids;
+    for (const auto node : nodes)
+    {
+        ids.push_back(graph.Id(node));
+    }
+    return ids;
+}
+
+// Connected components of the undirected projection without node `removed` or edge `skipped`.
+std::size_t Components(const std::vector<std::pair<std::size_t, std::size_t>> &edges,
+                       std::size_t nodes, std::size_t removed, std::size_t skipped)
+{
+    std::vector<std::size_t> parent(nodes);
+    for (std::size_t i = 0; i < nodes; ++i)
+    {
+        parent[i] = i;
+    }
+    const auto find = [&](std::size_t v)
+    {
+        while (parent[v] != v)
+        {
+            v = parent[v] = parent[parent[v]];
+        }
+        return v;
+    };
+    std::size_t count = nodes - (removed < nodes ? 1 : 0);
+    for (std::size_t e = 0; e < edges.size(); ++e)
+    {
+        const auto [a, b] = edges[e];
+        if (e == skipped || a == removed || b == removed || find(a) == find(b))
+        {
+            continue;
+        }
+        parent[find(a)] = find(b);
+        --count;
+    }
+    return count;
+}
+
+} // namespace
+
+TEST(GraphTestSmoke, WorkspaceSmoke)
+{
+    using lang::graph::Label;
+    using lang::graph::Relation;
+
+    std::ifstream file{WORKSPACE_JSON};
+    const auto graph = lang::graph::LoadGraph(nlohmann::json::parse(file));
+
+    EXPECT_EQ(graph.NodeCount(), 24U);
+    EXPECT_EQ(graph.EdgeCount(Relation::RELATES_TO), 19U);
+    EXPECT_EQ(graph.EdgeCount(Relation::CONTAINS), 18U);
+    EXPECT_EQ(graph.EdgeCount(Relation::INSTANCE_OF), 5U);
+
+    EXPECT_EQ(Ids(graph, graph.Nodes(Label::CONTAINER)),
+              (std::vector<std::string>{"6", "7", "9", "11", "17"}));
+    EXPECT_EQ(Ids(graph, graph.Nodes(Label::CONTAINER_INSTANCE)),
+              (std::vector<std::string>{"29", "32", "36", "39", "43"}));
+    EXPECT_EQ(Ids(graph, graph.Out(*graph.Find("4"), Relation::CONTAINS)),
+              (std::vector<std::string>{"6", "7", "9", "11", "17"}));
+    EXPECT_EQ(Ids(graph, graph.Out(*graph.Find("36"), Relation::INSTANCE_OF)),
+              (std::vector<std::string>{"11"}));
+    EXPECT_FALSE(graph.Find("missing").has_value());
+
+    for (lang::graph::NodeId node = 0; node < graph.NodeCount(); ++node)
+    {
+        EXPECT_EQ(graph.Find(graph.Id(node)), node);
+        const auto label = graph.LabelOf(node);
+        EXPECT_TRUE(graph.Nodes(label).front() <= node && node <= graph.Nodes(label).back());
+        for (const auto relation : lang::graph::relations)
+        {
+            for (const auto target : graph.Out(node, relation))
+            {
+                EXPECT_TRUE(std::ranges::binary_search(graph.In(target, relation), node));
+            }
+        }
+    }
+}
+
+TEST(GraphTestSmoke, BuilderSmoke)
+{
+    using lang::graph::Label;
+    using lang::graph::Relation;
+
+    lang::graph::GraphBuilder builder;
+    builder.AddEdge("b", "a", Relation::CONTAINS);
+    builder.AddEdge("b", "a", Relation::CONTAINS);
+    builder.AddEdge("b", "c", Relation::RELATES_TO);
+    builder.AddEdge("b", "dangling", Relation::RELATES_TO);
+    builder.AddNode("a", Label::CONTAINER);
+    builder.AddNode("b", Label::SOFTWARE_SYSTEM);
+    builder.AddNode("c", Label::PERSON);
+    builder.AddNode("a", Label::COMPONENT);
+    const auto graph = std::move(builder).Build();
+
+    EXPECT_EQ(graph.NodeCount(), 3U);
+    EXPECT_EQ(Ids(graph, std::vector<lang::graph::NodeId>{0, 1, 2}),
+              (std::vector<std::string>{"c", "b", "a"}));
+    EXPECT_EQ(graph.LabelOf(*graph.Find("a")), Label::CONTAINER);
+    EXPECT_TRUE(graph.Nodes(Label::COMPONENT).empty());
+    EXPECT_EQ(graph.EdgeCount(Relation::CONTAINS), 1U);
+    EXPECT_EQ(graph.EdgeCount(Relation::RELATES_TO), 1U);
+    EXPECT_EQ(Ids(graph, graph.In(*graph.Find("a"), Relation::CONTAINS)),
+              (std::vector<std::string>{"b"}));
+}
+
+TEST(GraphTestSmoke, MemorySmoke)
+{
+    constexpr std::size_t nodes = 100000;
+    constexpr std::size_t degree = 8;
+    lang::graph::GraphBuilder builder;
+    for (std::size_t i = 0; i < nodes; ++i)
+    {
+        builder.AddNode(std::to_string(i), lang::graph::Label::COMPONENT);
+    }
+    for (std::size_t i = 0; i < nodes; ++i)
+    {
+        for (std::size_t k = 1; k <= degree; ++k)
+        {
+            builder.AddEdge(std::to_string(i), std::to_string((i + k * 7919) % nodes),
+                            lang::graph::Relation::RELATES_TO);
+        }
+    }
+    const auto graph = std::move(builder).Build();
+
+    ASSERT_EQ(graph.EdgeCount(), nodes * degree);
+    EXPECT_LE(graph.AdjacencyBytes(), graph.EdgeCount() * 16);
+}
+
+TEST(GraphTestSmoke, BiconnectedSmoke)
+{
+    std::ifstream file{WORKSPACE_JSON};
+    const auto workspace = lang::graph::LoadGraph(nlohmann::json::parse(file));
+    const auto found = lang::graph::Biconnected(workspace);
+    std::vector<std::string> points;
+    for (lang::graph::NodeId node = 0; node < workspace.NodeCount(); ++node)
+    {
+        if (found.articulationPoints[node])
+        {
+            points.push_back(workspace.Id(node));
+        }
+    }
+    EXPECT_EQ(points, (std::vector<std::string>{"11"}));
+    EXPECT_EQ(found.bridges.size(), 2U);
+    EXPECT_EQ(found.components.size(), 3U);
+
+    // Two RELATES_TO edges between the same pair are stored once but still form a cycle.
+    {
+        lang::graph::GraphBuilder builder;
+        builder.AddNode("a", lang::graph::Label::CONTAINER);
+        builder.AddNode("b", lang::graph::Label::CONTAINER);
+        builder.AddNode("c", lang::graph::Label::CONTAINER);
+        builder.AddEdge("a", "b", lang::graph::Relation::RELATES_TO);
+        builder.AddEdge("a", "b", lang::graph::Relation::RELATES_TO);
+        builder.AddEdge("b", "c", lang::graph::Relation::RELATES_TO);
+        const auto graph = std::move(builder).Build();
+        EXPECT_EQ(graph.EdgeCount(), 2U);
+        EXPECT_TRUE(graph.Parallel(*graph.Find("a"), *graph.Find("b"),
+                                   lang::graph::Relation::RELATES_TO));
+        EXPECT_FALSE(graph.Parallel(*graph.Find("b"), *graph.Find("c"),
+                                    lang::graph::Relation::RELATES_TO));
+        const auto result = lang::graph::Biconnected(graph);
+        ASSERT_EQ(result.bridges.size(), 1U);
+        EXPECT_EQ(Ids(graph, std::vector{result.bridges[0].first, result.bridges[0].second}),
+                  (std::vector<std::string>{"b", "c"}));
+        EXPECT_FALSE(result.articulationPoints[*graph.Find("a")]);
+        EXPECT_TRUE(result.articulationPoints[*graph.Find("b")]);
+    }
+
+    // Against removing every node and every edge in turn, on random multigraphs.
+    std::mt19937 random{42};
+    for (int round = 0; round < 200; ++round)
+    {
+        const std::size_t nodes = 2 + random() % 12;
+        const std::size_t count = random() % (2 * nodes);
+        constexpr auto none = std::numeric_limits<std::size_t>::max();
+        lang::graph::GraphBuilder builder;
+        for (std::size_t i = 0; i < nodes; ++i)
+        {
+            builder.AddNode(std::to_string(i), lang::graph::Label::CONTAINER);
+        }
+        std::vector<std::pair<std::size_t, std::size_t>> edges;
+        for (std::size_t e = 0; e < count; ++e)
+        {
+            const std::size_t a = random() % nodes;
+            const std::size_t b = random() % nodes;
+            const auto relation = random() % lang::graph::relationCount;
+            if (a == b)
+            {
+                continue;
+            }
+            edges.emplace_back(a, b);
+            builder.AddEdge(std::to_string(a), std::to_string(b),
+                            lang::graph::relations[relation]);
+        }
+        const auto graph = std::move(builder).Build();
+        const auto result = lang::graph::Biconnected(graph);
+        const auto base = Components(edges, nodes, none, none);
+
+        for (std::size_t v = 0; v < nodes; ++v)
+        {
+            const auto node = *graph.Find(std::to_string(v));
+            EXPECT_EQ(result.articulationPoints[node], Components(edges, nodes, v, none) > base);
+        }
+        std::set<std::pair<std::string, std::string>> expected;
+        for (std::size_t e = 0; e < edges.size(); ++e)
+        {
+            if (Components(edges, nodes, none, e) > base)
+            {
+                const auto [a, b] = std::minmax(edges[e].first, edges[e].second);
+                expected.emplace(std::to_string(a), std::to_string(b));
+            }
+        }
+        std::set<std::pair<std::string, std::string>> bridges;
+        for (const auto &[a, b] : result.bridges)
+        {
+            const auto [first, second] =
+                std::minmax({std::stoul(graph.Id(a)), std::stoul(graph.Id(b))});
+            bridges.emplace(std::to_string(first), std::to_string(second));
+        }
+        EXPECT_EQ(bridges, expected);
+        // Every edge is in exactly one component, so a bridge is a component of its own.
+        std::size_t pairs = 0;
+        for (const auto &component : result.components)
+        {
+            EXPECT_GE(component.size(), 2U);
+            pairs += component.size() == 2 ? 1 : 0;
+        }
+        EXPECT_GE(pairs, bridges.size());
+    }
+}
+
+TEST(GraphTestSmoke, ReachabilitySmoke)
+{
+    using lang::graph::NodeId;
+
+    // Against a traversal from every node, with the bitset and with 2-hop labels.
+    std::mt19937 random{7};
+    for (int round = 0; round < 100; ++round)
+    {
+        const std::size_t nodes = 1 + random() % 30;
+        const std::size_t count = random() % (3 * nodes);
+        lang::graph::GraphBuilder builder;
+        for (std::size_t i = 0; i < nodes; ++i)
+        {
+            builder.AddNode(std::to_string(i), lang::graph::Label::CONTAINER);
+        }
+        for (std::size_t e = 0; e < count; ++e)
+        {
+            builder.AddEdge(std::to_string(random() % nodes), std::to_string(random() % nodes),
+                            lang::graph::relations[random() % lang::graph::relationCount]);
+        }
+        const auto graph = std::move(builder).Build();
+
+        std::vector<std::vector<bool>> reach(nodes);
+        for (NodeId from = 0; from < nodes; ++from)
+        {
+            auto &seen = reach[from];
+            seen.assign(nodes, false);
+            std::vector<NodeId> stack{from};
+            while (!stack.empty())
+            {
+                const auto v = stack.back();
+                stack.pop_back();
+                for (const auto w : graph.Out(v, lang::graph::Relation::RELATES_TO))
+                {
+                    if (!seen[w])
+                    {
+                        seen[w] = true;
+                        stack.push_back(w);
+                    }
+                }
+            }
+        }
+
+        for (const std::size_t limit : {std::size_t{0}, std::size_t{1000}})
+        {
+            const lang::graph::ReachabilityIndex index{graph, lang::graph::routeRelations,
+                                                       {.bitsetLimit = limit}};
+            EXPECT_EQ(index.UsesBitset(), limit != 0 || index.ComponentCount() == 0);
+            for (NodeId from = 0; from < nodes; ++from)
+            {
+                for (NodeId to = 0; to < nodes; ++to)
+                {
+                    ASSERT_EQ(index.Reaches(from, to), reach[from][to]);
+                    std::vector<NodeId> between;
+                    for (NodeId via = 0; via < nodes && reach[from][to]; ++via)
+                    {
+                        if ((via == from || reach[from][via]) && (via == to || reach[via][to]))
+                        {
+                            between.push_back(via);
+                        }
+                    }
+                    EXPECT_EQ(index.Between(graph, from, to), between);
+                }
+            }
+        }
+    }
+
+    std::ifstream file{WORKSPACE_JSON};
+    const auto workspace = lang::graph::LoadGraph(nlohmann::json::parse(file));
+    const lang::graph::ReachabilityIndex index{workspace};
+    const auto find = [&](const std::string &id) { return *workspace.Find(id); };
+    EXPECT_TRUE(index.Reaches(find("4"), find("3")));
+    EXPECT_FALSE(index.Reaches(find("3"), find("4")));
+    EXPECT_EQ(Ids(workspace, index.Between(workspace, find("4"), find("3"))),
+              (std::vector<std::string>{"3", "4"}));
+}
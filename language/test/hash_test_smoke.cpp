@@ -0,0 +1,72 @@
+#include "parser/expressions.hpp"
+#include "parser/parser.hpp"
+#include <ast/hash.hpp>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+
+TEST(HashTestSmoke, ExpressionSmoke)
+{
+    const auto result = lang::grammar::ParseTest<lang::grammar::ExpressionProduct>(
+        std::string{"f(c).tags == f(c).tags"});
+    const auto other =
+        lang::grammar::ParseTest<lang::grammar::ExpressionProduct>(std::string{"f(c).name"});
+    EXPECT_TRUE(result.has_value() && other.has_value());
+
+    // The operands sit at different source locations.
+    const auto &equal = std::get<lang::ast::EqualPtr>(*result.value());
+    EXPECT_TRUE(lang::ast::Equal(equal->left, equal->right));
+    EXPECT_EQ(lang::ast::Hash(equal->left), lang::ast::Hash(equal->right));
+    EXPECT_FALSE(lang::ast::Equal(equal->left, other.value()));
+    EXPECT_NE(lang::ast::Hash(equal->left), lang::ast::Hash(other.value()));
+
+    const auto number =
+        lang::grammar::ParseTest<lang::grammar::ExpressionProduct>(std::string{"1"});
+    const auto string =
+        lang::grammar::ParseTest<lang::grammar::ExpressionProduct>(std::string{"\"1\""});
+    EXPECT_FALSE(lang::ast::Equal(number.value(), string.value()));
+
+    std::unordered_set<std::uint64_t> hashes{lang::ast::Hash(equal->left),
+                                             lang::ast::Hash(equal->right),
+                                             lang::ast::Hash(other.value())};
+    EXPECT_EQ(hashes.size(), 2);
+}
+
+TEST(HashTestSmoke, HashConsingSmoke)
+{
+    const std::string database{R"(rule Database {
+        description: "Hello world";
+        priority: Info;
+        all {
+            c in container: "Database" in c.tags
+        }
+    }
+    )"};
+    const std::string legacy{R"(rule Legacy {
+        description: "Hello world";
+        priority: Warn;
+        all {
+            c in container: "Database" in c.tags
+        }
+    }
+    )"};
+    const auto first = lang::grammar::ParseTest<lang::grammar::RuleDecl>(database);
+    const auto second = lang::grammar::ParseTest<lang::grammar::RuleDecl>(legacy);
+    EXPECT_TRUE(first.has_value() && second.has_value());
+    EXPECT_FALSE(lang::ast::Equal(first.value(), second.value()));
+    EXPECT_TRUE(lang::ast::Equal(first.value().calls, second.value().calls));
+
+    lang::ast::HashConsing dag;
+    const auto rule = dag.Add(first.value());
+    const auto size = dag.Size();
+    EXPECT_EQ(dag.Add(first.value()), rule);
+    EXPECT_EQ(dag.Size(), size);
+
+    // Only the root differs: the block and everything below it are shared.
+    EXPECT_NE(dag.Add(second.value()), rule);
+    EXPECT_EQ(dag.Size(), size + 1);
+    EXPECT_EQ(dag.Get(rule).children.size(), 1);
+    EXPECT_EQ(dag.Added(), 3 * size);
+}
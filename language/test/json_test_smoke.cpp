@@ -4,12 +4,15 @@
 #include "parser/statements.hpp"
 #include <gtest/gtest.h>
 #include <json/serializer.hpp>
+#include <json/writer.hpp>
 #include <lexy/action/parse.hpp>
 #include <lexy/encoding.hpp>
 #include <lexy/input/string_input.hpp>
 #include <lexy_ext/report_error.hpp>
 #include <parser/identifiers.hpp>
+#include <stdexcept>
 #include <string>
+#include <unistd.h>
 
 TEST(TestJsonSmoke, IdentifierSmoke)
 {
@@ -145,4 +148,42 @@ TEST(TestJsonSmoke, RuleSmoke)
     const auto jsonResult = lang::ast::json::Serialize(result.value());
     EXPECT_TRUE(not jsonResult.empty());
     GTEST_LOG_(INFO) << jsonResult;
-}
\ No newline at end of file
+}
+
+TEST(TestJsonSmoke, WriterSmoke)
+{
+    const std::string input{R"(rule first {
+        description: "Tab	and back\\slash";
+        priority: Info;
+        x = 10;
+        t = x > 1 ? "many" : "one";
+        z = ["token", 1, true];
+        all {
+            s1 in system:
+                not s1.internal and s1.name /= "DMZ"
+        };
+        except exist {
+            s1 in system:
+                s1.tech in ["go"]
+        }
+    }
+    )"};
+    const auto result = lang::grammar::ParseTest<lang::grammar::RuleDecl>(input);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(lang::ast::json::Write(result.value()), lang::ast::json::Serialize(result.value()));
+
+    const auto compact = lang::ast::json::Write(result.value(), {.locations = false});
+    EXPECT_EQ(compact.find("\"node\""), std::string::npos);
+    EXPECT_LT(compact.size(), lang::ast::json::Write(result.value()).size());
+
+    // A Writer that throws leaves nothing behind on the descriptor.
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    lang::ast::Rule broken;
+    broken.name = "broken";
+    EXPECT_THROW(lang::ast::json::Write(broken, fds[1]), std::runtime_error);
+    close(fds[1]);
+    char symbol = 0;
+    EXPECT_EQ(read(fds[0], &symbol, 1), 0);
+    close(fds[0]);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <parallel/quantifier.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+using lang::ast::QuantifierType;
+using lang::parallel::Collect;
+
+constexpr std::uint32_t elements = 200000;
+
+// True, after uneven work: the first eighth of the range costs a hundred times the rest, so
+// that workers with cheap parts run dry and steal.
+bool Costly(std::uint32_t id)
+{
+    std::uint32_t hash = id;
+    for (int i = id < elements / 8 ? 100 : 1; i > 0; --i)
+    {
+        hash = hash * 2654435761U + 1;
+    }
+    return hash != id || hash != 0;
+}
+
+} // namespace
+
+TEST(ParallelTestSmoke, EveryElementOnceSmoke)
+{
+    for (const std::size_t threads : {1, 2, 3, 8})
+    {
+        lang::parallel::Pool pool{threads};
+        for (const std::uint32_t grain : {0U, 1U, 64U})
+        {
+            std::vector<std::atomic<int>> calls(elements + 10);
+            const auto result = lang::parallel::Quantify(
+                pool, {10, elements + 10}, QuantifierType::ALL,
+                [&](std::uint32_t id)
+                {
+                    calls[id].fetch_add(1, std::memory_order_relaxed);
+                    return Costly(id);
+                },
+                {Collect::FIRST, grain});
+            EXPECT_TRUE(result.holds);
+            EXPECT_TRUE(result.found.empty());
+            EXPECT_EQ(result.evaluated, elements);
+            for (std::uint32_t id = 0; id < elements + 10; ++id)
+            {
+                ASSERT_EQ(calls[id].load(), id < 10 ? 0 : 1) << threads << " threads, id " << id;
+            }
+        }
+    }
+}
+
+TEST(ParallelTestSmoke, EarlyExitSmoke)
+{
+    // One worker goes in order, so it stops right at the witness or the counterexample.
+    lang::parallel::Pool single{1};
+    const auto witness = lang::parallel::Quantify(single, {0, elements}, QuantifierType::ANY,
+                                                  [](std::uint32_t id) { return id == 41; });
+    EXPECT_TRUE(witness.holds);
+    EXPECT_EQ(witness.found, std::vector<std::uint32_t>{41});
+    EXPECT_EQ(witness.evaluated, 42U);
+
+    const auto counterexample = lang::parallel::Quantify(
+        single, {0, elements}, QuantifierType::ALL, [](std::uint32_t id) { return id != 7; });
+    EXPECT_FALSE(counterexample.holds);
+    EXPECT_EQ(counterexample.evaluated, 8U);
+
+    // Several stop early too, with the same answer wherever the decisive element lies.
+    lang::parallel::Pool pool{4};
+    for (const std::uint32_t decisive : {0U, elements / 3, elements - 1})
+    {
+        const auto any = lang::parallel::Quantify(pool, {0, elements}, QuantifierType::ANY,
+                                                  [&](std::uint32_t id)
+                                                  { return id == decisive && Costly(id); });
+        EXPECT_TRUE(any.holds);
+        EXPECT_EQ(any.found, std::vector<std::uint32_t>{decisive});
+        EXPECT_LE(any.evaluated, elements);
+
+        const auto all = lang::parallel::Quantify(pool, {0, elements}, QuantifierType::ALL,
+                                                  [&](std::uint32_t id)
+                                                  { return id != decisive && Costly(id); });
+        EXPECT_FALSE(all.holds);
+        EXPECT_EQ(all.found, std::vector<std::uint32_t>{decisive});
+    }
+
+    const auto none = lang::parallel::Quantify(pool, {5, 5}, QuantifierType::ANY,
+                                               [](std::uint32_t /*unused*/) { return true; });
+    EXPECT_FALSE(none.holds);
+    EXPECT_EQ(none.evaluated, 0U);
+    EXPECT_TRUE(lang::parallel::Quantify(pool, {5, 5}, QuantifierType::ALL,
+                                         [](std::uint32_t /*unused*/) { return false; })
+                    .holds);
+}
+
+TEST(ParallelTestSmoke, CollectAllSmoke)
+{
+    lang::parallel::Pool pool{3};
+    std::vector<std::uint32_t> expected;
+    for (std::uint32_t id = 0; id < elements; id += 97)
+    {
+        expected.push_back(id);
+    }
+    const auto violations = lang::parallel::Quantify(
+        pool, {0, elements}, QuantifierType::ALL,
+        [](std::uint32_t id) { return id % 97 != 0 && Costly(id); }, {Collect::ALL});
+    EXPECT_FALSE(violations.holds);
+    EXPECT_EQ(violations.found, expected);
+    EXPECT_EQ(violations.evaluated, elements);
+
+    const auto witnesses = lang::parallel::Quantify(
+        pool, {0, elements}, QuantifierType::ANY,
+        [](std::uint32_t id) { return id % 97 == 0; }, {Collect::ALL});
+    EXPECT_TRUE(witnesses.holds);
+    EXPECT_EQ(witnesses.found, expected);
+}
+
+TEST(ParallelTestSmoke, PoolSmoke)
+{
+    EXPECT_THROW(lang::parallel::Pool{0}, std::runtime_error);
+
+    // An error stops the other workers and reaches the caller; the pool stays usable.
+    lang::parallel::Pool pool{4};
+    EXPECT_THROW(lang::parallel::Quantify(pool, {0, elements}, QuantifierType::ALL,
+                                          [](std::uint32_t id)
+                                          {
+                                              if (id == elements / 2)
+                                              {
+                                                  throw std::runtime_error{"predicate failed"};
+                                              }
+                                              return true;
+                                          }),
+                 std::runtime_error);
+
+    std::vector<std::atomic<int>> ran(pool.Size());
+    pool.Run([&](std::size_t worker) { ran[worker].fetch_add(1); });
+    EXPECT_THROW(pool.Run([&](std::size_t /*unused*/) { pool.Run([](std::size_t) {}); }),
+                 std::runtime_error);
+    for (const auto &count : ran)
+    {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
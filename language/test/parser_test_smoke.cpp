@@ -15,6 +15,7 @@
 #include <lexy_ext/report_error.hpp>
 
 #include <memory>
+#include <variant>
 #include <vector>
 
 template <typename T> inline auto ParseMultiple(const auto &arrayInput) -> void
@@ -279,4 +280,30 @@ TEST(ParserTestSmoke, RuleSmoke)
     const auto result = lang::grammar::ParseTest<lang::grammar::RuleDecl>(input);
     EXPECT_TRUE(result.has_value());
     EXPECT_FALSE(result.errors());
-}
\ No newline at end of file
+}
+TEST(ParserTestSmoke, TemplateSmoke)
+{
+    const std::string input{R"(rule template hold(lst, limit) {
+        description: "Hello world";
+        priority: Info;
+        all {
+            c in container:
+                cross(c.technology, lst) == none
+        }
+    }
+    instance payments = hold(["Flask"], 1);
+    instance retail = hold(["Django", "Flask"], 2);
+    )"};
+    // The entry production tells the two apart, after any leading blank lines.
+    EXPECT_TRUE(std::holds_alternative<lang::ast::RuleTemplate>(
+        lang::grammar::ParseSource("\n\n  " + input)));
+    EXPECT_TRUE(std::holds_alternative<lang::ast::Rule>(lang::grammar::ParseSource(
+        "\n rule templates {\n description: \"d\";\n priority: Info;\n x = 1\n}")));
+    const auto result = lang::grammar::ParseTest<lang::grammar::TemplateDecl>(input);
+    EXPECT_TRUE(result.has_value());
+    EXPECT_FALSE(result.errors());
+    EXPECT_EQ(result.value().parameters, (std::vector<std::string>{"lst", "limit"}));
+    ASSERT_EQ(result.value().instances.size(), 2);
+    EXPECT_EQ(result.value().instances.back().name, "retail");
+    EXPECT_EQ(result.value().instances.back().arguments.size(), 2);
+}
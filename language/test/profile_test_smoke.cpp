@@ -0,0 +1,91 @@
+#include <profile/report.hpp>
+#include <translator/translator.hpp>
+
+#include <parser/parser.hpp>
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+// cypher-shell --format verbose output captured for two rules translated with `-t profile`.
+std::string Recorded()
+{
+    std::ifstream file{PROFILE_DATA};
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+} // namespace
+
+TEST(ProfileTestSmoke, TranslateSmoke)
+{
+    const std::string input{R"(rule Articulation {
+        description: "Hello world";
+        priority: Info;
+        all {
+            c in container: failure_point(c):
+            all {
+                ci in instance(c): ci.instanceCount > 1
+            }
+        }
+    }
+    )"};
+    const auto result = lang::grammar::ParseTest<lang::grammar::RuleDecl>(input);
+    EXPECT_TRUE(result.has_value());
+    const auto translation = lang::ast::cypher::Profile(result.value());
+    EXPECT_NE(translation.find("// [RULE]: Articulation\n"), std::string::npos);
+    EXPECT_NE(translation.find("RETURN \"Articulation\" AS profiledRule;\n"
+                               "PROFILE MATCH (c:Container)"),
+              std::string::npos);
+    EXPECT_EQ(translation.substr(translation.size() - 2), ";\n");
+    GTEST_LOG_(INFO) << translation;
+}
+
+TEST(ProfileTestSmoke, ParseSmoke)
+{
+    const auto recorded = Recorded();
+    const auto profiles = lang::profile::ParseProfiles(recorded);
+    ASSERT_EQ(profiles.size(), 2U);
+
+    const auto &articulation = profiles.front();
+    EXPECT_EQ(articulation.rule, "Articulation");
+    EXPECT_EQ(articulation.dbHits, 58U);
+    EXPECT_EQ(articulation.rows, 1U);
+    EXPECT_DOUBLE_EQ(articulation.timeMs, 43.0);
+    ASSERT_EQ(articulation.operators.size(), 5U);
+    EXPECT_EQ(articulation.operators[2].name, "Filter");
+    EXPECT_EQ(articulation.operators[2].rows, 1U);
+    EXPECT_EQ(articulation.operators[2].dbHits, 40U);
+    EXPECT_EQ(articulation.operators[3].name, "NodeByLabelScan");
+    EXPECT_EQ(articulation.operators[3].rows, 8U);
+
+    EXPECT_EQ(profiles.back().rule, "DMZ");
+    EXPECT_EQ(profiles.back().dbHits, 9U);
+
+    EXPECT_ANY_THROW(lang::profile::ParseProfiles(recorded.substr(recorded.find("\n\n"))));
+}
+
+TEST(ProfileTestSmoke, ReportSmoke)
+{
+    auto profiles = lang::profile::ParseProfiles(Recorded());
+    std::swap(profiles.front(), profiles.back());
+    lang::profile::Rank(profiles);
+    EXPECT_EQ(profiles.front().rule, "Articulation");
+
+    const auto top = lang::profile::TopOperators(profiles.front(), 2);
+    ASSERT_EQ(top.size(), 2U);
+    EXPECT_EQ(top.front().name, "Filter");
+    EXPECT_EQ(top.back().dbHits, 9U);
+
+    const auto report = lang::profile::FormatReport(profiles, 1);
+    EXPECT_LT(report.find("Articulation"), report.find("DMZ"));
+    EXPECT_NE(report.find("Filter (40)"), std::string::npos);
+    EXPECT_EQ(report.find("NodeByLabelScan (9)"), std::string::npos);
+    GTEST_LOG_(INFO) << report;
+}
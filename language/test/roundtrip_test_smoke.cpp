@@ -0,0 +1,95 @@
+#include "parser/parser.hpp"
+#include <ast/hash.hpp>
+#include <binary/decoder.hpp>
+#include <binary/writer.hpp>
+#include <gtest/gtest.h>
+#include <json/deserializer.hpp>
+#include <json/serializer.hpp>
+#include <json/writer.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::vector<std::filesystem::path> Examples()
+{
+    std::vector<std::filesystem::path> inputs;
+    for (const auto &entry : std::filesystem::directory_iterator{EXAMPLES_DIR})
+    {
+        const auto input = entry.path() / "input.arch";
+        if (std::filesystem::exists(input))
+        {
+            inputs.push_back(input);
+        }
+    }
+    return inputs;
+}
+
+std::string Read(const std::filesystem::path &path)
+{
+    std::ifstream file{path};
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+} // namespace
+
+TEST(RoundTripTestSmoke, ExamplesSmoke)
+{
+    const auto inputs = Examples();
+    ASSERT_FALSE(inputs.empty());
+    for (const auto &input : inputs)
+    {
+        SCOPED_TRACE(input.string());
+        const auto parsed = lang::grammar::Parse(Read(input));
+        ASSERT_TRUE(parsed.has_value());
+        const auto &rule = parsed.value();
+        const auto json = lang::ast::json::Serialize(rule);
+
+        const auto fromJson = lang::ast::json::Deserialize<lang::ast::Rule>(json);
+        EXPECT_EQ(lang::ast::json::Serialize(fromJson), json);
+
+        const auto fromBinary =
+            lang::ast::binary::Decode<lang::ast::Rule>(lang::ast::binary::Encode(rule));
+        EXPECT_EQ(lang::ast::json::Serialize(fromBinary), json);
+
+        // Without locations the structure still survives.
+        const auto compact = lang::ast::json::Deserialize<lang::ast::Rule>(
+            lang::ast::json::Write(rule, {.locations = false}));
+        EXPECT_TRUE(lang::ast::Equal(compact.calls, rule.calls));
+    }
+}
+
+TEST(RoundTripTestSmoke, TemplateSmoke)
+{
+    const auto parsed = lang::grammar::ParseTemplate(Read(EXAMPLES_DIR "/Hold/template.arch"));
+    ASSERT_TRUE(parsed.has_value());
+    const auto json = lang::ast::json::Serialize(parsed.value());
+    EXPECT_EQ(lang::ast::json::Serialize(
+                  lang::ast::json::Deserialize<lang::ast::RuleTemplate>(json)),
+              json);
+    EXPECT_EQ(lang::ast::json::Serialize(lang::ast::binary::Decode<lang::ast::RuleTemplate>(
+                  lang::ast::binary::Encode(parsed.value()))),
+              json);
+}
+
+TEST(RoundTripTestSmoke, InvalidSmoke)
+{
+    EXPECT_THROW(lang::ast::json::Deserialize<lang::ast::Rule>(R"({"type": "rule"})"),
+                 std::runtime_error);
+    EXPECT_THROW(lang::ast::json::Deserialize<lang::ast::Rule>(
+                     R"({"type": "rule", "name": "a", "description": "b", "priority": "HUGE",
+                         "blocks": {"type": "block", "statements": []}})"),
+                 std::runtime_error);
+    EXPECT_THROW(lang::ast::json::Deserialize<lang::ast::Rule>(
+                     R"({"type": "rule", "name": "a", "description": "b", "priority": "INFO",
+                         "blocks": {"type": "block", "statements": [{"type": "FOO"}]}})"),
+                 std::runtime_error);
+}
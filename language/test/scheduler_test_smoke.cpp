@@ -0,0 +1,209 @@
+#include "parser/parser.hpp"
+#include <gtest/gtest.h>
+#include <parallel/scheduler.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using lang::parallel::RuleStatus;
+using namespace std::chrono_literals;
+
+lang::ast::Rule Rule(const std::string &name, const std::string &priority, bool nested = false)
+{
+    const auto body = nested ? R"(all {
+            c in container:
+            exist {
+                d in component: d.name == c.name
+            }
+        })"
+                             : R"(all {
+            c in container: "Database" in c.tags
+        })";
+    auto parsed = lang::grammar::ParseTest<lang::grammar::RuleDecl>(
+        "rule " + name + " {\n description: \"" + name + "\";\n priority: " + priority + ";\n " +
+        body + "\n}");
+    EXPECT_TRUE(parsed.has_value());
+    return std::move(parsed).value();
+}
+
+// Sleeps in short steps until `time` has passed or the scheduler asks it to stop.
+void Sleep(const lang::parallel::RuleContext &context, std::chrono::milliseconds time)
+{
+    const auto until = std::chrono::steady_clock::now() + time;
+    while (!context.Stopped() && std::chrono::steady_clock::now() < until)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+}
+
+} // namespace
+
+TEST(SchedulerTestSmoke, OrderSmoke)
+{
+    std::vector<lang::ast::Rule> rules;
+    rules.push_back(Rule("Notes", "Info"));
+    rules.push_back(Rule("Flat", "Error"));
+    rules.push_back(Rule("Style", "Warn"));
+    rules.push_back(Rule("Nested", "Error", true));
+    EXPECT_GT(lang::parallel::Cost(rules[3]), lang::parallel::Cost(rules[1]));
+
+    // On one thread the rules run exactly in the order of the schedule.
+    std::vector<std::string> started;
+    const auto reports = lang::parallel::Schedule(
+        std::move(rules),
+        [&](const lang::ast::Rule &rule, lang::parallel::RuleContext & /*unused*/)
+        {
+            started.push_back(rule.name);
+            return rule.name == "Flat" ? 0 : rule.name.size();
+        },
+        {.threads = 1});
+    EXPECT_EQ(started, (std::vector<std::string>{"Nested", "Flat", "Style", "Notes"}));
+    ASSERT_EQ(reports.size(), 4U);
+    for (std::size_t i = 0; i < reports.size(); ++i)
+    {
+        EXPECT_EQ(reports[i].rule, started[i]);
+    }
+    EXPECT_EQ(reports[0].status, RuleStatus::FAILED);
+    EXPECT_EQ(reports[0].violations, 6U);
+    EXPECT_EQ(reports[1].status, RuleStatus::PASSED);
+    EXPECT_EQ(reports[3].priority, lang::ast::Priority::INFO);
+
+    EXPECT_TRUE(lang::parallel::Schedule({}, [](const auto &, auto &) { return 0; }).empty());
+    std::vector<lang::ast::Rule> one;
+    one.push_back(Rule("Notes", "Info"));
+    EXPECT_THROW(lang::parallel::Schedule(
+                     std::move(one), [](const auto &, auto &) { return 0; }, {.threads = 0}),
+                 std::runtime_error);
+}
+
+TEST(SchedulerTestSmoke, TimeoutSmoke)
+{
+    std::vector<lang::ast::Rule> rules;
+    rules.push_back(Rule("Runaway", "Error"));
+    rules.push_back(Rule("Polite", "Error"));
+    for (int i = 0; i < 6; ++i)
+    {
+        rules.push_back(Rule("Quick" + std::to_string(i), "Warn"));
+    }
+    const auto count = rules.size();
+    lang::parallel::SchedulerOptions options{.threads = 2};
+    options.budgets["Runaway"] = {50ms};
+    options.budgets["Polite"] = {50ms};
+
+    // The runaway ignores its stop token and outlives Schedule, so what it touches is shared
+    // with it rather than borrowed from this frame.
+    struct Progress
+    {
+        std::atomic<bool> runawayReturned{false};
+        std::atomic<int> quick{0};
+        std::atomic<int> maxQuick{0};
+    };
+    const auto progress = std::make_shared<Progress>();
+    const auto start = std::chrono::steady_clock::now();
+    const auto reports = lang::parallel::Schedule(
+        std::move(rules),
+        [progress](const lang::ast::Rule &rule,
+                   lang::parallel::RuleContext &context) -> std::size_t
+        {
+            if (rule.name == "Runaway")
+            {
+                std::this_thread::sleep_for(1s);
+                progress->runawayReturned = true;
+                return 0;
+            }
+            if (rule.name == "Polite")
+            {
+                Sleep(context, 1s);
+                return 1;
+            }
+            const auto quick = ++progress->quick;
+            auto most = progress->maxQuick.load();
+            while (quick > most && !progress->maxQuick.compare_exchange_weak(most, quick))
+            {
+            }
+            Sleep(context, 10ms);
+            --progress->quick;
+            return 1;
+        },
+        options);
+    // Schedule does not wait for the runaway, whose thread still counts against the two: the
+    // quick rules run one at a time.
+    EXPECT_FALSE(progress->runawayReturned);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 800ms);
+    EXPECT_EQ(progress->maxQuick.load(), 1);
+
+    ASSERT_EQ(reports.size(), count);
+    for (const auto &report : reports)
+    {
+        if (report.rule == "Runaway" || report.rule == "Polite")
+        {
+            EXPECT_EQ(report.status, RuleStatus::TIMEOUT) << report.rule;
+            EXPECT_EQ(report.violations, 0U);
+            EXPECT_GE(report.elapsed, 50ms);
+            EXPECT_LT(report.elapsed, 800ms);
+        }
+        else
+        {
+            EXPECT_EQ(report.status, RuleStatus::FAILED) << report.rule;
+            EXPECT_EQ(report.violations, 1U);
+        }
+    }
+    EXPECT_NE(lang::parallel::FormatSchedule(reports).find("Runaway"), std::string::npos);
+}
+
+TEST(SchedulerTestSmoke, MemorySmoke)
+{
+    std::vector<lang::ast::Rule> rules;
+    rules.push_back(Rule("Hog", "Error"));
+    rules.push_back(Rule("Modest", "Error"));
+    rules.push_back(Rule("Broken", "Warn"));
+    lang::parallel::SchedulerOptions options{.threads = 3};
+    options.budget.memory = 1 << 20;
+
+    const auto reports = lang::parallel::Schedule(
+        std::move(rules),
+        [](const lang::ast::Rule &rule, lang::parallel::RuleContext &context) -> std::size_t
+        {
+            if (rule.name == "Broken")
+            {
+                throw std::runtime_error{"no such label"};
+            }
+            std::vector<char, lang::parallel::Charged<char>> rows{
+                lang::parallel::Charged<char>{context}};
+            rows.resize(rule.name == "Hog" ? 4 << 20 : 100000);
+            return 0;
+        },
+        options);
+    ASSERT_EQ(reports.size(), 3U);
+    for (const auto &report : reports)
+    {
+        if (report.rule == "Hog")
+        {
+            EXPECT_EQ(report.status, RuleStatus::OUT_OF_MEMORY);
+            EXPECT_LE(report.peakMemory, 1U << 20);
+        }
+        else if (report.rule == "Modest")
+        {
+            EXPECT_EQ(report.status, RuleStatus::PASSED);
+            EXPECT_EQ(report.peakMemory, 100000U);
+        }
+        else
+        {
+            EXPECT_EQ(report.status, RuleStatus::ERROR);
+            EXPECT_EQ(report.message, "no such label");
+        }
+    }
+    const auto table = lang::parallel::FormatSchedule(reports);
+    EXPECT_NE(table.find("out of memory"), std::string::npos);
+    EXPECT_NE(table.find("no such label"), std::string::npos);
+}
@@ -6,6 +6,15 @@
 #include <lexy/action/parse.hpp>
 #include <lexy/input/string_input.hpp>
 #include <lexy_ext/report_error.hpp>
+#include <translator/pass.hpp>
+#include <translator/passes/closure.hpp>
+#include <translator/passes/cse.hpp>
+#include <translator/passes/decorrelate.hpp>
+#include <translator/passes/fold.hpp>
+#include <translator/passes/reorder.hpp>
+#include <translator/passes/simplify.hpp>
+#include <translator/passes/symmetry.hpp>
+#include <translator/passes/workspace.hpp>
 #include <translator/translator.hpp>
 
 #include <parser/parser.hpp>
@@ -66,6 +75,12 @@ TEST(TranslatorTestSmoke, FunctionCallSmoke)
     const auto translation = lang::ast::cypher::Translate(result.value());
     EXPECT_TRUE(not translation.empty());
     GTEST_LOG_(INFO) << translation;
+
+    // elementId is only emitted by the translator's passes; rules cannot call it.
+    const auto internal =
+        lang::grammar::ParseTest<lang::grammar::ExpressionProduct>(R"(elementId(1))");
+    EXPECT_TRUE(internal.has_value());
+    EXPECT_ANY_THROW({ const auto rejected = lang::ast::cypher::Translate(internal.value()); });
 }
 
 TEST(TranslatorTestSmoke, AssignmentSmoke)
@@ -210,4 +225,641 @@ TEST(TranslatorTestSmoke, ArticulationSmoke)
     const auto translation = lang::ast::cypher::Translate(result.value());
     EXPECT_TRUE(not translation.empty());
     GTEST_LOG_(INFO) << translation;
-}
\ No newline at end of file
+}
+TEST(TranslatorTestSmoke, ContainmentClosureSmoke)
+{
+    const std::string input{R"(rule DMZ {
+        description: "Hello world";
+        priority: Info;
+        all {
+            d in deploy: "DMZ" == d.name:
+            all {
+                c in d: "Database" not in c.tags
+            }
+        }
+    }
+    )"};
+    const auto result = lang::grammar::ParseTest<lang::grammar::RuleDecl>(input);
+    EXPECT_TRUE(result.has_value());
+    lang::ast::cypher::TranslatorOptions options;
+    options.closure = true;
+    const auto translation = lang::ast::cypher::Translate(result.value(), options);
+    EXPECT_NE(translation.find("(d)-[:IN_SUBTREE]->(:ContainerInstance)-[:INSTANCE_OF]->"),
+              std::string::npos);
+    EXPECT_EQ(translation.find("CONTAINS*"), std::string::npos);
+
+    // Routes keep to the model's relationships whether or not the closure edges are used, so
+    // that they never take an IN_SUBTREE shortcut.
+    const std::string route{R"(rule Route {
+        description: "Hello world";
+        priority: Info;
+        all {
+            s1, s2 in system:
+            all {
+                s in route(s1, s2): "Integration platform" in s.tags
+            }
+        }
+    }
+    )"};
+    const auto routed = lang::grammar::ParseTest<lang::grammar::RuleDecl>(route);
+    EXPECT_TRUE(routed.has_value());
+    for (const bool closure : {false, true})
+    {
+        options.closure = closure;
+        const auto paths = lang::ast::cypher::Translate(routed.value(), options);
+        EXPECT_NE(paths.find("(s1)-[:RELATES_TO|CONTAINS|INSTANCE_OF*1..]->(s2)"),
+                  std::string::npos);
+        EXPECT_EQ(paths.find("[*1..]"), std::string::npos);
+    }
+}
+
+TEST(TranslatorTestSmoke, WorkspaceScopingSmoke)
+{
+    const std::string input{R"(rule DMZ {
+        description: "Hello world";
+        priority: Info;
+        all {
+            d in deploy: "DMZ" == d.name:
+            all {
+                c in d: "Database" not in c.tags
+            }
+        }
+    }
+    )"};
+    const auto result = lang::grammar::ParseTest<lang::grammar::RuleDecl>(input);
+    EXPECT_TRUE(result.has_value());
+    lang::ast::cypher::TranslatorOptions options;
+    options.workspace = lang::ast::cypher::WorkspaceScope::PARAMETER;
+    const auto translation = lang::ast::cypher::Translate(result.value(), options);
+    EXPECT_NE(translation.find("MATCH (d:DeploymentNode {workspace: $workspace})"),
+              std::string::npos);
+    EXPECT_NE(translation.find("(c:Container {workspace: $workspace})"), std::string::npos);
+
+    namespace ir = lang::ast::cypher::ir;
+    ir::Match match;
+    match.patterns.push_back(ir::PathPattern{"", {ir::NodePattern{"s1", "SoftwareSystem"}}, {}});
+    match.patterns.push_back(ir::PathPattern{"", {ir::NodePattern{"s2", "SoftwareSystem"}}, {}});
+    ir::Return projection;
+    projection.items.push_back(ir::Projection{ir::Make<ir::Variable>("s1"), ""});
+    projection.items.push_back(ir::Projection{ir::Make<ir::Variable>("s2"), ""});
+    ir::Query pairs;
+    pairs.clauses.emplace_back(std::move(match));
+    pairs.clauses.emplace_back(std::move(projection));
+    lang::ast::cypher::passes::WorkspaceScoping{lang::ast::cypher::WorkspaceScope::GROUPED}.Run(
+        pairs);
+    EXPECT_EQ(ir::Print(pairs), "MATCH (s1:SoftwareSystem), (s2:SoftwareSystem {workspace: "
+                                "s1.workspace}) RETURN s1.workspace AS workspace, s1, s2");
+}
+
+TEST(TranslatorTestSmoke, TemplateSmoke)
+{
+    const std::string input{R"(rule template HOLD(lst) {
+        description: "Hello world";
+        priority: Info;
+        all {
+            c in container:
+                cross(c.technology, lst) == none
+        }
+    }
+    instance Payments = HOLD(["Flask"]);
+    instance Retail = HOLD(["Django", "Flask"]);
+    )"};
+    const auto result = lang::grammar::ParseTest<lang::grammar::TemplateDecl>(input);
+    EXPECT_TRUE(result.has_value());
+    const auto translation = lang::ast::cypher::TranslateTemplate(result.value());
+    EXPECT_EQ(translation.find(R"(:param instances => [{instance: "Payments", lst: ["Flask"]}, )"
+                               R"({instance: "Retail", lst: ["Django", "Flask"]}];)"),
+              0);
+    EXPECT_NE(translation.find("UNWIND $instances AS __instance WITH __instance.instance AS "
+                               "instance, __instance.lst AS lst MATCH (c:Container) WHERE NOT "
+                               "([ x IN c.technology WHERE x IN lst ] = []) RETURN instance, c"),
+              std::string::npos);
+    EXPECT_EQ(translation.find("MATCH", translation.find("MATCH") + 1), std::string::npos);
+}
+
+TEST(TranslatorTestSmoke, TemplateArgumentsSmoke)
+{
+    const std::string input{R"(rule template HOLD(lst) {
+        description: "Hello world";
+        priority: Info;
+        all {
+            c in container:
+                cross(c.technology, lst) == none
+        }
+    }
+    instance Payments = HOLD(["Flask"], 1);
+    )"};
+    const auto result = lang::grammar::ParseTest<lang::grammar::TemplateDecl>(input);
+    EXPECT_TRUE(result.has_value());
+    EXPECT_THROW(lang::ast::cypher::TranslateTemplate(result.value()), std::runtime_error);
+}
+
+TEST(TranslatorTestSmoke, PrettySmoke)
+{
+    const std::string input{R"(rule Articulation {
+        description: "Hello world";
+        priority: Info;
+        all {
+            c in container: failure_point(c):
+            all {
+                ci in instance(c): ci.instanceCount > 1
+            }
+        }
+    }
+    )"};
+    const auto result = lang::grammar::ParseTest<lang::grammar::RuleDecl>(input);
+    EXPECT_TRUE(result.has_value());
+    lang::ast::cypher::TranslatorOptions options;
+    options.print.pretty = true;
+    const auto compact = lang::ast::cypher::Translate(result.value());
+    const auto pretty = lang::ast::cypher::Translate(result.value(), options);
+    EXPECT_NE(compact, pretty);
+    EXPECT_NE(pretty.find("\n  MATCH (ci:ContainerInstance)"), std::string::npos);
+    EXPECT_NE(compact.find("RETURN c"), std::string::npos);
+    GTEST_LOG_(INFO) << pretty;
+}
+
+TEST(TranslatorTestSmoke, PassManagerSmoke)
+{
+    namespace ir = lang::ast::cypher::ir;
+    ir::Query query;
+    ir::Match match;
+    match.patterns.push_back(ir::PathPattern{"", {ir::NodePattern{"c", "Container"}}, {}});
+    match.where = ir::Make<ir::Not>(ir::Make<ir::Not>(ir::Make<ir::Binary>(
+        lang::ast::ExprType::EQ, ir::Make<ir::Variable>("c"), ir::Make<ir::Variable>("c"))));
+    query.clauses.emplace_back(std::move(match));
+
+    ir::PassManager manager;
+    manager.Add<lang::ast::cypher::passes::Simplify>();
+    manager.Run(query);
+    EXPECT_EQ(ir::Print(query), "MATCH (c:Container) WHERE c = c");
+}
+
+TEST(TranslatorTestSmoke, CommonSubexpressionSmoke)
+{
+    const std::string input{R"(rule Integration {
+        description: "Hello world";
+        priority: Error;
+        all {
+            s1, s2 in system:
+            exist {
+                c in s1: "Integration platform" in s1.tags and c.name == s2.name
+            }
+        };
+        except all {
+            s1, s2 in system:
+                "Integration platform" in s1.tags xor "Integration platform" in s2.tags
+        }
+    }
+    )"};
+    const auto result = lang::grammar::ParseTest<lang::grammar::RuleDecl>(input);
+    EXPECT_TRUE(result.has_value());
+    lang::ast::cypher::TranslatorOptions options;
+    options.optimize = true;
+    const auto translation = lang::ast::cypher::Translate(result.value(), options);
+    const std::string shared{R"("Integration platform" IN s1.tags)"};
+    const auto first = translation.find(shared);
+    EXPECT_NE(first, std::string::npos);
+    EXPECT_EQ(translation.find(shared, first + 1), std::string::npos);
+    EXPECT_NE(translation.find("WITH *, " + shared + " AS __cse0"), std::string::npos);
+    GTEST_LOG_(INFO) << translation;
+}
+
+TEST(TranslatorTestSmoke, ConstantHoistSmoke)
+{
+    namespace ir = lang::ast::cypher::ir;
+    using lang::ast::ExprType;
+    std::vector<ir::ExprPtr> args;
+    args.push_back(ir::Make<ir::List>());
+    args.push_back(ir::Make<ir::List>());
+    ir::Match match;
+    match.patterns.push_back(ir::PathPattern{"", {ir::NodePattern{"c", "Container"}}, {}});
+    match.where = ir::Make<ir::Binary>(
+        ExprType::IN,
+        ir::Make<ir::Property>(ExprType::ACCESS, ir::Make<ir::Variable>("c"), "name"),
+        ir::Make<ir::Call>("cross", std::move(args)));
+    ir::Query query;
+    query.clauses.emplace_back(std::move(match));
+
+    lang::ast::cypher::passes::CommonSubexpressions{}.Run(query);
+    EXPECT_EQ(ir::Print(query), "WITH [ x IN [] WHERE x IN [] ] AS __cse0 "
+                                "MATCH (c:Container) WHERE c.name IN __cse0");
+}
+
+TEST(TranslatorTestSmoke, OptionalHoistSmoke)
+{
+    namespace ir = lang::ast::cypher::ir;
+    using lang::ast::ExprType;
+    const auto sum = [](const char *left, const char *right)
+    {
+        return ir::Make<ir::Binary>(
+            ExprType::PLUS,
+            ir::Make<ir::Property>(ExprType::ACCESS, ir::Make<ir::Variable>(left), "a"),
+            ir::Make<ir::Property>(ExprType::ACCESS, ir::Make<ir::Variable>(right), "b"));
+    };
+    const auto limit = [](std::int64_t value)
+    { return ir::Make<ir::Literal>(ir::LiteralValue{value}); };
+    ir::Match outer;
+    outer.patterns.push_back(ir::PathPattern{"", {ir::NodePattern{"s", "SoftwareSystem"}}, {}});
+    ir::Match match;
+    match.optional = true;
+    match.patterns.push_back(ir::PathPattern{"", {ir::NodePattern{"c", "Container"}}, {}});
+    std::vector<ir::ExprPtr> conjuncts;
+    conjuncts.push_back(ir::Make<ir::Binary>(ExprType::GREATER, sum("c", "s"), limit(1)));
+    conjuncts.push_back(ir::Make<ir::Binary>(ExprType::LESS, sum("c", "s"), limit(5)));
+    conjuncts.push_back(ir::Make<ir::Binary>(ExprType::GREATER, sum("s", "s"), limit(0)));
+    conjuncts.push_back(ir::Make<ir::Binary>(ExprType::LESS, sum("s", "s"), limit(9)));
+    match.where = ir::Combine(ExprType::AND, std::move(conjuncts));
+    ir::Query query;
+    query.clauses.emplace_back(std::move(outer));
+    query.clauses.emplace_back(std::move(match));
+
+    // Moving `c.a + s.b` into a WITH after the OPTIONAL MATCH would drop rows that the WHERE
+    // only nulls, so just the expression over `s` is bound, before the match.
+    lang::ast::cypher::passes::CommonSubexpressions{}.Run(query);
+    EXPECT_EQ(ir::Print(query), "MATCH (s:SoftwareSystem) WITH *, s.a + s.b AS __cse0 "
+                                "OPTIONAL MATCH (c:Container) WHERE c.a + s.b > 1 AND "
+                                "c.a + s.b < 5 AND __cse0 > 0 AND __cse0 < 9");
+}
+
+TEST(TranslatorTestSmoke, GuardedHoistSmoke)
+{
+    namespace ir = lang::ast::cypher::ir;
+    using lang::ast::ExprType;
+    const auto property = [](const std::string &name)
+    { return ir::Make<ir::Property>(ExprType::ACCESS, ir::Make<ir::Variable>("c"), name); };
+    const auto literal = [](const std::string &value)
+    { return ir::Make<ir::Literal>(ir::LiteralValue{value}); };
+    const auto tagged = [&]
+    { return ir::Make<ir::Binary>(ExprType::IN, literal("a"), property("tags")); };
+    const auto either = [&](const std::string &kind, ir::ExprPtr expr)
+    {
+        std::vector<ir::ExprPtr> operands;
+        operands.push_back(ir::Make<ir::Binary>(ExprType::EQ, literal(kind), property("kind")));
+        operands.push_back(std::move(expr));
+        return ir::Combine(ExprType::OR, std::move(operands));
+    };
+    const auto query = [](std::vector<ir::ExprPtr> conjuncts)
+    {
+        ir::Match match;
+        match.patterns.push_back(ir::PathPattern{"", {ir::NodePattern{"c", "Container"}}, {}});
+        match.where = ir::Combine(ExprType::AND, std::move(conjuncts));
+        ir::Query result;
+        result.clauses.emplace_back(std::move(match));
+        lang::ast::cypher::passes::CommonSubexpressions{}.Run(result);
+        return ir::Print(result);
+    };
+
+    // `"a" IN c.tags` fails on a scalar `tags`; the query only evaluates it where `c.kind`
+    // does not match, so it stays in place.
+    std::vector<ir::ExprPtr> guarded;
+    guarded.push_back(either("b", tagged()));
+    guarded.push_back(either("c", tagged()));
+    EXPECT_EQ(query(std::move(guarded)), R"(MATCH (c:Container) WHERE ("b" = c.kind OR )"
+                                         R"("a" IN c.tags) AND ("c" = c.kind OR "a" IN c.tags))");
+
+    std::vector<ir::ExprPtr> anchored;
+    anchored.push_back(ir::Make<ir::Binary>(ExprType::EQ, property("name"), literal("x")));
+    anchored.push_back(tagged());
+    anchored.push_back(either("c", tagged()));
+    EXPECT_EQ(query(std::move(anchored)),
+              R"(MATCH (c:Container) WHERE c.name = "x" WITH *, "a" IN c.tags AS __cse0 )"
+              R"(WHERE __cse0 AND ("c" = c.kind OR __cse0))");
+}
+
+TEST(TranslatorTestSmoke, ConstantFoldingSmoke)
+{
+    const std::string input{R"(rule HOLD {
+    description: "Hello world";
+    priority: Info;
+    lst = ["JS", "JS"];
+    all {
+        c in container:
+            cross(c.tech, lst) == none
+    }
+    }
+    )"};
+    const auto result = lang::grammar::ParseTest<lang::grammar::RuleDecl>(input);
+    EXPECT_TRUE(result.has_value());
+    lang::ast::cypher::TranslatorOptions options;
+    options.optimize = true;
+    const auto translation = lang::ast::cypher::Translate(result.value(), options);
+    EXPECT_NE(translation.find(R"(MATCH (c:Container) WHERE "JS" IN c.tech RETURN c)"),
+              std::string::npos);
+    EXPECT_EQ(translation.find("lst"), std::string::npos);
+    GTEST_LOG_(INFO) << translation;
+}
+
+TEST(TranslatorTestSmoke, ReassignmentFoldingSmoke)
+{
+    const std::string input{R"(rule Reassigned {
+    description: "Hello world";
+    priority: Info;
+    lst = ["A"];
+    lst = ["B", "C"];
+    all {
+        c in container:
+            c.name in lst
+    }
+    }
+    )"};
+    const auto result = lang::grammar::ParseTest<lang::grammar::RuleDecl>(input);
+    EXPECT_TRUE(result.has_value());
+    lang::ast::cypher::TranslatorOptions options;
+    options.optimize = true;
+    const auto translation = lang::ast::cypher::Translate(result.value(), options);
+    EXPECT_NE(translation.find(R"(c.name IN ["B", "C"])"), std::string::npos);
+    EXPECT_EQ(translation.find(R"("A")"), std::string::npos);
+
+    // Once the constant is folded away, the next assignment opens the query and has no scope
+    // to carry over with `*`.
+    namespace ir = lang::ast::cypher::ir;
+    std::vector<ir::ExprPtr> items;
+    items.push_back(ir::Make<ir::Literal>(ir::LiteralValue{std::string{"A"}}));
+    ir::With constant;
+    constant.items.push_back(ir::Projection{ir::Make<ir::List>(std::move(items)), "lst"});
+    ir::With random;
+    random.items.push_back(ir::Projection{ir::Make<ir::Raw>("*"), ""});
+    random.items.push_back(ir::Projection{ir::Make<ir::Raw>("rand()"), "n"});
+    ir::Query query;
+    query.clauses.emplace_back(std::move(constant));
+    query.clauses.emplace_back(std::move(random));
+    lang::ast::cypher::passes::ConstantFolding{}.Run(query);
+    EXPECT_EQ(ir::Print(query), "WITH rand() AS n");
+}
+
+TEST(TranslatorTestSmoke, ExceptPrecomputeSmoke)
+{
+    const std::string input{R"(rule Replicated {
+    description: "Hello world";
+    priority: Info;
+    all {
+        c in container:
+            "Flask" in c.technology
+    };
+    except all {
+        c in container:
+        exist {
+            ci in instance(c): ci.instanceCount > 1
+        }
+    }
+    }
+    )"};
+    const auto result = lang::grammar::ParseTest<lang::grammar::RuleDecl>(input);
+    EXPECT_TRUE(result.has_value());
+    lang::ast::cypher::TranslatorOptions options;
+    options.optimize = true;
+    const auto translation = lang::ast::cypher::Translate(result.value(), options);
+    EXPECT_NE(translation.find("OPTIONAL MATCH (c:Container) WHERE EXISTS { MATCH "
+                               "(ci:ContainerInstance)-[:INSTANCE_OF]->(c) WHERE "
+                               "ci.instanceCount > 1 } "
+                               "WITH collect(DISTINCT elementId(c)) AS __except0 "
+                               "MATCH (c:Container) WHERE"),
+              std::string::npos);
+    EXPECT_NE(translation.find("NOT (elementId(c) IN __except0)"), std::string::npos);
+    GTEST_LOG_(INFO) << translation;
+}
+
+TEST(TranslatorTestSmoke, TwoExceptPrecomputeSmoke)
+{
+    // No container has a thousand instances, so __except1 is empty. Its set must not become
+    // a grouping key over a MATCH without rows, which would drop every finding.
+    const std::string input{R"(rule Replicated {
+    description: "Hello world";
+    priority: Info;
+    all {
+        c in container:
+            "Flask" in c.technology
+    };
+    except all {
+        c in container:
+        exist {
+            ci in instance(c): ci.instanceCount > 1
+        }
+    };
+    except all {
+        c in container:
+        exist {
+            ci in instance(c): ci.instanceCount > 1000
+        }
+    }
+    }
+    )"};
+    const auto result = lang::grammar::ParseTest<lang::grammar::RuleDecl>(input);
+    EXPECT_TRUE(result.has_value());
+    lang::ast::cypher::TranslatorOptions options;
+    options.optimize = true;
+    const auto translation = lang::ast::cypher::Translate(result.value(), options);
+    EXPECT_EQ(translation.find("MATCH"), translation.find("OPTIONAL MATCH") + 9);
+    EXPECT_NE(translation.find("WITH collect(DISTINCT elementId(c)) AS __except1 "
+                               "OPTIONAL MATCH (c:Container) WHERE EXISTS { MATCH "
+                               "(ci:ContainerInstance)-[:INSTANCE_OF]->(c) WHERE "
+                               "ci.instanceCount > 1 } "
+                               "WITH collect(DISTINCT elementId(c)) AS __except0, __except1 "
+                               "MATCH (c:Container) WHERE"),
+              std::string::npos);
+    EXPECT_NE(translation.find("NOT (elementId(c) IN __except1)"), std::string::npos);
+    GTEST_LOG_(INFO) << translation;
+}
+
+TEST(TranslatorTestSmoke, LiteralSetFoldingSmoke)
+{
+    namespace ir = lang::ast::cypher::ir;
+    const auto list = [](std::initializer_list<std::string> values)
+    {
+        std::vector<ir::ExprPtr> items;
+        for (const auto &value : values)
+        {
+            items.push_back(ir::Make<ir::Literal>(ir::LiteralValue{value}));
+        }
+        return ir::Make<ir::List>(std::move(items));
+    };
+    std::vector<ir::ExprPtr> args;
+    args.push_back(list({"b", "a"}));
+    args.push_back(list({"c", "a"}));
+    auto expr = ir::Make<ir::Call>("union", std::move(args));
+    lang::ast::cypher::passes::ConstantFolding::Fold(expr);
+    EXPECT_EQ(ir::Print(expr), R"(["a", "b", "c"])");
+
+    auto sum = ir::Make<ir::Binary>(
+        lang::ast::ExprType::MULT,
+        ir::Make<ir::Binary>(lang::ast::ExprType::PLUS,
+                             ir::Make<ir::Literal>(ir::LiteralValue{std::int64_t{2}}),
+                             ir::Make<ir::Literal>(ir::LiteralValue{std::int64_t{3}})),
+        ir::Make<ir::Literal>(ir::LiteralValue{std::int64_t{4}}));
+    lang::ast::cypher::passes::ConstantFolding::Fold(sum);
+    EXPECT_EQ(ir::Print(sum), "20");
+}
+
+TEST(TranslatorTestSmoke, ConjunctReorderingSmoke)
+{
+    namespace ir = lang::ast::cypher::ir;
+    using lang::ast::ExprType;
+    const auto membership = [](const std::string &value, const std::string &property)
+    {
+        return ir::Make<ir::Binary>(
+            ExprType::IN, ir::Make<ir::Literal>(ir::LiteralValue{value}),
+            ir::Make<ir::Property>(ExprType::ACCESS, ir::Make<ir::Variable>("d"), property));
+    };
+    const auto build = [&]
+    {
+        ir::Query inner;
+        inner.clauses.emplace_back(ir::Match{
+            {ir::PathPattern{"",
+                             {ir::NodePattern{"d", ""}, ir::NodePattern{"c", "Container"}},
+                             {ir::RelationshipPattern{"CONTAINS", "*"}}}},
+            nullptr});
+        ir::Match match;
+        match.patterns.push_back(ir::PathPattern{"", {ir::NodePattern{"d", "DeploymentNode"}}, {}});
+        match.where = ir::And(ir::Make<ir::Exists>(std::move(inner)), membership("a", "tags"),
+                              membership("b", "labels"));
+        ir::Query query;
+        query.clauses.emplace_back(std::move(match));
+        return query;
+    };
+
+    auto query = build();
+    lang::ast::cypher::passes::ConjunctReordering{}.Run(query);
+    EXPECT_EQ(ir::Print(query), R"(MATCH (d:DeploymentNode) WHERE "a" IN d.tags AND "b" IN )"
+                                R"(d.labels AND EXISTS { MATCH (d)-[:CONTAINS*]->(c:Container) })");
+
+    lang::ast::cypher::Statistics statistics;
+    statistics.properties["labels"] = 0.01;
+    auto informed = build();
+    lang::ast::cypher::passes::ConjunctReordering{statistics}.Run(informed);
+    EXPECT_EQ(ir::Print(informed), R"(MATCH (d:DeploymentNode) WHERE "b" IN d.labels AND )"
+                                   R"("a" IN d.tags AND EXISTS { )"
+                                   R"(MATCH (d)-[:CONTAINS*]->(c:Container) })");
+}
+
+TEST(TranslatorTestSmoke, DecorrelationSmoke)
+{
+    namespace ir = lang::ast::cypher::ir;
+    using lang::ast::ExprType;
+    const auto property = [](const std::string &variable, const std::string &name)
+    { return ir::Make<ir::Property>(ExprType::ACCESS, ir::Make<ir::Variable>(variable), name); };
+    const auto subquery = [](ir::PathPattern path, ir::ExprPtr where)
+    {
+        ir::Query query;
+        query.clauses.emplace_back(ir::Match{{std::move(path)}, std::move(where)});
+        return ir::Make<ir::Exists>(std::move(query));
+    };
+
+    auto correlated = subquery(
+        ir::PathPattern{"",
+                        {ir::NodePattern{"ci", "ContainerInstance"}, ir::NodePattern{"c", ""}},
+                        {ir::RelationshipPattern{"INSTANCE_OF", ""}}},
+        ir::Make<ir::Binary>(ExprType::GREATER, property("ci", "instanceCount"),
+                             ir::Make<ir::Literal>(ir::LiteralValue{std::int64_t{1}})));
+    auto uncorrelated = subquery(
+        ir::PathPattern{"", {ir::NodePattern{"s", "SoftwareSystem"}}, {}},
+        ir::Make<ir::Binary>(ExprType::EQ, property("s", "name"),
+                             ir::Make<ir::Literal>(ir::LiteralValue{std::string{"Legacy"}})));
+    ir::Match match;
+    match.patterns.push_back(ir::PathPattern{"", {ir::NodePattern{"c", "Container"}}, {}});
+    match.where = ir::And(std::move(correlated), ir::Make<ir::Not>(std::move(uncorrelated)));
+    ir::Query query;
+    query.clauses.emplace_back(std::move(match));
+    query.clauses.emplace_back(ir::Return{});
+    std::get<ir::Return>(query.clauses.back())
+        .items.push_back(ir::Projection{ir::Make<ir::Variable>("c"), ""});
+
+    lang::ast::cypher::passes::Decorrelation{}.Run(query);
+    EXPECT_EQ(ir::Print(query),
+              R"(OPTIONAL MATCH (ci:ContainerInstance)-[:INSTANCE_OF]->(c:Container) )"
+              R"(WHERE ci.instanceCount > 1 )"
+              R"(WITH collect(DISTINCT elementId(c)) AS __q0 )"
+              R"(OPTIONAL MATCH (s:SoftwareSystem) WHERE s.name = "Legacy" )"
+              R"(WITH __q0, count(s) AS __q1 )"
+              R"(MATCH (c:Container) WHERE elementId(c) IN __q0 AND __q1 = 0 )"
+              R"(RETURN c)");
+}
+
+TEST(TranslatorTestSmoke, DecorrelationWithoutOptimizeSmoke)
+{
+    const std::string input{R"(rule Articulation {
+        description: "Hello world";
+        priority: Info;
+        all {
+            c in container: failure_point(c):
+            all {
+                ci in instance(c): ci.instanceCount > 1
+            }
+        }
+    }
+    )"};
+    const auto result = lang::grammar::ParseTest<lang::grammar::RuleDecl>(input);
+    EXPECT_TRUE(result.has_value());
+    lang::ast::cypher::TranslatorOptions options;
+    options.decorrelate = true;
+    const auto translation = lang::ast::cypher::Translate(result.value(), options);
+    EXPECT_EQ(translation.find("EXISTS"), std::string::npos);
+    EXPECT_NE(translation.find("OPTIONAL MATCH (ci:ContainerInstance)-[:INSTANCE_OF]->"
+                               "(c:Container) WHERE "),
+              std::string::npos);
+    EXPECT_NE(translation.find("WITH collect(DISTINCT elementId(c)) AS __q0 MATCH (c:Container)"),
+              std::string::npos);
+    GTEST_LOG_(INFO) << translation;
+}
+
+TEST(TranslatorTestSmoke, SymmetryReductionSmoke)
+{
+    namespace ir = lang::ast::cypher::ir;
+    using lang::ast::ExprType;
+    const auto query = [](const std::vector<std::string> &variables, ir::ExprPtr predicate)
+    {
+        ir::Match match;
+        std::vector<ir::ExprPtr> conjuncts;
+        for (std::size_t i = 0; i < variables.size(); ++i)
+        {
+            match.patterns.push_back(
+                ir::PathPattern{"", {ir::NodePattern{variables[i], "SoftwareSystem"}}, {}});
+            for (std::size_t j = i + 1; j < variables.size(); ++j)
+            {
+                conjuncts.push_back(ir::Make<ir::Binary>(ExprType::NOT_EQ,
+                                                         ir::Make<ir::Variable>(variables[i]),
+                                                         ir::Make<ir::Variable>(variables[j])));
+            }
+        }
+        conjuncts.push_back(std::move(predicate));
+        match.where = ir::Combine(ExprType::AND, std::move(conjuncts));
+        ir::Query result;
+        result.clauses.emplace_back(std::move(match));
+        return result;
+    };
+    const auto tagged = [](const std::string &variable)
+    {
+        return ir::Make<ir::Binary>(
+            ExprType::IN, ir::Make<ir::Literal>(ir::LiteralValue{std::string{"Platform"}}),
+            ir::Make<ir::Property>(ExprType::ACCESS, ir::Make<ir::Variable>(variable), "tags"));
+    };
+    const auto reduce = [](ir::Query query)
+    {
+        lang::ast::cypher::passes::SymmetryReduction{}.Run(query);
+        return ir::Print(query);
+    };
+
+    std::vector<ir::ExprPtr> pair;
+    pair.push_back(tagged("s1"));
+    pair.push_back(tagged("s2"));
+    EXPECT_EQ(reduce(query({"s1", "s2"}, ir::Combine(ExprType::XOR, std::move(pair)))),
+              R"(MATCH (s1:SoftwareSystem), (s2:SoftwareSystem) )"
+              R"(WHERE elementId(s1) < elementId(s2) AND )"
+              R"(("Platform" IN s1.tags XOR "Platform" IN s2.tags))");
+
+    std::vector<ir::ExprPtr> triple;
+    for (const auto *variable : {"a", "b", "c"})
+    {
+        triple.push_back(tagged(variable));
+    }
+    const auto chain = reduce(query({"a", "b", "c"}, ir::Combine(ExprType::OR, std::move(triple))));
+    EXPECT_NE(chain.find("WHERE elementId(a) < elementId(b) AND elementId(b) < elementId(c) AND"),
+              std::string::npos);
+
+    std::vector<ir::ExprPtr> route;
+    route.push_back(ir::Make<ir::Variable>("s1"));
+    route.push_back(ir::Make<ir::Variable>("s2"));
+    const auto directed =
+        reduce(query({"s1", "s2"}, ir::Make<ir::Call>("route", std::move(route))));
+    EXPECT_NE(directed.find("WHERE s1 <> s2 AND"), std::string::npos);
+}
@@ -0,0 +1,290 @@
+#include <eval/evaluator.hpp>
+#include <gtest/gtest.h>
+#include <vm/compiler.hpp>
+#include <vm/machine.hpp>
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using lang::ast::Expression;
+using lang::ast::ExpressionPtr;
+using lang::ast::ExprType;
+using lang::ast::eval::Value;
+
+template <typename T> ExpressionPtr Wrap(T node)
+{
+    return std::make_unique<Expression>(std::make_unique<T>(std::move(node)));
+}
+
+ExpressionPtr Literal(Value value)
+{
+    if (const auto *number = value.As<std::int64_t>(); number != nullptr)
+    {
+        return Wrap(lang::ast::LiteralExpr<std::int64_t>{*number});
+    }
+    if (const auto *flag = value.As<bool>(); flag != nullptr)
+    {
+        return Wrap(lang::ast::LiteralExpr<bool>{*flag});
+    }
+    return Wrap(lang::ast::LiteralExpr<std::string>{*value.As<std::string>()});
+}
+
+ExpressionPtr Variable(const std::string &name)
+{
+    return Wrap(lang::ast::VariableExpr{name, {}});
+}
+
+template <template <ExprType> class T, ExprType U>
+ExpressionPtr Binary(ExpressionPtr left, ExpressionPtr right)
+{
+    return Wrap(T<U>{std::move(left), std::move(right)});
+}
+
+constexpr std::array binaries{
+    &Binary<lang::ast::AddExpr, ExprType::PLUS>,
+    &Binary<lang::ast::AddExpr, ExprType::MINUS>,
+    &Binary<lang::ast::MultExpr, ExprType::MULT>,
+    &Binary<lang::ast::MultExpr, ExprType::DIV>,
+    &Binary<lang::ast::BooleanExpr, ExprType::EQ>,
+    &Binary<lang::ast::BooleanExpr, ExprType::NOT_EQ>,
+    &Binary<lang::ast::BooleanExpr, ExprType::LESS>,
+    &Binary<lang::ast::BooleanExpr, ExprType::GREATER>,
+    &Binary<lang::ast::BooleanExpr, ExprType::LESS_EQ>,
+    &Binary<lang::ast::BooleanExpr, ExprType::GREATER_EQ>,
+    &Binary<lang::ast::LogicalExpr, ExprType::IN>,
+    &Binary<lang::ast::LogicalExpr, ExprType::NOT_IN>,
+    &Binary<lang::ast::LogicalExpr, ExprType::AND>,
+    &Binary<lang::ast::LogicalExpr, ExprType::OR>,
+    &Binary<lang::ast::LogicalExpr, ExprType::XOR>,
+};
+
+// Random expressions over the variables of Row(), mixing types freely so that errors and nulls
+// are as common as values.
+class Generator
+{
+public:
+    explicit Generator(unsigned seed) : random_(seed)
+    {
+    }
+
+    ExpressionPtr operator()(int depth)
+    {
+        if (depth == 0 || Pick(4) == 0)
+        {
+            return Leaf();
+        }
+        switch (Pick(10))
+        {
+        case 0:
+        case 1: {
+            auto operand = Pick(4) == 0 ? (*this)(depth - 1) : Variable(Pick(2) ? "a" : "b");
+            auto prop = std::string{properties[Pick(properties.size())]};
+            if (Pick(3) == 0)
+            {
+                return Wrap(lang::ast::AccessExpr<ExprType::SAFE_ACCESS>{std::move(operand),
+                                                                         std::move(prop)});
+            }
+            return Wrap(
+                lang::ast::AccessExpr<ExprType::ACCESS>{std::move(operand), std::move(prop)});
+        }
+        case 2:
+            return Wrap(lang::ast::UnaryExpr<ExprType::NEG>{(*this)(depth - 1)});
+        case 3:
+            return Wrap(lang::ast::TernaryExpr{(*this)(depth - 1), (*this)(depth - 1),
+                                               (*this)(depth - 1)});
+        case 4: {
+            lang::ast::SetExpr set;
+            for (auto count = Pick(4); count > 0; --count)
+            {
+                set.items.push_back((*this)(depth - 1));
+            }
+            return Wrap(std::move(set));
+        }
+        default: {
+            auto left = (*this)(depth - 1);
+            return binaries[Pick(binaries.size())](std::move(left), (*this)(depth - 1));
+        }
+        }
+    }
+
+private:
+    static constexpr std::array<const char *, 6> properties{
+        "name", "tags", "technology", "instanceCount", "articulationPoint", "missing"};
+    static constexpr std::array<const char *, 6> variables{"a", "b", "n", "k", "s", "l"};
+
+    std::mt19937 random_;
+
+    std::size_t Pick(std::size_t count)
+    {
+        return random_() % count;
+    }
+
+    ExpressionPtr Leaf()
+    {
+        switch (Pick(5))
+        {
+        case 0:
+            return Literal(static_cast<std::int64_t>(Pick(5)));
+        case 1:
+            return Literal(Pick(2) == 0);
+        case 2:
+            return Literal(std::array{"Database", "Element", "API Gateway"}[Pick(3)]);
+        default:
+            return Variable(variables[Pick(variables.size())]);
+        }
+    }
+};
+
+const lang::ast::eval::Workspace &Workspace()
+{
+    static const auto workspace = []
+    {
+        std::ifstream file{WORKSPACE_JSON};
+        return lang::ast::eval::LoadWorkspace(nlohmann::json::parse(file));
+    }();
+    return workspace;
+}
+
+lang::ast::eval::Row Row()
+{
+    const auto &graph = Workspace().graph;
+    return {{"a", lang::ast::eval::Node{*graph.Find("11")}},
+            {"b", lang::ast::eval::Node{*graph.Find("6")}},
+            {"n", Value{}},
+            {"k", Value{std::int64_t{2}}},
+            {"s", Value{"Database"}},
+            {"l", Value{lang::ast::eval::List{"Database", std::int64_t{1}, Value{}}}}};
+}
+
+// The value, or the message of the error, the tree-walking evaluator gives.
+std::pair<std::optional<Value>, std::string> Walk(const ExpressionPtr &expr)
+{
+    lang::ast::eval::EvaluatorContext context{Workspace(), Row()};
+    try
+    {
+        return {lang::ast::eval::Evaluator<ExpressionPtr>{context}(expr), ""};
+    }
+    catch (const std::runtime_error &error)
+    {
+        return {std::nullopt, error.what()};
+    }
+}
+
+std::pair<std::optional<Value>, std::string> Execute(const lang::ast::vm::Program &program,
+                                                     const lang::ast::vm::Records &records)
+{
+    lang::ast::vm::Machine machine{program, records};
+    const auto row = Row();
+    std::vector<Value> arguments;
+    for (const auto &name : program.variables)
+    {
+        arguments.push_back(row.at(name));
+    }
+    try
+    {
+        return {machine.Run(arguments), ""};
+    }
+    catch (const std::runtime_error &error)
+    {
+        return {std::nullopt, error.what()};
+    }
+}
+
+} // namespace
+
+TEST(VmTestSmoke, DifferentialSmoke)
+{
+    const lang::ast::vm::Records records{Workspace()};
+    std::size_t values = 0;
+    for (unsigned seed = 0; seed < 3000; ++seed)
+    {
+        Generator generate{seed};
+        const auto expr = generate(1 + static_cast<int>(seed % 5));
+        const auto program = lang::ast::vm::Compile(expr);
+        const auto expected = Walk(expr);
+        EXPECT_EQ(Execute(program, records), expected)
+            << "seed " << seed << '\n'
+            << lang::ast::vm::Disassemble(program);
+        values += expected.first.has_value();
+    }
+    // Errors must not crowd out the values the comparison is about.
+    EXPECT_GT(values, 1000U);
+}
+
+TEST(VmTestSmoke, ProgramSmoke)
+{
+    // `false and 1 / 0` is decided by its left operand, `null and 1 / 0` is not.
+    const auto divide = []
+    {
+        return Binary<lang::ast::MultExpr, ExprType::DIV>(Literal(std::int64_t{1}),
+                                                          Literal(std::int64_t{0}));
+    };
+    const lang::ast::vm::PropertyMap none;
+    const auto shortCircuit = lang::ast::vm::Compile(
+        Binary<lang::ast::LogicalExpr, ExprType::AND>(Literal(false), divide()));
+    EXPECT_EQ(lang::ast::vm::Machine(shortCircuit, none).Run({}), Value{false});
+    const auto unknown = lang::ast::vm::Compile(
+        Binary<lang::ast::LogicalExpr, ExprType::AND>(Variable("x"), divide()));
+    lang::ast::vm::Machine machine{unknown, none};
+    const std::vector<Value> null{Value{}};
+    EXPECT_THROW(machine.Run(null), std::runtime_error);
+    EXPECT_THROW(machine.Run({}), std::runtime_error);
+
+    // A set of literals is one constant.
+    lang::ast::SetExpr set;
+    set.items.push_back(Literal(std::int64_t{1}));
+    set.items.push_back(Literal("x"));
+    const auto constant = lang::ast::vm::Compile(Wrap(std::move(set)));
+    ASSERT_EQ(constant.code.size(), 1U);
+    EXPECT_EQ(lang::ast::vm::Machine(constant, none).Run({}),
+              (Value{lang::ast::eval::List{std::int64_t{1}, "x"}}));
+
+    EXPECT_THROW(lang::ast::vm::Compile(Wrap(lang::ast::CallExpr{"count", {}, {}})),
+                 std::runtime_error);
+}
+
+TEST(VmTestSmoke, PropertyMapSmoke)
+{
+    // `c.count * 2 + 1 > 6 ? c.name : [c.name, c.!missing]`
+    const auto access = [](const char *prop)
+    { return Wrap(lang::ast::AccessExpr<ExprType::ACCESS>{Variable("c"), prop}); };
+    lang::ast::SetExpr set;
+    set.items.push_back(access("name"));
+    set.items.push_back(
+        Wrap(lang::ast::AccessExpr<ExprType::SAFE_ACCESS>{Variable("c"), "missing"}));
+    const auto program = lang::ast::vm::Compile(Wrap(lang::ast::TernaryExpr{
+        Binary<lang::ast::BooleanExpr, ExprType::GREATER>(
+            Binary<lang::ast::AddExpr, ExprType::PLUS>(
+                Binary<lang::ast::MultExpr, ExprType::MULT>(access("count"),
+                                                            Literal(std::int64_t{2})),
+                Literal(std::int64_t{1})),
+            Literal(std::int64_t{6})),
+        access("name"), Wrap(std::move(set))}));
+    ASSERT_EQ(program.variables, (std::vector<std::string>{"c"}));
+
+    lang::ast::vm::PropertyMap properties;
+    properties.Set({0}, "count", std::int64_t{3});
+    properties.Set({0}, "name", "first");
+    properties.Set({1}, "count", std::int64_t{2});
+    properties.Set({1}, "name", "second");
+    lang::ast::vm::Machine machine{program, properties};
+    const std::vector<Value> first{lang::ast::eval::Node{0}};
+    const std::vector<Value> second{lang::ast::eval::Node{1}};
+    const std::vector<Value> other{lang::ast::eval::Node{2}};
+    EXPECT_EQ(machine.Run(first), Value{"first"});
+    EXPECT_EQ(machine.Run(second),
+              (Value{lang::ast::eval::List{"second", false}}));
+    EXPECT_EQ(machine.Run(other),
+              (Value{lang::ast::eval::List{Value{}, false}}));
+}
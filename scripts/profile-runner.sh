@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+set -e
+
+# Profiles every example rule against the running neo4j-test container and prints a ranked
+# per-rule cost report. The captured plans are kept in examples/*/profile.txt so the report
+# can be rebuilt offline with ./artifacts/profile-report.
+
+chmod +x ./artifacts/dsl-parser ./artifacts/profile-report ./artifacts/graph-analysis
+export GRAPH_ANALYSIS=./artifacts/graph-analysis
+
+echo "=== Profiling all examples ==="
+
+for testdir in examples/*; do
+  if [ -d "$testdir" ]; then
+    echo "===== Profiling: $testdir ====="
+
+    python converter/converter.py -f "$testdir/workspace.json" \
+      --workspace "$(basename "$testdir")"
+
+    ./artifacts/dsl-parser \
+      -f "$testdir/input.arch" \
+      -o "$testdir/profile.cypher" \
+      -t profile
+
+    docker exec -i neo4j-test bin/cypher-shell --format verbose < "$testdir/profile.cypher" \
+      > "$testdir/profile.txt" 2>&1
+
+    docker exec -i neo4j-test bin/cypher-shell <<EOF2
+MATCH (n) DETACH DELETE n;
+EOF2
+  fi
+done
+
+./artifacts/profile-report examples/*/profile.txt
@@ -1,7 +1,8 @@
 #!/usr/bin/env bash
 set -e
 
-chmod +x ./artifacts/dsl-parser
+chmod +x ./artifacts/dsl-parser ./artifacts/graph-analysis
+export GRAPH_ANALYSIS=./artifacts/graph-analysis
 
 docker pull structurizr/cli:latest
 
@@ -18,7 +19,8 @@ for testdir in examples/*; do
       -format json \
       -output "$testdir/"
 
-    python converter/converter.py -f "$testdir/workspace.json"
+    python converter/converter.py -f "$testdir/workspace.json" \
+      --workspace "$(basename "$testdir")"
 
     ./artifacts/dsl-parser \
       -f "$testdir/input.arch" \
@@ -29,7 +31,12 @@ for testdir in examples/*; do
       > "$testdir/actual_result.txt" 2>&1
 
 
-    diff -u "$testdir/result.txt" "$testdir/actual_result.txt"
+    # UPDATE_RESULTS=1 records the output of this run as the expected result.
+    if [ -n "${UPDATE_RESULTS:-}" ]; then
+      cp "$testdir/actual_result.txt" "$testdir/result.txt"
+    else
+      diff -u "$testdir/result.txt" "$testdir/actual_result.txt"
+    fi
 
     docker exec -i neo4j-test bin/cypher-shell <<EOF
 MATCH (n) DETACH DELETE n;